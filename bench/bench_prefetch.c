@@ -0,0 +1,227 @@
+/**
+ * @file bench_prefetch.c
+ * @brief Effect of slot prefetching on rings larger than the last-level cache.
+ *
+ * For each element size and prefetch distance, a ring of about `ring_mb`
+ * megabytes is filled with `bufferWrite()` and then drained with
+ * `bufferRead()`, so the reader starts at slots that were evicted long ago.
+ * It is then filled again and drained by a zero-copy reader that claims
+ * each slot and only reads its first word, as a consumer dispatching on a
+ * header would. Each phase reports, per element:
+ * - the time taken,
+ * - last-level cache misses, read from the `perf` hardware counters where
+ *   the kernel allows it (`n/a` otherwise, e.g. in containers or with
+ *   `perf_event_paranoid` > 2).
+ *
+ * Usage: `bench_prefetch [ring_mb] [rounds]`
+ *
+ * Distance 0 is the baseline without software prefetch.
+ */
+#define _GNU_SOURCE
+#include "buffer.h"
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifndef USE_ATOMIC
+#error "bench_prefetch requires USE_ATOMIC"
+#endif
+
+#ifndef USE_PREFETCH
+#error "bench_prefetch requires USE_PREFETCH"
+#endif
+
+#define BENCH_DEFAULT_RING_MB 128
+#define BENCH_DEFAULT_ROUNDS 3
+
+static const uint16_t type_sizes[] = { 256, 1024, 4096 };
+static const uint16_t distances[] = { 0, 1, 2, 4, 8, 16 };
+
+/* -- Cache miss counter --------------------------------------------------- */
+
+/**
+ * @brief Opens a counter of last-level cache misses of this thread, or returns -1.
+ */
+static int missCounterOpen(void) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    return -1;
+#endif
+}
+
+static void missCounterStart(int fd) {
+#ifdef __linux__
+    if (fd < 0) return;
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#else
+    (void)fd;
+#endif
+}
+
+/**
+ * @brief Stops the counter and returns the misses since the start, or -1.
+ */
+static int64_t missCounterStop(int fd) {
+#ifdef __linux__
+    if (fd < 0) return -1;
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    uint64_t count;
+    if (read(fd, &count, sizeof(count)) != sizeof(count)) return -1;
+    return (int64_t)count;
+#else
+    (void)fd;
+    return -1;
+#endif
+}
+
+/* -- Ring setup ----------------------------------------------------------- */
+
+static Buffer* ringCreate(uint16_t size, uint16_t type_size) {
+    Buffer* buffer = calloc(1, sizeof(Buffer));
+    Lock_t* lock = calloc(1, sizeof(Lock_t));
+    void* raw = aligned_alloc(64, ((size_t)size * type_size + 63) & ~(size_t)63);
+    LockState_t* state = calloc(size, sizeof(LockState_t));
+    if (!buffer || !lock || !raw || !state) {
+        free(buffer); free(lock); free(raw); free(state);
+        return NULL;
+    }
+    INIT_LOCK(lock, state, size);
+    memset(raw, 0, (size_t)size * type_size);
+    *buffer = (Buffer){ .size = size, .type_size = type_size, .raw = raw, .lock = lock };
+    return buffer;
+}
+
+static void ringDestroy(Buffer* buffer) {
+    free((void*)buffer->lock->slot_state);
+    free(buffer->lock);
+    free(buffer->raw);
+    free(buffer);
+}
+
+/* -- Measurements --------------------------------------------------------- */
+
+typedef struct {
+    double ns;          ///< Nanoseconds per element
+    double misses;      ///< LLC misses per element, negative if unavailable
+} PhaseStats;
+
+static double elapsedSeconds(const struct timespec* a, const struct timespec* b) {
+    return (double)(b->tv_sec - a->tv_sec) + (double)(b->tv_nsec - a->tv_nsec) * 1e-9;
+}
+
+static void phaseAdd(PhaseStats* stats, double secs, int64_t misses, uint16_t count, int rounds) {
+    stats->ns += secs * 1e9 / count / rounds;
+    if (misses < 0 || stats->misses < 0) stats->misses = -1.0;
+    else stats->misses += (double)misses / count / rounds;
+}
+
+static void printPhase(const PhaseStats* stats) {
+    if (stats->misses < 0) printf(" %10.1f %10s", stats->ns, "n/a");
+    else printf(" %10.1f %10.2f", stats->ns, stats->misses);
+}
+
+static volatile uint64_t sink;
+
+static int runCase(uint16_t type_size, uint16_t distance, uint32_t ring_mb, int rounds, int counter) {
+    uint32_t slots = (ring_mb << 20) / type_size;
+    uint16_t size = slots > UINT16_MAX ? UINT16_MAX : (uint16_t)slots;
+    if (distance >= size) return 0;
+    Buffer* buffer = ringCreate(size, type_size);
+    uint8_t* element = malloc(type_size);
+    if (!buffer || !element) {
+        if (buffer) ringDestroy(buffer);
+        free(element);
+        return -ENOMEM;
+    }
+    memset(element, 0xA5, type_size);
+    (void)bufferSetPrefetch(buffer, distance);
+
+    PhaseStats write = {0}, read = {0}, peek = {0};
+    uint64_t sum = 0;
+    for (int r = 0; r < rounds; r++) {
+        struct timespec t0, t1;
+        missCounterStart(counter);
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (uint16_t i = 0; i < size; i++) {
+            element[0] = (uint8_t)i;
+            (void)bufferWrite(buffer, element);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        phaseAdd(&write, elapsedSeconds(&t0, &t1), missCounterStop(counter), size, rounds);
+
+        missCounterStart(counter);
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (uint16_t i = 0; i < size; i++) {
+            (void)bufferRead(buffer, element);
+            sum += element[0];
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        phaseAdd(&read, elapsedSeconds(&t0, &t1), missCounterStop(counter), size, rounds);
+
+        for (uint16_t i = 0; i < size; i++) (void)bufferWrite(buffer, element);
+        missCounterStart(counter);
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (uint16_t i = 0; i < size; i++) {
+            void* addr;
+            int index = bufferReadClaim(buffer, &addr);
+            sum += *(const uint64_t*)addr;
+            (void)bufferReadRelease(buffer, (uint16_t)index);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        phaseAdd(&peek, elapsedSeconds(&t0, &t1), missCounterStop(counter), size, rounds);
+    }
+    sink = sum;
+
+    printf("%9u %6u %8u", type_size, size, distance);
+    printPhase(&write);
+    printPhase(&read);
+    printPhase(&peek);
+    printf("\n");
+    ringDestroy(buffer);
+    free(element);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    long ring_mb = argc > 1 ? strtol(argv[1], NULL, 10) : BENCH_DEFAULT_RING_MB;
+    int rounds = argc > 2 ? (int)strtol(argv[2], NULL, 10) : BENCH_DEFAULT_ROUNDS;
+    if (ring_mb <= 0 || ring_mb > 1024) ring_mb = BENCH_DEFAULT_RING_MB;
+    if (rounds <= 0) rounds = BENCH_DEFAULT_ROUNDS;
+
+    int counter = missCounterOpen();
+    printf("%9s %6s %8s %10s %10s %10s %10s %10s %10s\n",
+        "type_size", "slots", "distance", "write ns", "write miss",
+        "read ns", "read miss", "peek ns", "peek miss");
+    for (size_t t = 0; t < sizeof(type_sizes) / sizeof(type_sizes[0]); t++) {
+        for (size_t d = 0; d < sizeof(distances) / sizeof(distances[0]); d++) {
+            if (runCase(type_sizes[t], distances[d], (uint32_t)ring_mb, rounds, counter) < 0) {
+                fprintf(stderr, "allocation failed\n");
+                return 1;
+            }
+        }
+    }
+#ifdef __linux__
+    if (counter >= 0) close(counter);
+#endif
+    return 0;
+}
@@ -0,0 +1,233 @@
+/**
+ * @file bench_stack.c
+ * @brief Throughput and scalability benchmark for the Stack container.
+ *
+ * Runs a set of push/pop workloads against every registered stack variant
+ * at increasing thread counts and reports, for each run:
+ * - successful operations per second,
+ * - the retry rate (`-EBUSY` results per attempted operation),
+ * - the empty/full rate (`-EAGAIN` / `-ENOSPC` per attempted operation),
+ * - per-thread fairness as Jain's index and the min/max success ratio.
+ *
+ * Usage: `bench_stack [duration_ms] [max_threads]`
+ *
+ * New stack implementations are benchmarked by adding an entry to
+ * `variants[]`, so scalability regressions show up side by side.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include "stack.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef USE_ATOMIC
+#error "bench_stack requires USE_ATOMIC"
+#endif
+
+#define BENCH_CAPACITY 4096
+#define BENCH_MAX_THREADS 64
+#define BENCH_DEFAULT_DURATION_MS 200
+
+/* -- Stack variants ------------------------------------------------------- */
+
+/**
+ * @brief Operations a stack implementation provides to the benchmark.
+ */
+typedef struct {
+    const char* name;                                    ///< Label used in the report
+    void* (*create)(uint16_t capacity, uint16_t type_size);
+    void (*destroy)(void* container);
+    int (*push)(void* container, const void* data);
+    int (*pop)(void* container, void* data);
+} StackVariant;
+
+static void* lockedCreate(uint16_t capacity, uint16_t type_size) {
+    Stack* stack = calloc(1, sizeof(Stack));
+    Lock_t* lock = calloc(1, sizeof(Lock_t));
+    void* raw = calloc(capacity, type_size);
+    atomic_uint_least8_t* slot_state = calloc(capacity, sizeof(atomic_uint_least8_t));
+    if (!stack || !lock || !raw || !slot_state) {
+        free(stack); free(lock); free(raw); free(slot_state);
+        return NULL;
+    }
+    for (uint16_t i = 0; i < capacity; i++) {
+        atomic_init(slot_state + i, BUFFER_FREE);
+    }
+    atomic_init(&lock->read, false);
+    atomic_init(&lock->write, false);
+    lock->slot_state = slot_state;
+    stack->lock = lock;
+    stack->raw = raw;
+    stack->size = capacity;
+    stack->type_size = type_size;
+    return stack;
+}
+
+static void lockedDestroy(void* container) {
+    Stack* stack = container;
+    free((void*)stack->lock->slot_state);
+    free(stack->lock);
+    free(stack->raw);
+    free(stack);
+}
+
+static int lockedPush(void* container, const void* data) { return stackPush(container, data); }
+static int lockedPop(void* container, void* data) { return stackPop(container, data); }
+
+static const StackVariant variants[] = {
+    { "locked", lockedCreate, lockedDestroy, lockedPush, lockedPop },
+};
+
+/* -- Workloads ------------------------------------------------------------ */
+
+typedef enum {
+    MIX_PUSH_HEAVY = 0,  ///< 75% push / 25% pop
+    MIX_POP_HEAVY,       ///< 25% push / 75% pop
+    MIX_BALANCED,        ///< 50% push / 50% pop
+    MIX_PAIRWISE,        ///< strict push followed by pop
+    MIX_COUNT
+} Mix;
+
+static const char* mix_names[MIX_COUNT] = { "push-heavy", "pop-heavy", "balanced", "pairwise" };
+static const uint32_t mix_push_pct[MIX_COUNT] = { 75, 25, 50, 0 };
+
+/**
+ * @brief Per-thread counters, padded to a cache line to avoid false sharing.
+ */
+typedef struct {
+    uint64_t attempts;
+    uint64_t success;
+    uint64_t busy;
+    uint64_t bounds;     ///< -EAGAIN (empty) or -ENOSPC (full)
+    uint8_t _pad[32];
+} ThreadStats;
+
+typedef struct {
+    const StackVariant* variant;
+    void* container;
+    Mix mix;
+    uint32_t seed;
+    atomic_bool* stop;
+    pthread_barrier_t* start;
+    ThreadStats* stats;
+} ThreadArgs;
+
+static inline uint32_t xorshift32(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static inline void record(ThreadStats* stats, int res) {
+    stats->attempts++;
+    if (res >= 0) stats->success++;
+    else if (res == -EBUSY) stats->busy++;
+    else stats->bounds++;
+}
+
+static void* worker(void* arg) {
+    ThreadArgs* args = arg;
+    const StackVariant* v = args->variant;
+    uint32_t rng = args->seed;
+    uint64_t value = args->seed;
+    pthread_barrier_wait(args->start);
+    while (!atomic_load_explicit(args->stop, memory_order_relaxed)) {
+        if (args->mix == MIX_PAIRWISE) {
+            record(args->stats, v->push(args->container, &value));
+            record(args->stats, v->pop(args->container, &value));
+        } else if (xorshift32(&rng) % 100 < mix_push_pct[args->mix]) {
+            record(args->stats, v->push(args->container, &value));
+        } else {
+            record(args->stats, v->pop(args->container, &value));
+        }
+    }
+    return NULL;
+}
+
+static double elapsedSeconds(const struct timespec* a, const struct timespec* b) {
+    return (double)(b->tv_sec - a->tv_sec) + (double)(b->tv_nsec - a->tv_nsec) * 1e-9;
+}
+
+static int runCase(const StackVariant* v, Mix mix, int threads, long duration_ms) {
+    void* container = v->create(BENCH_CAPACITY, sizeof(uint64_t));
+    if (!container) return -ENOMEM;
+    // prefill to half capacity so both pushes and pops can make progress
+    for (uint64_t i = 0; i < BENCH_CAPACITY / 2; i++) (void)v->push(container, &i);
+
+    pthread_t tids[BENCH_MAX_THREADS];
+    ThreadArgs args[BENCH_MAX_THREADS];
+    ThreadStats stats[BENCH_MAX_THREADS] = {0};
+    atomic_bool stop = false;
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, (unsigned)threads + 1);
+
+    for (int t = 0; t < threads; t++) {
+        args[t] = (ThreadArgs){
+            .variant = v, .container = container, .mix = mix,
+            .seed = 0x9e3779b9u * (uint32_t)(t + 1), .stop = &stop,
+            .start = &start, .stats = &stats[t],
+        };
+        pthread_create(&tids[t], NULL, worker, &args[t]);
+    }
+
+    struct timespec t0, t1;
+    struct timespec nap = { duration_ms / 1000, (duration_ms % 1000) * 1000000L };
+    pthread_barrier_wait(&start);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    nanosleep(&nap, NULL);
+    atomic_store(&stop, true);
+    for (int t = 0; t < threads; t++) pthread_join(tids[t], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    pthread_barrier_destroy(&start);
+    v->destroy(container);
+
+    uint64_t attempts = 0, success = 0, busy = 0, bounds = 0;
+    uint64_t min_ok = UINT64_MAX, max_ok = 0;
+    double sum_sq = 0.0;
+    for (int t = 0; t < threads; t++) {
+        attempts += stats[t].attempts;
+        success += stats[t].success;
+        busy += stats[t].busy;
+        bounds += stats[t].bounds;
+        if (stats[t].success < min_ok) min_ok = stats[t].success;
+        if (stats[t].success > max_ok) max_ok = stats[t].success;
+        sum_sq += (double)stats[t].success * (double)stats[t].success;
+    }
+    double secs = elapsedSeconds(&t0, &t1);
+    double jain = sum_sq > 0.0 ? ((double)success * (double)success) / (threads * sum_sq) : 0.0;
+    printf("%-8s %-10s %3d %14.0f %9.2f%% %9.2f%% %7.3f %7.3f\n",
+        v->name, mix_names[mix], threads,
+        (double)success / secs,
+        attempts ? 100.0 * (double)busy / (double)attempts : 0.0,
+        attempts ? 100.0 * (double)bounds / (double)attempts : 0.0,
+        jain,
+        max_ok ? (double)min_ok / (double)max_ok : 0.0);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    long duration_ms = argc > 1 ? strtol(argv[1], NULL, 10) : BENCH_DEFAULT_DURATION_MS;
+    int max_threads = argc > 2 ? (int)strtol(argv[2], NULL, 10) : BENCH_MAX_THREADS;
+    if (duration_ms <= 0) duration_ms = BENCH_DEFAULT_DURATION_MS;
+    if (max_threads <= 0 || max_threads > BENCH_MAX_THREADS) max_threads = BENCH_MAX_THREADS;
+
+    printf("%-8s %-10s %3s %14s %10s %10s %7s %7s\n",
+        "variant", "mix", "thr", "ops/sec", "retry", "empty/full", "jain", "min/max");
+    for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++) {
+        for (int mix = 0; mix < MIX_COUNT; mix++) {
+            for (int threads = 1; threads <= max_threads; threads *= 2) {
+                if (runCase(&variants[v], (Mix)mix, threads, duration_ms) < 0) {
+                    fprintf(stderr, "%s: allocation failed\n", variants[v].name);
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
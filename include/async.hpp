@@ -0,0 +1,307 @@
+#pragma once
+/**
+ * @file async.hpp
+ * @brief C++20 coroutine awaitables for Buffer, Queue and Stack.
+ *
+ * `AsyncBuffer<T>`, `AsyncStack<T>` and `AsyncQueue` wrap an existing
+ * container and expose `co_await ring.push(...)` / `co_await ring.pop()`:
+ * - If data (or space) is available the operation completes inline, without
+ *   suspending and without taking the wait-list lock.
+ * - Otherwise the coroutine is queued on a wait list owned by the wrapper.
+ *   The next successful operation on the opposite end performs the pending
+ *   operation on behalf of the waiter and schedules it for resumption.
+ * - Resumptions are handed out in batches to a user-provided `Resumer`,
+ *   e.g. an event loop or an `Executor`; without one they run inline.
+ *
+ * All producers and consumers of a wrapped container must go through the
+ * wrapper, otherwise waiters are not notified. A coroutine must not be
+ * destroyed while it is suspended on a wrapper.
+ */
+#include "buffer.h"
+#include "queue.h"
+#include "stack.h"
+#include <atomic>
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace buffers {
+
+/**
+ * @brief Destination for batches of coroutines ready to resume.
+ *
+ * `post` receives up to `ASYNC_RESUME_BATCH` handles at a time and is
+ * expected to resume each of them, typically on another thread. When `post`
+ * is null the handles are resumed inline by the notifying thread.
+ */
+struct Resumer {
+    void (*post)(void* ctx, std::coroutine_handle<>* handles, std::size_t count) = nullptr;
+    void* ctx = nullptr;
+};
+
+#ifndef ASYNC_RESUME_BATCH
+#define ASYNC_RESUME_BATCH 16  ///< Maximum number of handles per `Resumer::post` call
+#endif
+
+namespace detail {
+
+/** @brief Minimal test-and-set lock guarding the wait lists. */
+class SpinLock {
+public:
+    void lock() { while (flag_.test_and_set(std::memory_order_acquire)); }
+    void unlock() { flag_.clear(std::memory_order_release); }
+private:
+    std::atomic_flag flag_ = ATOMIC_FLAG_INIT;
+};
+
+/** @brief Pending operation of a suspended coroutine. */
+struct Waiter {
+    Waiter* next = nullptr;
+    std::coroutine_handle<> handle;
+    bool (*attempt)(Waiter*) = nullptr;  ///< Performs the operation; false if it must keep waiting
+};
+
+/** @brief Intrusive FIFO of waiters. */
+struct WaitList {
+    Waiter* head = nullptr;
+    Waiter* tail = nullptr;
+
+    void push(Waiter* w) {
+        w->next = nullptr;
+        if (tail) tail->next = w; else head = w;
+        tail = w;
+    }
+    Waiter* pop() {
+        Waiter* w = head;
+        head = w->next;
+        if (!head) tail = nullptr;
+        return w;
+    }
+};
+
+/** @brief Retries an operation for as long as it only failed on contention. */
+template <typename Op>
+int retryBusy(Op op) {
+    int res;
+    do { res = op(); } while (res == -EBUSY);
+    return res;
+}
+
+template <typename T>
+struct BufferTraits {
+    static_assert(std::is_trivially_copyable_v<T>, "elements are copied bytewise");
+    using Container = Buffer;
+    using PushArg = T;
+    using PopArg = T;
+    using PopResult = T;
+    static constexpr int kFull = -ENOSPC;
+    static constexpr int kEmpty = -EAGAIN;
+    static int push(Buffer* c, const T& v) { return bufferWrite(c, &v); }
+    static int pop(Buffer* c, T& out) { return bufferRead(c, &out); }
+    static T result(T& out, int) { return out; }
+};
+
+template <typename T>
+struct StackTraits {
+    static_assert(std::is_trivially_copyable_v<T>, "elements are copied bytewise");
+    using Container = Stack;
+    using PushArg = T;
+    using PopArg = T;
+    using PopResult = T;
+    static constexpr int kFull = -ENOSPC;
+    static constexpr int kEmpty = -EAGAIN;
+    static int push(Stack* c, const T& v) { return stackPush(c, &v); }
+    static int pop(Stack* c, T& out) { return stackPop(c, &out); }
+    static T result(T& out, int) { return out; }
+};
+
+struct QueueTraits {
+    struct Message { const uint8_t* data; uint16_t len; };
+    struct Destination { uint8_t* data; uint16_t len; };
+    using Container = Queue;
+    using PushArg = Message;
+    using PopArg = Destination;
+    using PopResult = int;
+    static constexpr int kFull = -ENOSPC;
+    static constexpr int kEmpty = -EAGAIN;
+    static int push(Queue* c, const Message& m) { return queueWrite(c, m.data, m.len); }
+    static int pop(Queue* c, Destination& d) { return queueRead(c, d.data, d.len); }
+    static int result(Destination&, int res) { return res; }
+};
+
+} // namespace detail
+
+/**
+ * @brief Awaitable wrapper around a container described by `Traits`.
+ *
+ * Use through the `AsyncBuffer`, `AsyncStack` and `AsyncQueue` aliases.
+ */
+template <typename Traits>
+class AsyncRing {
+public:
+    using Container = typename Traits::Container;
+
+    explicit AsyncRing(Container* container, Resumer resumer = {})
+        : container_(container), resumer_(resumer) {}
+
+    AsyncRing(const AsyncRing&) = delete;
+    AsyncRing& operator=(const AsyncRing&) = delete;
+
+    /** @brief Awaiter returned by `push()`; resumes with the container's result. */
+    class PushAwaiter : detail::Waiter {
+    public:
+        bool await_ready() {
+            res_ = detail::retryBusy([&] { return Traits::push(ring_->container_, arg_); });
+            if (res_ == Traits::kFull) return false;
+            ring_->notify();
+            return true;
+        }
+        bool await_suspend(std::coroutine_handle<> h) {
+            handle = h;
+            return ring_->suspend(ring_->push_waiters_, this);
+        }
+        int await_resume() const { return res_; }
+
+    private:
+        friend class AsyncRing;
+        PushAwaiter(AsyncRing* ring, const typename Traits::PushArg& arg) : ring_(ring), arg_(arg) {
+            attempt = [](detail::Waiter* w) {
+                auto* self = static_cast<PushAwaiter*>(w);
+                self->res_ = detail::retryBusy([&] { return Traits::push(self->ring_->container_, self->arg_); });
+                return self->res_ != Traits::kFull;
+            };
+        }
+        AsyncRing* ring_;
+        typename Traits::PushArg arg_;
+        int res_ = 0;
+    };
+
+    /** @brief Awaiter returned by `pop()`; resumes with the popped value. */
+    class PopAwaiter : detail::Waiter {
+    public:
+        bool await_ready() {
+            res_ = detail::retryBusy([&] { return Traits::pop(ring_->container_, arg_); });
+            if (res_ == Traits::kEmpty) return false;
+            ring_->notify();
+            return true;
+        }
+        bool await_suspend(std::coroutine_handle<> h) {
+            handle = h;
+            return ring_->suspend(ring_->pop_waiters_, this);
+        }
+        typename Traits::PopResult await_resume() { return Traits::result(arg_, res_); }
+
+    private:
+        friend class AsyncRing;
+        PopAwaiter(AsyncRing* ring, const typename Traits::PopArg& arg) : ring_(ring), arg_(arg) {
+            attempt = [](detail::Waiter* w) {
+                auto* self = static_cast<PopAwaiter*>(w);
+                self->res_ = detail::retryBusy([&] { return Traits::pop(self->ring_->container_, self->arg_); });
+                return self->res_ != Traits::kEmpty;
+            };
+        }
+        AsyncRing* ring_;
+        typename Traits::PopArg arg_;
+        int res_ = 0;
+    };
+
+    /** @brief Push an element, suspending while the container is full. */
+    PushAwaiter push(const typename Traits::PushArg& arg) { return PushAwaiter(this, arg); }
+
+    /** @brief Pop an element, suspending while the container is empty. */
+    PopAwaiter pop() requires std::is_same_v<typename Traits::PopArg, typename Traits::PopResult> {
+        return PopAwaiter(this, typename Traits::PopArg{});
+    }
+
+    /** @brief Pop into caller-provided storage, suspending while the container is empty. */
+    PopAwaiter pop(const typename Traits::PopArg& arg)
+        requires (!std::is_same_v<typename Traits::PopArg, typename Traits::PopResult>) {
+        return PopAwaiter(this, arg);
+    }
+
+    /** @brief Number of coroutines currently suspended on this wrapper. */
+    std::size_t waiting() const { return waiting_.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * Enqueues `w` unless its operation succeeds under the lock. The waiter
+     * count is raised before the retry, pairing with the fence in `notify()`:
+     * either the retry sees the other side's progress, or the other side
+     * sees the waiter.
+     */
+    bool suspend(detail::WaitList& list, detail::Waiter* w) {
+        lock_.lock();
+        waiting_.fetch_add(1, std::memory_order_seq_cst);
+        if (w->attempt(w)) {
+            waiting_.fetch_sub(1, std::memory_order_relaxed);
+            lock_.unlock();
+            notify();
+            return false;
+        }
+        list.push(w);
+        lock_.unlock();
+        return true;
+    }
+
+    /** Completes as many waiters as possible and hands them to the resumer. */
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_.load(std::memory_order_relaxed) == 0) return;
+        std::coroutine_handle<> batch[ASYNC_RESUME_BATCH];
+        std::size_t count;
+        do {
+            count = 0;
+            lock_.lock();
+            bool progress = true;
+            while (progress && count < ASYNC_RESUME_BATCH) {
+                progress = serve(pop_waiters_, batch, count);
+                if (count < ASYNC_RESUME_BATCH) progress |= serve(push_waiters_, batch, count);
+            }
+            lock_.unlock();
+            dispatch(batch, count);
+        } while (count == ASYNC_RESUME_BATCH);
+    }
+
+    bool serve(detail::WaitList& list, std::coroutine_handle<>* batch, std::size_t& count) {
+        if (!list.head || !list.head->attempt(list.head)) return false;
+        batch[count++] = list.pop()->handle;
+        waiting_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void dispatch(std::coroutine_handle<>* batch, std::size_t count) {
+        if (count == 0) return;
+        if (resumer_.post) {
+            resumer_.post(resumer_.ctx, batch, count);
+            return;
+        }
+        for (std::size_t i = 0; i < count; i++) batch[i].resume();
+    }
+
+    Container* container_;
+    Resumer resumer_;
+    detail::SpinLock lock_;
+    std::atomic<std::size_t> waiting_{0};
+    detail::WaitList push_waiters_;
+    detail::WaitList pop_waiters_;
+};
+
+/** @brief Awaitable FIFO of `T` over a `Buffer` with `type_size == sizeof(T)`. */
+template <typename T>
+using AsyncBuffer = AsyncRing<detail::BufferTraits<T>>;
+
+/** @brief Awaitable LIFO of `T` over a `Stack` with `type_size == sizeof(T)`. */
+template <typename T>
+using AsyncStack = AsyncRing<detail::StackTraits<T>>;
+
+/**
+ * @brief Awaitable message queue over a `Queue`.
+ *
+ * `co_await q.push({data, len})` resumes with the number of bytes written;
+ * `co_await q.pop({dest, capacity})` resumes with the number of bytes read.
+ */
+using AsyncQueue = AsyncRing<detail::QueueTraits>;
+
+} // namespace buffers
@@ -10,14 +10,42 @@
  * internally, although it may use a BlockAllocator for memory management. 
  */
 #include "locking.h"
+#include "watermark.h"
+#include "stride.h"
 #ifdef USE_BITMAP_ALLOCATOR
 #include "block_allocator.h"
 #endif
 #include <stdbool.h>
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define BUFFER_OK 0 // success
 
+#ifdef USE_ATOMIC
+typedef atomic_uint_least32_t BufferWord_t;  ///< Counter storage
+#else
+typedef uint32_t BufferWord_t;               ///< Counter storage
+#endif
+
+/**
+ * @brief Decides whether an element is passed on by `bufferTransferWith()`.
+ * @param ctx     Context passed to `bufferTransferWith()`.
+ * @param element The element, read in place from the source slot.
+ * @return `true` to transfer the element, `false` to drop it.
+ */
+typedef bool (*BufferFilterFn)(void* ctx, const void* element);
+
+/**
+ * @brief Produces the destination element in `bufferTransferWith()`.
+ * @param ctx Context passed to `bufferTransferWith()`.
+ * @param dst Destination slot, `type_size` bytes of the destination buffer.
+ * @param src Source slot, `type_size` bytes of the source buffer.
+ */
+typedef void (*BufferMapFn)(void* ctx, void* dst, const void* src);
+
 /**
  * @brief Creates a statically allocated circular buffer instance.
  *
@@ -40,17 +68,49 @@
         .lock = &__##name##_lock,           \
     };                                      \
 
+/**
+ * @brief Creates a statically allocated circular buffer with aligned, padded slots.
+ *
+ * @param name  The identifier for the buffer instance.
+ * @param S     Number of elements the buffer can hold.
+ * @param T     The data type of each element in the buffer.
+ * @param A     Slot alignment in bytes: 8, 16, 32 or 64.
+ *
+ * Like `CREATE_BUFFER()`, but every slot starts on an `A` byte boundary and
+ * is padded to `SLOT_STRIDE(T, A)` bytes.
+ */
+#define CREATE_BUFFER_ALIGNED(name, S, T, A)                \
+    SLOT_ALIGNAS(A) uint8_t name##_raw[(S) * SLOT_STRIDE(T, A)]; \
+    CREATE_LOCK(__##name##_lock, S);                        \
+    Buffer name = {                                         \
+        .full = false,                                      \
+        .head = 0,                                          \
+        .tail = 0,                                          \
+        .size = (S),                                        \
+        .type_size = (T),                                   \
+        .stride = SLOT_STRIDE(T, A),                        \
+        .raw = name##_raw,                                  \
+        .lock = &__##name##_lock,                           \
+    };                                                      \
+
 /**
  * @brief Circular FIFO buffer for fixed-size elements.
  */
 typedef struct {
     bool full;                          ///< Indicates whether the buffer is full
+    LockState_t epoch;                  ///< Generation of the contents, advanced by `bufferClear()`
     uint16_t head;                      ///< Index for next write
     uint16_t tail;                      ///< Index for next read
     uint16_t size;                      ///< Total number of elements the buffer can hold
     uint16_t type_size;                 ///< Size of each element in bytes
+    uint16_t prefetch;                  ///< Slots ahead to prefetch on each claim, 0 if disabled
+    uint16_t stream_min;                ///< Smallest write copied with non-temporal stores, 0 if disabled
+    uint16_t stride;                    ///< Distance between aligned slots in bytes, 0 if packed at `type_size`
     void* raw;                          ///< Pointer to the raw memory backing the buffer
     Lock_t* lock;                       ///< Pointer to the lock structure
+    Watermark* watermark;               ///< Optional fill level notifications, NULL if unused
+    uint32_t* checksum;                 ///< Optional per-slot CRC32C, `size` entries, NULL if unused
+    BufferWord_t dropped;               ///< Elements lost by `bufferTransferWith()`; see `bufferDropped()`
 } Buffer;
 
 #ifdef USE_BITMAP_ALLOCATOR
@@ -66,6 +126,22 @@ typedef struct {
  */
 Buffer* bufferAllocate(BlockAllocator* allocator, uint16_t size, uint16_t type_size);
 
+/**
+ * @brief Allocates and initializes a new buffer with aligned, padded slots.
+ *
+ * Every slot starts on an `align` byte boundary and is padded to
+ * `SLOT_STRIDE(type_size, align)` bytes; see `bufferStride()`.
+ *
+ * @param allocator The BlockAllocator used to obtain memory for the Buffer and its storage.
+ * @param size The number of elements the buffer can hold.
+ * @param type_size The size of each element in bytes.
+ * @param align Slot alignment in bytes: 8, 16, 32 or 64.
+ *
+ * @return A pointer to the initialized Buffer on success, or `NULL` if allocation fails
+ * or if invalid parameters are provided.
+ */
+Buffer* bufferAllocateAligned(BlockAllocator* allocator, uint16_t size, uint16_t type_size, uint16_t align);
+
 /**
  * @brief Deallocates a buffer and its storage.
  * 
@@ -80,12 +156,118 @@ int bufferDeallocate(BlockAllocator* allocator, Buffer** buffer);
 #endif
 
 /**
- * @brief Resets the buffer without clearing contents.
- * 
+ * @brief Discards all elements in O(1), without touching their contents.
+ *
+ * Safe to call while producers and consumers are active. Slots that are
+ * claimed at the time of the clear are invalidated: their release reports
+ * `-ESTALE` and frees the slot instead of publishing or keeping it, however
+ * many clears have happened since. Every 31st clear also walks the slot
+ * states once, so it runs in O(size). An attached watermark that has fired
+ * `WATERMARK_HIGH` fires `WATERMARK_LOW` with a count of 0.
+ *
  * @param buffer The Buffer to clear. No action is taken if NULL.
  */
 void bufferClear(Buffer* buffer);
 
+/**
+ * @brief Attaches a watermark to the buffer, or detaches it if NULL.
+ *
+ * Set up before producers and consumers start; the watermark must outlive
+ * its attachment.
+ *
+ * @param buffer    The Buffer to observe.
+ * @param watermark Initialized watermark, or NULL.
+ * @return `BUFFER_OK` on success, or `-EINVAL` if arguments are invalid.
+ */
+int bufferSetWatermark(Buffer* buffer, Watermark* watermark);
+
+/**
+ * @brief Returns the distance in bytes between the starts of consecutive slots.
+ *
+ * This is `type_size` for buffers created without an alignment, and
+ * `type_size` rounded up to the alignment otherwise.
+ *
+ * @param buffer The Buffer to query.
+ */
+uint16_t bufferStride(const Buffer* buffer);
+
+/**
+ * @brief Sets how many slots ahead of each claim are prefetched, 0 to disable.
+ *
+ * Each `bufferReadClaim()` prefetches the data and state of the slot
+ * `distance` positions after the one it claimed, and each
+ * `bufferWriteClaim()` does the same with write intent. Every read and write
+ * path, including `bufferTransfer()` and the `Queue` and drain built on the
+ * buffer, goes through a claim, so a consumer walking a ring larger than
+ * the cache finds the next slots already loaded. A distance covering the
+ * time to process a few slots is usually enough; the best value depends on
+ * `type_size` and the work done per element.
+ *
+ * Prefetching is opt-in at build time: the library must be configured with
+ * `-DUSE_PREFETCH=ON`, otherwise the claims carry no prefetch code at all.
+ *
+ * @param buffer   The Buffer to configure.
+ * @param distance Number of slots ahead, less than `size`.
+ * @return `BUFFER_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-ENOTSUP` if `distance` is not 0 and the library was built without `USE_PREFETCH`
+ */
+int bufferSetPrefetch(Buffer* buffer, uint16_t distance);
+
+/**
+ * @brief Copies writes of at least `threshold` bytes with non-temporal stores, 0 to disable.
+ *
+ * Non-temporal stores bypass the producer's cache, which is worthwhile when
+ * multi-KB elements are handed to a consumer on another core: the producer
+ * keeps its own working set, and the consumer's reads are served from
+ * memory instead of snooping the producer's cache. Smaller writes keep
+ * ordinary stores, since they are likely read while still cached.
+ *
+ * Applies to `bufferWrite()` / `bufferWriteRaw()` and everything built on
+ * them, such as `queueWrite()`. The data is fenced before the slot is
+ * published. On targets without the instructions, writes are copied as usual.
+ *
+ * @param buffer    The Buffer to configure.
+ * @param threshold Smallest write, in bytes, to stream; 0 to disable.
+ * @return `BUFFER_OK` on success, or `-EINVAL` if `buffer` is NULL.
+ */
+int bufferSetStreaming(Buffer* buffer, uint16_t threshold);
+
+/**
+ * @brief Enables per-slot CRC32C checksums, or disables them if NULL.
+ *
+ * With checksums enabled, every published element is checksummed and every
+ * element read through `bufferRead()` / `bufferReadRaw()` is verified; both
+ * happen in the same pass as the copy. Elements published with
+ * `bufferWriteRelease()` are checksummed at release, and zero-copy readers
+ * check them with `bufferVerify()`. A checksum always covers the whole slot
+ * (`type_size` bytes).
+ *
+ * The array may live in shared or persistent memory next to the slots, so a
+ * process attaching to an existing ring can validate what it finds. Set up
+ * before producers and consumers start.
+ *
+ * @param buffer   The Buffer to protect.
+ * @param checksum Array of `size` checksums, or NULL.
+ * @return `BUFFER_OK` on success, or `-EINVAL` if `buffer` is NULL.
+ */
+int bufferSetChecksums(Buffer* buffer, uint32_t* checksum);
+
+/**
+ * @brief Checks a claimed slot against its checksum.
+ *
+ * Intended for zero-copy readers between `bufferReadClaim()` and
+ * `bufferReadRelease()`; the slot must still be claimed.
+ *
+ * @param buffer The Buffer holding the slot.
+ * @param index  Slot index returned by `bufferReadClaim()`.
+ * @return `BUFFER_OK` if the slot matches or checksums are disabled, or a
+ *         negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBADMSG` if the slot does not match its checksum
+ */
+int bufferVerify(const Buffer* buffer, uint16_t index);
+
 /**
  * @brief Checks if the buffer is empty.
  * 
@@ -142,7 +324,10 @@ int bufferWriteClaim(Buffer* buffer, void** out_addr);
  * 
  * @param buffer Pointer to the buffer.
  * @param index Slot index to release.
- * @return negative errno on failure
+ * @return `BUFFER_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EPERM` if the slot is not claimed
+ * - `-ESTALE` if the buffer was cleared since the claim; the slot is freed
  */
 int bufferWriteRelease(Buffer* buffer, uint16_t index);
 
@@ -155,6 +340,7 @@ int bufferWriteRelease(Buffer* buffer, uint16_t index);
  * @return slot index on success, or a negative errno value if:
  * - `-EINVAL` if arguments are invalid
  * - `-EAGAIN` if the buffer is empty
+ * - `-EBADMSG` if the element does not match its checksum; it is consumed
  */
 int bufferRead(Buffer* buffer, void* data);
 
@@ -168,6 +354,7 @@ int bufferRead(Buffer* buffer, void* data);
  * @return slot index on success, or a negative errno value if:
  * - `-EINVAL` if arguments are invalid
  * - `-EAGAIN` if the buffer is empty
+ * - `-EBADMSG` if the element does not match its checksum; it is consumed
  */
 int bufferReadRaw(Buffer* buffer, void* data, uint16_t size);
 
@@ -186,6 +373,106 @@ int bufferReadClaim(Buffer* buffer, void** out_addr);
  * 
  * @param buffer Pointer to the buffer.
  * @param index Slot index to release.
- * @return negative errno on failure
+ * @return `BUFFER_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EPERM` if the slot is not claimed
+ * - `-ESTALE` if the buffer was cleared since the claim; the slot is freed
  */
-int bufferReadRelease(Buffer* buffer, uint16_t index);
\ No newline at end of file
+int bufferReadRelease(Buffer* buffer, uint16_t index);
+
+/**
+ * @brief Move elements from one buffer to another with a single copy.
+ *
+ * Each element is copied directly from its slot in `src` into a slot in
+ * `dst`, without an intermediate copy. Both buffers must have the same
+ * `type_size`. If `src` keeps checksums, an element that does not match its
+ * checksum is consumed but not moved, and ends the transfer.
+ *
+ * @param src       Buffer to take elements from.
+ * @param dst       Buffer to append elements to.
+ * @param max_count Maximum number of elements to move.
+ * @return Number of elements moved, or a negative errno value if nothing was moved:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EAGAIN` if `src` is empty
+ * - `-ENOSPC` if `dst` is full
+ * - `-EBUSY` if either buffer was contended; retry
+ * - `-EBADMSG` if the first element does not match its checksum; it is consumed
+ */
+int bufferTransfer(Buffer* src, Buffer* dst, uint16_t max_count);
+
+/**
+ * @brief Move elements between buffers, filtering and/or mapping them on the way.
+ *
+ * `filter` is evaluated on the element in place; rejected elements are
+ * consumed from `src` but not written to `dst`. `map` writes the destination
+ * element directly into its slot, so `src` and `dst` may have different
+ * element sizes. Without `map`, elements are copied as-is.
+ *
+ * An element whose claim on `src` cannot be undone because another reader
+ * claimed a later slot, and that `dst` cannot take, is written back at the
+ * head of `src`. Should `src` have no room left for it either, the element
+ * is dropped, the transfer stops and the drop is counted in
+ * `bufferDropped()` of `src`; the return value still counts the elements
+ * moved before it.
+ *
+ * An element that does not match its checksum is consumed, as by
+ * `bufferRead()`, and stops the transfer.
+ *
+ * @param src       Buffer to take elements from.
+ * @param dst       Buffer to append elements to.
+ * @param max_count Maximum number of elements to consume from `src`.
+ * @param filter    Optional filter, or NULL to keep every element.
+ * @param map       Optional transform, or NULL to copy elements unchanged.
+ * @param ctx       Context passed to `filter` and `map`.
+ *
+ * @return Number of elements written to `dst` (0 if all were filtered out),
+ * or a negative errno value as for `bufferTransfer()` if nothing was moved.
+ */
+int bufferTransferWith(Buffer* src, Buffer* dst, uint16_t max_count,
+                       BufferFilterFn filter, BufferMapFn map, void* ctx);
+
+/**
+ * @brief Returns the number of elements `bufferTransferWith()` has dropped from `buffer`.
+ *
+ * Counts elements taken from `buffer` as a source that could neither be
+ * moved to the destination nor put back. The count is never reset.
+ *
+ * @param buffer The source Buffer; 0 if NULL.
+ */
+uint32_t bufferDropped(Buffer* buffer);
+
+/**
+ * @brief Finds the oldest ready element whose key field equals `key`.
+ *
+ * The key is an unsigned integer field of `width` bytes at byte `offset` of
+ * each element, compared in native byte order. Elements are scanned in
+ * place, oldest first, with vector compares across slots where the CPU
+ * supports them; nothing is consumed. Slots still claimed by a writer are
+ * skipped.
+ *
+ * @param buffer The Buffer to search.
+ * @param offset Byte offset of the key field within an element.
+ * @param width  Width of the key field in bytes: 1, 2, 4 or 8.
+ * @param key    Key to look for; only the low `width` bytes are compared.
+ * @return Slot index of the match, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid or the field lies outside the element
+ * - `-EBUSY` if the read lock is held by another thread
+ * - `-ENOENT` if no ready element matches
+ */
+int bufferFind(Buffer* buffer, uint16_t offset, uint16_t width, uint64_t key);
+
+/**
+ * @brief Counts the ready elements whose key field equals `key`.
+ *
+ * @param buffer The Buffer to search.
+ * @param offset Byte offset of the key field within an element.
+ * @param width  Width of the key field in bytes: 1, 2, 4 or 8.
+ * @param key    Key to look for; only the low `width` bytes are compared.
+ * @return Number of matching elements, or a negative errno value as for `bufferFind()`
+ * other than `-ENOENT`.
+ */
+int bufferCountMatches(Buffer* buffer, uint16_t offset, uint16_t width, uint64_t key);
+
+#ifdef __cplusplus
+}
+#endif
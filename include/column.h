@@ -0,0 +1,246 @@
+#pragma once
+/**
+ * @file column.h
+ * @brief Struct-of-arrays circular buffer for columnar consumers.
+ *
+ * A `ColumnBuffer` stores the fields of its records in separate column
+ * arrays instead of storing whole records slot by slot. Row `i` of the ring
+ * is field `f` at `columns[f] + i * fields[f].size` for every field, so a
+ * consumer that only needs one or two fields touches only their columns.
+ *
+ * - Records are described by a list of `ColumnField` descriptors, typically
+ *   built with `COLUMN_FIELD()` from the members of a struct.
+ * - `columnWrite()` scatters a record into the columns and `columnRead()`
+ *   gathers it back, both through the slot claims of an embedded `Buffer`,
+ *   so every column shares one head, one tail and one set of slot states.
+ * - `columnReadSpan()` claims a run of consecutive rows at once and
+ *   `columnSpanData()` returns each column of the run as a plain array, ready
+ *   for vectorized scans without any copy. Every column starts on a
+ *   `COLUMN_ALIGN` byte boundary. `columnSpanFind()` searches one column of a
+ *   span with the SIMD kernels of `bufferFind()`.
+ */
+#include "buffer.h"
+#include "locking.h"
+#include "stride.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define COLUMN_OK 0 // success
+
+#define COLUMN_MAX_FIELDS 8     // maximum number of fields in a record
+#define COLUMN_ALIGN 64         // alignment of the start of every column in bytes
+
+/**
+ * @brief Location of one field within a record.
+ */
+typedef struct {
+    uint16_t offset;    ///< Offset of the field from the start of the record in bytes
+    uint16_t size;      ///< Size of the field in bytes
+} ColumnField;
+
+/** @brief Descriptor of the field `member` of the record type `T`. */
+#define COLUMN_FIELD(T, member) { (uint16_t)offsetof(T, member), (uint16_t)sizeof(((T*)0)->member) }
+
+/** @brief Number of entries of a field descriptor array. */
+#define COLUMN_FIELD_COUNT(fields_) ((uint16_t)(sizeof(fields_) / sizeof((fields_)[0])))
+
+/**
+ * @brief Bytes of column storage for `S` records of `record_size` bytes with `field_count` fields.
+ *
+ * Covers every column, each padded to a `COLUMN_ALIGN` byte boundary.
+ */
+#define COLUMN_STORAGE_SIZE(S, record_size, field_count) \
+    ((uint32_t)(S) * (record_size) + (uint32_t)(field_count) * COLUMN_ALIGN)
+
+/**
+ * @brief Creates a statically allocated column buffer instance.
+ *
+ * @param id      The identifier for the column buffer instance.
+ * @param S       Number of records the buffer can hold.
+ * @param T       The record type.
+ * @param fields_ Array of `ColumnField` descriptors of the stored fields of `T`.
+ *
+ * This macro defines the column storage and the lock using static memory,
+ * then lays the columns out with `columnInit()`.
+ */
+#define CREATE_COLUMN_BUFFER(id, S, T, fields_)                                             \
+    SLOT_ALIGNAS(COLUMN_ALIGN) uint8_t __##id##_raw[                                        \
+        COLUMN_STORAGE_SIZE(S, sizeof(T), COLUMN_FIELD_COUNT(fields_))];                    \
+    CREATE_LOCK(__##id##_lock, S);                                                          \
+    ColumnBuffer id = {                                                                     \
+        .rows = { .size = (S), .lock = &__##id##_lock },                                    \
+    };                                                                                      \
+    (void)columnInit(&id, __##id##_raw, sizeof(T), fields_, COLUMN_FIELD_COUNT(fields_))
+
+/**
+ * @brief Circular FIFO buffer of records stored as one array per field.
+ */
+typedef struct {
+    Buffer rows;                            ///< Slot states, head and tail of the rows; its storage is column 0
+    uint8_t* columns[COLUMN_MAX_FIELDS];    ///< Start of each column, `COLUMN_ALIGN` aligned
+    ColumnField fields[COLUMN_MAX_FIELDS];  ///< Field descriptors, in column order
+    uint16_t field_count;                   ///< Number of fields
+    uint16_t record_size;                   ///< Size of a whole record in bytes
+} ColumnBuffer;
+
+/**
+ * @brief Run of consecutive rows claimed by `columnReadSpan()`.
+ */
+typedef struct {
+    uint16_t first;     ///< Row index of the first record
+    uint16_t count;     ///< Number of records
+} ColumnSpan;
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Allocates and initializes a new column buffer.
+ *
+ * @param allocator   The BlockAllocator used to obtain memory for the buffer and its columns.
+ * @param size        Number of records the buffer can hold.
+ * @param record_size Size of a whole record in bytes.
+ * @param fields      Array of `field_count` field descriptors; copied.
+ * @param field_count Number of fields, 1 to `COLUMN_MAX_FIELDS`.
+ *
+ * @return Pointer to the new ColumnBuffer, or NULL on failure or invalid parameters.
+ */
+ColumnBuffer* columnAllocate(BlockAllocator* allocator, uint16_t size, uint16_t record_size,
+                             const ColumnField* fields, uint16_t field_count);
+
+/**
+ * @brief Deallocates a column buffer and its storage.
+ *
+ * @param allocator The BlockAllocator used for the original allocation.
+ * @param columns   Pointer to the ColumnBuffer pointer; will be set to NULL on success.
+ *
+ * @return `COLUMN_OK` on success, or a negative errno value.
+ */
+int columnDeallocate(BlockAllocator* allocator, ColumnBuffer** columns);
+#endif
+
+/**
+ * @brief Lays the columns of a column buffer out in `storage`.
+ *
+ * `columns->rows.size` and `columns->rows.lock` must already be set; the
+ * buffer is left empty. Used by `CREATE_COLUMN_BUFFER()`.
+ *
+ * @param columns     Pointer to the column buffer.
+ * @param storage     `COLUMN_ALIGN` aligned block of at least
+ *                    `COLUMN_STORAGE_SIZE(size, record_size, field_count)` bytes.
+ * @param record_size Size of a whole record in bytes.
+ * @param fields      Array of `field_count` field descriptors; copied.
+ * @param field_count Number of fields, 1 to `COLUMN_MAX_FIELDS`.
+ * @return `COLUMN_OK` on success, or `-EINVAL` if arguments are invalid,
+ *         e.g. a field reaches past the end of the record.
+ */
+int columnInit(ColumnBuffer* columns, void* storage, uint16_t record_size,
+               const ColumnField* fields, uint16_t field_count);
+
+/**
+ * @brief Discards every record; see `bufferClear()`.
+ *
+ * @param columns Pointer to the column buffer. No action is taken if NULL.
+ */
+void columnClear(ColumnBuffer* columns);
+
+/**
+ * @brief Writes a record, scattering its fields into their columns.
+ *
+ * @param columns Pointer to the column buffer.
+ * @param record  Record of `record_size` bytes; only the described fields are read.
+ * @return Row index written on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-ENOSPC` if the buffer is full
+ * - `-EBUSY` if the buffer is locked by another thread
+ */
+int columnWrite(ColumnBuffer* columns, const void* record);
+
+/**
+ * @brief Reads the oldest record, gathering its fields from their columns.
+ *
+ * @param columns     Pointer to the column buffer.
+ * @param[out] record Record of `record_size` bytes; only the described fields are written.
+ * @return Row index read on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EAGAIN` if the buffer is empty
+ * - `-EBUSY` if the buffer is locked by another thread
+ */
+int columnRead(ColumnBuffer* columns, void* record);
+
+/**
+ * @brief Claims up to `max_count` of the oldest records as one run of rows.
+ *
+ * The run stops early at the end of the ring, so its rows are consecutive
+ * in every column, and at the first row still being written. The records
+ * stay in place until the span is released with `columnSpanRelease()`.
+ *
+ * @param columns   Pointer to the column buffer.
+ * @param max_count Maximum number of records to claim.
+ * @param[out] span Receives the claimed rows.
+ * @return Number of records claimed (at least 1), or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EAGAIN` if the buffer is empty
+ * - `-EBUSY` if the buffer is locked, or its oldest record is still being written
+ */
+int columnReadSpan(ColumnBuffer* columns, uint16_t max_count, ColumnSpan* span);
+
+/**
+ * @brief Returns field `field` of the records in `span` as an array.
+ *
+ * @param columns Pointer to the column buffer.
+ * @param span    Span claimed by `columnReadSpan()`.
+ * @param field   Index of the field in the descriptor list.
+ * @return Address of `span->count` consecutive values of `fields[field].size`
+ *         bytes each, or NULL if arguments are invalid.
+ */
+const void* columnSpanData(const ColumnBuffer* columns, const ColumnSpan* span, uint16_t field);
+
+/**
+ * @brief Finds the first record of a span whose field equals `key`.
+ *
+ * The column is searched with the SIMD kernels of `bufferFind()`, which
+ * compare 16 or 32 packed values per instruction.
+ *
+ * @param columns Pointer to the column buffer.
+ * @param span    Span claimed by `columnReadSpan()`.
+ * @param field   Index of a field of 1, 2, 4 or 8 bytes.
+ * @param key     Key, compared as an unsigned integer of the field's size in
+ *                native byte order; bits beyond the field's size are ignored.
+ * @return Position of the match within the span, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid, or the field is not 1, 2, 4 or 8 bytes
+ * - `-ENOENT` if no record matches
+ */
+int columnSpanFind(const ColumnBuffer* columns, const ColumnSpan* span, uint16_t field, uint64_t key);
+
+/**
+ * @brief Releases the records of a span, freeing their rows.
+ *
+ * @param columns Pointer to the column buffer.
+ * @param span    Span claimed by `columnReadSpan()`.
+ * @return `COLUMN_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EPERM` if a row of the span is not claimed
+ * - `-ESTALE` if the buffer was cleared since the claim; the rows are freed
+ */
+int columnSpanRelease(ColumnBuffer* columns, const ColumnSpan* span);
+
+/**
+ * @brief Returns true if the column buffer holds no records.
+ */
+bool columnIsEmpty(const ColumnBuffer* columns);
+
+/**
+ * @brief Returns true if the column buffer holds `size` records.
+ */
+bool columnIsFull(const ColumnBuffer* columns);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,165 @@
+#pragma once
+/**
+ * @file conflate.h
+ * @brief Conflating queue keeping only the latest pending message per key.
+ *
+ * A `ConflatingQueue` holds at most one pending message per 64-bit key. A
+ * message written for a key that already has a pending message replaces it
+ * in place, so a consumer that falls behind skips superseded updates instead
+ * of working through them, and the queue depth is bounded by the number of
+ * distinct keys rather than by the update rate.
+ *
+ * - Messages are read in the order their key first became pending; a
+ *   replacement keeps the position of the message it replaces.
+ * - Pending keys are found through an open-addressing index of
+ *   `2 * size` entries with linear probing. Each entry is a 16-bit pool index,
+ *   so the index for 256 messages fits in 1 KiB.
+ * - Message payloads stay in a fixed pool whose free entries are kept on a
+ *   `Stack`; a `Buffer` ring of pool indices records the read order.
+ *
+ * All operations take the queue's lock and fail with `-EBUSY` if it is
+ * contended.
+ */
+#include "buffer.h"
+#include "stack.h"
+#include "locking.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CONFLATE_OK 0 // success
+
+#define CONFLATE_EMPTY 0xFFFF   ///< Index entry that holds no pool index
+
+// Conflating queue lock macros, reuse lock->write as single lock
+#define TAKE_CONFLATE_LOCK(lock) TAKE_WRITE_LOCK(lock)
+#define CLEAR_CONFLATE_LOCK(lock) CLEAR_WRITE_LOCK(lock)
+
+/**
+ * @brief Creates a statically allocated `ConflatingQueue` instance.
+ *
+ * @param id         The identifier for the conflating queue instance.
+ * @param msg_size   Maximum size in bytes of each message.
+ * @param msg_count  Maximum number of pending messages, i.e. of distinct pending keys.
+ *
+ * This macro defines the message pool, the key index, the read order ring
+ * and the free list, all backed by static memory.
+ */
+#define CREATE_CONFLATING_QUEUE(id, msg_size, msg_count)                        \
+    uint8_t __##id##_raw[(msg_count) * (msg_size)];                             \
+    uint64_t __##id##_keys[(msg_count)];                                        \
+    uint16_t __##id##_msg_len[(msg_count)];                                     \
+    uint16_t __##id##_index[2 * (msg_count)];                                   \
+    CREATE_BUFFER(__##id##_order, msg_count, sizeof(uint16_t));                 \
+    CREATE_STACK(__##id##_free, msg_count, sizeof(uint16_t));                   \
+    CREATE_LOCK(__##id##_lock, 1);                                              \
+    ConflatingQueue id = {                                                      \
+        .order = &__##id##_order,                                               \
+        .free_slots = &__##id##_free,                                           \
+        .raw = __##id##_raw,                                                    \
+        .keys = __##id##_keys,                                                  \
+        .msg_len = __##id##_msg_len,                                            \
+        .index = __##id##_index,                                                \
+        .size = (msg_count),                                                    \
+        .slot_len = (msg_size),                                                 \
+        .lock = &__##id##_lock,                                                 \
+    };                                                                          \
+    conflatingQueueClear(&id)
+
+/**
+ * @brief Queue of the latest pending message per key.
+ */
+typedef struct {
+    Buffer* order;          ///< Ring of pool indices in first-arrival order
+    Stack* free_slots;      ///< Free list of message pool indices
+    uint8_t* raw;           ///< Message pool, `size * slot_len` bytes
+    uint64_t* keys;         ///< Key of each pool entry
+    uint16_t* msg_len;      ///< Length of each pool entry
+    uint16_t* index;        ///< Open-addressing key index of `2 * size` pool indices
+    uint32_t conflated;     ///< Messages replaced before they were read
+    uint16_t count;         ///< Number of pending messages
+    uint16_t size;          ///< Maximum number of pending messages
+    uint16_t slot_len;      ///< Maximum message length (in bytes)
+    Lock_t* lock;           ///< Pointer to the lock structure
+} ConflatingQueue;
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Allocates and initializes a new conflating queue.
+ *
+ * @param allocator Pointer to a pre-initialized BlockAllocator.
+ * @param slot_len  Maximum length (in bytes) of a single message.
+ * @param size      Maximum number of pending messages.
+ *
+ * @return Pointer to a new ConflatingQueue instance, or NULL on failure.
+ */
+ConflatingQueue* conflatingQueueAllocate(BlockAllocator* allocator, uint16_t slot_len, uint16_t size);
+
+/**
+ * @brief Deallocates a conflating queue and all associated memory.
+ *
+ * @param allocator The allocator used for the original allocation.
+ * @param queue Pointer to the ConflatingQueue pointer; will be set to NULL on success.
+ *
+ * @return `CONFLATE_OK` on success, or a negative errno value.
+ */
+int conflatingQueueDeallocate(BlockAllocator* allocator, ConflatingQueue** queue);
+#endif
+
+/**
+ * @brief Drops all pending messages and resets the conflation counter.
+ *
+ * @param queue Pointer to the conflating queue. No action is taken if NULL.
+ */
+void conflatingQueueClear(ConflatingQueue* queue);
+
+/**
+ * @brief Returns true if the conflating queue holds no pending messages.
+ *
+ * @param queue Pointer to the conflating queue.
+ * @return true if empty, false otherwise.
+ */
+bool conflatingQueueIsEmpty(const ConflatingQueue* queue);
+
+/**
+ * @brief Writes the latest message for `key`.
+ *
+ * If a message for `key` is pending, it is overwritten in place and keeps
+ * its position; otherwise the message is appended.
+ *
+ * @param queue Pointer to the conflating queue.
+ * @param key   Key of the message.
+ * @param data  Pointer to the message.
+ * @param len   Length of the message in bytes; truncated to `slot_len`.
+ *
+ * @return Number of bytes stored on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if the queue is locked by another thread
+ * - `-ENOSPC` if `size` other keys are already pending
+ */
+int conflatingQueueWrite(ConflatingQueue* queue, uint64_t key, const uint8_t* data, uint16_t len);
+
+/**
+ * @brief Reads the pending message whose key has waited longest.
+ *
+ * @param queue     Pointer to the conflating queue.
+ * @param[out] key  Optional. Receives the key of the message.
+ * @param data      Output buffer to store the message.
+ * @param len       Maximum number of bytes to read.
+ *
+ * @return Number of bytes read on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if the queue is locked by another thread
+ * - `-EAGAIN` if no message is pending
+ */
+int conflatingQueueRead(ConflatingQueue* queue, uint64_t* key, uint8_t* data, uint16_t len);
+
+#ifdef __cplusplus
+}
+#endif
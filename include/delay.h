@@ -0,0 +1,183 @@
+#pragma once
+/**
+ * @file delay.h
+ * @brief Timestamp-ordered delay queue backed by a hierarchical timing wheel.
+ *
+ * A `DelayQueue` holds variable-length messages until their due time. Pending
+ * messages are tracked in a hierarchical timing wheel of `DELAY_WHEEL_LEVELS`
+ * levels with `DELAY_WHEEL_SLOTS` buckets each. Every bucket is a `Buffer` ring
+ * of entry indices; message payloads stay in place in a fixed pool whose free
+ * entries are kept on a `Stack`.
+ *
+ * - Insertion is O(1): the entry index is written into the bucket selected by
+ *   the distance between its due time and the current wheel time.
+ * - Expiry is amortized O(1): an entry is moved down at most once per level
+ *   as the wheel advances, and empty stretches of time are skipped.
+ *
+ * Time is an abstract, caller-supplied 32-bit tick counter (wrap-around safe).
+ * Due times further than `DELAY_WHEEL_SPAN` ticks ahead are parked in the top
+ * level and re-examined each time their bucket comes around.
+ */
+#include "buffer.h"
+#include "stack.h"
+#include "locking.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DELAY_OK 0 // success
+
+#ifndef DELAY_WHEEL_BITS
+#define DELAY_WHEEL_BITS 4      ///< log2 of the number of buckets per level
+#endif
+#ifndef DELAY_WHEEL_LEVELS
+#define DELAY_WHEEL_LEVELS 4    ///< Number of wheel levels
+#endif
+
+#define DELAY_WHEEL_SLOTS (1u << DELAY_WHEEL_BITS)
+#define DELAY_WHEEL_MASK (DELAY_WHEEL_SLOTS - 1)
+#define DELAY_WHEEL_BUCKETS (DELAY_WHEEL_LEVELS * DELAY_WHEEL_SLOTS)
+#define DELAY_WHEEL_SPAN (1ul << (DELAY_WHEEL_BITS * DELAY_WHEEL_LEVELS))
+
+#if (DELAY_WHEEL_BITS * DELAY_WHEEL_LEVELS) >= 32
+#error "DELAY_WHEEL_BITS * DELAY_WHEEL_LEVELS must be less than 32"
+#endif
+
+// Delay queue lock macros, reuse lock->write as single lock
+#define TAKE_DELAY_LOCK(lock) TAKE_WRITE_LOCK(lock)
+#define CLEAR_DELAY_LOCK(lock) CLEAR_WRITE_LOCK(lock)
+
+/**
+ * @brief Creates a statically allocated `DelayQueue` instance.
+ *
+ * @param id         The identifier for the delay queue instance.
+ * @param msg_size   Maximum size in bytes of each message.
+ * @param msg_count  Maximum number of pending messages.
+ *
+ * This macro defines the message pool, the free list and one index ring per
+ * wheel bucket, all backed by static memory.
+ */
+#define CREATE_DELAY_QUEUE(id, msg_size, msg_count)                                 \
+    uint8_t __##id##_raw[(msg_count) * (msg_size)];                                 \
+    uint32_t __##id##_due[(msg_count)];                                             \
+    uint16_t __##id##_msg_len[(msg_count)];                                         \
+    uint16_t __##id##_wheel_raw[DELAY_WHEEL_BUCKETS][(msg_count)];                  \
+    LockState_t __##id##_wheel_state[DELAY_WHEEL_BUCKETS][(msg_count)];             \
+    Lock_t __##id##_wheel_lock[DELAY_WHEEL_BUCKETS];                                \
+    Buffer __##id##_wheel[DELAY_WHEEL_BUCKETS];                                     \
+    for (uint16_t b = 0; b < DELAY_WHEEL_BUCKETS; b++) {                            \
+        INIT_LOCK(&__##id##_wheel_lock[b], __##id##_wheel_state[b], (msg_count));   \
+        __##id##_wheel[b] = (Buffer){                                               \
+            .size = (msg_count),                                                    \
+            .type_size = sizeof(uint16_t),                                          \
+            .raw = __##id##_wheel_raw[b],                                           \
+            .lock = &__##id##_wheel_lock[b],                                        \
+        };                                                                          \
+    }                                                                               \
+    CREATE_STACK(__##id##_free, msg_count, sizeof(uint16_t));                       \
+    CREATE_LOCK(__##id##_lock, 1);                                                  \
+    DelayQueue id = {                                                               \
+        .wheel = __##id##_wheel,                                                    \
+        .free_slots = &__##id##_free,                                               \
+        .raw = __##id##_raw,                                                        \
+        .due = __##id##_due,                                                        \
+        .msg_len = __##id##_msg_len,                                                \
+        .size = (msg_count),                                                        \
+        .slot_len = (msg_size),                                                     \
+        .lock = &__##id##_lock,                                                     \
+    };                                                                              \
+    delayQueueClear(&id)
+
+/**
+ * @brief Delay queue holding messages until their due time.
+ */
+typedef struct {
+    Buffer* wheel;                              ///< `DELAY_WHEEL_BUCKETS` index rings, level-major
+    Stack* free_slots;                          ///< Free list of message pool indices
+    uint8_t* raw;                               ///< Message pool, `size * slot_len` bytes
+    uint32_t* due;                              ///< Due time of each pool entry
+    uint16_t* msg_len;                          ///< Length of each pool entry
+    uint16_t level_count[DELAY_WHEEL_LEVELS];   ///< Pending entries per wheel level
+    uint32_t time;                              ///< Current wheel time
+    uint16_t count;                             ///< Number of pending messages
+    uint16_t size;                              ///< Maximum number of pending messages
+    uint16_t slot_len;                          ///< Maximum message length (in bytes)
+    Lock_t* lock;                               ///< Pointer to the lock structure
+} DelayQueue;
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Allocates and initializes a new delay queue.
+ *
+ * @param allocator Pointer to a pre-initialized BlockAllocator.
+ * @param slot_len  Maximum length (in bytes) of a single message.
+ * @param size      Maximum number of pending messages.
+ *
+ * @return Pointer to a new DelayQueue instance, or NULL on failure.
+ */
+DelayQueue* delayQueueAllocate(BlockAllocator* allocator, uint16_t slot_len, uint16_t size);
+
+/**
+ * @brief Deallocates a delay queue and all associated memory.
+ *
+ * @param allocator The allocator used for the original allocation.
+ * @param queue Pointer to the DelayQueue pointer; will be set to NULL on success.
+ *
+ * @return `DELAY_OK` on success, or a negative errno value.
+ */
+int delayQueueDeallocate(BlockAllocator* allocator, DelayQueue** queue);
+#endif
+
+/**
+ * @brief Drops all pending messages.
+ *
+ * @param queue Pointer to the delay queue. No action is taken if NULL.
+ */
+void delayQueueClear(DelayQueue* queue);
+
+/**
+ * @brief Returns true if the delay queue holds no pending messages.
+ *
+ * @param queue Pointer to the delay queue.
+ * @return true if empty, false otherwise.
+ */
+bool delayQueueIsEmpty(const DelayQueue* queue);
+
+/**
+ * @brief Schedules a message for delivery at `due`.
+ *
+ * @param queue Pointer to the delay queue.
+ * @param data  Pointer to the message.
+ * @param len   Length of the message in bytes; truncated to `slot_len`.
+ * @param now   Current time, used to re-synchronize an idle wheel.
+ * @param due   Time at which the message becomes readable.
+ *
+ * @return Number of bytes stored on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if the queue is locked by another thread
+ * - `-ENOSPC` if the message pool is exhausted
+ */
+int delayQueueWrite(DelayQueue* queue, const uint8_t* data, uint16_t len, uint32_t now, uint32_t due);
+
+/**
+ * @brief Reads the next message whose due time has passed.
+ *
+ * Advances the wheel to `now` and dequeues one due message. Messages due on
+ * the same tick are returned in insertion order.
+ *
+ * @param queue    Pointer to the delay queue.
+ * @param data     Output buffer to store the message.
+ * @param len      Maximum number of bytes to read.
+ * @param now      Current time.
+ * @param[out] next_due Optional. When no message is due, receives the earliest
+ *                 pending due time so the caller can sleep until then. Left
+ *                 untouched if the queue is empty.
+ *
+ * @return Number of bytes read on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if the queue is locked by another thread
+ * - `-EAGAIN` if no message is due yet
+ */
+int delayQueueRead(DelayQueue* queue, uint8_t* data, uint16_t len, uint32_t now, uint32_t* next_due);
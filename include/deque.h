@@ -0,0 +1,201 @@
+#pragma once
+/**
+ * @file deque.h
+ * @brief Double-ended ring built on the `Buffer` layout.
+ *
+ * A `Deque` is a `Buffer` that can also be written at its front and read at
+ * its back:
+ * - `dequePushBack()` / `dequePopFront()` are the plain FIFO paths of the
+ *   underlying ring and cost exactly as much as `bufferWrite()` /
+ *   `bufferRead()`; `ring` may also be passed to any `buffer*` function.
+ * - `dequePushFront()` re-queues an element ahead of everything else, e.g. an
+ *   urgent retry.
+ * - `dequePopBack()` takes the newest element, for LIFO draining.
+ *
+ * Every end supports the zero-copy claim / release protocol of `Buffer`, with
+ * the same slot states, so a slot being filled or read at one end blocks
+ * the other end from reaching it until it is released.
+ *
+ * The front push and back pop move an index against the direction its owner
+ * moves it, so they take both the write and the read lock of the ring and
+ * fail with `-EBUSY` while either is held.
+ */
+#include "buffer.h"
+#include "locking.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DEQUE_OK 0 // success
+
+/**
+ * @brief Creates a statically allocated deque instance.
+ *
+ * @param id         The identifier for the deque instance.
+ * @param count      Number of elements the deque can hold.
+ * @param type_size_ The size in bytes of each element.
+ *
+ * This macro defines the deque and its backing ring using static memory.
+ */
+#define CREATE_DEQUE(id, count, type_size_)                     \
+    CREATE_BUFFER(__##id##_ring, count, type_size_);            \
+    Deque id = { .ring = __##id##_ring }
+
+/**
+ * @brief Double-ended ring of fixed-size elements.
+ */
+typedef struct {
+    Buffer ring;    ///< Underlying ring; `head` is the back, `tail` the front
+} Deque;
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Allocates and initializes a new deque.
+ *
+ * @param allocator The BlockAllocator used to obtain memory for the deque and its storage.
+ * @param size      The number of elements the deque can hold.
+ * @param type_size The size of each element in bytes.
+ *
+ * @return Pointer to the new Deque, or NULL on failure.
+ */
+Deque* dequeAllocate(BlockAllocator* allocator, uint16_t size, uint16_t type_size);
+
+/**
+ * @brief Deallocates a deque and its storage.
+ *
+ * @param allocator The BlockAllocator used for the original allocation.
+ * @param deque     Pointer to the Deque pointer; will be set to NULL on success.
+ *
+ * @return `DEQUE_OK` on success, or a negative errno value.
+ */
+int dequeDeallocate(BlockAllocator* allocator, Deque** deque);
+#endif
+
+/**
+ * @brief Discards every element, see `bufferClear()`.
+ *
+ * @param deque Pointer to the deque. No action is taken if NULL.
+ */
+void dequeClear(Deque* deque);
+
+/**
+ * @brief Returns true if the deque contains no elements.
+ */
+bool dequeIsEmpty(const Deque* deque);
+
+/**
+ * @brief Returns true if the deque cannot accept more elements.
+ */
+bool dequeIsFull(const Deque* deque);
+
+/**
+ * @brief Copies an element to the back of the deque.
+ *
+ * @param deque Pointer to the deque.
+ * @param data  Element to copy, `type_size` bytes.
+ * @return Slot index on success, or a negative errno value as for `bufferWrite()`.
+ */
+int dequePushBack(Deque* deque, const void* data);
+
+/**
+ * @brief Copies an element to the front of the deque.
+ *
+ * @param deque Pointer to the deque.
+ * @param data  Element to copy, `type_size` bytes.
+ * @return Slot index on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if the ring is locked or the front slot is still in use
+ * - `-ENOSPC` if the deque is full
+ */
+int dequePushFront(Deque* deque, const void* data);
+
+/**
+ * @brief Removes the element at the front of the deque.
+ *
+ * @param deque     Pointer to the deque.
+ * @param[out] data Receives the element, `type_size` bytes.
+ * @return Slot index on success, or a negative errno value as for `bufferRead()`.
+ */
+int dequePopFront(Deque* deque, void* data);
+
+/**
+ * @brief Removes the element at the back of the deque.
+ *
+ * @param deque     Pointer to the deque.
+ * @param[out] data Receives the element, `type_size` bytes.
+ * @return Slot index on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if the ring is locked or the back slot is not yet published
+ * - `-EAGAIN` if the deque is empty
+ */
+int dequePopBack(Deque* deque, void* data);
+
+/**
+ * @brief Claims a slot at the back for zero-copy writing, see `bufferWriteClaim()`.
+ *
+ * @param deque         Pointer to the deque.
+ * @param[out] out_addr Address of the claimed slot.
+ * @return Slot index on success, or a negative errno value as for `bufferWriteClaim()`.
+ */
+int dequePushBackClaim(Deque* deque, void** out_addr);
+
+/**
+ * @brief Claims a slot at the front for zero-copy writing.
+ *
+ * The slot is published with `dequePushRelease()`. Until then, readers of
+ * the front see the deque as busy.
+ *
+ * @param deque         Pointer to the deque.
+ * @param[out] out_addr Address of the claimed slot.
+ * @return Slot index on success, or a negative errno value as for `dequePushFront()`.
+ */
+int dequePushFrontClaim(Deque* deque, void** out_addr);
+
+/**
+ * @brief Publishes a slot claimed by `dequePushBackClaim()` or `dequePushFrontClaim()`.
+ *
+ * @param deque Pointer to the deque.
+ * @param index Slot index returned by the claim.
+ * @return `DEQUE_OK` on success, or a negative errno value as for `bufferWriteRelease()`.
+ */
+int dequePushRelease(Deque* deque, uint16_t index);
+
+/**
+ * @brief Claims the front element for zero-copy reading, see `bufferReadClaim()`.
+ *
+ * @param deque         Pointer to the deque.
+ * @param[out] out_addr Address of the claimed slot.
+ * @return Slot index on success, or a negative errno value as for `bufferReadClaim()`.
+ */
+int dequePopFrontClaim(Deque* deque, void** out_addr);
+
+/**
+ * @brief Claims the back element for zero-copy reading.
+ *
+ * The slot is freed with `dequePopRelease()`. Until then, writers of the
+ * back see the deque as busy.
+ *
+ * @param deque         Pointer to the deque.
+ * @param[out] out_addr Address of the claimed slot.
+ * @return Slot index on success, or a negative errno value as for `dequePopBack()`.
+ */
+int dequePopBackClaim(Deque* deque, void** out_addr);
+
+/**
+ * @brief Frees a slot claimed by `dequePopFrontClaim()` or `dequePopBackClaim()`.
+ *
+ * @param deque Pointer to the deque.
+ * @param index Slot index returned by the claim.
+ * @return `DEQUE_OK` on success, or a negative errno value as for `bufferReadRelease()`.
+ */
+int dequePopRelease(Deque* deque, uint16_t index);
+
+#ifdef __cplusplus
+}
+#endif
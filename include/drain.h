@@ -0,0 +1,84 @@
+#pragma once
+/**
+ * @file drain.h
+ * @brief Batched zero-copy drain of `Queue` contents for asynchronous I/O.
+ *
+ * A drain claims ready messages in bulk and hands out their addresses and
+ * lengths, so they can be submitted directly as asynchronous writes (e.g.
+ * io_uring `WRITE_FIXED` / `SEND` SQEs, one per `DrainSlot`). A slot stays
+ * claimed, and cannot be overwritten by producers, until its completion is
+ * reported with `drainComplete()`. Completions may arrive in any order.
+ *
+ * `drainRegion()` returns the single contiguous block that holds every
+ * slot, so the whole queue can be registered once as a fixed buffer and no
+ * pages are pinned per I/O.
+ *
+ * The module performs no system calls itself; submitting and reaping I/O is
+ * left to the application's event loop.
+ */
+#include "queue.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DRAIN_OK 0 // success
+
+/**
+ * @brief A claimed message, ready to be submitted as one write.
+ */
+typedef struct {
+    uint8_t* data;      ///< Start of the bytes still to be written
+    uint16_t len;       ///< Number of bytes still to be written
+    uint16_t index;     ///< Queue slot index, e.g. for use as I/O user data
+} DrainSlot;
+
+/**
+ * @brief Returns the contiguous storage block backing every queue slot.
+ *
+ * @param queue     Pointer to the queue.
+ * @param[out] base Start of the slot storage.
+ * @param[out] len  Size of the slot storage in bytes.
+ * @return `DRAIN_OK` on success, `-EINVAL` if arguments are invalid.
+ */
+int drainRegion(const Queue* queue, void** base, uint32_t* len);
+
+/**
+ * @brief Claims up to `max_count` ready messages in FIFO order.
+ *
+ * @param queue     Pointer to the queue.
+ * @param slots     Array receiving one entry per claimed message.
+ * @param max_count Capacity of `slots`.
+ * @return Number of messages claimed (at least 1), or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EAGAIN` if no message is ready
+ * - `-EBUSY` if the first message could not be claimed without contention; retry
+ */
+int drainClaim(Queue* queue, DrainSlot* slots, uint16_t max_count);
+
+/**
+ * @brief Reports the completion of a write submitted for `slot`.
+ *
+ * A short write advances `slot` past the written bytes and keeps it claimed
+ * so the remainder can be resubmitted. A failed write leaves `slot` untouched.
+ *
+ * @param queue   Pointer to the queue.
+ * @param slot    Slot the completion belongs to.
+ * @param written Result of the write: bytes written, or a negative errno value.
+ * @return `DRAIN_OK` if the message was fully written and its slot released,
+ * or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EAGAIN` if the write was short; resubmit `slot`
+ * - `written` itself if the write failed; resubmit or drop `slot`
+ * - `-EPERM` if `slot` is not claimed
+ */
+int drainComplete(Queue* queue, DrainSlot* slot, int32_t written);
+
+/**
+ * @brief Releases a claimed slot without writing the rest of its message.
+ *
+ * @param queue Pointer to the queue.
+ * @param slot  Slot to drop.
+ * @return `DRAIN_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EPERM` if `slot` is not claimed
+ */
+int drainRelease(Queue* queue, const DrainSlot* slot);
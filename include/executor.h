@@ -0,0 +1,245 @@
+#pragma once
+/**
+ * @file executor.h
+ * @brief Worker-pool task executor built on per-worker `Buffer` rings.
+ *
+ * An `Executor` owns one input ring of `Task` descriptors per worker. Tasks
+ * are small fixed-size records, so submitting one is a single ring write with
+ * no allocation. The executor does not create threads: each worker thread
+ * repeatedly calls `executorRun()` with its own worker index.
+ *
+ * - Submitters pick a worker round-robin (`executorSubmit()`), or by key
+ *   (`executorSubmitKeyed()`) when tasks for the same key must run in order.
+ * - A worker whose ring is empty steals a task from the other rings.
+ * - Idle workers may park: `executorPark()` publishes an idle flag that the
+ *   next submitter to that worker clears before calling the wake hook. The
+ *   flag is a 32-bit word so it can be waited on directly with a futex.
+ * - Completions are optionally reported as `TaskResult` records written to a
+ *   caller-provided reply ring.
+ */
+#include "buffer.h"
+#include "locking.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdbool.h>
+#include <stdint.h>
+
+#define EXECUTOR_OK 0 // success
+
+#ifdef USE_ATOMIC
+#include <stdatomic.h>
+typedef atomic_uint_least32_t ExecutorWord_t;  ///< Idle flag / counter storage
+#else
+typedef uint32_t ExecutorWord_t;               ///< Idle flag / counter storage
+#endif
+
+/**
+ * @brief Task entry point.
+ * @param arg Argument stored in the task descriptor.
+ * @return Result reported through the reply ring.
+ */
+typedef int (*TaskFn)(void* arg);
+
+/**
+ * @brief Hook called by a submitter to wake a parked worker.
+ * @param ctx    Context registered with `executorSetWakeHook()`.
+ * @param worker Index of the worker to wake.
+ */
+typedef void (*ExecutorWakeFn)(void* ctx, uint16_t worker);
+
+/**
+ * @brief Fixed-size task descriptor.
+ */
+typedef struct {
+    TaskFn fn;          ///< Function to run
+    void* arg;          ///< Argument passed to `fn`
+    uint32_t tag;       ///< Caller-defined identifier, echoed in the reply
+} Task;
+
+/**
+ * @brief Completion record written to the reply ring.
+ */
+typedef struct {
+    uint32_t tag;       ///< Tag of the completed task
+    int result;         ///< Return value of the task function
+} TaskResult;
+
+/**
+ * @brief Per-worker state.
+ */
+typedef struct {
+    Buffer ring;            ///< Input ring of `Task` descriptors
+    ExecutorWord_t idle;    ///< Non-zero while the worker is parked
+    bool reply_pending;     ///< Set while `reply` could not be delivered
+    TaskResult reply;       ///< Completion waiting for space in the reply ring
+} ExecutorWorker;
+
+/**
+ * @brief Creates a statically allocated executor instance.
+ *
+ * @param id            The identifier for the executor instance.
+ * @param worker_count_ Number of workers.
+ * @param depth_        Number of tasks each worker's ring can hold.
+ *
+ * This macro defines the worker states and one input ring per worker, all
+ * backed by static memory.
+ */
+#define CREATE_EXECUTOR(id, worker_count_, depth_)                                      \
+    uint8_t __##id##_ring_raw[(worker_count_)][(depth_) * sizeof(Task)];                \
+    LockState_t __##id##_ring_state[(worker_count_)][(depth_)];                         \
+    Lock_t __##id##_ring_lock[(worker_count_)];                                         \
+    ExecutorWorker __##id##_workers[(worker_count_)];                                   \
+    for (int w = 0; w < (worker_count_); w++) {                                         \
+        INIT_LOCK(&__##id##_ring_lock[w], __##id##_ring_state[w], (depth_));            \
+        __##id##_workers[w].ring = (Buffer){                                            \
+            .size = (depth_),                                                           \
+            .type_size = sizeof(Task),                                                  \
+            .raw = __##id##_ring_raw[w],                                                \
+            .lock = &__##id##_ring_lock[w],                                             \
+        };                                                                              \
+    }                                                                                   \
+    Executor id = {                                                                     \
+        .workers = __##id##_workers,                                                    \
+        .worker_count = (worker_count_),                                                \
+    };                                                                                  \
+    executorClear(&id)
+
+/**
+ * @brief Pool of workers fed through per-worker task rings.
+ */
+typedef struct {
+    ExecutorWorker* workers;    ///< `worker_count` worker states
+    uint16_t worker_count;      ///< Number of workers
+    ExecutorWord_t next;        ///< Round-robin submission counter
+    Buffer* replies;            ///< Optional ring of `TaskResult` records
+    ExecutorWakeFn wake;        ///< Optional hook to wake a parked worker
+    void* wake_ctx;             ///< Context passed to `wake`
+} Executor;
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Allocates and initializes a new executor.
+ *
+ * @param allocator     Pointer to a pre-initialized BlockAllocator.
+ * @param worker_count  Number of workers.
+ * @param depth         Number of tasks each worker's ring can hold.
+ *
+ * @return Pointer to a new Executor instance, or NULL on failure.
+ */
+Executor* executorAllocate(BlockAllocator* allocator, uint16_t worker_count, uint16_t depth);
+
+/**
+ * @brief Deallocates an executor and all associated memory.
+ *
+ * The reply ring, if any, is owned by the caller and is not freed.
+ *
+ * @param allocator The allocator used for the original allocation.
+ * @param executor  Pointer to the Executor pointer; will be set to NULL on success.
+ *
+ * @return `EXECUTOR_OK` on success, or a negative errno value.
+ */
+int executorDeallocate(BlockAllocator* allocator, Executor** executor);
+#endif
+
+/**
+ * @brief Drops every queued task and pending reply and marks all workers awake.
+ *
+ * Must not be called while workers or submitters are active.
+ *
+ * @param executor Pointer to the executor. No action is taken if NULL.
+ */
+void executorClear(Executor* executor);
+
+/**
+ * @brief Registers the ring that receives a `TaskResult` per completed task.
+ *
+ * @param executor Pointer to the executor.
+ * @param replies  Ring with `type_size == sizeof(TaskResult)`, or NULL to
+ *                 stop reporting completions.
+ * @return `EXECUTOR_OK` on success, `-EINVAL` if arguments are invalid.
+ */
+int executorSetReplyRing(Executor* executor, Buffer* replies);
+
+/**
+ * @brief Registers the hook used to wake parked workers.
+ *
+ * @param executor Pointer to the executor.
+ * @param wake     Wake hook, or NULL to disable parking notifications.
+ * @param ctx      Context passed to `wake`.
+ * @return `EXECUTOR_OK` on success, `-EINVAL` if arguments are invalid.
+ */
+int executorSetWakeHook(Executor* executor, ExecutorWakeFn wake, void* ctx);
+
+/**
+ * @brief Submit a task to the next worker in round-robin order.
+ *
+ * If the chosen worker's ring is full or contended, the following workers
+ * are tried in turn.
+ *
+ * @param executor Pointer to the executor.
+ * @param task     Task descriptor, copied into the ring.
+ * @return Index of the worker that received the task, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-ENOSPC` if every ring is full
+ * - `-EBUSY` if no ring could be written without contention; retry
+ */
+int executorSubmit(Executor* executor, const Task* task);
+
+/**
+ * @brief Submit a task to the worker selected by `key`.
+ *
+ * Tasks with the same key land on the same ring and are started in
+ * submission order, unless another worker steals them.
+ *
+ * @param executor Pointer to the executor.
+ * @param task     Task descriptor, copied into the ring.
+ * @param key      Routing key; the worker is `key % worker_count`.
+ * @return Index of the worker that received the task, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-ENOSPC` if the worker's ring is full
+ * - `-EBUSY` if the ring is contended; retry
+ */
+int executorSubmitKeyed(Executor* executor, const Task* task, uint32_t key);
+
+/**
+ * @brief Run one task on behalf of `worker`.
+ *
+ * Takes the next task from the worker's own ring or, if that is empty,
+ * steals one from another worker. A completion that could not be written to
+ * the reply ring is retried before any new task is started.
+ *
+ * @param executor Pointer to the executor.
+ * @param worker   Index of the calling worker.
+ * @return `EXECUTOR_OK` if a task was run, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EAGAIN` if no task was available
+ * - `-ENOSPC` if the reply ring is full; the completion is kept and retried
+ * - `-EBUSY` if the reply ring is contended; the completion is kept and retried
+ */
+int executorRun(Executor* executor, uint16_t worker);
+
+/**
+ * @brief Announce that `worker` is about to sleep.
+ *
+ * On success the worker may block until its idle flag (see
+ * `executorIdleFlag()`) is cleared, e.g. with `futex(FUTEX_WAIT, 1)`. The
+ * flag is re-checked against the worker's ring, so a task submitted
+ * concurrently is never missed.
+ *
+ * @param executor Pointer to the executor.
+ * @param worker   Index of the calling worker.
+ * @return `EXECUTOR_OK` if the worker may sleep, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EAGAIN` if work is already queued; the idle flag was withdrawn
+ */
+int executorPark(Executor* executor, uint16_t worker);
+
+/**
+ * @brief Address of a worker's idle flag, for use with futex-style waits.
+ *
+ * @param executor Pointer to the executor.
+ * @param worker   Index of the worker.
+ * @return Pointer to the flag, or NULL if arguments are invalid.
+ */
+ExecutorWord_t* executorIdleFlag(Executor* executor, uint16_t worker);
@@ -0,0 +1,190 @@
+#pragma once
+/**
+ * @file heap.h
+ * @brief Fixed-capacity d-ary min-heap priority queue keyed by 64-bit values.
+ *
+ * A `Heap` orders fixed-size payloads by an arbitrary `uint64_t` key, e.g. a
+ * deadline, and always releases the smallest key first. Payloads live in a
+ * contiguous `raw` array laid out like a `Stack`'s and never move once
+ * written. The heap itself is an array of `HeapEntry` records pairing each key
+ * with the index of its payload slot, so sift operations only touch the
+ * entry array.
+ *
+ * - Each node has `HEAP_ARITY` children (4 by default). The children of a node
+ *   are adjacent, so a sift down scans one contiguous run of 16-byte entries
+ *   per level (at most two cache lines for four children), and the tree is
+ *   half as deep as a binary heap.
+ * - Entries past `count` hold the free payload slots, so no separate free
+ *   list is needed.
+ * - All operations take the heap's `Lock_t` and fail with `-EBUSY` if it is
+ *   contended, like `Stack`. `heapPopBatch()` releases several entries under
+ *   a single lock acquisition.
+ *
+ * Entries with equal keys are released in no particular order.
+ */
+#include "locking.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HEAP_OK 0 // success
+
+#ifndef HEAP_ARITY
+#define HEAP_ARITY 4    ///< Children per node
+#endif
+
+#if HEAP_ARITY < 2
+#error "HEAP_ARITY must be at least 2"
+#endif
+
+// Heap lock macros, reuse lock->write as single lock
+#define TAKE_HEAP_LOCK(lock) TAKE_WRITE_LOCK(lock)
+#define CLEAR_HEAP_LOCK(lock) CLEAR_WRITE_LOCK(lock)
+
+/**
+ * @brief Heap node: a key and the payload slot it orders.
+ */
+typedef struct {
+    uint64_t key;       ///< Priority, smallest first
+    uint16_t slot;      ///< Index of the payload in `raw`
+} HeapEntry;
+
+/**
+ * @brief Creates a statically allocated heap instance.
+ *
+ * @param id         The identifier for the heap instance.
+ * @param count      The number of elements the heap can hold.
+ * @param type_size_ The size in bytes of each payload.
+ *
+ * This macro defines the entry array and payload storage using static memory.
+ */
+#define CREATE_HEAP(id, count, type_size_)                          \
+    uint8_t __##id##_raw[(count) * (type_size_)];                   \
+    HeapEntry __##id##_entries[(count)];                            \
+    CREATE_LOCK(id##_lock, 1);                                      \
+    Heap id = {                                                     \
+        .size = (count),                                            \
+        .type_size = (type_size_),                                  \
+        .entries = __##id##_entries,                                \
+        .raw = __##id##_raw,                                        \
+        .lock = &id##_lock,                                         \
+    };                                                              \
+    heapClear(&id)
+
+/**
+ * @brief Fixed-capacity priority queue.
+ */
+typedef struct {
+    uint16_t size;          ///< Maximum number of elements
+    uint16_t type_size;     ///< Size of each payload in bytes
+    uint16_t count;         ///< Number of elements stored
+    HeapEntry* entries;     ///< Heap-ordered entries, followed by the free slots
+    void* raw;              ///< Payload storage, `size * type_size` bytes
+    Lock_t* lock;           ///< Pointer to the lock structure
+} Heap;
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Allocate a heap dynamically using a BlockAllocator.
+ *
+ * @param allocator Pointer to a valid BlockAllocator instance.
+ * @param size      Maximum number of elements the heap should hold.
+ * @param type_size Size in bytes of each payload.
+ * @return Pointer to the newly allocated heap, or NULL on failure.
+ */
+Heap* heapAllocate(BlockAllocator* allocator, uint16_t size, uint16_t type_size);
+
+/**
+ * @brief Deallocate a heap allocated via `heapAllocate`.
+ *
+ * @param allocator Pointer to the same BlockAllocator used to allocate the heap.
+ * @param heap      Address of the pointer to the heap to deallocate.
+ *                  The pointer will be set to NULL on success.
+ * @return `HEAP_OK` on success, or a negative errno value.
+ */
+int heapDeallocate(BlockAllocator* allocator, Heap** heap);
+#endif
+
+/**
+ * @brief Discard every element.
+ *
+ * Must not run concurrently with other heap operations.
+ *
+ * @param heap Pointer to the heap. No action is taken if NULL.
+ */
+void heapClear(Heap* heap);
+
+/**
+ * @brief Insert an element.
+ *
+ * @param heap Pointer to the heap.
+ * @param key  Priority of the element; smaller keys are released first.
+ * @param data Payload to copy, `type_size` bytes.
+ * @return `HEAP_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if the heap is locked by another thread
+ * - `-ENOSPC` if the heap is full
+ */
+int heapPush(Heap* heap, uint64_t key, const void* data);
+
+/**
+ * @brief Remove the element with the smallest key.
+ *
+ * @param heap      Pointer to the heap.
+ * @param[out] key  Key of the removed element, may be NULL.
+ * @param[out] data Receives the payload, `type_size` bytes.
+ * @return `HEAP_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if the heap is locked by another thread
+ * - `-EAGAIN` if the heap is empty
+ */
+int heapPop(Heap* heap, uint64_t* key, void* data);
+
+/**
+ * @brief Remove up to `max_count` elements with keys at most `limit`, smallest first.
+ *
+ * Passing `UINT64_MAX` as `limit` drains without a bound, while a deadline
+ * scheduler passes the current time to collect every expired entry at once.
+ *
+ * @param heap      Pointer to the heap.
+ * @param limit     Largest key to remove.
+ * @param[out] keys Receives the keys, `max_count` entries; may be NULL.
+ * @param[out] data Receives the payloads back to back, `max_count * type_size` bytes.
+ * @param max_count Maximum number of elements to remove.
+ * @return Number of elements removed, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if the heap is locked by another thread
+ */
+int heapPopBatch(Heap* heap, uint64_t limit, uint64_t* keys, void* data, uint16_t max_count);
+
+/**
+ * @brief Read the smallest key without removing it.
+ *
+ * @param heap     Pointer to the heap.
+ * @param[out] key Smallest key.
+ * @return `HEAP_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if the heap is locked by another thread
+ * - `-EAGAIN` if the heap is empty
+ */
+int heapPeek(Heap* heap, uint64_t* key);
+
+/**
+ * @brief Returns true if the heap contains no elements.
+ */
+bool heapIsEmpty(const Heap* heap);
+
+/**
+ * @brief Returns true if the heap cannot accept more elements.
+ */
+bool heapIsFull(const Heap* heap);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,177 @@
+#pragma once
+/**
+ * @file lease.h
+ * @brief At-least-once delivery on top of a `Queue`, with leases and redelivery.
+ *
+ * A `LeaseQueue` hands out messages under a lease instead of consuming them:
+ * - `leaseQueueClaim()` delivers the next message and moves its slot to the
+ *   `BUFFER_LEASED` state. The message stays in its slot, invisible to other
+ *   consumers, until the lease ends.
+ * - `leaseQueueAck()` ends the lease and frees the slot.
+ * - `leaseQueueNack()` ends the lease and queues the message for redelivery.
+ * - A lease that is neither acked nor nacked within `lease` ticks expires,
+ *   and the message is redelivered to the next consumer.
+ *
+ * Every delivery carries a delivery count. Acks and nacks for a delivery
+ * whose lease has already expired are rejected, so a message is never freed
+ * by a consumer that lost its lease.
+ *
+ * Producers write with `queueWrite()` / `queueWriteClaim()` on `queue`. The
+ * plain `queueRead()` path is unaffected by leases; expired leases are found
+ * by an incremental sweep (`leaseQueueExpire()`) that idle consumers run on
+ * their own, or that the application runs from a timer.
+ *
+ * Leased slots are not reused by producers until they are acked, so a
+ * consumer that keeps messages leased limits the free capacity of the queue.
+ */
+#include "queue.h"
+#include "buffer.h"
+#include "locking.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LEASE_OK 0 // success
+
+#ifndef LEASE_SCAN_STEP
+#define LEASE_SCAN_STEP 8  ///< Slots examined by an idle `leaseQueueClaim()`
+#endif
+
+#ifdef USE_ATOMIC
+#include <stdatomic.h>
+typedef atomic_uint_least32_t LeaseWord_t;  ///< Lease ticket, expiry time and sweep cursor storage
+#else
+typedef uint32_t LeaseWord_t;               ///< Lease ticket, expiry time and sweep cursor storage
+#endif
+
+/**
+ * @brief A leased message.
+ */
+typedef struct {
+    uint8_t* data;      ///< Message bytes, valid until the lease ends
+    uint16_t len;       ///< Message length
+    uint16_t index;     ///< Queue slot index
+    uint16_t delivery;  ///< Delivery count, 1 on the first delivery
+} LeaseSlot;
+
+/**
+ * @brief Creates a statically allocated lease queue instance.
+ *
+ * @param id         The identifier for the lease queue instance.
+ * @param msg_size   Maximum size in bytes of each message.
+ * @param msg_count  Maximum number of messages the queue can store.
+ * @param lease_     Lease period, in the same ticks as the `now` arguments.
+ *
+ * This macro defines the underlying queue, the redelivery ring and the
+ * per-slot lease records, all backed by static memory.
+ */
+#define CREATE_LEASE_QUEUE(id, msg_size, msg_count, lease_)         \
+    CREATE_QUEUE(__##id##_queue, msg_size, msg_count);              \
+    CREATE_BUFFER(__##id##_redeliver, msg_count, sizeof(uint16_t)); \
+    LeaseWord_t __##id##_ticket[(msg_count)];                       \
+    LeaseWord_t __##id##_due[(msg_count)];                          \
+    LeaseQueue id = {                                               \
+        .queue = &__##id##_queue,                                   \
+        .redeliver = &__##id##_redeliver,                           \
+        .ticket = __##id##_ticket,                                  \
+        .due = __##id##_due,                                        \
+        .lease = (lease_),                                          \
+    };                                                              \
+    leaseQueueClear(&id)
+
+/**
+ * @brief Queue with leased, acknowledged delivery.
+ */
+typedef struct {
+    Queue* queue;           ///< Underlying message queue, written by producers
+    Buffer* redeliver;      ///< Ring of slot indices awaiting redelivery
+    LeaseWord_t* ticket;    ///< Per-slot delivery count of the current lease, 0 if not leased
+    LeaseWord_t* due;       ///< Per-slot lease expiry time
+    LeaseWord_t scan;       ///< Position of the incremental expiry sweep
+    uint32_t lease;         ///< Lease period in ticks
+} LeaseQueue;
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Allocates and initializes a new lease queue.
+ *
+ * @param allocator Pointer to a pre-initialized BlockAllocator.
+ * @param slot_len  Maximum length (in bytes) of a single message.
+ * @param size      Number of message slots to support.
+ * @param lease     Lease period in ticks.
+ *
+ * @return Pointer to a new LeaseQueue instance, or NULL on failure.
+ */
+LeaseQueue* leaseQueueAllocate(BlockAllocator* allocator, uint16_t slot_len, uint16_t size, uint32_t lease);
+
+/**
+ * @brief Deallocates a lease queue and all associated memory.
+ *
+ * @param allocator The allocator used for the original allocation.
+ * @param queue     Pointer to the LeaseQueue pointer; will be set to NULL on success.
+ *
+ * @return `LEASE_OK` on success, or a negative errno value.
+ */
+int leaseQueueDeallocate(BlockAllocator* allocator, LeaseQueue** queue);
+#endif
+
+/**
+ * @brief Discards all messages and leases.
+ *
+ * Must not run concurrently with consumers.
+ *
+ * @param queue Pointer to the lease queue. No action is taken if NULL.
+ */
+void leaseQueueClear(LeaseQueue* queue);
+
+/**
+ * @brief Leases the next message, preferring messages due for redelivery.
+ *
+ * When no message is available, the caller sweeps up to `LEASE_SCAN_STEP`
+ * slots for expired leases before giving up.
+ *
+ * @param queue     Pointer to the lease queue.
+ * @param now       Current time in ticks; the lease ends at `now + lease`.
+ * @param[out] slot The leased message.
+ * @return Slot index on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EAGAIN` if no message is available
+ * - `-EBUSY` if the queue was contended; retry
+ */
+int leaseQueueClaim(LeaseQueue* queue, uint32_t now, LeaseSlot* slot);
+
+/**
+ * @brief Acknowledges a delivery, freeing its slot.
+ *
+ * @param queue Pointer to the lease queue.
+ * @param slot  Delivery returned by `leaseQueueClaim()`.
+ * @return `LEASE_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-ETIMEDOUT` if the lease expired; the message was or will be redelivered
+ * - `-EPERM` if the slot is not leased
+ */
+int leaseQueueAck(LeaseQueue* queue, const LeaseSlot* slot);
+
+/**
+ * @brief Gives up a delivery, making the message available for redelivery.
+ *
+ * @param queue Pointer to the lease queue.
+ * @param slot  Delivery returned by `leaseQueueClaim()`.
+ * @return `LEASE_OK` on success, or a negative errno value as for `leaseQueueAck()`.
+ */
+int leaseQueueNack(LeaseQueue* queue, const LeaseSlot* slot);
+
+/**
+ * @brief Examines up to `max_count` slots for expired leases.
+ *
+ * Successive calls continue where the previous one stopped, so the cost of
+ * finding expired leases is spread over many calls.
+ *
+ * @param queue     Pointer to the lease queue.
+ * @param now       Current time in ticks.
+ * @param max_count Maximum number of slots to examine.
+ * @return Number of leases that expired, or `-EINVAL` if arguments are invalid.
+ */
+int leaseQueueExpire(LeaseQueue* queue, uint32_t now, uint16_t max_count);
@@ -29,8 +29,31 @@
 #endif
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <errno.h>
 
+#if defined(USE_ATOMIC) && defined(__cplusplus)
+/* C++ translation units see the same atomic types through <atomic>. */
+#include <atomic>
+using std::atomic_bool;
+using std::atomic_uint_least8_t;
+using std::atomic_uint_least32_t;
+using std::atomic_store;
+using std::atomic_store_explicit;
+using std::atomic_load_explicit;
+using std::atomic_compare_exchange_strong_explicit;
+using std::atomic_fetch_add_explicit;
+using std::atomic_fetch_sub_explicit;
+using std::memory_order_acq_rel;
+using std::memory_order_relaxed;
+using std::memory_order_acquire;
+using std::memory_order_seq_cst;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define LOCK_OK 0 // success
 
 /**
@@ -46,10 +69,13 @@ typedef enum {
     BUFFER_CLAIMED,    ///< Slot has been claimed by a writer but not yet filled. */
     BUFFER_READY,      ///< Slot contains valid data ready to be read. */
     BUFFER_READING,    ///< Slot is currently being accessed by a reader. */
+    BUFFER_LEASED,     ///< Slot was delivered and awaits acknowledgement (see `lease.h`). */
 } BufferState;
 
 #ifdef USE_ATOMIC
+#ifndef __cplusplus
 #include <stdatomic.h>
+#endif
 
 /**
  * @brief [internal] Clear a lock variable (set to `false`).
@@ -64,6 +90,72 @@ typedef enum {
  */
 #define SET_LOCK_VAL(lock, val) atomic_store_explicit(lock, val, memory_order_relaxed)
 
+/**
+ * @brief [internal] Read a lock value with acquire ordering.
+ * @param lock Pointer to the atomic variable.
+ */
+#define GET_LOCK_VAL(lock) atomic_load_explicit(lock, memory_order_acquire)
+
+/**
+ * @brief [internal] Atomically replace a lock value.
+ *
+ * Publishes everything written before the swap and observes everything
+ * published by the previous owner of the value.
+ *
+ * @param lock Pointer to the atomic variable.
+ * @param val  Value to store.
+ * @return The previous value.
+ */
+#define SWAP_LOCK_VAL(lock, val) atomic_exchange_explicit(lock, val, memory_order_acq_rel)
+
+/**
+ * @brief [internal] Store a lock value with release ordering.
+ *
+ * Publishes every write made before the store to threads that observe the
+ * new value with `GET_LOCK_VAL()`.
+ *
+ * @param lock Pointer to the atomic variable.
+ * @param val  Value to store.
+ */
+#define PUBLISH_LOCK_VAL(lock, val) atomic_store_explicit(lock, val, memory_order_release)
+
+/**
+ * @brief [internal] Atomically increment a counter without ordering guarantees.
+ * @param lock Pointer to the atomic variable.
+ * @return The previous value.
+ */
+#define INCREMENT_LOCK_VAL(lock) atomic_fetch_add_explicit(lock, 1, memory_order_relaxed)
+
+/**
+ * @brief [internal] Atomically add to a counter, publishing and observing prior writes.
+ * @param lock Pointer to the atomic variable.
+ * @param val  Amount to add.
+ * @return The previous value.
+ */
+#define ADD_LOCK_VAL(lock, val) atomic_fetch_add_explicit(lock, val, memory_order_acq_rel)
+
+/**
+ * @brief [internal] Atomically subtract from a counter, publishing and observing prior writes.
+ * @param lock Pointer to the atomic variable.
+ * @param val  Amount to subtract.
+ * @return The previous value.
+ */
+#define SUB_LOCK_VAL(lock, val) atomic_fetch_sub_explicit(lock, val, memory_order_acq_rel)
+
+/** @brief [internal] Order earlier loads before any later loads and stores. */
+#define LOCK_ACQUIRE_FENCE() atomic_thread_fence(memory_order_acquire)
+
+/** @brief [internal] Order earlier loads and stores before any later stores. */
+#define LOCK_RELEASE_FENCE() atomic_thread_fence(memory_order_release)
+
+/**
+ * @brief [internal] Full sequentially consistent fence.
+ *
+ * Orders an earlier store before a later load of a different variable, which
+ * acquire and release fences alone do not guarantee.
+ */
+#define LOCK_FULL_FENCE() atomic_thread_fence(memory_order_seq_cst)
+
 /**
  * @brief [internal] Compare and set a lock value atomically.
  *
@@ -84,6 +176,21 @@ typedef enum {
         memory_order_acquire,                       \
         memory_order_relaxed)
 
+/**
+ * @brief [internal] Compare and set a lock value with sequentially consistent ordering.
+ *
+ * Same as `COMPARE_SET_LOCK()` but takes part in the single total order of
+ * `LOCK_FULL_FENCE()`, as required when two parties race for the same element
+ * from opposite ends.
+ */
+#define COMPARE_SET_LOCK_FULL(lock, expected, val)  \
+    atomic_compare_exchange_strong_explicit(        \
+        lock,                                       \
+        expected,                                   \
+        val,                                        \
+        memory_order_seq_cst,                       \
+        memory_order_relaxed)
+
 /** @brief [internal] helper for lock acquisition macros. */
 static bool __lock_expect_false__ = false;
 
@@ -121,6 +228,13 @@ static bool __lock_expect_false__ = false;
  */
 #define SET_SLOT_STATE(lock, index, val) SET_LOCK_VAL(lock->slot_state + index, val)
 
+/**
+ * @brief Read the state of a slot in the lock.
+ * @param lock  Pointer to the `Lock_t` structure.
+ * @param index Index of the slot to read.
+ */
+#define GET_SLOT_STATE(lock, index) GET_LOCK_VAL(lock->slot_state + index)
+
 /**
  * @brief Atomically check and update a slot's state.
  *
@@ -157,6 +271,29 @@ static bool __lock_expect_false__ = false;
     atomic_store(&name.read, false);                \
     atomic_store(&name.write, false)                \
 
+/**
+ * @brief Initialize a `Lock_t` in place over caller-provided slot state storage.
+ *
+ * Runtime counterpart of `CREATE_LOCK()`, used when locks live inside arrays
+ * (e.g. one lock per ring of a compound container).
+ *
+ * @param lock  Pointer to the `Lock_t` to initialize.
+ * @param state Pointer to `len` `LockState_t` entries.
+ * @param len   Number of slots to manage.
+ */
+#define INIT_LOCK(lock, state, len)                 \
+    do {                                            \
+        for (int i = 0; i < (len); i++) {           \
+            SET_LOCK_VAL((state) + i, BUFFER_FREE); \
+        }                                           \
+        (lock)->slot_state = (state);               \
+        atomic_store(&(lock)->read, false);         \
+        atomic_store(&(lock)->write, false);        \
+    } while (0)
+
+/** @brief Storage type of a single slot state. */
+typedef atomic_uint_least8_t LockState_t;
+
 /**
  * @struct Lock_t
  * @brief Represents the locking state for a concurrent container.
@@ -182,10 +319,48 @@ typedef struct {
 #define CLEAR_WRITE_LOCK(lock) {}
 /** @brief No-op in single-threaded mode. */
 #define SET_SLOT_STATE(lock, index, val) {}
+/** @brief Always reads as free in single-threaded mode. */
+#define GET_SLOT_STATE(lock, index) BUFFER_FREE
 /** @brief Always returns true in single-threaded mode. */
 #define EXPECT_SLOT_STATE(lock, index, expected, val) true
 /** @brief Declares a dummy lock variable in single-threaded mode. */
 #define CREATE_LOCK(name, len) Lock_t name = 0
+/** @brief Plain read in single-threaded mode. */
+#define GET_LOCK_VAL(lock) (*(lock))
+/** @brief Plain exchange in single-threaded mode. */
+#define SWAP_LOCK_VAL(lock, val) __lock_swap__(lock, val)
+/** @brief [internal] helper for `SWAP_LOCK_VAL()` in single-threaded mode. */
+static inline uint8_t __lock_swap__(uint8_t* lock, uint8_t val) {
+    uint8_t prev = *lock;
+    *lock = val;
+    return prev;
+}
+/** @brief Plain store in single-threaded mode. */
+#define SET_LOCK_VAL(lock, val) (*(lock) = (val))
+/** @brief Plain store in single-threaded mode. */
+#define PUBLISH_LOCK_VAL(lock, val) (*(lock) = (val))
+/** @brief Plain post-increment in single-threaded mode. */
+#define INCREMENT_LOCK_VAL(lock) ((*(lock))++)
+/** @brief Plain addition in single-threaded mode. */
+#define ADD_LOCK_VAL(lock, val) ((*(lock) += (val)) - (val))
+/** @brief Plain subtraction in single-threaded mode. */
+#define SUB_LOCK_VAL(lock, val) ((*(lock) -= (val)) + (val))
+/** @brief Plain compare and set in single-threaded mode. */
+#define COMPARE_SET_LOCK(lock, expected, val) \
+    ((*(lock) == *(expected)) ? (*(lock) = (val), true) : (*(expected) = *(lock), false))
+/** @brief No-op in single-threaded mode. */
+#define LOCK_ACQUIRE_FENCE() {}
+/** @brief No-op in single-threaded mode. */
+#define LOCK_RELEASE_FENCE() {}
+/** @brief No-op in single-threaded mode. */
+#define LOCK_FULL_FENCE() {}
+/** @brief Plain compare and set in single-threaded mode. */
+#define COMPARE_SET_LOCK_FULL(lock, expected, val) COMPARE_SET_LOCK(lock, expected, val)
+/** @brief Resets a dummy lock in single-threaded mode. */
+#define INIT_LOCK(lock, state, len) (*(lock) = 0)
+
+/** @brief Dummy slot state type for non-atomic builds. */
+typedef uint8_t LockState_t;
 
 /** @brief Dummy lock type for non-atomic builds. */
 typedef uint8_t Lock_t;
@@ -212,3 +387,7 @@ Lock_t* lockAllocate(BlockAllocator* allocator, uint16_t size);
  */
 int lockDeallocate(BlockAllocator* allocator, Lock_t** lock);
 #endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,323 @@
+#pragma once
+/**
+ * @file pipeline.h
+ * @brief Multi-stage processing pipeline of `Buffer` rings with credit-based flow control.
+ *
+ * A `Pipeline` chains stages through one input ring per stage. Elements are
+ * pushed into the first stage; each stage maps an element of its input ring
+ * directly into a slot of the next stage's ring, and the last stage consumes
+ * it. A stage is run by calling `pipelineRun()` with its stage index, from
+ * any number of threads.
+ *
+ * - The threads can be managed by the caller, like those of the executor, or
+ *   started by `pipelineStart()` when built with `USE_THREADS`. It starts the
+ *   number of threads set with `pipelineSetThreads()` for every stage, pins
+ *   them to consecutive CPUs if asked to, and `pipelineJoin()` waits for
+ *   them once the pipeline has drained.
+ *
+ * - Flow control is credit based. Every ring carries a credit count equal to
+ *   its free capacity. A stage reserves credits on the next ring before it
+ *   takes elements from its own, so a stage never consumes an element it has
+ *   nowhere to put, and a slow stage stalls its upstream instead of failing.
+ * - Credits are reserved and returned once per batch of up to `batch`
+ *   elements, so the shared counters are touched once per hop and batch.
+ * - `pipelineClose()` stops new pushes. Each stage then drains its ring and
+ *   reports `-EPIPE` once its upstream has finished and nothing is left, so
+ *   shutdown propagates stage by stage without losing elements.
+ * - Per-stage counters report elements processed, batches run, stalls on
+ *   downstream credit and the current ring depth (see `pipelineStats()`).
+ */
+#include "buffer.h"
+#include "locking.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#ifdef USE_THREADS
+#include <pthread.h>
+#endif
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PIPELINE_OK 0 // success
+
+#define PIPELINE_CPU_ANY -1 // stage threads are not pinned
+
+#ifdef USE_ATOMIC
+#include <stdatomic.h>
+typedef atomic_uint_least32_t PipelineWord_t;  ///< Credit, flag and counter storage
+#else
+typedef uint32_t PipelineWord_t;               ///< Credit, flag and counter storage
+#endif
+
+/**
+ * @brief Stage function.
+ * @param ctx Context registered with `pipelineSetStage()`.
+ * @param out Slot in the next stage's ring to fill, or NULL for the last stage.
+ * @param in  Element taken from the stage's ring.
+ */
+typedef void (*StageFn)(void* ctx, void* out, const void* in);
+
+/**
+ * @brief Per-stage state.
+ */
+typedef struct {
+    Buffer input;               ///< Ring feeding the stage
+    StageFn fn;                 ///< Stage function, NULL until configured
+    void* ctx;                  ///< Context passed to `fn`
+    uint16_t batch;             ///< Maximum elements taken per `pipelineRun()`
+    uint16_t threads;           ///< Threads started for the stage by `pipelineStart()`
+    int16_t cpu;                ///< CPU of the stage's first thread, `PIPELINE_CPU_ANY` if unpinned
+    PipelineWord_t credits;     ///< Free capacity of `input` not yet reserved by upstream
+    PipelineWord_t active;      ///< Number of threads inside `pipelineRun()` for the stage
+    PipelineWord_t done;        ///< Non-zero once the stage has drained after close
+    PipelineWord_t processed;   ///< Elements processed
+    PipelineWord_t batches;     ///< Non-empty batches run
+    PipelineWord_t stalls;      ///< Runs that found no credit on the next ring
+} PipelineStage;
+
+/**
+ * @brief Snapshot of a stage's counters.
+ *
+ * Throughput is the change in `processed` between two snapshots divided by
+ * the time between them; `processed / batches` is the mean batch size.
+ */
+typedef struct {
+    uint32_t processed;     ///< Elements processed
+    uint32_t batches;       ///< Non-empty batches run
+    uint32_t stalls;        ///< Runs that found no credit on the next ring
+    uint16_t depth;         ///< Elements queued or reserved in the stage's ring
+} PipelineStats;
+
+/**
+ * @brief Creates a statically allocated pipeline instance.
+ *
+ * @param id            The identifier for the pipeline instance.
+ * @param stage_count_  Number of stages.
+ * @param depth_        Number of elements each stage's ring can hold.
+ * @param type_size_    Size in bytes of the elements passed between stages.
+ *
+ * This macro defines the stage states and one ring per stage, all backed by
+ * static memory, and sets them up with `pipelineInit()`. It ends in a
+ * statement, so like `CREATE_COLUMN_BUFFER()` it can only be used at block
+ * scope. Stage functions are set with `pipelineSetStage()`.
+ */
+#define CREATE_PIPELINE(id, stage_count_, depth_, type_size_)                           \
+    uint8_t __##id##_ring_raw[(stage_count_) * (depth_) * (type_size_)];                \
+    LockState_t __##id##_ring_state[(stage_count_) * (depth_)];                         \
+    Lock_t __##id##_ring_lock[(stage_count_)];                                          \
+    PipelineStage __##id##_stages[(stage_count_)];                                      \
+    Pipeline id = {                                                                     \
+        .stages = __##id##_stages,                                                      \
+        .stage_count = (stage_count_),                                                  \
+    };                                                                                  \
+    (void)pipelineInit(&id, (depth_), (type_size_), __##id##_ring_raw,                  \
+                       __##id##_ring_lock, __##id##_ring_state)
+
+/**
+ * @brief Chain of stages connected by rings.
+ */
+typedef struct {
+    PipelineStage* stages;      ///< `stage_count` stage states
+    uint16_t stage_count;       ///< Number of stages
+    PipelineWord_t closed;      ///< Non-zero once `pipelineClose()` was called
+} Pipeline;
+
+#ifdef USE_THREADS
+/**
+ * @brief Thread started by `pipelineStart()`.
+ */
+typedef struct {
+    Pipeline* pipeline;     ///< Pipeline the thread runs
+    PipelineWord_t* stop;   ///< Stop flag of the runner
+    pthread_t thread;       ///< Thread handle
+    uint16_t stage;         ///< Index of the stage the thread runs
+    int status;             ///< `PIPELINE_OK` once the stage drained, or the error that stopped the thread
+} PipelineWorker;
+
+/**
+ * @brief Threads running the stages of a pipeline.
+ */
+typedef struct {
+    PipelineWorker* workers;    ///< Storage for up to `capacity` threads
+    uint16_t capacity;          ///< Number of entries of `workers`
+    uint16_t count;             ///< Threads started and not yet joined
+    PipelineWord_t stop;        ///< Set when starting failed, to stop the threads already running
+} PipelineRunner;
+
+/**
+ * @brief Creates a statically allocated pipeline runner.
+ *
+ * @param id        The identifier for the runner instance.
+ * @param capacity_ Maximum number of threads over all stages.
+ */
+#define CREATE_PIPELINE_RUNNER(id, capacity_)                                           \
+    PipelineWorker __##id##_workers[(capacity_)];                                       \
+    PipelineRunner id = { .workers = __##id##_workers, .capacity = (capacity_) }
+#endif
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Allocates and initializes a new pipeline.
+ *
+ * @param allocator     Pointer to a pre-initialized BlockAllocator.
+ * @param stage_count   Number of stages.
+ * @param depth         Number of elements each stage's ring can hold.
+ * @param type_size     Size in bytes of the elements passed between stages.
+ *
+ * @return Pointer to a new Pipeline instance, or NULL on failure.
+ */
+Pipeline* pipelineAllocate(BlockAllocator* allocator, uint16_t stage_count, uint16_t depth, uint16_t type_size);
+
+/**
+ * @brief Deallocates a pipeline and all associated memory.
+ *
+ * @param allocator The allocator used for the original allocation.
+ * @param pipeline  Pointer to the Pipeline pointer; will be set to NULL on success.
+ *
+ * @return `PIPELINE_OK` on success, or a negative errno value.
+ */
+int pipelineDeallocate(BlockAllocator* allocator, Pipeline** pipeline);
+#endif
+
+/**
+ * @brief Lays the stage rings of a pipeline out in caller-provided memory.
+ *
+ * `pipeline->stages` and `pipeline->stage_count` must already be set. Every
+ * stage is reset to an unconfigured stage with a batch of 1 and a single
+ * unpinned thread, and the pipeline is left empty and open. Used by
+ * `CREATE_PIPELINE()`.
+ *
+ * @param pipeline  Pointer to the pipeline.
+ * @param depth     Number of elements each stage's ring can hold.
+ * @param type_size Size in bytes of the elements passed between stages.
+ * @param raw       `stage_count * depth * type_size` bytes of ring storage.
+ * @param locks     `stage_count` ring locks.
+ * @param states    `stage_count * depth` slot states.
+ * @return `PIPELINE_OK` on success, `-EINVAL` if arguments are invalid.
+ */
+int pipelineInit(Pipeline* pipeline, uint16_t depth, uint16_t type_size,
+                 uint8_t* raw, Lock_t* locks, LockState_t* states);
+
+/**
+ * @brief Drops every queued element, resets all counters and reopens the pipeline.
+ *
+ * Stage functions are kept. Must not be called while stages or producers
+ * are active.
+ *
+ * @param pipeline Pointer to the pipeline. No action is taken if NULL.
+ */
+void pipelineClear(Pipeline* pipeline);
+
+/**
+ * @brief Configures a stage.
+ *
+ * Must be called for every stage before threads start running it.
+ *
+ * @param pipeline Pointer to the pipeline.
+ * @param stage    Index of the stage.
+ * @param fn       Stage function.
+ * @param ctx      Context passed to `fn`.
+ * @param batch    Maximum elements taken per `pipelineRun()`, at most the ring depth.
+ * @return `PIPELINE_OK` on success, `-EINVAL` if arguments are invalid.
+ */
+int pipelineSetStage(Pipeline* pipeline, uint16_t stage, StageFn fn, void* ctx, uint16_t batch);
+
+/**
+ * @brief Sets how many threads `pipelineStart()` runs a stage with, and where.
+ *
+ * Thread `t` of the stage is pinned to CPU `cpu + t`.
+ *
+ * @param pipeline Pointer to the pipeline.
+ * @param stage    Index of the stage.
+ * @param threads  Number of threads, at least 1.
+ * @param cpu      CPU of the first thread, or `PIPELINE_CPU_ANY` to leave the threads unpinned.
+ * @return `PIPELINE_OK` on success, `-EINVAL` if arguments are invalid.
+ */
+int pipelineSetThreads(Pipeline* pipeline, uint16_t stage, uint16_t threads, int16_t cpu);
+
+/**
+ * @brief Push an element into the first stage.
+ *
+ * @param pipeline Pointer to the pipeline.
+ * @param data     Element to copy into the first stage's ring.
+ * @return `PIPELINE_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-ENOSPC` if the first stage has no credit left
+ * - `-EPIPE` if the pipeline was closed
+ */
+int pipelinePush(Pipeline* pipeline, const void* data);
+
+/**
+ * @brief Stop accepting pushes and let the stages drain.
+ *
+ * Call once every producer has stopped pushing.
+ *
+ * @param pipeline Pointer to the pipeline. No action is taken if NULL.
+ */
+void pipelineClose(Pipeline* pipeline);
+
+/**
+ * @brief Run one batch of a stage.
+ *
+ * Reserves up to `batch` credits on the next stage's ring, then maps as many
+ * elements from the stage's ring into it and returns the credits of the
+ * consumed slots to the stage's upstream.
+ *
+ * @param pipeline Pointer to the pipeline.
+ * @param stage    Index of the stage to run.
+ * @return Number of elements processed, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid or the stage is not configured
+ * - `-EAGAIN` if the stage's ring is empty
+ * - `-ENOSPC` if the next stage has no credit left
+ * - `-EPIPE` if the pipeline was closed and the stage has drained
+ */
+int pipelineRun(Pipeline* pipeline, uint16_t stage);
+
+/**
+ * @brief Read a stage's counters.
+ *
+ * @param pipeline  Pointer to the pipeline.
+ * @param stage     Index of the stage.
+ * @param[out] stats Counter snapshot.
+ * @return `PIPELINE_OK` on success, `-EINVAL` if arguments are invalid.
+ */
+int pipelineStats(Pipeline* pipeline, uint16_t stage, PipelineStats* stats);
+
+#ifdef USE_THREADS
+/**
+ * @brief Starts the threads of every stage.
+ *
+ * Each thread calls `pipelineRun()` for its stage, yielding the CPU whenever
+ * the stage's ring is empty or the next one has no credit, until the stage
+ * reports `-EPIPE`. Every stage must be configured with `pipelineSetStage()`.
+ * If a thread cannot be started, the threads started so far are stopped and
+ * joined and the error is returned; queued elements stay in the pipeline.
+ *
+ * @note
+ * This function is only available if `USE_THREADS` is defined.
+ *
+ * @param pipeline Pointer to the pipeline.
+ * @param runner   Runner with room for the threads of all stages; must not be running.
+ * @return `PIPELINE_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid, a stage is not configured or the
+ *   runner is already running
+ * - `-ENOSPC` if the runner has room for fewer threads than the stages need
+ * - any error of `pthread_create()`, e.g. `-EINVAL` for a CPU that does not exist
+ */
+int pipelineStart(Pipeline* pipeline, PipelineRunner* runner);
+
+/**
+ * @brief Waits for every thread of a runner to finish.
+ *
+ * Threads finish once their stage has drained after `pipelineClose()`.
+ *
+ * @note
+ * This function is only available if `USE_THREADS` is defined.
+ *
+ * @param runner Runner started with `pipelineStart()`.
+ * @return `PIPELINE_OK` if every stage drained, `-EINVAL` if `runner` is
+ *         NULL, or the first error that stopped a thread (`-ECANCELED` for
+ *         threads stopped by a failed `pipelineStart()`).
+ */
+int pipelineJoin(PipelineRunner* runner);
+#endif
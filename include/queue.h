@@ -16,6 +16,10 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define QUEUE_OK 0 // success
 
 /**
@@ -41,6 +45,31 @@
         .slot_len = msg_size                        \
     }
 
+/**
+ * @brief Creates a statically allocated queue with aligned, padded message slots.
+ *
+ * @param id        Name of the queue.
+ * @param msg_size  Maximum length of a message in bytes.
+ * @param msg_count Number of messages the queue can hold.
+ * @param align     Slot alignment in bytes: 8, 16, 32 or 64.
+ *
+ * Like `CREATE_QUEUE()`, but every message slot starts on an `align` byte
+ * boundary; see `CREATE_BUFFER_ALIGNED()`.
+ */
+#define CREATE_QUEUE_ALIGNED(id, msg_size, msg_count, align) \
+    uint16_t __##id##_msg_len[(msg_count)] = {0};   \
+    CREATE_BUFFER_ALIGNED(                          \
+        __##id##_buf,                               \
+        msg_count,                                  \
+        msg_size * sizeof(uint8_t),                 \
+        align                                       \
+    );                                              \
+    Queue id = {                                    \
+        .slot_buffer = &__##id##_buf,               \
+        .msg_len = __##id##_msg_len,                \
+        .slot_len = msg_size                        \
+    }
+
 /**
  * @brief Fixed-size message queue with variable-length messages.
  *
@@ -65,6 +94,18 @@ typedef struct {
  */
 Queue* queueAllocate(BlockAllocator* allocator, uint16_t slot_len, uint16_t size);
 
+/**
+ * @brief Allocates and initializes a new message queue with aligned, padded slots.
+ *
+ * @param allocator Pointer to a pre-initialized BlockAllocator.
+ * @param slot_len  Maximum length (in bytes) of a single message.
+ * @param size      Number of message slots to support.
+ * @param align     Slot alignment in bytes: 8, 16, 32 or 64.
+ *
+ * @return Pointer to a new Queue instance, or NULL on failure.
+ */
+Queue* queueAllocateAligned(BlockAllocator* allocator, uint16_t slot_len, uint16_t size, uint16_t align);
+
 /**
  * @brief Deallocates a queue and all associated memory.
  *
@@ -77,12 +118,31 @@ int queueDeallocate(BlockAllocator* allocator, Queue** queue);
 #endif
 
 /**
- * @brief Clears the queue, resetting message lengths and positions.
+ * @brief Discards all messages in O(1).
+ *
+ * Safe to call while producers and consumers are active; see `bufferClear()`.
  *
  * @param queue Pointer to the queue to clear.
  */
 void queueClear(Queue* queue);
 
+/**
+ * @brief Attaches a watermark to the queue, or detaches it if NULL.
+ *
+ * @param queue     Pointer to the queue.
+ * @param watermark Initialized watermark, or NULL.
+ * @return `QUEUE_OK` on success, or `-EINVAL` if arguments are invalid.
+ */
+int queueSetWatermark(Queue* queue, Watermark* watermark);
+
+/**
+ * @brief Returns the distance in bytes between the starts of consecutive message slots.
+ *
+ * @param queue Pointer to the queue.
+ * @return `slot_len`, rounded up to the alignment if the queue was created with one.
+ */
+uint16_t queueStride(const Queue* queue);
+
 /**
  * @brief Returns true if the queue contains no messages.
  *
@@ -167,4 +227,8 @@ int queueReadClaim(Queue* queue, uint8_t** data, uint16_t* len);
  *
  * @return Number of bytes released on success, or a negative error code on failure.
  */
-int queueReadRelease(Queue* queue, uint16_t index);
\ No newline at end of file
+int queueReadRelease(Queue* queue, uint16_t index);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,251 @@
+#pragma once
+/**
+ * @file reorder.h
+ * @brief Reorder buffer restoring sequence order from out-of-order producers.
+ *
+ * A `ReorderBuffer` holds results tagged with a 32-bit sequence number and
+ * hands them to the consumer in sequence order, e.g. when work is fanned out
+ * to several workers and the results are needed in submission order.
+ *
+ * - Sequence `seq` lives in slot `seq % size`. Producers complete slots in
+ *   any order; each slot goes through the same `BufferState` machine as a
+ *   `Buffer` slot (free, claimed, ready, reading).
+ * - Only sequences in the window `[next, next + size)` can be written, where
+ *   `next` is the sequence the consumer expects. Producers that run ahead
+ *   get `-ENOSPC` until the consumer catches up.
+ * - The consumer reads only the contiguous prefix of ready sequences; a gap
+ *   at `next` makes reads return `-EAGAIN` even if later sequences are ready.
+ * - A consumer waiting for `next` may park: `reorderPark()` publishes a wait
+ *   flag that the producer completing `next` clears before calling the wake
+ *   hook. The flag is a 32-bit word so it can be waited on with a futex.
+ *
+ * Producers need no lock, since the window maps every pending sequence to
+ * its own slot. Readers serialize on the read lock of `ring`.
+ *
+ * Every sequence must be written exactly once.
+ */
+#include "buffer.h"
+#include "locking.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define REORDER_OK 0 // success
+
+#ifdef USE_ATOMIC
+#ifndef __cplusplus
+#include <stdatomic.h>
+#endif
+typedef atomic_uint_least32_t ReorderWord_t;   ///< Sequence / wait flag storage
+#else
+typedef uint32_t ReorderWord_t;                ///< Sequence / wait flag storage
+#endif
+
+/**
+ * @brief Hook called by a producer to wake the parked consumer.
+ * @param ctx Context registered with `reorderSetWakeHook()`.
+ */
+typedef void (*ReorderWakeFn)(void* ctx);
+
+/**
+ * @brief Creates a statically allocated reorder buffer instance.
+ *
+ * @param id         The identifier for the reorder buffer instance.
+ * @param count      Number of slots, i.e. the width of the sequence window.
+ * @param type_size_ The size in bytes of each element.
+ *
+ * This macro defines the reorder buffer and its slot ring using static
+ * memory. The first expected sequence is 0.
+ */
+#define CREATE_REORDER_BUFFER(id, count, type_size_)            \
+    CREATE_BUFFER(__##id##_ring, count, type_size_);            \
+    ReorderBuffer id = { .ring = __##id##_ring }
+
+/**
+ * @brief Ring of elements indexed by sequence number.
+ */
+typedef struct {
+    Buffer ring;            ///< Slot storage and states; `head` and `tail` are unused
+    ReorderWord_t next;     ///< Next sequence expected by the consumer
+    ReorderWord_t waiting;  ///< Non-zero while the consumer is parked
+    ReorderWakeFn wake;     ///< Optional hook to wake a parked consumer
+    void* wake_ctx;         ///< Context passed to `wake`
+} ReorderBuffer;
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Allocates and initializes a new reorder buffer.
+ *
+ * @param allocator The BlockAllocator used to obtain memory for the buffer and its storage.
+ * @param size      Number of slots, i.e. the width of the sequence window.
+ * @param type_size The size of each element in bytes.
+ *
+ * @return Pointer to the new ReorderBuffer, or NULL on failure.
+ */
+ReorderBuffer* reorderAllocate(BlockAllocator* allocator, uint16_t size, uint16_t type_size);
+
+/**
+ * @brief Deallocates a reorder buffer and its storage.
+ *
+ * @param allocator The BlockAllocator used for the original allocation.
+ * @param reorder   Pointer to the ReorderBuffer pointer; will be set to NULL on success.
+ *
+ * @return `REORDER_OK` on success, or a negative errno value.
+ */
+int reorderDeallocate(BlockAllocator* allocator, ReorderBuffer** reorder);
+#endif
+
+/**
+ * @brief Discards every element and expects sequence `first` next.
+ *
+ * Slots still claimed by a producer are freed when released, see
+ * `bufferClear()`.
+ *
+ * @param reorder Pointer to the reorder buffer. No action is taken if NULL.
+ * @param first   Sequence the consumer expects after the clear.
+ */
+void reorderClear(ReorderBuffer* reorder, uint32_t first);
+
+/**
+ * @brief Returns the sequence the consumer expects next.
+ */
+uint32_t reorderNext(const ReorderBuffer* reorder);
+
+/**
+ * @brief Returns true if the element for the next expected sequence is ready.
+ */
+bool reorderIsReady(const ReorderBuffer* reorder);
+
+/**
+ * @brief Registers the hook used to wake a parked consumer.
+ *
+ * @param reorder Pointer to the reorder buffer.
+ * @param wake    Wake hook, or NULL to disable parking notifications.
+ * @param ctx     Context passed to `wake`.
+ * @return `REORDER_OK` on success, `-EINVAL` if arguments are invalid.
+ */
+int reorderSetWakeHook(ReorderBuffer* reorder, ReorderWakeFn wake, void* ctx);
+
+/**
+ * @brief Claims the slot of sequence `seq` for zero-copy writing.
+ *
+ * The slot is published with `reorderWriteRelease()`.
+ *
+ * @param reorder       Pointer to the reorder buffer.
+ * @param seq           Sequence number of the element.
+ * @param[out] out_addr Address of the claimed slot.
+ * @return Slot index on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid or `seq` was already read
+ * - `-ENOSPC` if `seq` is ahead of the window; retry once the consumer catches up
+ * - `-EBUSY` if the slot is still in use by the previous sequence or by another writer
+ */
+int reorderWriteClaim(ReorderBuffer* reorder, uint32_t seq, void** out_addr);
+
+/**
+ * @brief Publishes a slot claimed by `reorderWriteClaim()`.
+ *
+ * Wakes the consumer if it is parked and the slot holds the sequence it
+ * waits for.
+ *
+ * @param reorder Pointer to the reorder buffer.
+ * @param index   Slot index returned by the claim.
+ * @return `REORDER_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-ESTALE` if the buffer was cleared since the claim; the element is dropped
+ * - `-EPERM` if the slot was not claimed
+ */
+int reorderWriteRelease(ReorderBuffer* reorder, uint16_t index);
+
+/**
+ * @brief Copies the element of sequence `seq` into its slot.
+ *
+ * @param reorder Pointer to the reorder buffer.
+ * @param seq     Sequence number of the element.
+ * @param data    Element to copy, `type_size` bytes.
+ * @return Slot index on success, or a negative errno value as for `reorderWriteClaim()`.
+ */
+int reorderWrite(ReorderBuffer* reorder, uint32_t seq, const void* data);
+
+/**
+ * @brief Claims the element of the next expected sequence for zero-copy reading.
+ *
+ * The next expected sequence advances immediately; the slot is freed with
+ * `reorderReadRelease()`.
+ *
+ * @param reorder       Pointer to the reorder buffer.
+ * @param[out] out_addr Address of the claimed slot.
+ * @param[out] seq      Optional. Receives the sequence number of the element.
+ * @return Slot index on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if another reader holds the read lock
+ * - `-EAGAIN` if the next expected sequence is not ready
+ */
+int reorderReadClaim(ReorderBuffer* reorder, void** out_addr, uint32_t* seq);
+
+/**
+ * @brief Frees a slot claimed by `reorderReadClaim()`.
+ *
+ * @param reorder Pointer to the reorder buffer.
+ * @param index   Slot index returned by the claim.
+ * @return `REORDER_OK` on success, or a negative errno value as for `bufferReadRelease()`.
+ */
+int reorderReadRelease(ReorderBuffer* reorder, uint16_t index);
+
+/**
+ * @brief Removes the element of the next expected sequence.
+ *
+ * @param reorder   Pointer to the reorder buffer.
+ * @param[out] data Receives the element, `type_size` bytes.
+ * @param[out] seq  Optional. Receives the sequence number of the element.
+ * @return Slot index on success, or a negative errno value as for `reorderReadClaim()`.
+ */
+int reorderRead(ReorderBuffer* reorder, void* data, uint32_t* seq);
+
+/**
+ * @brief Removes the ready prefix of the sequence, up to `max_count` elements.
+ *
+ * Elements are copied to `data` in sequence order, starting with the
+ * sequence returned by `reorderNext()` before the call. Reading stops at the
+ * first sequence that is not ready.
+ *
+ * @param reorder   Pointer to the reorder buffer.
+ * @param[out] data Receives up to `max_count` elements.
+ * @param max_count Maximum number of elements to read.
+ * @return Number of elements read, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if another reader holds the read lock
+ */
+int reorderReadBatch(ReorderBuffer* reorder, void* data, uint16_t max_count);
+
+/**
+ * @brief Announce that the consumer is about to wait for the next sequence.
+ *
+ * On success the consumer may block until its wait flag (see
+ * `reorderWaitFlag()`) is cleared, e.g. with `futex(FUTEX_WAIT, 1)`. The
+ * next slot is re-checked after the flag is published, so a completion that
+ * races with the park is never missed.
+ *
+ * @param reorder Pointer to the reorder buffer.
+ * @return `REORDER_OK` if the consumer may sleep, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EAGAIN` if the next sequence is already ready; the wait flag was withdrawn
+ */
+int reorderPark(ReorderBuffer* reorder);
+
+/**
+ * @brief Address of the consumer's wait flag, for use with futex-style waits.
+ *
+ * @param reorder Pointer to the reorder buffer.
+ * @return Pointer to the flag, or NULL if arguments are invalid.
+ */
+ReorderWord_t* reorderWaitFlag(ReorderBuffer* reorder);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,148 @@
+#pragma once
+/**
+ * @file seqlock.h
+ * @brief Seqlock-protected single-value snapshot container.
+ *
+ * A `SeqLock` stores one value of `type_size` bytes that a single writer
+ * updates in place. The value is guarded by a sequence counter which is odd
+ * while a write is in progress:
+ * - The writer bumps the counter to odd, updates the value and bumps it back
+ *   to even.
+ * - Readers sample the counter, copy the value and check that the counter did
+ *   not change. Readers never write shared memory, so read throughput scales
+ *   with the number of cores.
+ *
+ * Suited to small, frequently read configuration or state structs.
+ */
+#include "locking.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SEQLOCK_OK 0 // success
+
+#ifdef USE_ATOMIC
+#include <stdatomic.h>
+typedef atomic_uint_least32_t SeqCount_t;  ///< Sequence counter storage
+#else
+typedef uint32_t SeqCount_t;               ///< Sequence counter storage
+#endif
+
+/**
+ * @brief Creates a statically allocated seqlock instance.
+ *
+ * @param id          The identifier for the seqlock instance.
+ * @param type_size_  The size in bytes of the protected value.
+ *
+ * This macro defines a `SeqLock` and its backing storage using static memory.
+ */
+#define CREATE_SEQLOCK(id, type_size_)                  \
+    uint8_t __##id##_raw[(type_size_)] = {0};           \
+    SeqLock id = {                                      \
+        .type_size = (type_size_),                      \
+        .seq = 0,                                       \
+        .raw = __##id##_raw,                            \
+    }
+
+/**
+ * @struct SeqLock
+ * @brief Single value guarded by a sequence counter.
+ */
+typedef struct {
+    uint16_t type_size; /**< Size of the protected value in bytes. */
+    SeqCount_t seq;     /**< Sequence counter, odd while a write is in progress. */
+    void* raw;          /**< Pointer to the protected value. */
+} SeqLock;
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Allocate a seqlock dynamically using a BlockAllocator.
+ *
+ * @param allocator   Pointer to a valid BlockAllocator instance.
+ * @param type_size   Size in bytes of the protected value.
+ * @return Pointer to the newly allocated seqlock, or NULL on failure.
+ */
+SeqLock* seqLockAllocate(BlockAllocator* allocator, uint16_t type_size);
+
+/**
+ * @brief Deallocate a seqlock allocated via `seqLockAllocate`.
+ *
+ * @param allocator   Pointer to the same BlockAllocator used to allocate it.
+ * @param lock        Address of the pointer to the seqlock.
+ *                    The pointer will be set to NULL on success.
+ * @return `SEQLOCK_OK` on success, or a negative errno value.
+ */
+int seqLockDeallocate(BlockAllocator* allocator, SeqLock** lock);
+#endif
+
+/**
+ * @brief Begin an in-place update of the value.
+ *
+ * @param lock Pointer to the seqlock.
+ * @param[out] out_addr Pointer to store the address of the value.
+ * @return `SEQLOCK_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if another write is in progress
+ */
+int seqLockWriteClaim(SeqLock* lock, void** out_addr);
+
+/**
+ * @brief Finish an update started with `seqLockWriteClaim()`.
+ *
+ * @param lock Pointer to the seqlock.
+ * @return `SEQLOCK_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EPERM` if no write is in progress
+ */
+int seqLockWriteRelease(SeqLock* lock);
+
+/**
+ * @brief Replace the value.
+ *
+ * @param lock Pointer to the seqlock.
+ * @param data Pointer to the new value. Must be `type_size` bytes long.
+ * @return `SEQLOCK_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if another write is in progress
+ */
+int seqLockWrite(SeqLock* lock, const void* data);
+
+/**
+ * @brief Begin a zero-copy read of the value.
+ *
+ * The value may be inspected in place, but anything derived from it must be
+ * discarded unless `seqLockReadRelease()` succeeds.
+ *
+ * @param lock Pointer to the seqlock.
+ * @param[out] out_addr Pointer to store the address of the value.
+ * @param[out] seq Sequence number to pass to `seqLockReadRelease()`.
+ * @return `SEQLOCK_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if a write is in progress
+ */
+int seqLockReadClaim(const SeqLock* lock, const void** out_addr, uint32_t* seq);
+
+/**
+ * @brief Validate a zero-copy read started with `seqLockReadClaim()`.
+ *
+ * @param lock Pointer to the seqlock.
+ * @param seq  Sequence number returned by the claim.
+ * @return `SEQLOCK_OK` if the value was stable for the whole read, or a
+ * negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-ESTALE` if a write overlapped the read
+ */
+int seqLockReadRelease(const SeqLock* lock, uint32_t seq);
+
+/**
+ * @brief Take a consistent snapshot of the value.
+ *
+ * @param lock Pointer to the seqlock.
+ * @param data Destination, must be `type_size` bytes long.
+ * @return `SEQLOCK_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if a write was in progress or overlapped the copy; retry
+ */
+int seqLockRead(const SeqLock* lock, void* data);
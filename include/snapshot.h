@@ -0,0 +1,142 @@
+#pragma once
+/**
+ * @file snapshot.h
+ * @brief Compact binary snapshots of `Buffer`, `Queue` and `Stack` contents.
+ *
+ * A snapshot holds the pending elements of a container so that they can be
+ * reloaded by another process, e.g. across a hot restart. The format is a
+ * fixed `SnapshotHeader` followed by the payload:
+ * - `Buffer`: `count` elements of `type_size` bytes, oldest first.
+ * - `Queue`:  `count` `uint16_t` message lengths, then `count` slots of
+ *             `type_size` (= `slot_len`) bytes, oldest first.
+ * - `Stack`:  `count` elements of `type_size` bytes, bottom first.
+ *
+ * Elements are written as at most two contiguous ranges straight from the
+ * container storage (a ring may wrap once), and restored with bulk reads into
+ * the storage of the target container. All values are in host byte order.
+ *
+ * I/O goes through caller-provided callbacks with `write(2)` / `read(2)`
+ * semantics, so a plain file descriptor, a socket or a memory sink can be
+ * used without this module making system calls itself.
+ */
+#include "buffer.h"
+#include "queue.h"
+#include "stack.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SNAPSHOT_OK 0 // success
+
+#define SNAPSHOT_MAGIC   0x4E534642u  ///< "BFSN" in little-endian byte order
+#define SNAPSHOT_VERSION 1            ///< Current format version
+
+/**
+ * @brief Container type recorded in a snapshot header.
+ */
+typedef enum {
+    SNAPSHOT_BUFFER = 1,  ///< Payload of a `Buffer`
+    SNAPSHOT_QUEUE,       ///< Payload of a `Queue`
+    SNAPSHOT_STACK,       ///< Payload of a `Stack`
+} SnapshotKind;
+
+/**
+ * @brief Fixed header at the start of every snapshot.
+ */
+typedef struct {
+    uint32_t magic;      ///< `SNAPSHOT_MAGIC`
+    uint16_t version;    ///< `SNAPSHOT_VERSION`
+    uint16_t kind;       ///< `SnapshotKind` of the payload
+    uint16_t type_size;  ///< Size of each element (slot) in bytes
+    uint16_t count;      ///< Number of elements in the payload
+} SnapshotHeader;
+
+/**
+ * @brief Writes up to `len` bytes to the snapshot sink.
+ * @param ctx  Context passed along with the callback.
+ * @param data Bytes to write.
+ * @param len  Number of bytes to write.
+ * @return Number of bytes written (may be short), or a negative errno value.
+ */
+typedef int32_t (*SnapshotWriteFn)(void* ctx, const void* data, uint32_t len);
+
+/**
+ * @brief Reads up to `len` bytes from the snapshot source.
+ * @param ctx  Context passed along with the callback.
+ * @param data Destination for the bytes read.
+ * @param len  Number of bytes to read.
+ * @return Number of bytes read (may be short, 0 at the end of the input),
+ *         or a negative errno value.
+ */
+typedef int32_t (*SnapshotReadFn)(void* ctx, void* data, uint32_t len);
+
+/**
+ * @brief Writes the pending elements of a buffer to a snapshot.
+ *
+ * Producers and consumers are held off with `-EBUSY` while the snapshot is
+ * written.
+ *
+ * @param buffer Buffer to snapshot.
+ * @param write  Sink for the snapshot bytes.
+ * @param ctx    Context passed to `write`.
+ * @return Number of elements written, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if a pending element is still claimed; retry
+ * - `-EIO` if `write` made no progress
+ * - any error returned by `write`
+ */
+int bufferSnapshot(Buffer* buffer, SnapshotWriteFn write, void* ctx);
+
+/**
+ * @brief Replaces the contents of an empty buffer with a snapshot.
+ *
+ * @param buffer Buffer to restore into, with the snapshot's `type_size`.
+ * @param read   Source of the snapshot bytes.
+ * @param ctx    Context passed to `read`.
+ * @return Number of elements restored, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid or the snapshot is of another kind or element size
+ * - `-EBUSY` if the buffer is not empty or has claimed slots
+ * - `-ENOSPC` if the snapshot holds more elements than the buffer
+ * - `-EBADMSG` if the snapshot is malformed or truncated; the buffer is left empty
+ * - any error returned by `read`; the buffer is left empty
+ */
+int bufferRestore(Buffer* buffer, SnapshotReadFn read, void* ctx);
+
+/**
+ * @brief Writes the pending messages of a queue to a snapshot.
+ *
+ * @param queue Queue to snapshot.
+ * @param write Sink for the snapshot bytes.
+ * @param ctx   Context passed to `write`.
+ * @return Number of messages written, or a negative errno value as for `bufferSnapshot()`.
+ */
+int queueSnapshot(Queue* queue, SnapshotWriteFn write, void* ctx);
+
+/**
+ * @brief Replaces the contents of an empty queue with a snapshot.
+ *
+ * @param queue Queue to restore into, with the snapshot's `slot_len`.
+ * @param read  Source of the snapshot bytes.
+ * @param ctx   Context passed to `read`.
+ * @return Number of messages restored, or a negative errno value as for `bufferRestore()`.
+ */
+int queueRestore(Queue* queue, SnapshotReadFn read, void* ctx);
+
+/**
+ * @brief Writes the elements of a stack to a snapshot.
+ *
+ * @param stack Stack to snapshot.
+ * @param write Sink for the snapshot bytes.
+ * @param ctx   Context passed to `write`.
+ * @return Number of elements written, or a negative errno value as for `bufferSnapshot()`.
+ */
+int stackSnapshot(Stack* stack, SnapshotWriteFn write, void* ctx);
+
+/**
+ * @brief Replaces the contents of an empty stack with a snapshot.
+ *
+ * @param stack Stack to restore into, with the snapshot's `type_size`.
+ * @param read  Source of the snapshot bytes.
+ * @param ctx   Context passed to `read`.
+ * @return Number of elements restored, or a negative errno value as for `bufferRestore()`.
+ */
+int stackRestore(Stack* stack, SnapshotReadFn read, void* ctx);
@@ -9,12 +9,18 @@
  */
 
 #include "locking.h"
+#include "watermark.h"
+#include "stride.h"
 #ifdef USE_BITMAP_ALLOCATOR
 #include "block_allocator.h"
 #endif
 #include <stdint.h>
 #include <stdbool.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define STACK_OK 0 // success
 
 // Stack lock macros, reuse lock->write as single lock
@@ -34,13 +40,37 @@
     uint8_t __##id##_raw[(count) * (type_size_)] = {0};            \
     CREATE_LOCK(id##_lock, count);                                 \
     Stack id = {                                                   \
-        .raw = __##id##_raw,                                       \
-        .type_size = (type_size_),                                 \
+        .full = false,                                             \
         .size = (count),                                           \
+        .type_size = (type_size_),                                 \
         .top = 0,                                                  \
-        .full = false,                                             \
+        .raw = __##id##_raw,                                       \
         .lock = &id##_lock                                         \
     }
+
+/**
+ * @brief Creates a statically allocated stack with aligned, padded slots.
+ *
+ * @param id         The identifier for the stack instance.
+ * @param count      The number of elements the stack can hold.
+ * @param type_size_ The size in bytes of the data type to be stored.
+ * @param align      Slot alignment in bytes: 8, 16, 32 or 64.
+ *
+ * Like `CREATE_STACK()`, but every slot starts on an `align` byte boundary
+ * and is padded to `SLOT_STRIDE(type_size_, align)` bytes.
+ */
+#define CREATE_STACK_ALIGNED(id, count, type_size_, align)                     \
+    SLOT_ALIGNAS(align) uint8_t __##id##_raw[(count) * SLOT_STRIDE(type_size_, align)] = {0}; \
+    CREATE_LOCK(id##_lock, count);                                             \
+    Stack id = {                                                               \
+        .full = false,                                                         \
+        .size = (count),                                                       \
+        .type_size = (type_size_),                                             \
+        .top = 0,                                                              \
+        .stride = SLOT_STRIDE(type_size_, align),                              \
+        .raw = __##id##_raw,                                                   \
+        .lock = &id##_lock                                                     \
+    }
     
 /**
  * @struct Stack
@@ -54,8 +84,10 @@ typedef struct {
     uint16_t size;      /**< Maximum number of elements. */
     uint16_t type_size; /**< Size of each element in bytes. */
     uint16_t top;       /**< Current top index. */
+    uint16_t stride;    /**< Distance between aligned slots in bytes, 0 if packed at `type_size`. */
     void* raw;          /**< Pointer to backing storage. */
     Lock_t* lock;       /**< Pointer to the lock structure. */
+    Watermark* watermark; /**< Optional fill level notifications, NULL if unused. */
 } Stack;
 
 #ifdef USE_BITMAP_ALLOCATOR
@@ -69,6 +101,17 @@ typedef struct {
  */
 Stack* stackAllocate(BlockAllocator* allocator, uint16_t size, uint16_t type_size);
 
+/**
+ * @brief Allocate a stack with aligned, padded slots using a BlockAllocator.
+ *
+ * @param allocator   Pointer to a valid BlockAllocator instance.
+ * @param size        Maximum number of elements the stack should hold.
+ * @param type_size   Size in bytes of the element type to store.
+ * @param align       Slot alignment in bytes: 8, 16, 32 or 64.
+ * @return Pointer to the newly allocated stack, or NULL on failure.
+ */
+Stack* stackAllocateAligned(BlockAllocator* allocator, uint16_t size, uint16_t type_size, uint16_t align);
+
 /**
  * @brief Deallocate a stack allocated via `stackAllocate`.
  *
@@ -87,6 +130,23 @@ int stackDeallocate(BlockAllocator* allocator, Stack** stack);
  */
 void stackClear(Stack* stack);
 
+/**
+ * @brief Get the distance in bytes between the starts of consecutive slots.
+ *
+ * @param stack   Pointer to the stack.
+ * @return `type_size`, rounded up to the alignment if the stack was created with one.
+ */
+uint16_t stackStride(const Stack* stack);
+
+/**
+ * @brief Attach a watermark to the stack, or detach it if NULL.
+ *
+ * @param stack     Pointer to the stack.
+ * @param watermark Initialized watermark, or NULL.
+ * @return `STACK_OK` on success, or `-EINVAL` if arguments are invalid.
+ */
+int stackSetWatermark(Stack* stack, Watermark* watermark);
+
 /**
  * @brief Push an element onto the stack.
  *
@@ -104,4 +164,8 @@ int stackPush(Stack* stack, const void* data);
  *                Must be `type_size` bytes long.
  * @return stack index, or a negative error code (e.g. if the stack is empty).
  */
-int stackPop(Stack* stack, void* data);
\ No newline at end of file
+int stackPop(Stack* stack, void* data);
+
+#ifdef __cplusplus
+}
+#endif
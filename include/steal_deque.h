@@ -0,0 +1,158 @@
+#pragma once
+/**
+ * @file steal_deque.h
+ * @brief Fixed-capacity Chase-Lev work-stealing deque.
+ *
+ * A `StealDeque` has a single owner and any number of thieves:
+ * - The owner pushes and pops at the bottom. Neither operation needs a
+ *   compare-and-set, except when popping the last remaining element.
+ * - Thieves steal from the top with a single compare-and-set per element.
+ *
+ * Elements are fixed-size records stored contiguously in `raw`, like `Stack`.
+ * The owner sees LIFO order (good cache locality) while thieves take the
+ * oldest work first. The capacity must be a power of two.
+ */
+#include "locking.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+
+#define STEAL_DEQUE_OK 0 // success
+
+#ifdef USE_ATOMIC
+#include <stdatomic.h>
+typedef atomic_uint_least32_t StealIndex_t;  ///< Monotonic top/bottom counter
+#else
+typedef uint32_t StealIndex_t;               ///< Monotonic top/bottom counter
+#endif
+
+/**
+ * @brief Creates a statically allocated work-stealing deque instance.
+ *
+ * @param id          The identifier for the deque instance.
+ * @param count       The number of elements the deque can hold. Must be a power of two.
+ * @param type_size_  The size in bytes of the data type to be stored.
+ *
+ * This macro creates a `StealDeque` variable and backing storage using static memory.
+ */
+#define CREATE_STEAL_DEQUE(id, count, type_size_)                           \
+    _Static_assert((count) > 0 && ((count) & ((count) - 1)) == 0,           \
+                   "steal deque capacity must be a power of two");          \
+    uint8_t __##id##_raw[(count) * (type_size_)] = {0};                     \
+    StealDeque id = {                                                       \
+        .raw = __##id##_raw,                                                \
+        .type_size = (type_size_),                                          \
+        .size = (count),                                                    \
+        .top = 0,                                                           \
+        .bottom = 0,                                                        \
+    }
+
+/**
+ * @struct StealDeque
+ * @brief Single-owner, multi-thief deque of fixed-size elements.
+ *
+ * `top` and `bottom` only ever increase (modulo 2^32); the element at
+ * counter `i` lives in slot `i & (size - 1)`.
+ */
+typedef struct {
+    uint16_t size;        /**< Maximum number of elements, a power of two. */
+    uint16_t type_size;   /**< Size of each element in bytes. */
+    StealIndex_t top;     /**< Next element to steal. */
+    StealIndex_t bottom;  /**< Next free position at the owner's end. */
+    void* raw;            /**< Pointer to backing storage. */
+} StealDeque;
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Allocate a work-stealing deque dynamically using a BlockAllocator.
+ *
+ * @param allocator   Pointer to a valid BlockAllocator instance.
+ * @param size        Maximum number of elements. Must be a power of two.
+ * @param type_size   Size in bytes of the element type to store.
+ * @return Pointer to the newly allocated deque, or NULL on failure.
+ */
+StealDeque* stealDequeAllocate(BlockAllocator* allocator, uint16_t size, uint16_t type_size);
+
+/**
+ * @brief Deallocate a deque allocated via `stealDequeAllocate`.
+ *
+ * @param allocator   Pointer to the same BlockAllocator used to allocate the deque.
+ * @param deque       Address of the pointer to the deque to deallocate.
+ *                    The pointer will be set to NULL on success.
+ * @return `STEAL_DEQUE_OK` on success, or a negative errno value.
+ */
+int stealDequeDeallocate(BlockAllocator* allocator, StealDeque** deque);
+#endif
+
+/**
+ * @brief Clear the contents of the deque without freeing memory.
+ *
+ * Must only be called by the owner while no thief is active.
+ *
+ * @param deque   Pointer to the deque to clear.
+ */
+void stealDequeClear(StealDeque* deque);
+
+/**
+ * @brief Approximate number of elements in the deque.
+ *
+ * Exact when called by the owner with no concurrent thieves.
+ *
+ * @param deque   Pointer to the deque.
+ * @return Number of elements, or 0 if `deque` is NULL.
+ */
+uint16_t stealDequeCount(const StealDeque* deque);
+
+/**
+ * @brief Push an element at the owner's end. Owner only.
+ *
+ * @param deque   Pointer to the deque.
+ * @param data    Pointer to the data to push. Must be `type_size` bytes long.
+ * @return `STEAL_DEQUE_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-ENOSPC` if the deque is full
+ */
+int stealDequePush(StealDeque* deque, const void* data);
+
+/**
+ * @brief Pop the most recently pushed element. Owner only.
+ *
+ * @param deque   Pointer to the deque.
+ * @param data    Destination, must be `type_size` bytes long.
+ * @return `STEAL_DEQUE_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EAGAIN` if the deque is empty, or a thief took the last element
+ */
+int stealDequePop(StealDeque* deque, void* data);
+
+/**
+ * @brief Steal the oldest element. Safe to call from any thread.
+ *
+ * @param deque   Pointer to the deque.
+ * @param data    Destination, must be `type_size` bytes long. Its contents
+ *                are unspecified if the call fails with `-EBUSY`.
+ * @return `STEAL_DEQUE_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EAGAIN` if the deque is empty
+ * - `-EBUSY` if another thief or the owner won the race; retry
+ */
+int stealDequeSteal(StealDeque* deque, void* data);
+
+/**
+ * @brief Steal up to half of the available elements. Safe to call from any thread.
+ *
+ * Elements are taken oldest first and written contiguously to `data`. Each
+ * element is claimed with its own compare-and-set, so the batch stops early
+ * as soon as a race is lost.
+ *
+ * @param deque   Pointer to the deque.
+ * @param data    Destination, must be `max_count * type_size` bytes long.
+ * @param max_count Maximum number of elements to steal.
+ * @return Number of elements stolen (at least 1), or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EAGAIN` if the deque is empty
+ * - `-EBUSY` if the first steal lost a race; retry
+ */
+int stealDequeStealBatch(StealDeque* deque, void* data, uint16_t max_count);
@@ -0,0 +1,32 @@
+#pragma once
+/**
+ * @file stride.h
+ * @brief Slot padding and alignment shared by the slot-based containers.
+ *
+ * By default, slot `i` of a `Buffer`, `Queue` or `Stack` starts at
+ * `i * type_size`, so elements of awkward sizes (e.g. 24 bytes) straddle
+ * cache lines and their addresses have no useful alignment. Containers
+ * created with an alignment of 8, 16, 32 or 64 bytes instead pad every slot
+ * to a multiple of it and place their storage on such a boundary, so every
+ * slot starts aligned: aligned vector loads become possible, and with 64 an
+ * element no larger than a cache line never spans two.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Slot stride of `type_size` byte elements padded to a multiple of `align`. */
+#define SLOT_STRIDE(type_size, align) ((((type_size) + (align) - 1) / (align)) * (align))
+
+/** @brief Aligns a storage declaration to `align` bytes, in C and C++. */
+#ifdef __cplusplus
+#define SLOT_ALIGNAS(align) alignas(align)
+#else
+#define SLOT_ALIGNAS(align) _Alignas(align)
+#endif
+
+/**
+ * @brief Returns true if `align` is a supported slot alignment: 8, 16, 32 or 64.
+ */
+static inline bool slotAlignValid(uint16_t align) {
+    return align == 8 || align == 16 || align == 32 || align == 64;
+}
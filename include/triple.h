@@ -0,0 +1,133 @@
+#pragma once
+/**
+ * @file triple.h
+ * @brief Triple-buffer mailbox holding the latest value of a fixed-size type.
+ *
+ * A `TripleBuffer` keeps three slots of `type_size` bytes in one contiguous raw
+ * block. The writer owns the back slot, the reader owns the front slot and the
+ * middle slot is exchanged between them:
+ * - The writer never blocks: it fills the back slot and publishes it by
+ *   swapping it with the middle slot in a single atomic exchange.
+ * - The reader always obtains the most recently published value by swapping
+ *   the middle slot into the front, again with a single atomic exchange.
+ *
+ * Stale values are overwritten rather than queued, so there is no backlog to
+ * drain. Intended for one writer and one reader.
+ */
+#include "locking.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TRIPLE_OK 0 // success
+
+#define TRIPLE_INDEX_MASK 0x03  ///< Slot index bits of the middle state
+#define TRIPLE_FRESH 0x04       ///< Set when the middle slot holds an unread value
+
+/**
+ * @brief Creates a statically allocated triple buffer instance.
+ *
+ * @param id          The identifier for the triple buffer instance.
+ * @param type_size_  The size in bytes of the stored value.
+ *
+ * This macro defines a `TripleBuffer` and its backing storage using static memory.
+ */
+#define CREATE_TRIPLE_BUFFER(id, type_size_)                \
+    uint8_t __##id##_raw[3 * (type_size_)] = {0};           \
+    TripleBuffer id = {                                     \
+        .type_size = (type_size_),                          \
+        .front = 0,                                         \
+        .middle = 1,                                        \
+        .back = 2,                                          \
+        .raw = __##id##_raw,                                \
+    }
+
+/**
+ * @struct TripleBuffer
+ * @brief Latest-value mailbox built from three fixed-size slots.
+ */
+typedef struct {
+    uint16_t type_size;   /**< Size of the stored value in bytes. */
+    uint8_t front;        /**< Slot index owned by the reader. */
+    uint8_t back;         /**< Slot index owned by the writer. */
+    LockState_t middle;   /**< Shared slot index, or'd with `TRIPLE_FRESH`. */
+    void* raw;            /**< Pointer to backing storage (`3 * type_size` bytes). */
+} TripleBuffer;
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Allocate a triple buffer dynamically using a BlockAllocator.
+ *
+ * @param allocator   Pointer to a valid BlockAllocator instance.
+ * @param type_size   Size in bytes of the stored value.
+ * @return Pointer to the newly allocated triple buffer, or NULL on failure.
+ */
+TripleBuffer* tripleBufferAllocate(BlockAllocator* allocator, uint16_t type_size);
+
+/**
+ * @brief Deallocate a triple buffer allocated via `tripleBufferAllocate`.
+ *
+ * @param allocator   Pointer to the same BlockAllocator used to allocate it.
+ * @param triple      Address of the pointer to the triple buffer.
+ *                    The pointer will be set to NULL on success.
+ * @return `TRIPLE_OK` on success, or a negative errno value.
+ */
+int tripleBufferDeallocate(BlockAllocator* allocator, TripleBuffer** triple);
+#endif
+
+/**
+ * @brief Claim the writer's slot without copying data.
+ *
+ * The slot may be filled in place (e.g. by DMA) and is published by
+ * `tripleBufferWriteRelease()`. Never blocks.
+ *
+ * @param triple Pointer to the triple buffer.
+ * @param[out] out_addr Pointer to store the address of the writer's slot.
+ * @return `TRIPLE_OK` on success, `-EINVAL` if arguments are invalid.
+ */
+int tripleBufferWriteClaim(TripleBuffer* triple, void** out_addr);
+
+/**
+ * @brief Publish the writer's slot as the latest value.
+ *
+ * @param triple Pointer to the triple buffer.
+ * @return `TRIPLE_OK` on success, `-EINVAL` if arguments are invalid.
+ */
+int tripleBufferWriteRelease(TripleBuffer* triple);
+
+/**
+ * @brief Copy a value into the writer's slot and publish it.
+ *
+ * @param triple Pointer to the triple buffer.
+ * @param data   Pointer to the value. Must be `type_size` bytes long.
+ * @return `TRIPLE_OK` on success, `-EINVAL` if arguments are invalid.
+ */
+int tripleBufferWrite(TripleBuffer* triple, const void* data);
+
+/**
+ * @brief Claim the latest published value without copying data.
+ *
+ * If a value was published since the last claim, it is swapped into the
+ * reader's slot. The reader's slot stays valid until the next claim.
+ *
+ * @param triple Pointer to the triple buffer.
+ * @param[out] out_addr Pointer to store the address of the reader's slot.
+ * @return `TRIPLE_OK` if a new value was obtained, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EAGAIN` if nothing was published since the last claim; `*out_addr`
+ *   still points to the previously obtained value
+ */
+int tripleBufferReadClaim(TripleBuffer* triple, const void** out_addr);
+
+/**
+ * @brief Copy out the latest published value.
+ *
+ * @param triple Pointer to the triple buffer.
+ * @param data   Destination, must be `type_size` bytes long.
+ * @return `TRIPLE_OK` if a new value was copied, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EAGAIN` if nothing was published since the last read; `data` is untouched
+ */
+int tripleBufferRead(TripleBuffer* triple, void* data);
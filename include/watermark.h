@@ -0,0 +1,109 @@
+#pragma once
+/**
+ * @file watermark.h
+ * @brief High/low watermark notifications for container fill levels.
+ *
+ * A `Watermark` attached to a `Buffer`, `Queue` or `Stack` reports when the
+ * number of stored elements crosses a threshold, so producers can be slowed
+ * down before the container is full:
+ * - `WATERMARK_HIGH` fires once when the count rises to `high`.
+ * - `WATERMARK_LOW` fires once when the count then falls to `low`.
+ *
+ * The gap between `high` and `low` provides hysteresis: after a high event,
+ * no further event fires until the low watermark is reached, and vice versa.
+ *
+ * The count is checked inside the write and read paths against a plain load
+ * of the watermark state, which lives outside the container. The state is
+ * only written when a watermark is crossed. The callback runs on the thread
+ * that crossed the watermark, after the container lock has been released; it
+ * should be short, e.g. signal an eventfd or set a flag.
+ *
+ * Crossings are delivered one at a time under a small delivery lock of the
+ * watermark, so high and low events always alternate, even when threads on
+ * both sides cross at once. A callback must therefore not add or remove
+ * elements of the container it watches.
+ */
+#include "locking.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WATERMARK_OK 0 // success
+
+/**
+ * @brief Watermark crossing reported to a `WatermarkFn`.
+ */
+typedef enum {
+    WATERMARK_HIGH = 1,  ///< The count rose to the high watermark
+    WATERMARK_LOW,       ///< The count fell to the low watermark
+} WatermarkEvent;
+
+/**
+ * @brief Called once per watermark crossing.
+ * @param ctx   Context registered with the watermark.
+ * @param event The watermark that was crossed.
+ * @param count Number of elements at the time of the crossing.
+ */
+typedef void (*WatermarkFn)(void* ctx, WatermarkEvent event, uint16_t count);
+
+/**
+ * @brief Watermark thresholds and state, shared by reference with a container.
+ */
+typedef struct {
+    uint16_t high;          ///< Count at which `WATERMARK_HIGH` fires
+    uint16_t low;           ///< Count at which `WATERMARK_LOW` fires, below `high`
+    WatermarkFn fn;         ///< Callback for both events
+    void* ctx;              ///< Context passed to `fn`
+    LockState_t raised;     ///< Non-zero between a high and the following low event
+    LockState_t delivering; ///< Non-zero while an event is being delivered
+} Watermark;
+
+/**
+ * @brief Initializes a watermark.
+ *
+ * @param watermark Watermark to initialize.
+ * @param high      Count at which `WATERMARK_HIGH` fires.
+ * @param low       Count at which `WATERMARK_LOW` fires; must be below `high`.
+ * @param fn        Callback for both events.
+ * @param ctx       Context passed to `fn`.
+ * @return `WATERMARK_OK` on success, or `-EINVAL` if arguments are invalid.
+ */
+int watermarkInit(Watermark* watermark, uint16_t high, uint16_t low, WatermarkFn fn, void* ctx);
+
+/**
+ * @brief [internal] Delivers `event` unless another thread delivered it first.
+ *
+ * @param watermark Watermark of the container.
+ * @param event     The watermark that was crossed.
+ * @param count     Number of elements at the time of the crossing.
+ */
+void watermarkDeliver(Watermark* watermark, WatermarkEvent event, uint16_t count);
+
+/**
+ * @brief [internal] Reports a count reached by adding elements.
+ *
+ * @param watermark Watermark of the container, or NULL.
+ * @param count     Number of elements after the addition.
+ */
+static inline void watermarkRise(Watermark* watermark, uint16_t count) {
+    if (!watermark || count < watermark->high || GET_LOCK_VAL(&watermark->raised)) return;
+    watermarkDeliver(watermark, WATERMARK_HIGH, count);
+}
+
+/**
+ * @brief [internal] Reports a count reached by removing elements.
+ *
+ * @param watermark Watermark of the container, or NULL.
+ * @param count     Number of elements after the removal.
+ */
+static inline void watermarkFall(Watermark* watermark, uint16_t count) {
+    if (!watermark || count > watermark->low || !GET_LOCK_VAL(&watermark->raised)) return;
+    watermarkDeliver(watermark, WATERMARK_LOW, count);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,202 @@
+#pragma once
+/**
+ * @file window.h
+ * @brief Sliding-window sum, mean, min and max over the last N numeric samples.
+ *
+ * A `Window` keeps the last `size` samples of one numeric type in a ring and
+ * maintains their aggregates as samples arrive, so reading them never
+ * rescans the ring:
+ * - The sum is updated by adding the new sample and subtracting the evicted
+ *   one. Integer sums are exact. Floating-point sums are recomputed from the
+ *   samples once per `size` pushes to bound rounding drift, so a push costs
+ *   O(1) amortized.
+ * - Min and max are kept in monotonic deques of slot indices: the front of
+ *   each deque is the current extreme, and every sample enters and leaves
+ *   each deque at most once.
+ * - `windowStats()` reads all aggregates in O(1).
+ * - `windowReset()` loads a whole window at once and recomputes the sum with
+ *   a bulk kernel over the contiguous samples instead of per-sample updates.
+ *
+ * Integer samples are summed in 64 bits, floating-point samples in `double`.
+ * All operations take the window's lock and fail with `-EBUSY` if it is
+ * contended, like `Heap`.
+ */
+#include "locking.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WINDOW_OK 0 // success
+
+// Window lock macros, reuse lock->write as single lock
+#define TAKE_WINDOW_LOCK(lock) TAKE_WRITE_LOCK(lock)
+#define CLEAR_WINDOW_LOCK(lock) CLEAR_WRITE_LOCK(lock)
+
+/**
+ * @brief Numeric type of the samples of a window.
+ */
+typedef enum {
+    WINDOW_I32 = 0,     ///< `int32_t` samples
+    WINDOW_I64,         ///< `int64_t` samples
+    WINDOW_F32,         ///< `float` samples
+    WINDOW_F64,         ///< `double` samples
+} WindowType;
+
+/** @brief Size in bytes of one sample of type `type`. */
+#define WINDOW_TYPE_SIZE(type) (((type) == WINDOW_I32 || (type) == WINDOW_F32) ? 4 : 8)
+
+/**
+ * @brief Aggregate value: `i` for integer windows, `f` for floating-point windows.
+ */
+typedef union {
+    int64_t i;
+    double f;
+} WindowValue;
+
+/**
+ * @brief Aggregates of the samples currently in a window.
+ */
+typedef struct {
+    uint16_t count;     ///< Number of samples in the window
+    WindowValue sum;    ///< Sum of the samples
+    WindowValue min;    ///< Smallest sample
+    WindowValue max;    ///< Largest sample
+    double mean;        ///< `sum / count`
+} WindowStats;
+
+/**
+ * @brief Monotonic deque of slot indices, oldest first.
+ */
+typedef struct {
+    uint16_t* slots;    ///< Ring of `size` slot indices
+    uint16_t first;     ///< Position of the oldest entry in `slots`
+    uint16_t len;       ///< Number of entries
+} WindowDeque;
+
+/**
+ * @brief Creates a statically allocated window instance.
+ *
+ * @param id     The identifier for the window instance.
+ * @param count  Number of samples in a full window.
+ * @param type_  `WindowType` of the samples.
+ *
+ * This macro defines the sample ring and both deques using static memory.
+ */
+#define CREATE_WINDOW(id, count, type_)                                             \
+    uint64_t __##id##_raw[((count) * WINDOW_TYPE_SIZE(type_) + 7) / 8];             \
+    uint16_t __##id##_min[(count)];                                                 \
+    uint16_t __##id##_max[(count)];                                                 \
+    CREATE_LOCK(id##_lock, 1);                                                      \
+    Window id = {                                                                   \
+        .raw = __##id##_raw,                                                        \
+        .min = { .slots = __##id##_min },                                           \
+        .max = { .slots = __##id##_max },                                           \
+        .size = (count),                                                            \
+        .type = (type_),                                                            \
+        .lock = &id##_lock,                                                         \
+    };                                                                              \
+    windowClear(&id)
+
+/**
+ * @brief Ring of the last `size` samples with incrementally maintained aggregates.
+ */
+typedef struct {
+    void* raw;              ///< Sample ring, `size` samples of `type`
+    WindowDeque min;        ///< Slots of increasing samples; the front is the minimum
+    WindowDeque max;        ///< Slots of decreasing samples; the front is the maximum
+    WindowValue sum;        ///< Running sum of the samples
+    uint16_t size;          ///< Number of samples in a full window
+    uint16_t count;         ///< Number of samples in the window
+    uint16_t head;          ///< Slot of the next sample
+    uint16_t since_sum;     ///< Pushes since the floating-point sum was recomputed
+    WindowType type;        ///< Type of the samples
+    Lock_t* lock;           ///< Pointer to the lock structure
+} Window;
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Allocates and initializes a new window.
+ *
+ * @param allocator The BlockAllocator used to obtain memory for the window.
+ * @param size      Number of samples in a full window.
+ * @param type      Type of the samples.
+ *
+ * @return Pointer to the new Window, or NULL on failure.
+ */
+Window* windowAllocate(BlockAllocator* allocator, uint16_t size, WindowType type);
+
+/**
+ * @brief Deallocates a window and its storage.
+ *
+ * @param allocator The BlockAllocator used for the original allocation.
+ * @param window    Pointer to the Window pointer; will be set to NULL on success.
+ *
+ * @return `WINDOW_OK` on success, or a negative errno value.
+ */
+int windowDeallocate(BlockAllocator* allocator, Window** window);
+#endif
+
+/**
+ * @brief Discards every sample.
+ *
+ * @param window Pointer to the window. No action is taken if NULL.
+ */
+void windowClear(Window* window);
+
+/**
+ * @brief Appends a sample, evicting the oldest one if the window is full.
+ *
+ * @param window Pointer to the window.
+ * @param sample Sample of the window's type.
+ * @return `WINDOW_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if the window is locked by another thread
+ */
+int windowPush(Window* window, const void* sample);
+
+/**
+ * @brief Replaces the contents of the window with `count` samples.
+ *
+ * Only the newest `size` samples are kept if `count` exceeds `size`. The sum
+ * is computed in one pass over the stored samples.
+ *
+ * @param window  Pointer to the window.
+ * @param samples Array of `count` samples of the window's type, oldest first.
+ * @param count   Number of samples.
+ * @return `WINDOW_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if the window is locked by another thread
+ */
+int windowReset(Window* window, const void* samples, uint16_t count);
+
+/**
+ * @brief Reads the aggregates of the samples in the window.
+ *
+ * @param window     Pointer to the window.
+ * @param[out] stats Receives the aggregates.
+ * @return `WINDOW_OK` on success, or a negative errno value if:
+ * - `-EINVAL` if arguments are invalid
+ * - `-EBUSY` if the window is locked by another thread
+ * - `-EAGAIN` if the window holds no samples
+ */
+int windowStats(Window* window, WindowStats* stats);
+
+/**
+ * @brief Returns true if the window holds no samples.
+ */
+bool windowIsEmpty(const Window* window);
+
+/**
+ * @brief Returns true if the window holds `size` samples.
+ */
+bool windowIsFull(const Window* window);
+
+#ifdef __cplusplus
+}
+#endif
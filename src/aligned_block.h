@@ -0,0 +1,36 @@
+#pragma once
+/**
+ * @file aligned_block.h
+ * @brief [internal] Over-aligned slot storage from a `BlockAllocator`.
+ *
+ * The allocator makes no alignment promise beyond its block size, so an
+ * aligned allocation asks for `align` extra bytes and returns the first
+ * aligned address after the block start. The distance back to the block
+ * start (1 to `align` bytes) is stored in the byte just before the returned
+ * address, so the block can be freed without keeping a second pointer.
+ */
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Allocates `size` bytes aligned to `align`, a power of two of at most 128.
+ */
+static inline void* alignedBlockAllocate(BlockAllocator* allocator, uint32_t size, uint16_t align) {
+    uint8_t* block = (uint8_t*)blockAllocate(allocator, size + align);
+    if (!block) return NULL;
+    uint8_t shift = (uint8_t)(align - ((uintptr_t)block & (align - 1)));
+    block[shift - 1] = shift;
+    return block + shift;
+}
+
+/**
+ * @brief Frees storage from `alignedBlockAllocate()`, or from `blockAllocate()` if not `aligned`.
+ */
+static inline int alignedBlockDeallocate(BlockAllocator* allocator, void* ptr, bool aligned) {
+    if (!aligned) return blockDeallocate(allocator, ptr);
+    uint8_t* start = (uint8_t*)ptr;
+    return blockDeallocate(allocator, start - start[-1]);
+}
+#endif
@@ -1,72 +1,241 @@
 #include "buffer.h"
 #include "locking.h"
+#include "copy.h"
+#include "slot.h"
+#include "scan.h"
 #ifdef USE_BITMAP_ALLOCATOR
 #include "block_allocator.h"
+#include "aligned_block.h"
 #endif
 #include <stdint.h>
 #include <stdbool.h>
 #include <errno.h>
 
+// Longest wait, in spin iterations, for a contended destination in `bufferTransferWith()`
+#define TRANSFER_BACKOFF_MAX 1024
+
 /* -- Private Functions --------------------------------------------------- */
 
 /**
- * @brief Copies `size` bytes from `src` to `dest`.
+ * @brief Undoes a `bufferReadClaim()` of slot `index`.
  *
- * @param dest Destination buffer.
- * @param src Source buffer.
- * @param size Number of bytes to copy.
+ * Only possible while `index` is still the most recently claimed slot, i.e.
+ * no other reader has claimed a later one in the meantime.
  *
- * @note
- * This function provides a minimal inline implementation of `memcpy` to avoid
- * relying on a standard library.
+ * @return `BUFFER_OK` if the slot is `BUFFER_READY` again at the tail,
+ *         `-ESTALE` if the buffer was cleared since the claim (the slot is
+ *         freed), or `-EBUSY` if a later slot has been claimed.
  */
-static inline void memcpy(void *dest, const void *src, uint16_t size) {
-    for (uint16_t i = 0; i < size; ++i) {
-        ((uint8_t*)dest)[i] = ((uint8_t*)src)[i];
+static int readUnclaim(Buffer* buffer, uint16_t index) {
+    while (!TAKE_READ_LOCK(buffer->lock));
+    // the epoch cannot advance while the read lock is held
+    uint8_t epoch = GET_LOCK_VAL(&buffer->epoch);
+    uint8_t reading = slotTag(epoch, BUFFER_READING);
+    uint8_t expected = reading;
+    int res = -EBUSY;
+    if (!EXPECT_SLOT_STATE(buffer->lock, index, &expected, reading)) {
+        res = -ESTALE;
+    } else if ((uint16_t)((index + 1) % buffer->size) == buffer->tail) {
+        SET_SLOT_STATE(buffer->lock, index, slotTag(epoch, BUFFER_READY));
+        buffer->tail = index;
+        // the slot was ready before the claim, so head == tail means full
+        if (buffer->head == buffer->tail) {
+            buffer->full = true;
+        }
+        res = BUFFER_OK;
     }
+    CLEAR_READ_LOCK(buffer->lock);
+    if (res == -ESTALE) return slotRelease(buffer, index, BUFFER_READING, BUFFER_FREE);
+    return res;
 }
 
-/* -- Public Functions ----------------------------------------------------- */
+/**
+ * @brief Moves every slot that is not free to `SLOT_EPOCH_RETIRED`, keeping its state.
+ *
+ * Called by `bufferClear()` before the epoch wraps, so that a slot claimed
+ * many clears ago can never match the new epoch. A holder releasing the slot
+ * at the same time either frees it first, leaving it alone, or finds it
+ * retired and frees it as stale.
+ */
+static void retireSlots(Buffer* buffer) {
+    for (uint16_t i = 0; i < buffer->size; i++) {
+        uint8_t state = GET_SLOT_STATE(buffer->lock, i);
+        while (slotKind(state) != BUFFER_FREE &&
+               !EXPECT_SLOT_STATE(buffer->lock, i, &state, slotTag(SLOT_EPOCH_RETIRED, slotKind(state))));
+    }
+}
 
-#ifdef USE_BITMAP_ALLOCATOR
 /**
- * @details
- * Allocates and initializes a circular buffer using the provided BlockAllocator.
- * Two allocations are performed:
- * - A `Buffer` structure to hold metadata
- * - A raw data array sized to `size * type_size`
+ * @brief Retries a `bufferWriteClaim()` that failed with `res` while it is contended.
  *
- * If allocation of the raw buffer fails, the previously allocated Buffer
- * structure is automatically deallocated.
- * 
- * @note
- * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ * Waits twice as long before each attempt and gives up once the wait
+ * reaches `TRANSFER_BACKOFF_MAX` iterations. Other errors are returned at once.
  */
-Buffer* bufferAllocate(BlockAllocator* allocator, uint16_t size, uint16_t type_size) {
-    if (!allocator) return NULL;
-    if (size == 0 || type_size == 0) return NULL;
+static int writeClaimBackoff(Buffer* buffer, void** out_addr, int res) {
+    for (uint16_t spin = 1; res == -EBUSY && spin <= TRANSFER_BACKOFF_MAX; spin <<= 1) {
+        for (volatile uint16_t i = 0; i < spin; i++);
+        res = bufferWriteClaim(buffer, out_addr);
+    }
+    return res;
+}
+
+/**
+ * @brief Puts back a claimed element that `readUnclaim()` could not return to its place.
+ *
+ * The element is written again at the head of `buffer`, so it is kept but
+ * moves behind the elements written since, and its old slot is freed. A
+ * write contended by producers is retried, as `redeliver()` in lease.c
+ * does, unless the head has reached the element's own slot: that slot stays
+ * busy until it is freed below, so `buffer` has no room left.
+ *
+ * @return `BUFFER_OK`, or the error of the write if `buffer` had no room
+ *         and the element was dropped.
+ */
+static int readRequeue(Buffer* buffer, uint16_t index, const void* element) {
+    int res;
+    while ((res = bufferWrite(buffer, element)) == -EBUSY && buffer->head != index);
+    (void)bufferReadRelease(buffer, index);
+    if (res < BUFFER_OK) {
+        (void)INCREMENT_LOCK_VAL(&buffer->dropped);
+        return res;
+    }
+    return BUFFER_OK;
+}
+
+/**
+ * @brief Scans the ready region for elements whose key field equals `key`.
+ *
+ * The region between tail and head is searched as at most two contiguous
+ * runs of slots. Slots between tail and head may still be claimed by a
+ * writer, so a match only counts if its slot is ready. When counting, each
+ * run is counted in one pass of `scanCount()`, and the matches in slots that
+ * are not ready, which are rare, are then taken off again.
+ *
+ * @return The slot index of the first ready match if `first_only`, otherwise
+ *         the number of ready matches; `-ENOENT` if `first_only` and nothing
+ *         matches, or a negative errno value as for `bufferFind()`.
+ */
+static int scanReady(Buffer* buffer, uint16_t offset, uint16_t width, uint64_t key, bool first_only) {
+    if (!buffer) return -EINVAL;
+    if (width != 1 && width != 2 && width != 4 && width != 8) return -EINVAL;
+    if ((uint32_t)offset + width > buffer->type_size) return -EINVAL;
+    if (width < 8) key &= (1ull << (8 * width)) - 1;
+    if (!TAKE_READ_LOCK(buffer->lock)) return -EBUSY;
+    // the epoch cannot advance while the read lock is held
+    uint8_t ready = slotTag(GET_LOCK_VAL(&buffer->epoch), BUFFER_READY);
+    uint16_t left = bufferCount(buffer);
+    uint16_t pos = buffer->tail;
+    int found = 0;
+    while (left > 0) {
+        uint16_t run = (uint16_t)(buffer->size - pos);
+        if (run > left) run = left;
+        const uint8_t* keys = slotAddr(buffer, pos) + offset;
+        if (first_only) {
+            for (uint16_t i = 0; i < run;) {
+                int hit = scanFind(keys + (uint32_t)i * slotStride(buffer), slotStride(buffer),
+                                   (uint16_t)(run - i), width, key);
+                if (hit < 0) break;
+                uint16_t index = (uint16_t)(pos + i + hit);
+                uint8_t expected = ready;
+                if (EXPECT_SLOT_STATE(buffer->lock, index, &expected, ready)) {
+                    CLEAR_READ_LOCK(buffer->lock);
+                    return index;
+                }
+                i = (uint16_t)(i + hit + 1);
+            }
+        } else {
+            found += scanCount(keys, slotStride(buffer), run, width, key);
+#ifdef USE_ATOMIC
+            for (uint16_t i = 0; i < run; i++) {
+                if (GET_SLOT_STATE(buffer->lock, pos + i) == ready) continue;
+                if (scanFind(keys + (uint32_t)i * slotStride(buffer), slotStride(buffer), 1, width, key) == 0) found--;
+            }
+#endif
+        }
+        left = (uint16_t)(left - run);
+        pos = (uint16_t)((pos + run) % buffer->size);
+    }
+    CLEAR_READ_LOCK(buffer->lock);
+    return first_only ? -ENOENT : found;
+}
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Allocates a buffer whose slots are aligned to `align` bytes, or packed if 0.
+ */
+static Buffer* allocateBuffer(BlockAllocator* allocator, uint16_t size, uint16_t type_size, uint16_t align) {
+    uint16_t stride = align ? (uint16_t)SLOT_STRIDE(type_size, align) : 0;
     Buffer* buf = (Buffer*)blockAllocate(allocator, sizeof(Buffer));
     if (!buf) {
         return NULL; // Allocation failed
     }
-    buf->raw = blockAllocate(allocator, size * type_size);
+    if (stride) {
+        buf->raw = alignedBlockAllocate(allocator, (uint32_t)size * stride, align);
+    } else {
+        buf->raw = blockAllocate(allocator, size * type_size);
+    }
     if (!(buf->raw)) {
         blockDeallocate(allocator, buf);
         return NULL; // Allocation failed
     }
     buf->lock = lockAllocate(allocator, size);
     if (!(buf->lock)) {
-        blockDeallocate(allocator, buf->raw);
+        alignedBlockDeallocate(allocator, buf->raw, stride != 0);
         blockDeallocate(allocator, buf);
         return NULL; // Allocation failed
     }
     buf->size = size;
     buf->type_size = type_size;
+    buf->stride = stride;
     buf->head = 0;
     buf->tail = 0;
     buf->full = false;
+    buf->epoch = 0;
+    buf->watermark = NULL;
+    buf->checksum = NULL;
+    buf->prefetch = 0;
+    buf->stream_min = 0;
+    SET_LOCK_VAL(&buf->dropped, 0);
     return buf;
 }
+#endif
+
+/* -- Public Functions ----------------------------------------------------- */
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @details
+ * Allocates and initializes a circular buffer using the provided BlockAllocator.
+ * Two allocations are performed:
+ * - A `Buffer` structure to hold metadata
+ * - A raw data array sized to `size * type_size`
+ *
+ * If allocation of the raw buffer fails, the previously allocated Buffer
+ * structure is automatically deallocated.
+ * 
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+Buffer* bufferAllocate(BlockAllocator* allocator, uint16_t size, uint16_t type_size) {
+    if (!allocator) return NULL;
+    if (size == 0 || type_size == 0) return NULL;
+    return allocateBuffer(allocator, size, type_size, 0);
+}
+
+/**
+ * @details
+ * As `bufferAllocate()`, with the raw data array sized to `size * stride`
+ * and placed on an `align` byte boundary.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+Buffer* bufferAllocateAligned(BlockAllocator* allocator, uint16_t size, uint16_t type_size, uint16_t align) {
+    if (!allocator) return NULL;
+    if (size == 0 || type_size == 0 || !slotAlignValid(align)) return NULL;
+    if (SLOT_STRIDE((uint32_t)type_size, align) > UINT16_MAX) return NULL;
+    return allocateBuffer(allocator, size, type_size, align);
+}
 
 /**
  * @details
@@ -80,7 +249,7 @@ int bufferDeallocate(BlockAllocator* allocator, Buffer** buffer) {
     if (!allocator || !buffer || !(*buffer)) return -EINVAL;
     int res1, res2, res3;
     res1 = lockDeallocate(allocator, (&(*buffer)->lock));
-    res2 = blockDeallocate(allocator, (*buffer)->raw);
+    res2 = alignedBlockDeallocate(allocator, (*buffer)->raw, (*buffer)->stride != 0);
     res3 = blockDeallocate(allocator, *buffer);
     if (res1 != LOCK_OK) return res1;
     if (res2 != BLOCK_ALLOCATOR_OK) return res2;
@@ -92,15 +261,76 @@ int bufferDeallocate(BlockAllocator* allocator, Buffer** buffer) {
 
 /**
  * @details
- * Resets the buffer state by setting head and tail indices to 0 and clearing
- * the `full` flag. The raw memory contents are not modified.
+ * Takes both locks, resets the head and tail indices and the `full` flag and
+ * advances the epoch; the slot states and raw contents are not touched.
+ *
+ * Slots left `BUFFER_READY` by the old contents are reclaimed lazily by the
+ * next writer to reach them. Slots still claimed by a writer or reader keep
+ * blocking their index until released, at which point the epoch mismatch
+ * frees them.
+ *
+ * The epoch only has `SLOT_EPOCH_RETIRED` values, so every time it wraps
+ * the slots are walked once and every claim still held is retired. Without
+ * this, a holder that stalls across that many clears would see its old epoch
+ * come around again and publish or keep a slot of discarded contents.
+ *
+ * An attached watermark sees the buffer drop to empty once the locks are
+ * released, so a raised HIGH is answered by a LOW.
  */
 void bufferClear(Buffer* buffer) {
-    if (buffer) {
-        buffer->head = 0;
-        buffer->tail = 0;
-        buffer->full = false;
-    }
+    if (!buffer) return;
+    while (!TAKE_WRITE_LOCK(buffer->lock));
+    while (!TAKE_READ_LOCK(buffer->lock));
+    buffer->head = 0;
+    buffer->tail = 0;
+    buffer->full = false;
+    uint8_t epoch = (uint8_t)((GET_LOCK_VAL(&buffer->epoch) + 1) % SLOT_EPOCH_RETIRED);
+    if (epoch == 0) retireSlots(buffer);
+    PUBLISH_LOCK_VAL(&buffer->epoch, epoch);
+    CLEAR_READ_LOCK(buffer->lock);
+    CLEAR_WRITE_LOCK(buffer->lock);
+    watermarkFall(buffer->watermark, 0);
+}
+
+int bufferSetWatermark(Buffer* buffer, Watermark* watermark) {
+    if (!buffer) return -EINVAL;
+    buffer->watermark = watermark;
+    return BUFFER_OK;
+}
+
+/**
+ * @note
+ * Without `USE_PREFETCH` the claims carry no prefetch code, and any
+ * distance but 0 is refused.
+ */
+int bufferSetPrefetch(Buffer* buffer, uint16_t distance) {
+    if (!buffer || distance >= buffer->size) return -EINVAL;
+#ifndef USE_PREFETCH
+    if (distance > 0) return -ENOTSUP;
+#endif
+    buffer->prefetch = distance;
+    return BUFFER_OK;
+}
+
+int bufferSetStreaming(Buffer* buffer, uint16_t threshold) {
+    if (!buffer) return -EINVAL;
+    buffer->stream_min = threshold;
+    return BUFFER_OK;
+}
+
+int bufferSetChecksums(Buffer* buffer, uint32_t* checksum) {
+    if (!buffer) return -EINVAL;
+    buffer->checksum = checksum;
+    return BUFFER_OK;
+}
+
+int bufferVerify(const Buffer* buffer, uint16_t index) {
+    if (!buffer || index >= buffer->size) return -EINVAL;
+    return slotVerify(buffer, index);
+}
+
+uint16_t bufferStride(const Buffer* buffer) {
+    return slotStride(buffer);
 }
 
 bool bufferIsEmpty(const Buffer* buffer) {
@@ -130,37 +360,44 @@ int bufferWriteClaim(Buffer* buffer, void** out_addr) {
         CLEAR_WRITE_LOCK(buffer->lock);
         return -ENOSPC;
     }
-    // check if the current slot has already been claimed
+    // check if the current slot has already been claimed. The slot at the
+    // head of a buffer that is not full can only be ready if it was discarded
+    // by a clear, so it is as good as free
     uint16_t cur_head = buffer->head;
-    uint8_t expected = BUFFER_FREE;
-    if (!EXPECT_SLOT_STATE(buffer->lock, cur_head, &expected, BUFFER_CLAIMED)) {
+    uint8_t expected = GET_SLOT_STATE(buffer->lock, cur_head);
+    BufferState kind = slotKind(expected);
+    uint8_t claimed = slotTag(GET_LOCK_VAL(&buffer->epoch), BUFFER_CLAIMED);
+    if ((kind != BUFFER_FREE && kind != BUFFER_READY) ||
+        !EXPECT_SLOT_STATE(buffer->lock, cur_head, &expected, claimed)) {
         CLEAR_WRITE_LOCK(buffer->lock);
         return -EBUSY;
     }
     // With all checks down, we can claim the slot
-    *out_addr = (uint8_t*)buffer->raw + (cur_head * buffer->type_size);
+    *out_addr = slotAddr(buffer, cur_head);
     // advance the head and mark if the buffer is now full
     buffer->head = (uint16_t)((cur_head + 1) % buffer->size);
     if (buffer->head == buffer->tail) {
         buffer->full = true;
     }
+    uint16_t count = buffer->watermark ? bufferCount(buffer) : 0;
     // release the write lock so concurrent writers can claim a slot
     CLEAR_WRITE_LOCK(buffer->lock);
+    watermarkRise(buffer->watermark, count);
+    slotPrefetch(buffer, cur_head, true);
     return cur_head;
 }
 
 /** 
  * @details
- * Releases a slot that was previously claimed with `bufferWriteClaim()`.
- * The slot is set to `BUFFER_FREE` and the lock is released.
+ * Publishes a slot that was previously claimed with `bufferWriteClaim()` by
+ * setting it to `BUFFER_READY`, unless the buffer was cleared in between.
+ * The checksum is recorded before the state change publishes it along with
+ * the data.
  */
 int bufferWriteRelease(Buffer* buffer, uint16_t index) {
-    if (!buffer) return -EINVAL;
-    uint8_t expected = BUFFER_CLAIMED;
-    if (!EXPECT_SLOT_STATE(buffer->lock, index, &expected, BUFFER_READY)) {
-        return -EPERM;
-    }
-    return BUFFER_OK;
+    if (!buffer || index >= buffer->size) return -EINVAL;
+    slotSeal(buffer, index);
+    return slotRelease(buffer, index, BUFFER_CLAIMED, BUFFER_READY);
 }
 
 int bufferWriteRaw(Buffer* buffer, const void* data, uint16_t size) {
@@ -168,13 +405,14 @@ int bufferWriteRaw(Buffer* buffer, const void* data, uint16_t size) {
     if (!buffer || !data) return -EINVAL;
     if (size == 0 || size > buffer->type_size) return -EINVAL;
     // claim the write lock or exit if busy
-    uint8_t* head_addr;
-    int res = bufferWriteClaim(buffer, (void**)&head_addr);
+    void* head_addr;
+    int res = bufferWriteClaim(buffer, &head_addr);
     if (res < BUFFER_OK) return res;
-    // copy the data into the slot
-    memcpy((void*)head_addr, data, size);
+    // copy the data into the slot, checksumming it on the way
+    slotStore(buffer, (uint16_t)res, data, size);
     // mark the slot as ready to be read
-    SET_SLOT_STATE(buffer->lock, res, BUFFER_READY);
+    int tmp = slotRelease(buffer, (uint16_t)res, BUFFER_CLAIMED, BUFFER_READY);
+    if (tmp < BUFFER_OK) return tmp;
     // exit
     return res;
 }
@@ -198,20 +436,24 @@ int bufferReadClaim(Buffer* buffer, void** out_addr) {
     }
     // check if the current slot has already been claimed
     uint16_t cur_tail = buffer->tail;
-    uint8_t slot_expected = BUFFER_READY;
-    if (!EXPECT_SLOT_STATE(buffer->lock, cur_tail, &slot_expected, BUFFER_READING)) {
+    uint8_t epoch = GET_LOCK_VAL(&buffer->epoch);
+    uint8_t slot_expected = slotTag(epoch, BUFFER_READY);
+    if (!EXPECT_SLOT_STATE(buffer->lock, cur_tail, &slot_expected, slotTag(epoch, BUFFER_READING))) {
         CLEAR_READ_LOCK(buffer->lock);
         return -EBUSY;
     }
     // With all checks down, we can claim the slot
-    *out_addr = (uint8_t*)buffer->raw + (cur_tail * buffer->type_size);
+    *out_addr = slotAddr(buffer, cur_tail);
     // advance the tail and remove the full flag
     if (buffer->head == buffer->tail) {
         buffer->full = false;
     }
     buffer->tail = (uint16_t)((cur_tail + 1) % buffer->size);
+    uint16_t count = buffer->watermark ? bufferCount(buffer) : 0;
     // release the read lock so concurrent readers can claim a slot
     CLEAR_READ_LOCK(buffer->lock);
+    watermarkFall(buffer->watermark, count);
+    slotPrefetch(buffer, cur_tail, false);
     return cur_tail;
 }
 
@@ -227,27 +469,114 @@ int bufferReadRaw(Buffer* buffer, void* data, uint16_t size) {
     // ensure arguments are valid
     if (!buffer  || !data) return -EINVAL;
     if (size == 0 || size > buffer->type_size) return -EINVAL;
-    uint8_t* tail_addr;
-    int cur_tail = bufferReadClaim(buffer, (void**)&tail_addr);
+    void* tail_addr;
+    int cur_tail = bufferReadClaim(buffer, &tail_addr);
     if (cur_tail < BUFFER_OK) return cur_tail;
-    // copy the data from the slot
-    memcpy(data, (void*)tail_addr, size);
+    // copy the data from the slot, verifying it on the way
+    int valid = slotLoad(buffer, (uint16_t)cur_tail, data, size);
     // mark the slot as free
-    SET_SLOT_STATE(buffer->lock, cur_tail, BUFFER_FREE);
+    int tmp = slotRelease(buffer, (uint16_t)cur_tail, BUFFER_READING, BUFFER_FREE);
+    if (tmp < BUFFER_OK) return tmp;
+    if (valid < BUFFER_OK) return valid;
     // exit
     return cur_tail;
 }
 
 int bufferReadRelease(Buffer* buffer, uint16_t index) {
-    if (!buffer) return -EINVAL;
-    uint8_t expected = BUFFER_READING;
-    if (!EXPECT_SLOT_STATE(buffer->lock, index, &expected, BUFFER_FREE)) {
-        return -EPERM;
-    }
-    return BUFFER_OK;
+    if (!buffer || index >= buffer->size) return -EINVAL;
+    return slotRelease(buffer, index, BUFFER_READING, BUFFER_FREE);
 }
 
 int bufferRead(Buffer* buffer, void* data) {
     if (!buffer || !data) return -EINVAL;
     return bufferReadRaw(buffer, data, buffer->type_size);
 }
+
+/**
+ * @details
+ * For each element, a ready slot is claimed in `src` and a free slot in
+ * `dst`; the element is copied (or mapped) straight from one slot into the
+ * other, and both slots are released. Elements rejected by `filter` are
+ * released in `src` without touching `dst`.
+ *
+ * If `dst` runs out of space after a source slot was claimed, the claim is
+ * undone. Should another reader of `src` have claimed a later slot in the
+ * meantime, the claim cannot be undone: a contended `dst` is retried with a
+ * bounded backoff, and if it still cannot take the element, the element is
+ * written back at the head of `src` instead of being lost. Transfers are
+ * therefore best run by the only reader of `src`.
+ */
+int bufferTransferWith(Buffer* src, Buffer* dst, uint16_t max_count,
+                       BufferFilterFn filter, BufferMapFn map, void* ctx) {
+    if (!src || !dst || src == dst || max_count == 0) return -EINVAL;
+    if (!map && src->type_size != dst->type_size) return -EINVAL;
+    uint16_t consumed = 0;
+    uint16_t moved = 0;
+    while (consumed < max_count) {
+        if (bufferIsFull(dst)) {
+            if (consumed == 0) return -ENOSPC;
+            break;
+        }
+        void* in;
+        int src_index = bufferReadClaim(src, &in);
+        if (src_index < BUFFER_OK) {
+            if (consumed == 0) return src_index;
+            break;
+        }
+        consumed++;
+        int verified = slotVerify(src, (uint16_t)src_index);
+        if (verified < BUFFER_OK) {
+            (void)bufferReadRelease(src, (uint16_t)src_index);
+            if (moved == 0) return verified;
+            break;
+        }
+        if (filter && !filter(ctx, in)) {
+            (void)bufferReadRelease(src, (uint16_t)src_index);
+            continue;
+        }
+        void* out;
+        int dst_index = bufferWriteClaim(dst, &out);
+        if (dst_index < BUFFER_OK) {
+            int res = readUnclaim(src, (uint16_t)src_index);
+            if (res == -ESTALE) continue;
+            if (res == BUFFER_OK) {
+                if (--consumed == 0) return dst_index;
+                break;
+            }
+            dst_index = writeClaimBackoff(dst, &out, dst_index);
+            if (dst_index < BUFFER_OK) {
+                // a dropped element is counted by `bufferDropped()`, not in the result
+                bool kept = readRequeue(src, (uint16_t)src_index, in) == BUFFER_OK;
+                if (kept && --consumed == 0) return dst_index;
+                break;
+            }
+        }
+        if (map) {
+            map(ctx, out, in);
+        } else {
+            copyBytes(out, in, dst->type_size);
+        }
+        // an element discarded by a concurrent clear of either side is not counted
+        int published = bufferWriteRelease(dst, (uint16_t)dst_index);
+        (void)bufferReadRelease(src, (uint16_t)src_index);
+        if (published == BUFFER_OK) moved++;
+    }
+    return moved;
+}
+
+int bufferTransfer(Buffer* src, Buffer* dst, uint16_t max_count) {
+    return bufferTransferWith(src, dst, max_count, NULL, NULL, NULL);
+}
+
+uint32_t bufferDropped(Buffer* buffer) {
+    if (!buffer) return 0;
+    return GET_LOCK_VAL(&buffer->dropped);
+}
+
+int bufferFind(Buffer* buffer, uint16_t offset, uint16_t width, uint64_t key) {
+    return scanReady(buffer, offset, width, key, true);
+}
+
+int bufferCountMatches(Buffer* buffer, uint16_t offset, uint16_t width, uint64_t key) {
+    return scanReady(buffer, offset, width, key, false);
+}
@@ -0,0 +1,251 @@
+#include "column.h"
+#include "buffer.h"
+#include "locking.h"
+#include "copy.h"
+#include "slot.h"
+#include "scan.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#include "aligned_block.h"
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+/* -- Private Functions --------------------------------------------------- */
+
+/**
+ * @brief Address of field `field` of row `row`.
+ */
+static inline uint8_t* columnCell(const ColumnBuffer* columns, uint16_t field, uint16_t row) {
+    return columns->columns[field] + (uint32_t)row * columns->fields[field].size;
+}
+
+static inline bool spanValid(const ColumnBuffer* columns, const ColumnSpan* span) {
+    return span->count > 0 && (uint32_t)span->first + span->count <= columns->rows.size;
+}
+
+/* -- Public Functions ----------------------------------------------------- */
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @details
+ * Allocates the ColumnBuffer structure, one aligned block holding every
+ * column and the lock from the provided BlockAllocator. If any allocation
+ * fails, all intermediate allocations are cleaned up to avoid leaks.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+ColumnBuffer* columnAllocate(BlockAllocator* allocator, uint16_t size, uint16_t record_size,
+                             const ColumnField* fields, uint16_t field_count) {
+    if (!allocator || !fields) return NULL;
+    if (size == 0 || field_count == 0 || field_count > COLUMN_MAX_FIELDS) return NULL;
+    if ((uint64_t)size * record_size + (uint64_t)field_count * COLUMN_ALIGN > UINT32_MAX) return NULL;
+    ColumnBuffer* columns = (ColumnBuffer*)blockAllocate(allocator, sizeof(ColumnBuffer));
+    if (!columns) return NULL;
+    *columns = (ColumnBuffer){ .rows = { .size = size } };
+    void* storage = alignedBlockAllocate(allocator, COLUMN_STORAGE_SIZE(size, record_size, field_count), COLUMN_ALIGN);
+    columns->rows.lock = lockAllocate(allocator, size);
+    if (!storage || !columns->rows.lock ||
+        columnInit(columns, storage, record_size, fields, field_count) != COLUMN_OK) {
+        if (storage) (void)alignedBlockDeallocate(allocator, storage, true);
+        if (columns->rows.lock) (void)lockDeallocate(allocator, &columns->rows.lock);
+        (void)blockDeallocate(allocator, columns);
+        return NULL;
+    }
+    return columns;
+}
+
+/**
+ * @details
+ * Frees the lock, the column storage and the ColumnBuffer structure itself.
+ * The storage starts with column 0. On success, the caller's pointer is set
+ * to NULL.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+int columnDeallocate(BlockAllocator* allocator, ColumnBuffer** columns) {
+    if (!allocator || !columns || !(*columns)) return -EINVAL;
+    int res1 = lockDeallocate(allocator, &(*columns)->rows.lock);
+    int res2 = alignedBlockDeallocate(allocator, (*columns)->columns[0], true);
+    int res3 = blockDeallocate(allocator, *columns);
+    if (res1 != LOCK_OK) return res1;
+    if (res2 != BLOCK_ALLOCATOR_OK) return res2;
+    if (res3 != BLOCK_ALLOCATOR_OK) return res3;
+    *columns = NULL;
+    return COLUMN_OK;
+}
+#endif
+
+/**
+ * @details
+ * Column `f` takes `size * fields[f].size` bytes and starts at the next
+ * `COLUMN_ALIGN` boundary after column `f - 1`. The embedded buffer uses
+ * column 0 as its slot storage, so its claims hand out rows of column 0 and
+ * every other column is indexed by the same row.
+ */
+int columnInit(ColumnBuffer* columns, void* storage, uint16_t record_size,
+               const ColumnField* fields, uint16_t field_count) {
+    if (!columns || !storage || !fields) return -EINVAL;
+    if (columns->rows.size == 0 || !columns->rows.lock) return -EINVAL;
+    if (field_count == 0 || field_count > COLUMN_MAX_FIELDS) return -EINVAL;
+    uint32_t total = 0;
+    for (uint16_t f = 0; f < field_count; f++) {
+        if (fields[f].size == 0) return -EINVAL;
+        if ((uint32_t)fields[f].offset + fields[f].size > record_size) return -EINVAL;
+        total += fields[f].size;
+    }
+    // the storage size only covers fields that do not overlap
+    if (total > record_size) return -EINVAL;
+    uint8_t* next = (uint8_t*)storage;
+    for (uint16_t f = 0; f < field_count; f++) {
+        columns->fields[f] = fields[f];
+        columns->columns[f] = next;
+        uint32_t len = (uint32_t)columns->rows.size * fields[f].size;
+        next += SLOT_STRIDE(len, COLUMN_ALIGN);
+    }
+    columns->field_count = field_count;
+    columns->record_size = record_size;
+    Buffer* rows = &columns->rows;
+    *rows = (Buffer){
+        .size = rows->size,
+        .type_size = fields[0].size,
+        .raw = columns->columns[0],
+        .lock = rows->lock,
+    };
+    return COLUMN_OK;
+}
+
+void columnClear(ColumnBuffer* columns) {
+    if (!columns) return;
+    bufferClear(&columns->rows);
+}
+
+/**
+ * @details
+ * Claims the row at the head, copies each field of the record into its
+ * column, and publishes the row.
+ */
+int columnWrite(ColumnBuffer* columns, const void* record) {
+    if (!columns || !record) return -EINVAL;
+    void* addr;
+    int row = bufferWriteClaim(&columns->rows, &addr);
+    if (row < BUFFER_OK) return row;
+    const uint8_t* src = (const uint8_t*)record;
+    for (uint16_t f = 0; f < columns->field_count; f++) {
+        const ColumnField* field = &columns->fields[f];
+        copyBytes(columnCell(columns, f, (uint16_t)row), src + field->offset, field->size);
+    }
+    int res = bufferWriteRelease(&columns->rows, (uint16_t)row);
+    if (res < BUFFER_OK) return res;
+    return row;
+}
+
+/**
+ * @details
+ * Claims the row at the tail, copies each field from its column into the
+ * record, and frees the row.
+ */
+int columnRead(ColumnBuffer* columns, void* record) {
+    if (!columns || !record) return -EINVAL;
+    void* addr;
+    int row = bufferReadClaim(&columns->rows, &addr);
+    if (row < BUFFER_OK) return row;
+    uint8_t* dst = (uint8_t*)record;
+    for (uint16_t f = 0; f < columns->field_count; f++) {
+        const ColumnField* field = &columns->fields[f];
+        copyBytes(dst + field->offset, columnCell(columns, f, (uint16_t)row), field->size);
+    }
+    int res = bufferReadRelease(&columns->rows, (uint16_t)row);
+    if (res < BUFFER_OK) return res;
+    return row;
+}
+
+/**
+ * @details
+ * Claims rows from the tail under a single read lock, as `bufferReadClaim()`
+ * would one at a time, so no other reader can interleave its claims and the
+ * rows of the span are consecutive.
+ */
+int columnReadSpan(ColumnBuffer* columns, uint16_t max_count, ColumnSpan* span) {
+    if (!columns || !span || max_count == 0) return -EINVAL;
+    Buffer* rows = &columns->rows;
+    if (!TAKE_READ_LOCK(rows->lock)) {
+        return -EBUSY;
+    }
+    if (bufferIsEmpty(rows)) {
+        CLEAR_READ_LOCK(rows->lock);
+        return -EAGAIN;
+    }
+    uint16_t first = rows->tail;
+    uint16_t limit = bufferCount(rows);
+    if (limit > rows->size - first) limit = (uint16_t)(rows->size - first);
+    if (limit > max_count) limit = max_count;
+    uint8_t epoch = GET_LOCK_VAL(&rows->epoch);
+    uint16_t count = 0;
+    // stop at the first row that is not ready, e.g. still being written
+    while (count < limit) {
+        uint8_t expected = slotTag(epoch, BUFFER_READY);
+        if (!EXPECT_SLOT_STATE(rows->lock, first + count, &expected, slotTag(epoch, BUFFER_READING))) break;
+        count++;
+    }
+    if (count == 0) {
+        CLEAR_READ_LOCK(rows->lock);
+        return -EBUSY;
+    }
+    rows->full = false;
+    rows->tail = (uint16_t)((first + count) % rows->size);
+    uint16_t level = rows->watermark ? bufferCount(rows) : 0;
+    CLEAR_READ_LOCK(rows->lock);
+    watermarkFall(rows->watermark, level);
+    *span = (ColumnSpan){ .first = first, .count = count };
+    return count;
+}
+
+const void* columnSpanData(const ColumnBuffer* columns, const ColumnSpan* span, uint16_t field) {
+    if (!columns || !span || field >= columns->field_count) return NULL;
+    if (!spanValid(columns, span)) return NULL;
+    return columnCell(columns, field, span->first);
+}
+
+/**
+ * @details
+ * The values of a column are packed back to back, so the search always
+ * runs on the packed kernels (`stride == width`).
+ */
+int columnSpanFind(const ColumnBuffer* columns, const ColumnSpan* span, uint16_t field, uint64_t key) {
+    if (!columns || !span || field >= columns->field_count) return -EINVAL;
+    if (!spanValid(columns, span)) return -EINVAL;
+    uint16_t width = columns->fields[field].size;
+    if (width != 1 && width != 2 && width != 4 && width != 8) return -EINVAL;
+    // the kernels expect a key that fits the field, as in `bufferFind()`
+    if (width < 8) key &= (1ull << (8 * width)) - 1;
+    int hit = scanFind(columnCell(columns, field, span->first), width, span->count, width, key);
+    return (hit < 0) ? -ENOENT : hit;
+}
+
+/**
+ * @details
+ * Every row is released even if an earlier one fails; the first error is
+ * returned.
+ */
+int columnSpanRelease(ColumnBuffer* columns, const ColumnSpan* span) {
+    if (!columns || !span) return -EINVAL;
+    if (!spanValid(columns, span)) return -EINVAL;
+    int res = COLUMN_OK;
+    for (uint16_t i = 0; i < span->count; i++) {
+        int tmp = bufferReadRelease(&columns->rows, (uint16_t)(span->first + i));
+        if (tmp < BUFFER_OK && res == COLUMN_OK) res = tmp;
+    }
+    return res;
+}
+
+bool columnIsEmpty(const ColumnBuffer* columns) {
+    return bufferIsEmpty(&columns->rows);
+}
+
+bool columnIsFull(const ColumnBuffer* columns) {
+    return columns->rows.full;
+}
@@ -0,0 +1,254 @@
+#include "conflate.h"
+#include "buffer.h"
+#include "stack.h"
+#include "locking.h"
+#include "copy.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+/* -- Private Functions --------------------------------------------------- */
+
+/** @brief Number of entries in the key index. */
+static inline uint32_t indexSize(const ConflatingQueue* queue) {
+    return 2u * queue->size;
+}
+
+/**
+ * @brief Home position of `key` in the key index.
+ *
+ * The key is mixed with the 64-bit finalizer of MurmurHash3 and its upper
+ * half is scaled onto the index with a multiply and shift, so the index size
+ * does not have to be a power of two.
+ */
+static inline uint32_t homeOf(const ConflatingQueue* queue, uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDull;
+    key ^= key >> 33;
+    key *= 0xC4CEB9FE1A85EC53ull;
+    key ^= key >> 33;
+    return (uint32_t)(((key >> 32) * indexSize(queue)) >> 32);
+}
+
+/** @brief Next position of a linear probe. */
+static inline uint32_t probeNext(const ConflatingQueue* queue, uint32_t pos) {
+    return (pos + 1 == indexSize(queue)) ? 0 : pos + 1;
+}
+
+/**
+ * @brief Finds the index position holding `key`, or the empty position ending its probe.
+ */
+static uint32_t indexFind(const ConflatingQueue* queue, uint64_t key) {
+    uint32_t pos = homeOf(queue, key);
+    for (;;) {
+        uint16_t slot = queue->index[pos];
+        if (slot == CONFLATE_EMPTY || queue->keys[slot] == key) return pos;
+        pos = probeNext(queue, pos);
+    }
+}
+
+/**
+ * @brief Empties index position `pos`, shifting later entries of the probe back.
+ *
+ * Backward shift deletion keeps every probe sequence free of holes, so no
+ * tombstones are needed and lookups never scan more than the live cluster.
+ */
+static void indexRemove(ConflatingQueue* queue, uint32_t pos) {
+    uint32_t next = pos;
+    for (;;) {
+        next = probeNext(queue, next);
+        uint16_t slot = queue->index[next];
+        if (slot == CONFLATE_EMPTY) break;
+        uint32_t home = homeOf(queue, queue->keys[slot]);
+        // the entry may move to `pos` unless its home lies cyclically in (pos, next]
+        bool stays = (pos <= next) ? (pos < home && home <= next)
+                                   : (pos < home || home <= next);
+        if (stays) continue;
+        queue->index[pos] = slot;
+        pos = next;
+    }
+    queue->index[pos] = CONFLATE_EMPTY;
+}
+
+/* -- Public Functions ----------------------------------------------------- */
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Releases every allocation owned by a (possibly partially built) queue.
+ */
+static int conflatingQueueRelease(BlockAllocator* allocator, ConflatingQueue* queue) {
+    int res = CONFLATE_OK;
+    int tmp;
+    if (queue->order) {
+        tmp = bufferDeallocate(allocator, &queue->order);
+        if (tmp != BUFFER_OK) res = tmp;
+    }
+    if (queue->free_slots) {
+        tmp = stackDeallocate(allocator, &queue->free_slots);
+        if (tmp != STACK_OK) res = tmp;
+    }
+    if (queue->lock) {
+        tmp = lockDeallocate(allocator, &queue->lock);
+        if (tmp != LOCK_OK) res = tmp;
+    }
+    if (queue->raw) {
+        tmp = blockDeallocate(allocator, queue->raw);
+        if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+    }
+    if (queue->keys) {
+        tmp = blockDeallocate(allocator, queue->keys);
+        if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+    }
+    if (queue->msg_len) {
+        tmp = blockDeallocate(allocator, queue->msg_len);
+        if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+    }
+    if (queue->index) {
+        tmp = blockDeallocate(allocator, queue->index);
+        if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+    }
+    tmp = blockDeallocate(allocator, queue);
+    if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+    return res;
+}
+
+/**
+ * @details
+ * Allocates a ConflatingQueue using the provided BlockAllocator. Internally, it allocates:
+ * - The message pool (`size * slot_len` bytes) with its key and length arrays.
+ * - The key index of `2 * size` entries.
+ * - A `Buffer` ring for the read order and a free list `Stack` of pool indices.
+ *
+ * If any allocation fails, all previously allocated structures are cleaned up.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+ConflatingQueue* conflatingQueueAllocate(BlockAllocator* allocator, uint16_t slot_len, uint16_t size) {
+    if (!allocator) return NULL;
+    if (slot_len == 0 || size == 0 || size == CONFLATE_EMPTY) return NULL;
+    ConflatingQueue* queue = (ConflatingQueue*)blockAllocate(allocator, sizeof(ConflatingQueue));
+    if (!queue) return NULL;
+    *queue = (ConflatingQueue){ .size = size, .slot_len = slot_len };
+    queue->raw = blockAllocate(allocator, size * slot_len);
+    queue->keys = blockAllocate(allocator, size * sizeof(uint64_t));
+    queue->msg_len = blockAllocate(allocator, size * sizeof(uint16_t));
+    queue->index = blockAllocate(allocator, 2 * size * sizeof(uint16_t));
+    queue->lock = lockAllocate(allocator, 1);
+    queue->order = bufferAllocate(allocator, size, sizeof(uint16_t));
+    queue->free_slots = stackAllocate(allocator, size, sizeof(uint16_t));
+    if (!queue->raw || !queue->keys || !queue->msg_len || !queue->index || !queue->lock
+        || !queue->order || !queue->free_slots) {
+        (void)conflatingQueueRelease(allocator, queue);
+        return NULL;
+    }
+    conflatingQueueClear(queue);
+    return queue;
+}
+
+/**
+ * @details
+ * Frees the message pool, the key index, the order ring, the free list and
+ * the queue struct itself. On success, sets the queue pointer to NULL.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+int conflatingQueueDeallocate(BlockAllocator* allocator, ConflatingQueue** queue) {
+    if (!allocator || !queue || !(*queue)) return -EINVAL;
+    int res = conflatingQueueRelease(allocator, *queue);
+    if (res != CONFLATE_OK) return res;
+    *queue = NULL;
+    return CONFLATE_OK;
+}
+#endif
+
+/**
+ * @details
+ * Empties the key index and the order ring and refills the free list with
+ * every pool index.
+ *
+ * @note
+ * Does not free or reallocate memory.
+ */
+void conflatingQueueClear(ConflatingQueue* queue) {
+    if (!queue) return;
+    for (uint32_t i = 0; i < indexSize(queue); i++) {
+        queue->index[i] = CONFLATE_EMPTY;
+    }
+    bufferClear(queue->order);
+    // drain rather than reset the free list, so its slot states return to free
+    uint16_t slot;
+    while (stackPop(queue->free_slots, &slot) >= STACK_OK);
+    for (slot = 0; slot < queue->size; slot++) {
+        (void)stackPush(queue->free_slots, &slot);
+    }
+    queue->count = 0;
+    queue->conflated = 0;
+}
+
+bool conflatingQueueIsEmpty(const ConflatingQueue* queue) {
+    return queue->count == 0;
+}
+
+/**
+ * @details
+ * Looks `key` up in the index. A pending message is overwritten in its pool
+ * entry. Otherwise a pool entry is taken from the free list, recorded in the
+ * index and appended to the order ring.
+ */
+int conflatingQueueWrite(ConflatingQueue* queue, uint64_t key, const uint8_t* data, uint16_t len) {
+    if (!queue || !data || len == 0) return -EINVAL;
+    len = (len > queue->slot_len) ? queue->slot_len : len;
+    if (!TAKE_CONFLATE_LOCK(queue->lock)) return -EBUSY;
+    uint32_t pos = indexFind(queue, key);
+    uint16_t slot = queue->index[pos];
+    if (slot != CONFLATE_EMPTY) {
+        queue->conflated++;
+    } else {
+        if (stackPop(queue->free_slots, &slot) < STACK_OK) {
+            CLEAR_CONFLATE_LOCK(queue->lock);
+            return -ENOSPC;
+        }
+        // the ring holds one entry per pool entry, so it cannot be full
+        (void)bufferWrite(queue->order, &slot);
+        queue->index[pos] = slot;
+        queue->keys[slot] = key;
+        queue->count++;
+    }
+    copyBytes(queue->raw + slot * queue->slot_len, data, len);
+    queue->msg_len[slot] = len;
+    CLEAR_CONFLATE_LOCK(queue->lock);
+    return len;
+}
+
+/**
+ * @details
+ * Takes the oldest pool index from the order ring and removes its key from
+ * the index, so a later write for the key is appended again.
+ * - Only up to the actual message length (or `len`, whichever is smaller)
+ *   is copied; the remainder of `data` is zero-filled as in `queueRead`.
+ * - The pool entry is returned to the free list.
+ */
+int conflatingQueueRead(ConflatingQueue* queue, uint64_t* key, uint8_t* data, uint16_t len) {
+    if (!queue || !data || len == 0) return -EINVAL;
+    if (!TAKE_CONFLATE_LOCK(queue->lock)) return -EBUSY;
+    uint16_t slot;
+    if (bufferRead(queue->order, &slot) < BUFFER_OK) {
+        CLEAR_CONFLATE_LOCK(queue->lock);
+        return -EAGAIN;
+    }
+    indexRemove(queue, indexFind(queue, queue->keys[slot]));
+    queue->count--;
+    if (key) *key = queue->keys[slot];
+    uint16_t msg_len = queue->msg_len[slot];
+    msg_len = (len < msg_len) ? len : msg_len;
+    copyBytes(data, queue->raw + slot * queue->slot_len, msg_len);
+    for (uint16_t i = msg_len; i < len; i++) data[i] = '\0';
+    (void)stackPush(queue->free_slots, &slot);
+    CLEAR_CONFLATE_LOCK(queue->lock);
+    return msg_len;
+}
@@ -0,0 +1,104 @@
+#pragma once
+/**
+ * @file copy.h
+ * @brief [internal] Word-wide copy kernel shared by the container sources.
+ *
+ * Copies machine words while both pointers are word aligned and finishes
+ * with a byte loop. Like the per-file `memcpy` helpers it replaces, it does
+ * not depend on a standard library.
+ */
+#include <stdint.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+/** @brief Word type allowed to alias any object, so slot bytes can be read as words. */
+typedef uintptr_t __attribute__((__may_alias__)) CopyWord_t;
+/** @brief `CopyWord_t` without an alignment requirement, for the caller's side of a slot copy. */
+typedef uintptr_t __attribute__((__may_alias__, __aligned__(1))) CopyUnalignedWord_t;
+#define COPY_WIDE 1
+#else
+#define COPY_WIDE 0
+#endif
+
+/**
+ * @brief Copies `size` bytes from `src` to `dest`.
+ *
+ * @param dest Destination buffer.
+ * @param src Source buffer.
+ * @param size Number of bytes to copy.
+ */
+static inline void copyBytes(void* dest, const void* src, uint16_t size) {
+    uint8_t* d = (uint8_t*)dest;
+    const uint8_t* s = (const uint8_t*)src;
+#if COPY_WIDE
+    if ((((uintptr_t)d | (uintptr_t)s) & (sizeof(CopyWord_t) - 1)) == 0) {
+        while (size >= sizeof(CopyWord_t)) {
+            *(CopyWord_t*)d = *(const CopyWord_t*)s;
+            d += sizeof(CopyWord_t);
+            s += sizeof(CopyWord_t);
+            size -= sizeof(CopyWord_t);
+        }
+    }
+#endif
+    while (size--) {
+        *d++ = *s++;
+    }
+}
+
+/**
+ * @brief Copies `size` bytes into a word aligned slot from memory of any alignment.
+ *
+ * Slots of containers created with an alignment are always word aligned,
+ * since their stride is a multiple of at least 8 bytes, so the slot is
+ * written with aligned word stores. The caller's side is read with aligned
+ * loads when it is word aligned too, and with unaligned loads otherwise.
+ * Unlike `copyBytes()`, words are copied either way.
+ *
+ * @param slot Word aligned destination slot.
+ * @param src  Source buffer.
+ * @param size Number of bytes to copy.
+ */
+static inline void copyToSlot(void* slot, const void* src, uint16_t size) {
+#if COPY_WIDE
+    if (((uintptr_t)src & (sizeof(CopyWord_t) - 1)) == 0) {
+        copyBytes(slot, src, size);
+        return;
+    }
+    CopyWord_t* d = (CopyWord_t*)__builtin_assume_aligned(slot, sizeof(CopyWord_t));
+    const uint8_t* s = (const uint8_t*)src;
+    for (; size >= sizeof(CopyWord_t); size -= sizeof(CopyWord_t)) {
+        *d++ = *(const CopyUnalignedWord_t*)s;
+        s += sizeof(CopyWord_t);
+    }
+    copyBytes(d, s, size);
+#else
+    copyBytes(slot, src, size);
+#endif
+}
+
+/**
+ * @brief Copies `size` bytes from a word aligned slot to memory of any alignment.
+ *
+ * The mirror of `copyToSlot()`: the slot is read with aligned word loads and
+ * the caller's side is written with aligned or unaligned stores.
+ *
+ * @param dest Destination buffer.
+ * @param slot Word aligned source slot.
+ * @param size Number of bytes to copy.
+ */
+static inline void copyFromSlot(void* dest, const void* slot, uint16_t size) {
+#if COPY_WIDE
+    if (((uintptr_t)dest & (sizeof(CopyWord_t) - 1)) == 0) {
+        copyBytes(dest, slot, size);
+        return;
+    }
+    const CopyWord_t* s = (const CopyWord_t*)__builtin_assume_aligned(slot, sizeof(CopyWord_t));
+    uint8_t* d = (uint8_t*)dest;
+    for (; size >= sizeof(CopyWord_t); size -= sizeof(CopyWord_t)) {
+        *(CopyUnalignedWord_t*)d = *s++;
+        d += sizeof(CopyWord_t);
+    }
+    copyBytes(d, s, size);
+#else
+    copyBytes(dest, slot, size);
+#endif
+}
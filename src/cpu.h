@@ -0,0 +1,80 @@
+#pragma once
+/**
+ * @file cpu.h
+ * @brief [internal] Runtime CPU feature checks for the x86 kernels.
+ *
+ * Kernels that use instructions beyond the compiler's baseline are built
+ * with a per-function `target` attribute and only called after the matching
+ * check below succeeds, so the library still runs on CPUs without them.
+ *
+ * `CPU_X86` is 1 when `USE_SIMD` is defined and the compiler is GCC or Clang
+ * targeting x86; otherwise every check reports false and only the scalar
+ * kernels are built.
+ *
+ * The features are detected once, on the first check, and kept in a static
+ * of the including translation unit, so a check on a hot path is one
+ * relaxed load.
+ */
+#include <stdbool.h>
+
+#if defined(USE_SIMD) && (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define CPU_X86 1
+#else
+#define CPU_X86 0
+#endif
+
+#if CPU_X86
+/** @brief Function attribute enabling the instructions of `isa` in one kernel. */
+#define CPU_TARGET(isa) __attribute__((target(isa)))
+
+#define CPU_DETECTED (1u << 0)  // the other bits are valid
+#define CPU_AVX      (1u << 1)
+#define CPU_AVX2     (1u << 2)
+#define CPU_SSE42    (1u << 3)
+
+/**
+ * @brief Returns the `CPU_*` feature bits of the running CPU.
+ *
+ * Threads racing on the first call detect the same bits, so either store wins.
+ */
+static inline unsigned cpuFeatures(void) {
+    static unsigned features;
+    unsigned bits = __atomic_load_n(&features, __ATOMIC_RELAXED);
+    if (bits & CPU_DETECTED) return bits;
+    __builtin_cpu_init();
+    bits = CPU_DETECTED;
+    if (__builtin_cpu_supports("avx")) bits |= CPU_AVX;
+    if (__builtin_cpu_supports("avx2")) bits |= CPU_AVX2;
+    if (__builtin_cpu_supports("sse4.2")) bits |= CPU_SSE42;
+    __atomic_store_n(&features, bits, __ATOMIC_RELAXED);
+    return bits;
+}
+
+/** @brief Returns true if the CPU supports AVX. */
+static inline bool cpuHasAvx(void) {
+    return (cpuFeatures() & CPU_AVX) != 0;
+}
+
+/** @brief Returns true if the CPU supports AVX2. */
+static inline bool cpuHasAvx2(void) {
+    return (cpuFeatures() & CPU_AVX2) != 0;
+}
+
+/** @brief Returns true if the CPU supports SSE4.2. */
+static inline bool cpuHasSse42(void) {
+    return (cpuFeatures() & CPU_SSE42) != 0;
+}
+#else
+static inline bool cpuHasAvx(void) {
+    return false;
+}
+
+static inline bool cpuHasAvx2(void) {
+    return false;
+}
+
+static inline bool cpuHasSse42(void) {
+    return false;
+}
+#endif
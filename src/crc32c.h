@@ -0,0 +1,27 @@
+#pragma once
+/**
+ * @file crc32c.h
+ * @brief [internal] CRC32C (Castagnoli) checksum, optionally fused with a copy.
+ *
+ * `crc32cCopy()` checksums a run of bytes and, given a destination, copies
+ * it in the same pass, so a slot is only read once whether it is being
+ * written or read. The kernel is chosen at runtime:
+ * - SSE4.2: the `crc32` instruction, 8 bytes per step on x86-64.
+ * - Scalar: a 256-entry table, one byte per step, on every other target or
+ *   when the library is built without `USE_SIMD`.
+ */
+#include <stdint.h>
+
+/**
+ * @brief Extends the CRC32C `crc` of some bytes with `size` more bytes from `src`.
+ *
+ * Start with `crc = 0`; the checksum of a concatenation can be computed
+ * piece by piece by passing the previous result back in.
+ *
+ * @param crc  CRC32C of the bytes before `src`, or 0.
+ * @param dest Where to copy the bytes to, or NULL to only checksum them.
+ * @param src  Bytes to checksum.
+ * @param size Number of bytes.
+ * @return The CRC32C of the bytes before `src` followed by `src`.
+ */
+uint32_t crc32cCopy(uint32_t crc, void* dest, const void* src, uint32_t size);
@@ -0,0 +1,362 @@
+#include "delay.h"
+#include "buffer.h"
+#include "stack.h"
+#include "locking.h"
+#include "copy.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+/* -- Private Functions --------------------------------------------------- */
+
+/** @brief Returns true if time `a` is strictly before time `b` (wrap-around safe). */
+static inline bool timeBefore(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+/** @brief Returns the wheel bucket at `level`, `slot`. */
+static inline Buffer* bucketAt(DelayQueue* queue, uint8_t level, uint32_t slot) {
+    return &queue->wheel[level * DELAY_WHEEL_SLOTS + (slot & DELAY_WHEEL_MASK)];
+}
+
+/** @brief Number of entry indices stored in a bucket. */
+static inline uint16_t bucketCount(const Buffer* bucket) {
+    if (bucket->full) return bucket->size;
+    return (uint16_t)((bucket->head + bucket->size - bucket->tail) % bucket->size);
+}
+
+/**
+ * @brief Places a pool entry into the bucket matching its due time.
+ *
+ * Entries that are already due go to the current level 0 bucket; entries
+ * beyond the wheel span are parked in the top level.
+ */
+static int wheelInsert(DelayQueue* queue, uint16_t index) {
+    uint32_t due = queue->due[index];
+    uint32_t delta = due - queue->time;
+    uint8_t level = 0;
+    uint32_t slot = queue->time;
+    if (!timeBefore(due, queue->time + 1)) {
+        if (delta >= DELAY_WHEEL_SPAN) {
+            delta = DELAY_WHEEL_SPAN - 1;
+            due = queue->time + delta;
+        }
+        while (delta >> (DELAY_WHEEL_BITS * (level + 1))) level++;
+        slot = due >> (DELAY_WHEEL_BITS * level);
+    }
+    int res = bufferWrite(bucketAt(queue, level, slot), &index);
+    if (res < BUFFER_OK) return res;
+    queue->level_count[level]++;
+    return DELAY_OK;
+}
+
+/**
+ * @brief Finds the first non-empty bucket of `level` after the current time.
+ *
+ * @return Offset (in buckets) of the first non-empty bucket, or
+ *         `DELAY_WHEEL_SLOTS` if the level holds no entries.
+ */
+static uint32_t nextBucket(DelayQueue* queue, uint8_t level, uint32_t base) {
+    if (queue->level_count[level] == 0) return DELAY_WHEEL_SLOTS;
+    for (uint32_t k = 0; k < DELAY_WHEEL_SLOTS; k++) {
+        if (!bufferIsEmpty(bucketAt(queue, level, base + k))) return k;
+    }
+    return DELAY_WHEEL_SLOTS;
+}
+
+/**
+ * @brief Returns the next tick at which a level 0 bucket expires or a
+ *        higher level bucket has to be cascaded.
+ *
+ * Must only be called while the queue holds at least one entry.
+ */
+static uint32_t nextEvent(DelayQueue* queue) {
+    uint32_t best = queue->time + DELAY_WHEEL_SPAN;
+    uint32_t k = nextBucket(queue, 0, queue->time + 1);
+    if (k < DELAY_WHEEL_SLOTS) best = queue->time + 1 + k;
+    for (uint8_t level = 1; level < DELAY_WHEEL_LEVELS; level++) {
+        uint8_t shift = DELAY_WHEEL_BITS * level;
+        uint32_t base = (queue->time >> shift) + 1;
+        k = nextBucket(queue, level, base);
+        if (k == DELAY_WHEEL_SLOTS) continue;
+        uint32_t when = (base + k) << shift;
+        if (timeBefore(when, best)) best = when;
+    }
+    return best;
+}
+
+/**
+ * @brief Re-inserts every entry of the bucket that expires at the current
+ *        time, starting from the highest level.
+ */
+static void cascade(DelayQueue* queue) {
+    for (uint8_t level = DELAY_WHEEL_LEVELS - 1; level > 0; level--) {
+        uint8_t shift = DELAY_WHEEL_BITS * level;
+        if (queue->time & ((1ul << shift) - 1)) continue;
+        Buffer* bucket = bucketAt(queue, level, queue->time >> shift);
+        uint16_t index;
+        while (bufferRead(bucket, &index) >= BUFFER_OK) {
+            queue->level_count[level]--;
+            (void)wheelInsert(queue, index);
+        }
+    }
+}
+
+/**
+ * @brief Advances the wheel towards `now`, stopping early at the first tick
+ *        whose level 0 bucket holds due entries.
+ *
+ * Stretches without events are skipped in a single step.
+ */
+static void advance(DelayQueue* queue, uint32_t now) {
+    while (bufferIsEmpty(bucketAt(queue, 0, queue->time))) {
+        uint32_t next = (queue->count == 0) ? now : nextEvent(queue);
+        if (timeBefore(now, next)) {
+            if (timeBefore(queue->time, now)) queue->time = now;
+            return;
+        }
+        if (!timeBefore(queue->time, next)) return;
+        queue->time = next;
+        cascade(queue);
+    }
+}
+
+/**
+ * @brief Returns the earliest due time among pending entries.
+ *
+ * Level 0 buckets hold a single tick each. Entries of a higher level bucket
+ * are never due before the bucket is cascaded, so buckets are scanned in
+ * expiry order only until their cascade time passes the best candidate.
+ */
+static uint32_t nextDue(DelayQueue* queue) {
+    uint32_t best = queue->time;
+    uint32_t k = nextBucket(queue, 0, queue->time);
+    bool found = k < DELAY_WHEEL_SLOTS;
+    if (found) best = queue->time + k;
+    for (uint8_t level = 1; level < DELAY_WHEEL_LEVELS; level++) {
+        uint8_t shift = DELAY_WHEEL_BITS * level;
+        uint32_t base = (queue->time >> shift) + 1;
+        if (queue->level_count[level] == 0) continue;
+        for (k = 0; k < DELAY_WHEEL_SLOTS; k++) {
+            if (found && !timeBefore((base + k) << shift, best)) break;
+            Buffer* bucket = bucketAt(queue, level, base + k);
+            uint16_t n = bucketCount(bucket);
+            for (uint16_t i = 0; i < n; i++) {
+                uint16_t index = ((uint16_t*)bucket->raw)[(bucket->tail + i) % bucket->size];
+                if (!found || timeBefore(queue->due[index], best)) best = queue->due[index];
+                found = true;
+            }
+        }
+    }
+    return best;
+}
+
+/* -- Public Functions ----------------------------------------------------- */
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Releases every allocation owned by a (possibly partially built) queue.
+ */
+static int delayQueueRelease(BlockAllocator* allocator, DelayQueue* queue) {
+    int res = DELAY_OK;
+    int tmp;
+    if (queue->wheel) {
+        if (queue->wheel[0].lock) {
+            tmp = blockDeallocate(allocator, queue->wheel[0].lock);
+            if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+        }
+        if (queue->wheel[0].raw) {
+            tmp = blockDeallocate(allocator, queue->wheel[0].raw);
+            if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+        }
+        tmp = blockDeallocate(allocator, queue->wheel);
+        if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+    }
+    if (queue->free_slots) {
+        tmp = stackDeallocate(allocator, &queue->free_slots);
+        if (tmp != STACK_OK) res = tmp;
+    }
+    if (queue->lock) {
+        tmp = lockDeallocate(allocator, &queue->lock);
+        if (tmp != LOCK_OK) res = tmp;
+    }
+    if (queue->raw) {
+        tmp = blockDeallocate(allocator, queue->raw);
+        if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+    }
+    if (queue->due) {
+        tmp = blockDeallocate(allocator, queue->due);
+        if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+    }
+    if (queue->msg_len) {
+        tmp = blockDeallocate(allocator, queue->msg_len);
+        if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+    }
+    tmp = blockDeallocate(allocator, queue);
+    if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+    return res;
+}
+
+/**
+ * @details
+ * Allocates a DelayQueue using the provided BlockAllocator. Internally, it allocates:
+ * - The message pool (`size * slot_len` bytes) with its due time and length arrays.
+ * - A free list `Stack` of pool indices.
+ * - `DELAY_WHEEL_BUCKETS` index rings sharing one contiguous backing block,
+ *   and one block holding their locks followed by their slot states.
+ *
+ * If any allocation fails, all previously allocated structures are cleaned up.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+DelayQueue* delayQueueAllocate(BlockAllocator* allocator, uint16_t slot_len, uint16_t size) {
+    if (!allocator) return NULL;
+    if (slot_len == 0 || size == 0) return NULL;
+    DelayQueue* queue = (DelayQueue*)blockAllocate(allocator, sizeof(DelayQueue));
+    if (!queue) return NULL;
+    *queue = (DelayQueue){ .size = size, .slot_len = slot_len };
+    queue->raw = blockAllocate(allocator, size * slot_len);
+    queue->due = blockAllocate(allocator, size * sizeof(uint32_t));
+    queue->msg_len = blockAllocate(allocator, size * sizeof(uint16_t));
+    queue->lock = lockAllocate(allocator, 1);
+    queue->free_slots = stackAllocate(allocator, size, sizeof(uint16_t));
+    queue->wheel = blockAllocate(allocator, DELAY_WHEEL_BUCKETS * sizeof(Buffer));
+    for (uint16_t b = 0; queue->wheel && b < DELAY_WHEEL_BUCKETS; b++) {
+        queue->wheel[b] = (Buffer){ .size = size, .type_size = sizeof(uint16_t) };
+    }
+    if (!queue->raw || !queue->due || !queue->msg_len || !queue->lock
+        || !queue->free_slots || !queue->wheel) {
+        (void)delayQueueRelease(allocator, queue);
+        return NULL;
+    }
+    // bucket b uses wheel_raw[b * size] and the b-th lock; the released
+    // queue frees both blocks through bucket 0
+    uint16_t* wheel_raw = blockAllocate(allocator, (uint32_t)DELAY_WHEEL_BUCKETS * size * sizeof(uint16_t));
+    Lock_t* wheel_lock = blockAllocate(allocator, DELAY_WHEEL_BUCKETS * sizeof(Lock_t)
+                                                  + (uint32_t)DELAY_WHEEL_BUCKETS * size * sizeof(LockState_t));
+    queue->wheel[0].raw = wheel_raw;
+    queue->wheel[0].lock = wheel_lock;
+    if (!wheel_raw || !wheel_lock) {
+        (void)delayQueueRelease(allocator, queue);
+        return NULL;
+    }
+    for (uint16_t b = 0; b < DELAY_WHEEL_BUCKETS; b++) {
+        queue->wheel[b].raw = wheel_raw + (uint32_t)b * size;
+        queue->wheel[b].lock = &wheel_lock[b];
+        INIT_LOCK(&wheel_lock[b], (LockState_t*)(wheel_lock + DELAY_WHEEL_BUCKETS) + (uint32_t)b * size, size);
+    }
+    delayQueueClear(queue);
+    return queue;
+}
+
+/**
+ * @details
+ * Frees the message pool, the free list, every wheel bucket and the queue
+ * struct itself. On success, sets the queue pointer to NULL.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+int delayQueueDeallocate(BlockAllocator* allocator, DelayQueue** queue) {
+    if (!allocator || !queue || !(*queue)) return -EINVAL;
+    int res = delayQueueRelease(allocator, *queue);
+    if (res != DELAY_OK) return res;
+    *queue = NULL;
+    return DELAY_OK;
+}
+#endif
+
+/**
+ * @details
+ * Drains every wheel bucket, so that all slot states return to `BUFFER_FREE`,
+ * and refills the free list with every pool index.
+ *
+ * @note
+ * Does not free or reallocate memory.
+ */
+void delayQueueClear(DelayQueue* queue) {
+    if (!queue) return;
+    uint16_t index;
+    for (uint16_t b = 0; b < DELAY_WHEEL_BUCKETS; b++) {
+        while (bufferRead(&queue->wheel[b], &index) >= BUFFER_OK);
+    }
+    for (uint8_t level = 0; level < DELAY_WHEEL_LEVELS; level++) {
+        queue->level_count[level] = 0;
+    }
+    stackClear(queue->free_slots);
+    for (index = 0; index < queue->size; index++) {
+        (void)stackPush(queue->free_slots, &index);
+    }
+    queue->count = 0;
+    queue->time = 0;
+}
+
+bool delayQueueIsEmpty(const DelayQueue* queue) {
+    return queue->count == 0;
+}
+
+/**
+ * @details
+ * Takes a pool entry from the free list, copies the message into it and
+ * inserts the entry index into the wheel. If the queue is idle, the wheel
+ * time is first re-synchronized to `now` so that the entry is placed
+ * relative to the caller's clock.
+ */
+int delayQueueWrite(DelayQueue* queue, const uint8_t* data, uint16_t len, uint32_t now, uint32_t due) {
+    if (!queue || !data || len == 0) return -EINVAL;
+    len = (len > queue->slot_len) ? queue->slot_len : len;
+    if (!TAKE_DELAY_LOCK(queue->lock)) return -EBUSY;
+    uint16_t index;
+    if (stackPop(queue->free_slots, &index) < STACK_OK) {
+        CLEAR_DELAY_LOCK(queue->lock);
+        return -ENOSPC;
+    }
+    if (queue->count == 0) queue->time = now;
+    copyBytes(queue->raw + (uint32_t)index * queue->slot_len, data, len);
+    queue->msg_len[index] = len;
+    queue->due[index] = due;
+    int res = wheelInsert(queue, index);
+    if (res < DELAY_OK) {
+        (void)stackPush(queue->free_slots, &index);
+        CLEAR_DELAY_LOCK(queue->lock);
+        return res;
+    }
+    queue->count++;
+    CLEAR_DELAY_LOCK(queue->lock);
+    return len;
+}
+
+/**
+ * @details
+ * Advances the wheel to `now`, cascading higher level buckets as their
+ * boundaries are crossed, then dequeues one entry from the current level 0
+ * bucket.
+ * - Only up to the actual message length (or `len`, whichever is smaller)
+ *   is copied; the remainder of `data` is zero-filled as in `queueRead`.
+ * - The pool entry is returned to the free list.
+ */
+int delayQueueRead(DelayQueue* queue, uint8_t* data, uint16_t len, uint32_t now, uint32_t* next_due) {
+    if (!queue || !data || len == 0) return -EINVAL;
+    if (!TAKE_DELAY_LOCK(queue->lock)) return -EBUSY;
+    advance(queue, now);
+    uint16_t index;
+    if (timeBefore(now, queue->time)
+        || bufferRead(bucketAt(queue, 0, queue->time), &index) < BUFFER_OK) {
+        if (next_due && queue->count) *next_due = nextDue(queue);
+        CLEAR_DELAY_LOCK(queue->lock);
+        return -EAGAIN;
+    }
+    queue->level_count[0]--;
+    queue->count--;
+    uint16_t msg_len = queue->msg_len[index];
+    msg_len = (len < msg_len) ? len : msg_len;
+    copyBytes(data, queue->raw + (uint32_t)index * queue->slot_len, msg_len);
+    for (uint16_t i = msg_len; i < len; i++) data[i] = '\0';
+    (void)stackPush(queue->free_slots, &index);
+    CLEAR_DELAY_LOCK(queue->lock);
+    return msg_len;
+}
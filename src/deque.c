@@ -0,0 +1,215 @@
+#include "deque.h"
+#include "buffer.h"
+#include "locking.h"
+#include "slot.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+/* -- Private Functions --------------------------------------------------- */
+
+/**
+ * @brief Takes both locks of a ring, or neither.
+ */
+static bool takeBothLocks(Buffer* ring) {
+    if (!TAKE_WRITE_LOCK(ring->lock)) return false;
+    if (!TAKE_READ_LOCK(ring->lock)) {
+        CLEAR_WRITE_LOCK(ring->lock);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Releases both locks of a ring.
+ */
+static void clearBothLocks(Buffer* ring) {
+    CLEAR_READ_LOCK(ring->lock);
+    CLEAR_WRITE_LOCK(ring->lock);
+}
+
+/* -- Public Functions ----------------------------------------------------- */
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @details
+ * Allocates the deque structure, its element storage and the ring lock. If
+ * any allocation fails, all intermediate allocations are cleaned up.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+Deque* dequeAllocate(BlockAllocator* allocator, uint16_t size, uint16_t type_size) {
+    if (!allocator) return NULL;
+    if (size == 0 || type_size == 0) return NULL;
+    Deque* deque = (Deque*)blockAllocate(allocator, sizeof(Deque));
+    if (!deque) return NULL;
+    deque->ring = (Buffer){ .size = size, .type_size = type_size };
+    deque->ring.raw = blockAllocate(allocator, size * type_size);
+    if (!deque->ring.raw) {
+        (void)blockDeallocate(allocator, deque);
+        return NULL;
+    }
+    deque->ring.lock = lockAllocate(allocator, size);
+    if (!deque->ring.lock) {
+        (void)blockDeallocate(allocator, deque->ring.raw);
+        (void)blockDeallocate(allocator, deque);
+        return NULL;
+    }
+    return deque;
+}
+
+/**
+ * @details
+ * Frees the ring lock, the element storage and the deque structure itself.
+ * On success, sets the deque pointer to NULL.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+int dequeDeallocate(BlockAllocator* allocator, Deque** deque) {
+    if (!allocator || !deque || !(*deque)) return -EINVAL;
+    int res1 = lockDeallocate(allocator, &(*deque)->ring.lock);
+    int res2 = blockDeallocate(allocator, (*deque)->ring.raw);
+    int res3 = blockDeallocate(allocator, *deque);
+    if (res1 != LOCK_OK) return res1;
+    if (res2 != BLOCK_ALLOCATOR_OK) return res2;
+    if (res3 != BLOCK_ALLOCATOR_OK) return res3;
+    *deque = NULL;
+    return DEQUE_OK;
+}
+#endif
+
+void dequeClear(Deque* deque) {
+    if (!deque) return;
+    bufferClear(&deque->ring);
+}
+
+bool dequeIsEmpty(const Deque* deque) {
+    return bufferIsEmpty(&deque->ring);
+}
+
+bool dequeIsFull(const Deque* deque) {
+    return bufferIsFull(&deque->ring);
+}
+
+int dequePushBackClaim(Deque* deque, void** out_addr) {
+    if (!deque) return -EINVAL;
+    return bufferWriteClaim(&deque->ring, out_addr);
+}
+
+/**
+ * @details
+ * Mirrors `bufferWriteClaim()` one slot behind the tail: the slot before the
+ * tail is claimed and the tail is moved back onto it, so it becomes the next
+ * slot read from the front.
+ */
+int dequePushFrontClaim(Deque* deque, void** out_addr) {
+    if (!deque || !out_addr) return -EINVAL;
+    Buffer* ring = &deque->ring;
+    if (!takeBothLocks(ring)) return -EBUSY;
+    if (ring->full) {
+        clearBothLocks(ring);
+        return -ENOSPC;
+    }
+    // a slot outside the contents is free, or ready only if discarded by a clear
+    uint16_t cur_front = (uint16_t)((ring->tail + ring->size - 1) % ring->size);
+    uint8_t expected = GET_SLOT_STATE(ring->lock, cur_front);
+    BufferState kind = slotKind(expected);
+    uint8_t claimed = slotTag(GET_LOCK_VAL(&ring->epoch), BUFFER_CLAIMED);
+    if ((kind != BUFFER_FREE && kind != BUFFER_READY) ||
+        !EXPECT_SLOT_STATE(ring->lock, cur_front, &expected, claimed)) {
+        clearBothLocks(ring);
+        return -EBUSY;
+    }
+    *out_addr = slotAddr(ring, cur_front);
+    ring->tail = cur_front;
+    if (ring->head == ring->tail) {
+        ring->full = true;
+    }
+    uint16_t count = ring->watermark ? bufferCount(ring) : 0;
+    clearBothLocks(ring);
+    watermarkRise(ring->watermark, count);
+    return cur_front;
+}
+
+int dequePushRelease(Deque* deque, uint16_t index) {
+    if (!deque) return -EINVAL;
+    return bufferWriteRelease(&deque->ring, index);
+}
+
+int dequePopFrontClaim(Deque* deque, void** out_addr) {
+    if (!deque) return -EINVAL;
+    return bufferReadClaim(&deque->ring, out_addr);
+}
+
+/**
+ * @details
+ * Mirrors `bufferReadClaim()` at the other end: the slot before the head is
+ * claimed and the head is moved back onto it, so it becomes the next slot
+ * written at the back.
+ */
+int dequePopBackClaim(Deque* deque, void** out_addr) {
+    if (!deque || !out_addr) return -EINVAL;
+    Buffer* ring = &deque->ring;
+    if (!takeBothLocks(ring)) return -EBUSY;
+    if (bufferIsEmpty(ring)) {
+        clearBothLocks(ring);
+        return -EAGAIN;
+    }
+    uint16_t cur_back = (uint16_t)((ring->head + ring->size - 1) % ring->size);
+    uint8_t epoch = GET_LOCK_VAL(&ring->epoch);
+    uint8_t expected = slotTag(epoch, BUFFER_READY);
+    if (!EXPECT_SLOT_STATE(ring->lock, cur_back, &expected, slotTag(epoch, BUFFER_READING))) {
+        clearBothLocks(ring);
+        return -EBUSY;
+    }
+    *out_addr = slotAddr(ring, cur_back);
+    ring->head = cur_back;
+    ring->full = false;
+    uint16_t count = ring->watermark ? bufferCount(ring) : 0;
+    clearBothLocks(ring);
+    watermarkFall(ring->watermark, count);
+    return cur_back;
+}
+
+int dequePopRelease(Deque* deque, uint16_t index) {
+    if (!deque) return -EINVAL;
+    return bufferReadRelease(&deque->ring, index);
+}
+
+int dequePushBack(Deque* deque, const void* data) {
+    if (!deque) return -EINVAL;
+    return bufferWrite(&deque->ring, data);
+}
+
+int dequePushFront(Deque* deque, const void* data) {
+    if (!deque || !data) return -EINVAL;
+    void* addr;
+    int res = dequePushFrontClaim(deque, &addr);
+    if (res < DEQUE_OK) return res;
+    slotStore(&deque->ring, (uint16_t)res, data, deque->ring.type_size);
+    int tmp = slotRelease(&deque->ring, (uint16_t)res, BUFFER_CLAIMED, BUFFER_READY);
+    if (tmp < BUFFER_OK) return tmp;
+    return res;
+}
+
+int dequePopFront(Deque* deque, void* data) {
+    if (!deque) return -EINVAL;
+    return bufferRead(&deque->ring, data);
+}
+
+int dequePopBack(Deque* deque, void* data) {
+    if (!deque || !data) return -EINVAL;
+    void* addr;
+    int res = dequePopBackClaim(deque, &addr);
+    if (res < DEQUE_OK) return res;
+    int valid = slotLoad(&deque->ring, (uint16_t)res, data, deque->ring.type_size);
+    int tmp = slotRelease(&deque->ring, (uint16_t)res, BUFFER_READING, BUFFER_FREE);
+    if (tmp < BUFFER_OK) return tmp;
+    if (valid < BUFFER_OK) return valid;
+    return res;
+}
@@ -0,0 +1,56 @@
+#include "drain.h"
+#include "queue.h"
+#include "buffer.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+/* -- Public Functions ----------------------------------------------------- */
+
+int drainRegion(const Queue* queue, void** base, uint32_t* len) {
+    if (!queue || !base || !len) return -EINVAL;
+    *base = queue->slot_buffer->raw;
+    *len = (uint32_t)queue->slot_buffer->size * bufferStride(queue->slot_buffer);
+    return DRAIN_OK;
+}
+
+/**
+ * @details
+ * Claims messages one at a time with `queueReadClaim()`. Each claim moves the
+ * tail on, so producers can keep writing into the space that is already free
+ * while earlier slots are still in flight.
+ */
+int drainClaim(Queue* queue, DrainSlot* slots, uint16_t max_count) {
+    if (!queue || !slots || max_count == 0) return -EINVAL;
+    uint16_t count = 0;
+    while (count < max_count) {
+        uint8_t* data;
+        uint16_t len;
+        int res = queueReadClaim(queue, &data, &len);
+        if (res < QUEUE_OK) {
+            if (count == 0) return res;
+            break;
+        }
+        slots[count++] = (DrainSlot){ .data = data, .len = len, .index = (uint16_t)res };
+    }
+    return count;
+}
+
+int drainComplete(Queue* queue, DrainSlot* slot, int32_t written) {
+    if (!queue || !slot) return -EINVAL;
+    if (written < 0) return written;
+    if ((uint32_t)written < slot->len) {
+        slot->data += written;
+        slot->len -= (uint16_t)written;
+        return -EAGAIN;
+    }
+    return drainRelease(queue, slot);
+}
+
+int drainRelease(Queue* queue, const DrainSlot* slot) {
+    if (!queue || !slot) return -EINVAL;
+    if (slot->index >= queue->slot_buffer->size) return -EINVAL;
+    int res = queueReadRelease(queue, slot->index);
+    if (res < QUEUE_OK) return res;
+    return DRAIN_OK;
+}
@@ -0,0 +1,233 @@
+#include "executor.h"
+#include "buffer.h"
+#include "locking.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+/* -- Private Functions --------------------------------------------------- */
+
+/**
+ * @brief Attempts to write a worker's pending completion to the reply ring.
+ *
+ * @return `EXECUTOR_OK` if nothing is pending any more, otherwise the error
+ *         returned by `bufferWrite()`.
+ */
+static int deliverReply(Executor* executor, ExecutorWorker* worker) {
+    if (!executor->replies) {
+        worker->reply_pending = false;
+        return EXECUTOR_OK;
+    }
+    int res = bufferWrite(executor->replies, &worker->reply);
+    if (res < BUFFER_OK) return res;
+    worker->reply_pending = false;
+    return EXECUTOR_OK;
+}
+
+/**
+ * @brief Writes a task into a worker's ring and wakes the worker if parked.
+ *
+ * The full fence pairs with the one in `executorPark()`: either the worker
+ * sees the new task when it re-checks its ring, or the submitter sees the
+ * idle flag and wakes it.
+ */
+static int submitTo(Executor* executor, uint16_t index, const Task* task) {
+    ExecutorWorker* worker = &executor->workers[index];
+    int res = bufferWrite(&worker->ring, task);
+    if (res < BUFFER_OK) return res;
+    if (executor->wake) {
+        LOCK_FULL_FENCE();
+        uint32_t expected = 1;
+        if (GET_LOCK_VAL(&worker->idle) && COMPARE_SET_LOCK(&worker->idle, &expected, 0)) {
+            executor->wake(executor->wake_ctx, index);
+        }
+    }
+    return index;
+}
+
+/* -- Public Functions ----------------------------------------------------- */
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Releases every allocation owned by a (possibly partially built) executor.
+ */
+static int executorRelease(BlockAllocator* allocator, Executor* executor) {
+    int res = EXECUTOR_OK;
+    int tmp;
+    if (executor->workers) {
+        for (uint16_t w = 0; w < executor->worker_count; w++) {
+            if (!executor->workers[w].ring.lock) continue;
+            tmp = lockDeallocate(allocator, &executor->workers[w].ring.lock);
+            if (tmp != LOCK_OK) res = tmp;
+        }
+        if (executor->workers[0].ring.raw) {
+            tmp = blockDeallocate(allocator, executor->workers[0].ring.raw);
+            if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+        }
+        tmp = blockDeallocate(allocator, executor->workers);
+        if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+    }
+    tmp = blockDeallocate(allocator, executor);
+    if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+    return res;
+}
+
+/**
+ * @details
+ * Allocates the executor, the worker states, a single block holding every
+ * worker's ring storage and one lock per ring. If any allocation fails,
+ * everything allocated so far is released.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+Executor* executorAllocate(BlockAllocator* allocator, uint16_t worker_count, uint16_t depth) {
+    if (!allocator) return NULL;
+    if (worker_count == 0 || depth == 0) return NULL;
+    Executor* executor = (Executor*)blockAllocate(allocator, sizeof(Executor));
+    if (!executor) return NULL;
+    *executor = (Executor){ .worker_count = worker_count };
+    executor->workers = blockAllocate(allocator, worker_count * sizeof(ExecutorWorker));
+    if (!executor->workers) {
+        (void)executorRelease(allocator, executor);
+        return NULL;
+    }
+    for (uint16_t w = 0; w < worker_count; w++) {
+        executor->workers[w].ring = (Buffer){ .size = depth, .type_size = sizeof(Task) };
+    }
+    uint8_t* ring_raw = blockAllocate(allocator, worker_count * depth * sizeof(Task));
+    if (!ring_raw) {
+        (void)executorRelease(allocator, executor);
+        return NULL;
+    }
+    for (uint16_t w = 0; w < worker_count; w++) {
+        executor->workers[w].ring.raw = ring_raw + w * depth * sizeof(Task);
+        executor->workers[w].ring.lock = lockAllocate(allocator, depth);
+        if (!executor->workers[w].ring.lock) {
+            (void)executorRelease(allocator, executor);
+            return NULL;
+        }
+    }
+    executorClear(executor);
+    return executor;
+}
+
+/**
+ * @details
+ * Frees every worker ring, the worker states and the executor struct itself.
+ * On success, sets the executor pointer to NULL.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+int executorDeallocate(BlockAllocator* allocator, Executor** executor) {
+    if (!allocator || !executor || !(*executor)) return -EINVAL;
+    int res = executorRelease(allocator, *executor);
+    if (res != EXECUTOR_OK) return res;
+    *executor = NULL;
+    return EXECUTOR_OK;
+}
+#endif
+
+/**
+ * @details
+ * Drains every worker ring, so that all slot states return to `BUFFER_FREE`,
+ * and resets the idle flags, pending replies and round-robin counter.
+ */
+void executorClear(Executor* executor) {
+    if (!executor) return;
+    Task task;
+    for (uint16_t w = 0; w < executor->worker_count; w++) {
+        ExecutorWorker* worker = &executor->workers[w];
+        while (bufferRead(&worker->ring, &task) >= BUFFER_OK);
+        PUBLISH_LOCK_VAL(&worker->idle, 0);
+        worker->reply_pending = false;
+    }
+    PUBLISH_LOCK_VAL(&executor->next, 0);
+}
+
+int executorSetReplyRing(Executor* executor, Buffer* replies) {
+    if (!executor) return -EINVAL;
+    if (replies && replies->type_size != sizeof(TaskResult)) return -EINVAL;
+    executor->replies = replies;
+    return EXECUTOR_OK;
+}
+
+int executorSetWakeHook(Executor* executor, ExecutorWakeFn wake, void* ctx) {
+    if (!executor) return -EINVAL;
+    executor->wake = wake;
+    executor->wake_ctx = ctx;
+    return EXECUTOR_OK;
+}
+
+/**
+ * @details
+ * The round-robin counter is only a hint, so it is advanced with a relaxed
+ * increment. A full ring falls through to the next worker; if every ring
+ * fails, `-ENOSPC` is reported only when all of them were full.
+ */
+int executorSubmit(Executor* executor, const Task* task) {
+    if (!executor || !task || !task->fn) return -EINVAL;
+    uint16_t start = INCREMENT_LOCK_VAL(&executor->next) % executor->worker_count;
+    int res = -ENOSPC;
+    for (uint16_t k = 0; k < executor->worker_count; k++) {
+        int tmp = submitTo(executor, (start + k) % executor->worker_count, task);
+        if (tmp >= EXECUTOR_OK) return tmp;
+        if (tmp != -ENOSPC) res = tmp;
+    }
+    return res;
+}
+
+int executorSubmitKeyed(Executor* executor, const Task* task, uint32_t key) {
+    if (!executor || !task || !task->fn) return -EINVAL;
+    return submitTo(executor, key % executor->worker_count, task);
+}
+
+/**
+ * @details
+ * Other rings are scanned starting with the next worker, so concurrent
+ * thieves spread out instead of converging on worker 0. A ring that is
+ * contended is skipped rather than waited on.
+ */
+int executorRun(Executor* executor, uint16_t worker) {
+    if (!executor || worker >= executor->worker_count) return -EINVAL;
+    ExecutorWorker* self = &executor->workers[worker];
+    if (self->reply_pending) {
+        int res = deliverReply(executor, self);
+        if (res < EXECUTOR_OK) return res;
+    }
+    Task task;
+    int res = bufferRead(&self->ring, &task);
+    for (uint16_t k = 1; res < BUFFER_OK && k < executor->worker_count; k++) {
+        res = bufferRead(&executor->workers[(worker + k) % executor->worker_count].ring, &task);
+    }
+    if (res < BUFFER_OK) return -EAGAIN;
+    int result = task.fn(task.arg);
+    if (executor->replies) {
+        self->reply = (TaskResult){ .tag = task.tag, .result = result };
+        self->reply_pending = true;
+        (void)deliverReply(executor, self);
+    }
+    return EXECUTOR_OK;
+}
+
+int executorPark(Executor* executor, uint16_t worker) {
+    if (!executor || worker >= executor->worker_count) return -EINVAL;
+    ExecutorWorker* self = &executor->workers[worker];
+    PUBLISH_LOCK_VAL(&self->idle, 1);
+    LOCK_FULL_FENCE();
+    if (!bufferIsEmpty(&self->ring)) {
+        uint32_t expected = 1;
+        (void)COMPARE_SET_LOCK(&self->idle, &expected, 0);
+        return -EAGAIN;
+    }
+    return EXECUTOR_OK;
+}
+
+ExecutorWord_t* executorIdleFlag(Executor* executor, uint16_t worker) {
+    if (!executor || worker >= executor->worker_count) return NULL;
+    return &executor->workers[worker].idle;
+}
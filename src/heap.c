@@ -0,0 +1,198 @@
+#include "heap.h"
+#include "locking.h"
+#include "copy.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+/* -- Private Functions --------------------------------------------------- */
+
+/**
+ * @brief Moves `entry` up from position `pos` until its parent is not larger.
+ */
+static void siftUp(HeapEntry* entries, uint16_t pos, HeapEntry entry) {
+    while (pos > 0) {
+        uint16_t parent = (uint16_t)((pos - 1) / HEAP_ARITY);
+        if (entries[parent].key <= entry.key) break;
+        entries[pos] = entries[parent];
+        pos = parent;
+    }
+    entries[pos] = entry;
+}
+
+/**
+ * @brief Moves `entry` down from position `pos` until no child is smaller.
+ *
+ * Only the keys of the children are compared; entries are moved once per
+ * level.
+ */
+static void siftDown(HeapEntry* entries, uint16_t count, uint16_t pos, HeapEntry entry) {
+    for (;;) {
+        uint32_t first = (uint32_t)pos * HEAP_ARITY + 1;
+        if (first >= count) break;
+        uint32_t last = first + HEAP_ARITY;
+        if (last > count) last = count;
+        uint32_t min = first;
+        for (uint32_t c = first + 1; c < last; c++) {
+            if (entries[c].key < entries[min].key) min = c;
+        }
+        if (entries[min].key >= entry.key) break;
+        entries[pos] = entries[min];
+        pos = (uint16_t)min;
+    }
+    entries[pos] = entry;
+}
+
+/**
+ * @brief Removes the root, copying its payload to `data`. The heap must not be empty.
+ */
+static void popRoot(Heap* heap, uint64_t* key, void* data) {
+    HeapEntry root = heap->entries[0];
+    heap->count -= 1;
+    if (heap->count > 0) {
+        siftDown(heap->entries, heap->count, 0, heap->entries[heap->count]);
+    }
+    // the vacated position past `count` keeps the freed payload slot
+    heap->entries[heap->count].slot = root.slot;
+    if (key) *key = root.key;
+    copyBytes(data, (uint8_t*)heap->raw + root.slot * heap->type_size, heap->type_size);
+}
+
+/* -- Public Functions ----------------------------------------------------- */
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @details
+ * Allocates the heap structure, its entry array, payload storage and lock
+ * from the provided BlockAllocator. If any allocation fails, all
+ * intermediate allocations are cleaned up to avoid leaks.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+Heap* heapAllocate(BlockAllocator* allocator, uint16_t size, uint16_t type_size) {
+    if (!allocator) return NULL;
+    if (size == 0 || type_size == 0) return NULL;
+    Heap* heap = (Heap*)blockAllocate(allocator, sizeof(Heap));
+    if (!heap) return NULL;
+    heap->entries = blockAllocate(allocator, size * sizeof(HeapEntry));
+    heap->raw = blockAllocate(allocator, size * type_size);
+    heap->lock = lockAllocate(allocator, 1);
+    if (!heap->entries || !heap->raw || !heap->lock) {
+        if (heap->entries) (void)blockDeallocate(allocator, heap->entries);
+        if (heap->raw) (void)blockDeallocate(allocator, heap->raw);
+        if (heap->lock) (void)lockDeallocate(allocator, &heap->lock);
+        (void)blockDeallocate(allocator, heap);
+        return NULL;
+    }
+    heap->size = size;
+    heap->type_size = type_size;
+    heapClear(heap);
+    return heap;
+}
+
+/**
+ * @details
+ * Frees the lock, payload storage, entry array and the heap structure
+ * itself. On success, the caller's heap pointer is set to NULL.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+int heapDeallocate(BlockAllocator* allocator, Heap** heap) {
+    if (!allocator || !heap || !(*heap)) return -EINVAL;
+    int res1 = lockDeallocate(allocator, &(*heap)->lock);
+    int res2 = blockDeallocate(allocator, (*heap)->raw);
+    int res3 = blockDeallocate(allocator, (*heap)->entries);
+    int res4 = blockDeallocate(allocator, *heap);
+    if (res1 != LOCK_OK) return res1;
+    if (res2 != BLOCK_ALLOCATOR_OK) return res2;
+    if (res3 != BLOCK_ALLOCATOR_OK) return res3;
+    if (res4 != BLOCK_ALLOCATOR_OK) return res4;
+    *heap = NULL;
+    return HEAP_OK;
+}
+#endif
+
+/**
+ * @details
+ * Resets the count and hands every payload slot back to the free area of
+ * the entry array.
+ */
+void heapClear(Heap* heap) {
+    if (!heap) return;
+    heap->count = 0;
+    for (uint16_t i = 0; i < heap->size; i++) {
+        heap->entries[i] = (HeapEntry){ .key = 0, .slot = i };
+    }
+}
+
+/**
+ * @details
+ * The payload is written into the free slot recorded at position `count`,
+ * then only the entry is sifted up.
+ */
+int heapPush(Heap* heap, uint64_t key, const void* data) {
+    if (!heap || !data) return -EINVAL;
+    if (!TAKE_HEAP_LOCK(heap->lock)) return -EBUSY;
+    if (heap->count == heap->size) {
+        CLEAR_HEAP_LOCK(heap->lock);
+        return -ENOSPC;
+    }
+    uint16_t slot = heap->entries[heap->count].slot;
+    copyBytes((uint8_t*)heap->raw + slot * heap->type_size, data, heap->type_size);
+    siftUp(heap->entries, heap->count, (HeapEntry){ .key = key, .slot = slot });
+    heap->count += 1;
+    CLEAR_HEAP_LOCK(heap->lock);
+    return HEAP_OK;
+}
+
+int heapPop(Heap* heap, uint64_t* key, void* data) {
+    if (!heap || !data) return -EINVAL;
+    if (!TAKE_HEAP_LOCK(heap->lock)) return -EBUSY;
+    if (heap->count == 0) {
+        CLEAR_HEAP_LOCK(heap->lock);
+        return -EAGAIN;
+    }
+    popRoot(heap, key, data);
+    CLEAR_HEAP_LOCK(heap->lock);
+    return HEAP_OK;
+}
+
+int heapPopBatch(Heap* heap, uint64_t limit, uint64_t* keys, void* data, uint16_t max_count) {
+    if (!heap || !data) return -EINVAL;
+    if (!TAKE_HEAP_LOCK(heap->lock)) return -EBUSY;
+    uint16_t n = 0;
+    uint8_t* out = (uint8_t*)data;
+    while (n < max_count && heap->count > 0 && heap->entries[0].key <= limit) {
+        popRoot(heap, keys ? &keys[n] : NULL, out);
+        out += heap->type_size;
+        n++;
+    }
+    CLEAR_HEAP_LOCK(heap->lock);
+    return n;
+}
+
+int heapPeek(Heap* heap, uint64_t* key) {
+    if (!heap || !key) return -EINVAL;
+    if (!TAKE_HEAP_LOCK(heap->lock)) return -EBUSY;
+    int res = HEAP_OK;
+    if (heap->count == 0) {
+        res = -EAGAIN;
+    } else {
+        *key = heap->entries[0].key;
+    }
+    CLEAR_HEAP_LOCK(heap->lock);
+    return res;
+}
+
+bool heapIsEmpty(const Heap* heap) {
+    return heap->count == 0;
+}
+
+bool heapIsFull(const Heap* heap) {
+    return heap->count == heap->size;
+}
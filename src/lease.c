@@ -0,0 +1,242 @@
+#include "lease.h"
+#include "queue.h"
+#include "buffer.h"
+#include "locking.h"
+#include "slot.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#define LEASE_EXPIRED   0x80000000u  // ticket flag: lease ended, slot owned by the redelivery ring
+#define LEASE_DELIVERY  0x0000FFFFu  // ticket bits holding the delivery count
+
+/* -- Private Functions --------------------------------------------------- */
+
+/**
+ * @brief Starts a lease on slot `index` and fills in `slot`.
+ *
+ * The expiry time is stored before the ticket is published, so a sweep that
+ * observes the ticket also observes its expiry time.
+ */
+static int startLease(LeaseQueue* queue, uint16_t index, uint16_t delivery, uint32_t now, LeaseSlot* slot) {
+    SET_LOCK_VAL(&queue->due[index], now + queue->lease);
+    PUBLISH_LOCK_VAL(&queue->ticket[index], delivery);
+    Buffer* buffer = queue->queue->slot_buffer;
+    *slot = (LeaseSlot){
+        .data = slotAddr(buffer, index),
+        .len = queue->queue->msg_len[index],
+        .index = index,
+        .delivery = delivery,
+    };
+    return index;
+}
+
+/**
+ * @brief Hands an ended lease over to the redelivery ring.
+ *
+ * The ring holds one entry per slot, so it cannot be full.
+ */
+static void redeliver(LeaseQueue* queue, uint16_t index) {
+    while (bufferWrite(queue->redeliver, &index) == -EBUSY);
+}
+
+/**
+ * @brief Leases the next message waiting for redelivery.
+ */
+static int claimRedelivery(LeaseQueue* queue, uint32_t now, LeaseSlot* slot) {
+    if (bufferIsEmpty(queue->redeliver)) return -EAGAIN;
+    uint16_t index;
+    int res = bufferRead(queue->redeliver, &index);
+    if (res < BUFFER_OK) return res;
+    Buffer* buffer = queue->queue->slot_buffer;
+    uint32_t ticket = GET_LOCK_VAL(&queue->ticket[index]);
+    // a message discarded by a clear of the queue is dropped, not redelivered
+    uint8_t epoch = GET_LOCK_VAL(&buffer->epoch);
+    uint8_t expected = slotTag(epoch, BUFFER_LEASED);
+    if (!EXPECT_SLOT_STATE(buffer->lock, index, &expected, expected)) {
+        PUBLISH_LOCK_VAL(&queue->ticket[index], 0);
+        (void)slotRelease(buffer, index, BUFFER_LEASED, BUFFER_FREE);
+        return -EBUSY;
+    }
+    uint16_t delivery = (uint16_t)((ticket & LEASE_DELIVERY) + 1);
+    if (delivery == 0) delivery = 1;
+    return startLease(queue, index, delivery, now, slot);
+}
+
+/**
+ * @brief Leases the message at the tail of the queue.
+ */
+static int claimNew(LeaseQueue* queue, uint32_t now, LeaseSlot* slot) {
+    uint8_t* data;
+    uint16_t len;
+    int res = queueReadClaim(queue->queue, &data, &len);
+    if (res < QUEUE_OK) return res;
+    uint16_t index = (uint16_t)res;
+    res = slotRelease(queue->queue->slot_buffer, index, BUFFER_READING, BUFFER_LEASED);
+    // the queue was cleared since the claim and the slot has been freed
+    if (res < BUFFER_OK) return -EBUSY;
+    return startLease(queue, index, 1, now, slot);
+}
+
+/**
+ * @brief Ends the lease of `slot` by replacing its ticket with `ticket`.
+ */
+static int endLease(LeaseQueue* queue, const LeaseSlot* slot, uint32_t ticket) {
+    uint32_t expected = slot->delivery;
+    if (COMPARE_SET_LOCK(&queue->ticket[slot->index], &expected, ticket)) return LEASE_OK;
+    return (expected == 0) ? -EPERM : -ETIMEDOUT;
+}
+
+/* -- Public Functions ----------------------------------------------------- */
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Releases every allocation owned by a (possibly partially built) lease queue.
+ */
+static int leaseQueueRelease(BlockAllocator* allocator, LeaseQueue* queue) {
+    int res = LEASE_OK;
+    int tmp;
+    if (queue->queue) {
+        tmp = queueDeallocate(allocator, &queue->queue);
+        if (tmp != QUEUE_OK) res = tmp;
+    }
+    if (queue->redeliver) {
+        tmp = bufferDeallocate(allocator, &queue->redeliver);
+        if (tmp != BUFFER_OK) res = tmp;
+    }
+    if (queue->ticket) {
+        tmp = blockDeallocate(allocator, queue->ticket);
+        if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+    }
+    if (queue->due) {
+        tmp = blockDeallocate(allocator, queue->due);
+        if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+    }
+    tmp = blockDeallocate(allocator, queue);
+    if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+    return res;
+}
+
+/**
+ * @details
+ * Allocates the lease queue, the underlying queue, the redelivery ring and
+ * the per-slot lease records. If any allocation fails, everything allocated
+ * so far is released.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+LeaseQueue* leaseQueueAllocate(BlockAllocator* allocator, uint16_t slot_len, uint16_t size, uint32_t lease) {
+    if (!allocator) return NULL;
+    if (slot_len == 0 || size == 0) return NULL;
+    LeaseQueue* queue = (LeaseQueue*)blockAllocate(allocator, sizeof(LeaseQueue));
+    if (!queue) return NULL;
+    *queue = (LeaseQueue){ .lease = lease };
+    queue->queue = queueAllocate(allocator, slot_len, size);
+    queue->redeliver = bufferAllocate(allocator, size, sizeof(uint16_t));
+    queue->ticket = blockAllocate(allocator, size * sizeof(LeaseWord_t));
+    queue->due = blockAllocate(allocator, size * sizeof(LeaseWord_t));
+    if (!queue->queue || !queue->redeliver || !queue->ticket || !queue->due) {
+        (void)leaseQueueRelease(allocator, queue);
+        return NULL;
+    }
+    leaseQueueClear(queue);
+    return queue;
+}
+
+/**
+ * @details
+ * Frees the underlying queue, the redelivery ring, the lease records and the
+ * lease queue struct itself. On success, sets the queue pointer to NULL.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+int leaseQueueDeallocate(BlockAllocator* allocator, LeaseQueue** queue) {
+    if (!allocator || !queue || !(*queue)) return -EINVAL;
+    int res = leaseQueueRelease(allocator, *queue);
+    if (res != LEASE_OK) return res;
+    *queue = NULL;
+    return LEASE_OK;
+}
+#endif
+
+/**
+ * @details
+ * Clears the underlying queue and the redelivery ring, and frees every slot
+ * that is still leased.
+ */
+void leaseQueueClear(LeaseQueue* queue) {
+    if (!queue) return;
+    Buffer* buffer = queue->queue->slot_buffer;
+    queueClear(queue->queue);
+    bufferClear(queue->redeliver);
+    for (uint16_t i = 0; i < buffer->size; i++) {
+        PUBLISH_LOCK_VAL(&queue->ticket[i], 0);
+        SET_LOCK_VAL(&queue->due[i], 0);
+        uint8_t state = GET_SLOT_STATE(buffer->lock, i);
+        if (slotKind(state) == BUFFER_LEASED) {
+            SET_SLOT_STATE(buffer->lock, i, slotTag(slotEpoch(state), BUFFER_FREE));
+        }
+    }
+    PUBLISH_LOCK_VAL(&queue->scan, 0);
+}
+
+int leaseQueueClaim(LeaseQueue* queue, uint32_t now, LeaseSlot* slot) {
+    if (!queue || !slot) return -EINVAL;
+    int res = claimRedelivery(queue, now, slot);
+    if (res != -EAGAIN) return res;
+    res = claimNew(queue, now, slot);
+    if (res != -EAGAIN) return res;
+    // only idle consumers sweep, keeping the scan off the busy path
+    if (leaseQueueExpire(queue, now, LEASE_SCAN_STEP) > 0) {
+        return claimRedelivery(queue, now, slot);
+    }
+    return -EAGAIN;
+}
+
+int leaseQueueAck(LeaseQueue* queue, const LeaseSlot* slot) {
+    if (!queue || !slot || slot->delivery == 0) return -EINVAL;
+    if (slot->index >= queue->queue->slot_buffer->size) return -EINVAL;
+    int res = endLease(queue, slot, 0);
+    if (res < LEASE_OK) return res;
+    // a slot discarded by a clear of the queue is freed all the same
+    res = slotRelease(queue->queue->slot_buffer, slot->index, BUFFER_LEASED, BUFFER_FREE);
+    return (res == -ESTALE) ? LEASE_OK : res;
+}
+
+int leaseQueueNack(LeaseQueue* queue, const LeaseSlot* slot) {
+    if (!queue || !slot || slot->delivery == 0) return -EINVAL;
+    if (slot->index >= queue->queue->slot_buffer->size) return -EINVAL;
+    int res = endLease(queue, slot, slot->delivery | LEASE_EXPIRED);
+    if (res < LEASE_OK) return res;
+    redeliver(queue, slot->index);
+    return LEASE_OK;
+}
+
+/**
+ * @details
+ * The sweep position is advanced with a relaxed increment, so concurrent
+ * sweeps examine different slots. An expired lease is claimed for the
+ * redelivery ring with a compare-and-set on its ticket, which fails if the
+ * consumer acks or nacks it at the same time.
+ */
+int leaseQueueExpire(LeaseQueue* queue, uint32_t now, uint16_t max_count) {
+    if (!queue) return -EINVAL;
+    uint16_t size = queue->queue->slot_buffer->size;
+    if (max_count > size) max_count = size;
+    int expired = 0;
+    for (uint16_t k = 0; k < max_count; k++) {
+        uint16_t index = (uint16_t)(INCREMENT_LOCK_VAL(&queue->scan) % size);
+        uint32_t ticket = GET_LOCK_VAL(&queue->ticket[index]);
+        if (ticket == 0 || (ticket & LEASE_EXPIRED)) continue;
+        if ((int32_t)(now - GET_LOCK_VAL(&queue->due[index])) < 0) continue;
+        if (!COMPARE_SET_LOCK(&queue->ticket[index], &ticket, ticket | LEASE_EXPIRED)) continue;
+        redeliver(queue, index);
+        expired++;
+    }
+    return expired;
+}
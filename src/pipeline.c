@@ -0,0 +1,414 @@
+#ifdef USE_THREADS
+#define _GNU_SOURCE
+#endif
+#include "pipeline.h"
+#include "buffer.h"
+#include "locking.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#ifdef USE_THREADS
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+/* -- Private Functions --------------------------------------------------- */
+
+/**
+ * @brief Reserves up to `max_count` credits on a stage's ring.
+ *
+ * @return Number of credits reserved, 0 if the ring has none left.
+ */
+static uint16_t reserveCredits(PipelineStage* stage, uint16_t max_count) {
+    uint32_t credits = GET_LOCK_VAL(&stage->credits);
+    while (credits > 0) {
+        uint32_t take = (credits < max_count) ? credits : max_count;
+        if (COMPARE_SET_LOCK(&stage->credits, &credits, credits - take)) return (uint16_t)take;
+    }
+    return 0;
+}
+
+/**
+ * @brief Claims a slot of a ring for which a credit is held.
+ *
+ * The credit guarantees a free slot, but the slot at the head may still be
+ * released by a reader of an earlier lap, so a contended claim is retried.
+ */
+static int claimCredited(Buffer* ring, void** out_addr) {
+    int res;
+    while ((res = bufferWriteClaim(ring, out_addr)) == -EBUSY);
+    return res;
+}
+
+/**
+ * @brief Checks whether the stage preceding `stage` will deliver no more elements.
+ */
+static bool upstreamDone(Pipeline* pipeline, uint16_t stage) {
+    if (stage == 0) return GET_LOCK_VAL(&pipeline->closed) != 0;
+    return GET_LOCK_VAL(&pipeline->stages[stage - 1].done) != 0;
+}
+
+/**
+ * @brief Marks a stage done if its upstream is done and nothing is left in or behind its ring.
+ *
+ * The caller is counted in `active`. Any other runner that took an element
+ * registered in `active` before its claim, so an empty ring together with
+ * `active == 1` means no element is still on its way to the next ring.
+ */
+static bool tryFinish(Pipeline* pipeline, uint16_t stage) {
+    PipelineStage* self = &pipeline->stages[stage];
+    if (!upstreamDone(pipeline, stage)) return false;
+    LOCK_FULL_FENCE();
+    if (!bufferIsEmpty(&self->input) || GET_LOCK_VAL(&self->active) != 1) return false;
+    PUBLISH_LOCK_VAL(&self->done, 1);
+    return true;
+}
+
+/**
+ * @brief Default state of a stage using ring `input`.
+ */
+static PipelineStage stageDefaults(Buffer input) {
+    return (PipelineStage){ .input = input, .batch = 1, .threads = 1, .cpu = PIPELINE_CPU_ANY };
+}
+
+/**
+ * @brief Leaves a run that found the stage's ring empty.
+ *
+ * @return `-EPIPE` if the stage has finished, otherwise `-EAGAIN`.
+ */
+static int idle(Pipeline* pipeline, uint16_t stage) {
+    PipelineStage* self = &pipeline->stages[stage];
+    bool finished = tryFinish(pipeline, stage);
+    (void)SUB_LOCK_VAL(&self->active, 1);
+    return finished ? -EPIPE : -EAGAIN;
+}
+
+/* -- Public Functions ----------------------------------------------------- */
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Releases every allocation owned by a (possibly partially built) pipeline.
+ */
+static int pipelineRelease(BlockAllocator* allocator, Pipeline* pipeline) {
+    int res = PIPELINE_OK;
+    int tmp;
+    if (pipeline->stages) {
+        for (uint16_t s = 0; s < pipeline->stage_count; s++) {
+            if (!pipeline->stages[s].input.lock) continue;
+            tmp = lockDeallocate(allocator, &pipeline->stages[s].input.lock);
+            if (tmp != LOCK_OK) res = tmp;
+        }
+        if (pipeline->stages[0].input.raw) {
+            tmp = blockDeallocate(allocator, pipeline->stages[0].input.raw);
+            if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+        }
+        tmp = blockDeallocate(allocator, pipeline->stages);
+        if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+    }
+    tmp = blockDeallocate(allocator, pipeline);
+    if (tmp != BLOCK_ALLOCATOR_OK) res = tmp;
+    return res;
+}
+
+/**
+ * @details
+ * Allocates the pipeline, the stage states, a single block holding every
+ * stage's ring storage and one lock per ring. If any allocation fails,
+ * everything allocated so far is released.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+Pipeline* pipelineAllocate(BlockAllocator* allocator, uint16_t stage_count, uint16_t depth, uint16_t type_size) {
+    if (!allocator) return NULL;
+    if (stage_count == 0 || depth == 0 || type_size == 0) return NULL;
+    Pipeline* pipeline = (Pipeline*)blockAllocate(allocator, sizeof(Pipeline));
+    if (!pipeline) return NULL;
+    *pipeline = (Pipeline){ .stage_count = stage_count };
+    pipeline->stages = blockAllocate(allocator, stage_count * sizeof(PipelineStage));
+    if (!pipeline->stages) {
+        (void)pipelineRelease(allocator, pipeline);
+        return NULL;
+    }
+    for (uint16_t s = 0; s < stage_count; s++) {
+        pipeline->stages[s] = stageDefaults((Buffer){ .size = depth, .type_size = type_size });
+    }
+    uint8_t* ring_raw = blockAllocate(allocator, stage_count * depth * type_size);
+    if (!ring_raw) {
+        (void)pipelineRelease(allocator, pipeline);
+        return NULL;
+    }
+    for (uint16_t s = 0; s < stage_count; s++) {
+        pipeline->stages[s].input.raw = ring_raw + s * depth * type_size;
+        pipeline->stages[s].input.lock = lockAllocate(allocator, depth);
+        if (!pipeline->stages[s].input.lock) {
+            (void)pipelineRelease(allocator, pipeline);
+            return NULL;
+        }
+    }
+    pipelineClear(pipeline);
+    return pipeline;
+}
+
+/**
+ * @details
+ * Frees every stage ring, the stage states and the pipeline struct itself.
+ * On success, sets the pipeline pointer to NULL.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+int pipelineDeallocate(BlockAllocator* allocator, Pipeline** pipeline) {
+    if (!allocator || !pipeline || !(*pipeline)) return -EINVAL;
+    int res = pipelineRelease(allocator, *pipeline);
+    if (res != PIPELINE_OK) return res;
+    *pipeline = NULL;
+    return PIPELINE_OK;
+}
+#endif
+
+/**
+ * @details
+ * Stage `s` uses the `s`-th `depth * type_size` bytes of `raw`, lock
+ * `locks[s]` and the `s`-th `depth` slot states.
+ */
+int pipelineInit(Pipeline* pipeline, uint16_t depth, uint16_t type_size,
+                 uint8_t* raw, Lock_t* locks, LockState_t* states) {
+    if (!pipeline || !pipeline->stages || !raw || !locks || !states) return -EINVAL;
+    if (pipeline->stage_count == 0 || depth == 0 || type_size == 0) return -EINVAL;
+    for (uint16_t s = 0; s < pipeline->stage_count; s++) {
+        INIT_LOCK(&locks[s], states + (uint32_t)s * depth, depth);
+        pipeline->stages[s] = stageDefaults((Buffer){
+            .size = depth,
+            .type_size = type_size,
+            .raw = raw + (uint32_t)s * depth * type_size,
+            .lock = &locks[s],
+        });
+    }
+    pipelineClear(pipeline);
+    return PIPELINE_OK;
+}
+
+/**
+ * @details
+ * Clears every stage ring and restores its credits to the full ring depth.
+ */
+void pipelineClear(Pipeline* pipeline) {
+    if (!pipeline) return;
+    for (uint16_t s = 0; s < pipeline->stage_count; s++) {
+        PipelineStage* stage = &pipeline->stages[s];
+        bufferClear(&stage->input);
+        PUBLISH_LOCK_VAL(&stage->credits, stage->input.size);
+        PUBLISH_LOCK_VAL(&stage->active, 0);
+        PUBLISH_LOCK_VAL(&stage->done, 0);
+        PUBLISH_LOCK_VAL(&stage->processed, 0);
+        PUBLISH_LOCK_VAL(&stage->batches, 0);
+        PUBLISH_LOCK_VAL(&stage->stalls, 0);
+    }
+    PUBLISH_LOCK_VAL(&pipeline->closed, 0);
+}
+
+int pipelineSetStage(Pipeline* pipeline, uint16_t stage, StageFn fn, void* ctx, uint16_t batch) {
+    if (!pipeline || stage >= pipeline->stage_count || !fn) return -EINVAL;
+    PipelineStage* self = &pipeline->stages[stage];
+    if (batch == 0 || batch > self->input.size) return -EINVAL;
+    self->fn = fn;
+    self->ctx = ctx;
+    self->batch = batch;
+    return PIPELINE_OK;
+}
+
+int pipelineSetThreads(Pipeline* pipeline, uint16_t stage, uint16_t threads, int16_t cpu) {
+    if (!pipeline || stage >= pipeline->stage_count) return -EINVAL;
+    if (threads == 0 || cpu < PIPELINE_CPU_ANY) return -EINVAL;
+    pipeline->stages[stage].threads = threads;
+    pipeline->stages[stage].cpu = cpu;
+    return PIPELINE_OK;
+}
+
+int pipelinePush(Pipeline* pipeline, const void* data) {
+    if (!pipeline || !data) return -EINVAL;
+    if (GET_LOCK_VAL(&pipeline->closed)) return -EPIPE;
+    PipelineStage* first = &pipeline->stages[0];
+    if (reserveCredits(first, 1) == 0) return -ENOSPC;
+    int res;
+    while ((res = bufferWrite(&first->input, data)) == -EBUSY);
+    return (res < BUFFER_OK) ? res : PIPELINE_OK;
+}
+
+void pipelineClose(Pipeline* pipeline) {
+    if (!pipeline) return;
+    PUBLISH_LOCK_VAL(&pipeline->closed, 1);
+}
+
+/**
+ * @details
+ * Each element is mapped straight from its slot in the stage's ring into a
+ * claimed slot of the next ring, so it is copied once per hop by the stage
+ * function itself. Unused credits and the credits of the consumed slots are
+ * returned once at the end of the batch.
+ */
+int pipelineRun(Pipeline* pipeline, uint16_t stage) {
+    if (!pipeline || stage >= pipeline->stage_count) return -EINVAL;
+    PipelineStage* self = &pipeline->stages[stage];
+    if (!self->fn) return -EINVAL;
+    if (GET_LOCK_VAL(&self->done)) return -EPIPE;
+    PipelineStage* next = (stage + 1 < pipeline->stage_count) ? &pipeline->stages[stage + 1] : NULL;
+    (void)ADD_LOCK_VAL(&self->active, 1);
+    // an empty ring neither reserves downstream credit nor counts as a stall
+    if (bufferIsEmpty(&self->input)) return idle(pipeline, stage);
+    uint16_t credits = self->batch;
+    if (next) {
+        credits = reserveCredits(next, self->batch);
+        if (credits == 0) {
+            (void)INCREMENT_LOCK_VAL(&self->stalls);
+            (void)SUB_LOCK_VAL(&self->active, 1);
+            return -ENOSPC;
+        }
+    }
+    uint16_t count = 0;
+    int res = BUFFER_OK;
+    while (count < credits) {
+        void* in;
+        res = bufferReadClaim(&self->input, &in);
+        if (res < BUFFER_OK) break;
+        uint16_t in_index = (uint16_t)res;
+        void* out = NULL;
+        int out_index = -EINVAL;
+        if (next) out_index = claimCredited(&next->input, &out);
+        self->fn(self->ctx, (out_index >= BUFFER_OK) ? out : NULL, in);
+        if (out_index >= BUFFER_OK) (void)bufferWriteRelease(&next->input, (uint16_t)out_index);
+        (void)bufferReadRelease(&self->input, in_index);
+        count++;
+    }
+    if (next && count < credits) (void)ADD_LOCK_VAL(&next->credits, credits - count);
+    if (count > 0) {
+        (void)ADD_LOCK_VAL(&self->credits, count);
+        (void)ADD_LOCK_VAL(&self->processed, count);
+        (void)INCREMENT_LOCK_VAL(&self->batches);
+        (void)SUB_LOCK_VAL(&self->active, 1);
+        return count;
+    }
+    if (res == -EAGAIN) return idle(pipeline, stage);
+    (void)SUB_LOCK_VAL(&self->active, 1);
+    // a contended ring is reported like an empty one; the runner simply retries
+    return (res == -EBUSY) ? -EAGAIN : res;
+}
+
+int pipelineStats(Pipeline* pipeline, uint16_t stage, PipelineStats* stats) {
+    if (!pipeline || stage >= pipeline->stage_count || !stats) return -EINVAL;
+    PipelineStage* self = &pipeline->stages[stage];
+    *stats = (PipelineStats){
+        .processed = GET_LOCK_VAL(&self->processed),
+        .batches = GET_LOCK_VAL(&self->batches),
+        .stalls = GET_LOCK_VAL(&self->stalls),
+        .depth = (uint16_t)(self->input.size - GET_LOCK_VAL(&self->credits)),
+    };
+    return PIPELINE_OK;
+}
+
+#ifdef USE_THREADS
+/**
+ * @brief Thread body of a `PipelineWorker`: runs its stage until it has drained.
+ */
+static void* stageWorker(void* arg) {
+    PipelineWorker* worker = (PipelineWorker*)arg;
+    int res;
+    while ((res = pipelineRun(worker->pipeline, worker->stage)) != -EPIPE) {
+        if (GET_LOCK_VAL(worker->stop)) {
+            res = -ECANCELED;
+            break;
+        }
+        if (res == -EAGAIN || res == -ENOSPC) {
+            sched_yield();
+        } else if (res < 0) {
+            break;
+        }
+    }
+    worker->status = (res == -EPIPE) ? PIPELINE_OK : res;
+    return NULL;
+}
+
+/**
+ * @brief Starts `worker`, pinned to `cpu` unless it is `PIPELINE_CPU_ANY`.
+ *
+ * @return `PIPELINE_OK`, or the negated error of the pthread call that failed.
+ */
+static int startWorker(PipelineWorker* worker, int cpu) {
+    pthread_attr_t attr;
+    int res = pthread_attr_init(&attr);
+    if (res != 0) return -res;
+    if (cpu != PIPELINE_CPU_ANY) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        res = pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+#else
+        res = ENOTSUP;
+#endif
+    }
+    if (res == 0) res = pthread_create(&worker->thread, &attr, stageWorker, worker);
+    (void)pthread_attr_destroy(&attr);
+    return -res;
+}
+
+/**
+ * @details
+ * Threads are started stage by stage, so the workers of a stage are
+ * consecutive in `runner->workers`.
+ *
+ * @note
+ * This function is only available if `USE_THREADS` is defined.
+ */
+int pipelineStart(Pipeline* pipeline, PipelineRunner* runner) {
+    if (!pipeline || !runner || !runner->workers || runner->count > 0) return -EINVAL;
+    PUBLISH_LOCK_VAL(&runner->stop, 0);
+    uint32_t total = 0;
+    for (uint16_t s = 0; s < pipeline->stage_count; s++) {
+        if (!pipeline->stages[s].fn) return -EINVAL;
+        total += pipeline->stages[s].threads;
+    }
+    if (total > runner->capacity) return -ENOSPC;
+    for (uint16_t s = 0; s < pipeline->stage_count; s++) {
+        PipelineStage* stage = &pipeline->stages[s];
+        for (uint16_t t = 0; t < stage->threads; t++) {
+            PipelineWorker* worker = &runner->workers[runner->count];
+            *worker = (PipelineWorker){
+                .pipeline = pipeline,
+                .stop = &runner->stop,
+                .stage = s,
+                .status = PIPELINE_OK,
+            };
+            int cpu = (stage->cpu == PIPELINE_CPU_ANY) ? PIPELINE_CPU_ANY : stage->cpu + t;
+            int res = startWorker(worker, cpu);
+            if (res < PIPELINE_OK) {
+                // with a stage short of threads the pipeline would never drain
+                PUBLISH_LOCK_VAL(&runner->stop, 1);
+                (void)pipelineJoin(runner);
+                return res;
+            }
+            runner->count++;
+        }
+    }
+    return PIPELINE_OK;
+}
+
+/**
+ * @note
+ * This function is only available if `USE_THREADS` is defined.
+ */
+int pipelineJoin(PipelineRunner* runner) {
+    if (!runner) return -EINVAL;
+    int res = PIPELINE_OK;
+    for (uint16_t w = 0; w < runner->count; w++) {
+        (void)pthread_join(runner->workers[w].thread, NULL);
+        if (res == PIPELINE_OK) res = runner->workers[w].status;
+    }
+    runner->count = 0;
+    return res;
+}
+#endif
@@ -19,11 +19,27 @@
  * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
  */
 Queue* queueAllocate(BlockAllocator* allocator, uint16_t slot_len, uint16_t size) {
+    return queueAllocateAligned(allocator, slot_len, size, 0);
+}
+
+/**
+ * @details
+ * As `queueAllocate()`, with the slot buffer allocated by
+ * `bufferAllocateAligned()`. An `align` of 0 selects packed slots.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+Queue* queueAllocateAligned(BlockAllocator* allocator, uint16_t slot_len, uint16_t size, uint16_t align) {
     if (!allocator) return NULL;
     if (slot_len == 0 || size == 0) return NULL;
     Queue* queue = (Queue*)blockAllocate(allocator, sizeof(Queue));
     if (!queue) return NULL;
-    queue->slot_buffer = bufferAllocate(allocator, size, slot_len * sizeof(uint8_t));
+    if (align) {
+        queue->slot_buffer = bufferAllocateAligned(allocator, size, slot_len * sizeof(uint8_t), align);
+    } else {
+        queue->slot_buffer = bufferAllocate(allocator, size, slot_len * sizeof(uint8_t));
+    }
     if (!(queue->slot_buffer)) {
         (void)blockDeallocate(allocator, queue);
         return NULL;
@@ -63,21 +79,26 @@ int queueDeallocate(BlockAllocator* allocator, Queue** queue) {
 
 /**
  * @details
- * Resets the internal state of the queue, effectively clearing all messages.
- * - All stored message lengths are set to zero.
- * - The underlying circular buffer is cleared.
+ * Clears the underlying circular buffer in O(1). Message lengths are left in
+ * place: every slot gets a new length before it is published again.
  * 
  * @note
  * Does not free or reallocate memory.
  */
 void queueClear(Queue* queue) {
     if (!queue) return;
-    for (uint16_t i = 0; i < queue->slot_buffer->size; i++) {
-        queue->msg_len[i] = 0;
-    }
     bufferClear(queue->slot_buffer);
 }
 
+uint16_t queueStride(const Queue* queue) {
+    return bufferStride(queue->slot_buffer);
+}
+
+int queueSetWatermark(Queue* queue, Watermark* watermark) {
+    if (!queue) return -EINVAL;
+    return bufferSetWatermark(queue->slot_buffer, watermark);
+}
+
 /**
  * @details
  * Checks if the queue currently holds no messages.
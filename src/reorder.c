@@ -0,0 +1,255 @@
+#include "reorder.h"
+#include "buffer.h"
+#include "locking.h"
+#include "slot.h"
+#include "copy.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+/* -- Private Functions --------------------------------------------------- */
+
+/**
+ * @brief Slot index of sequence `seq`.
+ */
+static inline uint16_t slotOf(const ReorderBuffer* reorder, uint32_t seq) {
+    return (uint16_t)(seq % reorder->ring.size);
+}
+
+/**
+ * @brief Moves the slot of the next expected sequence from ready to reading.
+ *
+ * Must be called with the read lock held. On success the next expected
+ * sequence is advanced and its old value stored in `seq`.
+ */
+static int claimNext(ReorderBuffer* reorder, uint32_t* seq) {
+    Buffer* ring = &reorder->ring;
+    uint32_t next = GET_LOCK_VAL(&reorder->next);
+    uint16_t index = slotOf(reorder, next);
+    uint8_t epoch = GET_LOCK_VAL(&ring->epoch);
+    uint8_t expected = slotTag(epoch, BUFFER_READY);
+    if (!EXPECT_SLOT_STATE(ring->lock, index, &expected, slotTag(epoch, BUFFER_READING))) {
+        return -EAGAIN;
+    }
+    // writers of `next + size` see the window open but the slot busy until it is freed
+    PUBLISH_LOCK_VAL(&reorder->next, next + 1);
+    *seq = next;
+    return index;
+}
+
+/**
+ * @brief Wakes the parked consumer if slot `index` holds the sequence it waits for.
+ *
+ * The full fence pairs with the one in `reorderPark()`: either the consumer
+ * sees the slot ready when it re-checks it, or the producer sees the wait
+ * flag and wakes it.
+ */
+static void wakeConsumer(ReorderBuffer* reorder, uint16_t index) {
+    LOCK_FULL_FENCE();
+    if (slotOf(reorder, GET_LOCK_VAL(&reorder->next)) != index) return;
+    uint32_t expected = 1;
+    if (GET_LOCK_VAL(&reorder->waiting) && COMPARE_SET_LOCK(&reorder->waiting, &expected, 0)) {
+        reorder->wake(reorder->wake_ctx);
+    }
+}
+
+/* -- Public Functions ----------------------------------------------------- */
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @details
+ * Allocates the reorder buffer structure, its element storage and the slot
+ * lock. If any allocation fails, all intermediate allocations are cleaned up.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+ReorderBuffer* reorderAllocate(BlockAllocator* allocator, uint16_t size, uint16_t type_size) {
+    if (!allocator) return NULL;
+    if (size == 0 || type_size == 0) return NULL;
+    ReorderBuffer* reorder = (ReorderBuffer*)blockAllocate(allocator, sizeof(ReorderBuffer));
+    if (!reorder) return NULL;
+    *reorder = (ReorderBuffer){ .ring = { .size = size, .type_size = type_size } };
+    reorder->ring.raw = blockAllocate(allocator, size * type_size);
+    if (!reorder->ring.raw) {
+        (void)blockDeallocate(allocator, reorder);
+        return NULL;
+    }
+    reorder->ring.lock = lockAllocate(allocator, size);
+    if (!reorder->ring.lock) {
+        (void)blockDeallocate(allocator, reorder->ring.raw);
+        (void)blockDeallocate(allocator, reorder);
+        return NULL;
+    }
+    return reorder;
+}
+
+/**
+ * @details
+ * Frees the slot lock, the element storage and the reorder buffer structure
+ * itself. On success, sets the reorder buffer pointer to NULL.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+int reorderDeallocate(BlockAllocator* allocator, ReorderBuffer** reorder) {
+    if (!allocator || !reorder || !(*reorder)) return -EINVAL;
+    int res1 = lockDeallocate(allocator, &(*reorder)->ring.lock);
+    int res2 = blockDeallocate(allocator, (*reorder)->ring.raw);
+    int res3 = blockDeallocate(allocator, *reorder);
+    if (res1 != LOCK_OK) return res1;
+    if (res2 != BLOCK_ALLOCATOR_OK) return res2;
+    if (res3 != BLOCK_ALLOCATOR_OK) return res3;
+    *reorder = NULL;
+    return REORDER_OK;
+}
+#endif
+
+/**
+ * @details
+ * Advances the epoch of the ring with `bufferClear()`, which invalidates
+ * every ready slot at once, then publishes the new window start under the
+ * read lock.
+ */
+void reorderClear(ReorderBuffer* reorder, uint32_t first) {
+    if (!reorder) return;
+    bufferClear(&reorder->ring);
+    while (!TAKE_READ_LOCK(reorder->ring.lock));
+    PUBLISH_LOCK_VAL(&reorder->next, first);
+    CLEAR_READ_LOCK(reorder->ring.lock);
+}
+
+uint32_t reorderNext(const ReorderBuffer* reorder) {
+    return GET_LOCK_VAL(&reorder->next);
+}
+
+bool reorderIsReady(const ReorderBuffer* reorder) {
+    uint16_t index = slotOf(reorder, GET_LOCK_VAL(&reorder->next));
+    uint8_t epoch = GET_LOCK_VAL(&reorder->ring.epoch);
+    return GET_SLOT_STATE(reorder->ring.lock, index) == slotTag(epoch, BUFFER_READY);
+}
+
+int reorderSetWakeHook(ReorderBuffer* reorder, ReorderWakeFn wake, void* ctx) {
+    if (!reorder) return -EINVAL;
+    reorder->wake = wake;
+    reorder->wake_ctx = ctx;
+    return REORDER_OK;
+}
+
+/**
+ * @details
+ * The window check uses wrapping arithmetic, so sequence numbers may roll
+ * over. Within the window every sequence has its own slot, so the claim is
+ * a single compare-and-set on the slot state. A slot left ready by a clear
+ * carries an older epoch and is as good as free.
+ */
+int reorderWriteClaim(ReorderBuffer* reorder, uint32_t seq, void** out_addr) {
+    if (!reorder || !out_addr) return -EINVAL;
+    Buffer* ring = &reorder->ring;
+    uint32_t ahead = seq - GET_LOCK_VAL(&reorder->next);
+    if (ahead >= ring->size) {
+        return ((int32_t)ahead < 0) ? -EINVAL : -ENOSPC;
+    }
+    uint16_t index = slotOf(reorder, seq);
+    uint8_t epoch = GET_LOCK_VAL(&ring->epoch);
+    uint8_t expected = GET_SLOT_STATE(ring->lock, index);
+    BufferState kind = slotKind(expected);
+    bool reusable = (kind == BUFFER_FREE) || (kind == BUFFER_READY && slotEpoch(expected) != epoch);
+    if (!reusable ||
+        !EXPECT_SLOT_STATE(ring->lock, index, &expected, slotTag(epoch, BUFFER_CLAIMED))) {
+        return -EBUSY;
+    }
+    *out_addr = slotAddr(ring, index);
+    return index;
+}
+
+int reorderWriteRelease(ReorderBuffer* reorder, uint16_t index) {
+    if (!reorder || index >= reorder->ring.size) return -EINVAL;
+    int res = slotRelease(&reorder->ring, index, BUFFER_CLAIMED, BUFFER_READY);
+    if (res < BUFFER_OK) return res;
+    if (reorder->wake) wakeConsumer(reorder, index);
+    return REORDER_OK;
+}
+
+int reorderWrite(ReorderBuffer* reorder, uint32_t seq, const void* data) {
+    if (!reorder || !data) return -EINVAL;
+    void* addr;
+    int res = reorderWriteClaim(reorder, seq, &addr);
+    if (res < REORDER_OK) return res;
+    copyBytes(addr, data, reorder->ring.type_size);
+    int tmp = reorderWriteRelease(reorder, (uint16_t)res);
+    if (tmp < REORDER_OK) return tmp;
+    return res;
+}
+
+int reorderReadClaim(ReorderBuffer* reorder, void** out_addr, uint32_t* seq) {
+    if (!reorder || !out_addr) return -EINVAL;
+    if (!TAKE_READ_LOCK(reorder->ring.lock)) return -EBUSY;
+    uint32_t next;
+    int res = claimNext(reorder, &next);
+    CLEAR_READ_LOCK(reorder->ring.lock);
+    if (res < REORDER_OK) return res;
+    *out_addr = slotAddr(&reorder->ring, (uint16_t)res);
+    if (seq) *seq = next;
+    return res;
+}
+
+int reorderReadRelease(ReorderBuffer* reorder, uint16_t index) {
+    if (!reorder || index >= reorder->ring.size) return -EINVAL;
+    int res = slotRelease(&reorder->ring, index, BUFFER_READING, BUFFER_FREE);
+    return (res < BUFFER_OK) ? res : REORDER_OK;
+}
+
+int reorderRead(ReorderBuffer* reorder, void* data, uint32_t* seq) {
+    if (!reorder || !data) return -EINVAL;
+    void* addr;
+    int res = reorderReadClaim(reorder, &addr, seq);
+    if (res < REORDER_OK) return res;
+    copyBytes(data, addr, reorder->ring.type_size);
+    int tmp = reorderReadRelease(reorder, (uint16_t)res);
+    if (tmp < REORDER_OK) return tmp;
+    return res;
+}
+
+/**
+ * @details
+ * The read lock is held across the whole prefix, so the elements of one
+ * batch are consecutive sequences even with several readers.
+ */
+int reorderReadBatch(ReorderBuffer* reorder, void* data, uint16_t max_count) {
+    if (!reorder || !data) return -EINVAL;
+    if (!TAKE_READ_LOCK(reorder->ring.lock)) return -EBUSY;
+    uint8_t* out = (uint8_t*)data;
+    uint16_t n = 0;
+    uint32_t seq;
+    while (n < max_count) {
+        int res = claimNext(reorder, &seq);
+        if (res < REORDER_OK) break;
+        copyBytes(out, slotAddr(&reorder->ring, (uint16_t)res), reorder->ring.type_size);
+        (void)slotRelease(&reorder->ring, (uint16_t)res, BUFFER_READING, BUFFER_FREE);
+        out += reorder->ring.type_size;
+        n++;
+    }
+    CLEAR_READ_LOCK(reorder->ring.lock);
+    return n;
+}
+
+int reorderPark(ReorderBuffer* reorder) {
+    if (!reorder) return -EINVAL;
+    PUBLISH_LOCK_VAL(&reorder->waiting, 1);
+    LOCK_FULL_FENCE();
+    if (reorderIsReady(reorder)) {
+        uint32_t expected = 1;
+        (void)COMPARE_SET_LOCK(&reorder->waiting, &expected, 0);
+        return -EAGAIN;
+    }
+    return REORDER_OK;
+}
+
+ReorderWord_t* reorderWaitFlag(ReorderBuffer* reorder) {
+    if (!reorder) return NULL;
+    return &reorder->waiting;
+}
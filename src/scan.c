@@ -0,0 +1,267 @@
+#include "scan.h"
+#include "cpu.h"
+#include "copy.h"
+#include <stdint.h>
+#include <stdbool.h>
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+/* -- Private Functions --------------------------------------------------- */
+
+/**
+ * @brief Reads a key field of `width` bytes, which may be unaligned.
+ */
+static inline uint64_t loadKey(const uint8_t* p, uint16_t width) {
+    switch (width) {
+        case 1: return *p;
+        case 2: { uint16_t v; copyBytes(&v, p, 2); return v; }
+        case 4: { uint32_t v; copyBytes(&v, p, 4); return v; }
+        default: { uint64_t v; copyBytes(&v, p, 8); return v; }
+    }
+}
+
+static int findScalar(const uint8_t* keys, uint16_t stride, uint16_t n, uint16_t width, uint64_t key) {
+    for (uint16_t i = 0; i < n; i++, keys += stride) {
+        if (loadKey(keys, width) == key) return i;
+    }
+    return -1;
+}
+
+static uint16_t countScalar(const uint8_t* keys, uint16_t stride, uint16_t n, uint16_t width, uint64_t key) {
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < n; i++, keys += stride) {
+        count = (uint16_t)(count + (loadKey(keys, width) == key));
+    }
+    return count;
+}
+
+#if CPU_X86
+/**
+ * @brief Index of the lowest set bit of a non-zero mask.
+ */
+static inline int lowestBit(uint32_t mask) {
+    return __builtin_ctz(mask);
+}
+
+#ifdef __SSE2__
+/**
+ * @brief Lane-wise equality of `width`-byte lanes, all lane bytes set on a match.
+ *
+ * SSE2 has no 64-bit compare, so both 32-bit halves must match.
+ */
+static inline __m128i cmpeqSse2(__m128i a, __m128i b, uint16_t width) {
+    switch (width) {
+        case 1: return _mm_cmpeq_epi8(a, b);
+        case 2: return _mm_cmpeq_epi16(a, b);
+        case 4: return _mm_cmpeq_epi32(a, b);
+        default: {
+            __m128i eq = _mm_cmpeq_epi32(a, b);
+            return _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+    }
+}
+
+static inline __m128i splatSse2(uint64_t key, uint16_t width) {
+    switch (width) {
+        case 1: return _mm_set1_epi8((char)key);
+        case 2: return _mm_set1_epi16((short)key);
+        case 4: return _mm_set1_epi32((int)key);
+        default: return _mm_set1_epi64x((long long)key);
+    }
+}
+
+/**
+ * @brief Searches packed keys 16 bytes at a time.
+ *
+ * Every lane of a compare is one whole key, so the first set bit of the
+ * byte mask divided by `width` is the index of the matching key.
+ */
+static int findPackedSse2(const uint8_t* keys, uint16_t n, uint16_t width, uint64_t key) {
+    __m128i needle = splatSse2(key, width);
+    uint32_t bytes = (uint32_t)n * width;
+    uint32_t off = 0;
+    for (; off + 16 <= bytes; off += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(keys + off));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(cmpeqSse2(v, needle, width));
+        if (mask) return (int)((off + lowestBit(mask)) / width);
+    }
+    uint16_t done = (uint16_t)(off / width);
+    int hit = findScalar(keys + off, width, (uint16_t)(n - done), width, key);
+    return (hit < 0) ? -1 : done + hit;
+}
+
+/**
+ * @brief Counts packed keys 16 bytes at a time.
+ *
+ * A matching key sets `width` bits of the byte mask, so the popcount of all
+ * masks divided by `width` is the number of matches.
+ */
+static uint16_t countPackedSse2(const uint8_t* keys, uint16_t n, uint16_t width, uint64_t key) {
+    __m128i needle = splatSse2(key, width);
+    uint32_t bytes = (uint32_t)n * width;
+    uint32_t bits = 0;
+    uint32_t off = 0;
+    for (; off + 16 <= bytes; off += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(keys + off));
+        bits += (uint32_t)__builtin_popcount((uint32_t)_mm_movemask_epi8(cmpeqSse2(v, needle, width)));
+    }
+    uint16_t done = (uint16_t)(off / width);
+    return (uint16_t)(bits / width + countScalar(keys + off, width, (uint16_t)(n - done), width, key));
+}
+#endif
+
+CPU_TARGET("avx2")
+static inline __m256i cmpeqAvx2(__m256i a, __m256i b, uint16_t width) {
+    switch (width) {
+        case 1: return _mm256_cmpeq_epi8(a, b);
+        case 2: return _mm256_cmpeq_epi16(a, b);
+        case 4: return _mm256_cmpeq_epi32(a, b);
+        default: return _mm256_cmpeq_epi64(a, b);
+    }
+}
+
+CPU_TARGET("avx2")
+static inline __m256i splatAvx2(uint64_t key, uint16_t width) {
+    switch (width) {
+        case 1: return _mm256_set1_epi8((char)key);
+        case 2: return _mm256_set1_epi16((short)key);
+        case 4: return _mm256_set1_epi32((int)key);
+        default: return _mm256_set1_epi64x((long long)key);
+    }
+}
+
+/**
+ * @brief Searches packed keys 64 bytes at a time, as two 32-byte compares.
+ *
+ * Both loads are issued before either mask is tested, so two cache lines
+ * are in flight per iteration.
+ */
+CPU_TARGET("avx2")
+static int findPackedAvx2(const uint8_t* keys, uint16_t n, uint16_t width, uint64_t key) {
+    __m256i needle = splatAvx2(key, width);
+    uint32_t bytes = (uint32_t)n * width;
+    uint32_t off = 0;
+    for (; off + 64 <= bytes; off += 64) {
+        __m256i v0 = _mm256_loadu_si256((const __m256i*)(keys + off));
+        __m256i v1 = _mm256_loadu_si256((const __m256i*)(keys + off + 32));
+        uint32_t m0 = (uint32_t)_mm256_movemask_epi8(cmpeqAvx2(v0, needle, width));
+        uint32_t m1 = (uint32_t)_mm256_movemask_epi8(cmpeqAvx2(v1, needle, width));
+        if (m0 | m1) {
+            uint32_t at = m0 ? (uint32_t)lowestBit(m0) : 32u + (uint32_t)lowestBit(m1);
+            return (int)((off + at) / width);
+        }
+    }
+    for (; off + 32 <= bytes; off += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(keys + off));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(cmpeqAvx2(v, needle, width));
+        if (mask) return (int)((off + lowestBit(mask)) / width);
+    }
+    uint16_t done = (uint16_t)(off / width);
+    int hit = findScalar(keys + off, width, (uint16_t)(n - done), width, key);
+    return (hit < 0) ? -1 : done + hit;
+}
+
+/**
+ * @brief Searches 4- or 8-byte keys spread `stride` bytes apart with gathers.
+ *
+ * Each gather reads only the key fields, so no byte outside the elements'
+ * key fields is touched.
+ */
+CPU_TARGET("avx2")
+static int findStridedAvx2(const uint8_t* keys, uint16_t stride, uint16_t n, uint16_t width, uint64_t key) {
+    const int lanes = (width == 4) ? 8 : 4;
+    __m256i index = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                       _mm256_set1_epi32(stride));
+    __m256i needle = splatAvx2(key, width);
+    uint16_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        const uint8_t* base = keys + (uint32_t)i * stride;
+        uint32_t mask;
+        if (width == 4) {
+            __m256i v = _mm256_i32gather_epi32((const int*)base, index, 1);
+            mask = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, needle)));
+        } else {
+            __m256i v = _mm256_i32gather_epi64((const long long*)base, _mm256_castsi256_si128(index), 1);
+            mask = (uint32_t)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, needle)));
+        }
+        if (mask) return i + lowestBit(mask);
+    }
+    int hit = findScalar(keys + (uint32_t)i * stride, stride, (uint16_t)(n - i), width, key);
+    return (hit < 0) ? -1 : i + hit;
+}
+
+/**
+ * @brief Counts packed keys 32 bytes at a time; see `countPackedSse2()`.
+ */
+CPU_TARGET("avx2,popcnt")
+static uint16_t countPackedAvx2(const uint8_t* keys, uint16_t n, uint16_t width, uint64_t key) {
+    __m256i needle = splatAvx2(key, width);
+    uint32_t bytes = (uint32_t)n * width;
+    uint32_t bits = 0;
+    uint32_t off = 0;
+    for (; off + 32 <= bytes; off += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(keys + off));
+        bits += (uint32_t)__builtin_popcount((uint32_t)_mm256_movemask_epi8(cmpeqAvx2(v, needle, width)));
+    }
+    uint16_t done = (uint16_t)(off / width);
+    return (uint16_t)(bits / width + countScalar(keys + off, width, (uint16_t)(n - done), width, key));
+}
+
+/**
+ * @brief Counts 4- or 8-byte keys spread `stride` bytes apart with gathers.
+ *
+ * The lane masks have one bit per key, so their popcount is the number of
+ * matches.
+ */
+CPU_TARGET("avx2,popcnt")
+static uint16_t countStridedAvx2(const uint8_t* keys, uint16_t stride, uint16_t n, uint16_t width, uint64_t key) {
+    const int lanes = (width == 4) ? 8 : 4;
+    __m256i index = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                       _mm256_set1_epi32(stride));
+    __m256i needle = splatAvx2(key, width);
+    uint32_t count = 0;
+    uint16_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        const uint8_t* base = keys + (uint32_t)i * stride;
+        uint32_t mask;
+        if (width == 4) {
+            __m256i v = _mm256_i32gather_epi32((const int*)base, index, 1);
+            mask = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, needle)));
+        } else {
+            __m256i v = _mm256_i32gather_epi64((const long long*)base, _mm256_castsi256_si128(index), 1);
+            mask = (uint32_t)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, needle)));
+        }
+        count += (uint32_t)__builtin_popcount(mask);
+    }
+    return (uint16_t)(count + countScalar(keys + (uint32_t)i * stride, stride, (uint16_t)(n - i), width, key));
+}
+#endif
+
+/* -- Public Functions ----------------------------------------------------- */
+
+int scanFind(const uint8_t* keys, uint16_t stride, uint16_t n, uint16_t width, uint64_t key) {
+#if CPU_X86
+    if (cpuHasAvx2()) {
+        if (stride == width) return findPackedAvx2(keys, n, width, key);
+        if (width >= 4) return findStridedAvx2(keys, stride, n, width, key);
+    }
+#ifdef __SSE2__
+    if (stride == width) return findPackedSse2(keys, n, width, key);
+#endif
+#endif
+    return findScalar(keys, stride, n, width, key);
+}
+
+uint16_t scanCount(const uint8_t* keys, uint16_t stride, uint16_t n, uint16_t width, uint64_t key) {
+#if CPU_X86
+    if (cpuHasAvx2()) {
+        if (stride == width) return countPackedAvx2(keys, n, width, key);
+        if (width >= 4) return countStridedAvx2(keys, stride, n, width, key);
+    }
+#ifdef __SSE2__
+    if (stride == width) return countPackedSse2(keys, n, width, key);
+#endif
+#endif
+    return countScalar(keys, stride, n, width, key);
+}
@@ -0,0 +1,39 @@
+#pragma once
+/**
+ * @file scan.h
+ * @brief [internal] Key search kernels over runs of fixed-size elements.
+ *
+ * `scanFind()` compares one integer field of consecutive elements against a
+ * key and `scanCount()` counts the matches in the same single pass, adding
+ * up the popcounts of the compare masks. Both pick, at runtime, the widest
+ * kernel the CPU supports:
+ * - AVX2: 32 bytes per compare when the keys are packed back to back
+ *   (`stride == width`), or gathers of 8 (4-byte keys) / 4 (8-byte keys)
+ *   fields per compare when they are spread across larger elements.
+ * - SSE2: 16 bytes per compare for packed keys; part of the x86-64 baseline.
+ * - Scalar: one element at a time, on every other target or when the
+ *   library is built without `USE_SIMD`.
+ */
+#include <stdint.h>
+
+/**
+ * @brief Finds the first of `n` elements whose key field equals `key`.
+ *
+ * @param keys   Address of the key field of the first element.
+ * @param stride Distance in bytes between the key fields of consecutive elements.
+ * @param n      Number of elements to examine.
+ * @param width  Key width in bytes: 1, 2, 4 or 8.
+ * @param key    Key, compared as an unsigned integer of `width` bytes in
+ *               native byte order; must fit in `width` bytes.
+ * @return Index of the first matching element, or -1 if none matches.
+ */
+int scanFind(const uint8_t* keys, uint16_t stride, uint16_t n, uint16_t width, uint64_t key);
+
+/**
+ * @brief Counts the elements among `n` whose key field equals `key`.
+ *
+ * Takes the same arguments as `scanFind()`.
+ *
+ * @return Number of matching elements.
+ */
+uint16_t scanCount(const uint8_t* keys, uint16_t stride, uint16_t n, uint16_t width, uint64_t key);
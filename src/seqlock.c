@@ -0,0 +1,120 @@
+#include "seqlock.h"
+#include "locking.h"
+#include "copy.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+/* -- Public Functions ----------------------------------------------------- */
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @details
+ * Allocates the `SeqLock` structure and `type_size` bytes of storage for the
+ * value from the provided BlockAllocator. The sequence counter starts at 0.
+ *
+ * If allocation of the storage fails, the structure is released again.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+SeqLock* seqLockAllocate(BlockAllocator* allocator, uint16_t type_size) {
+    if (!allocator || type_size == 0) return NULL;
+    SeqLock* lock = (SeqLock*)blockAllocate(allocator, sizeof(SeqLock));
+    if (!lock) return NULL;
+    lock->raw = blockAllocate(allocator, type_size);
+    if (!lock->raw) {
+        (void)blockDeallocate(allocator, lock);
+        return NULL;
+    }
+    lock->type_size = type_size;
+    lock->seq = 0;
+    return lock;
+}
+
+/**
+ * @details
+ * Frees the value storage and then the structure itself. On success, the
+ * caller's pointer is set to NULL.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+int seqLockDeallocate(BlockAllocator* allocator, SeqLock** lock) {
+    if (!allocator || !lock || !(*lock)) return -EINVAL;
+    int res1, res2;
+    res1 = blockDeallocate(allocator, (*lock)->raw);
+    res2 = blockDeallocate(allocator, *lock);
+    if (res1 != BLOCK_ALLOCATOR_OK) return res1;
+    if (res2 != BLOCK_ALLOCATOR_OK) return res2;
+    *lock = NULL;
+    return SEQLOCK_OK;
+}
+#endif
+
+/**
+ * @details
+ * Moves the sequence counter from even to odd. The compare-and-set rejects a
+ * second concurrent writer; the release fence keeps the counter update ahead
+ * of the writes to the value.
+ */
+int seqLockWriteClaim(SeqLock* lock, void** out_addr) {
+    if (!lock || !out_addr) return -EINVAL;
+    uint32_t seq = GET_LOCK_VAL(&lock->seq);
+    if (seq & 1) return -EBUSY;
+    if (!COMPARE_SET_LOCK(&lock->seq, &seq, seq + 1)) return -EBUSY;
+    LOCK_RELEASE_FENCE();
+    *out_addr = lock->raw;
+    return SEQLOCK_OK;
+}
+
+int seqLockWriteRelease(SeqLock* lock) {
+    if (!lock) return -EINVAL;
+    uint32_t seq = GET_LOCK_VAL(&lock->seq);
+    if (!(seq & 1)) return -EPERM;
+    PUBLISH_LOCK_VAL(&lock->seq, seq + 1);
+    return SEQLOCK_OK;
+}
+
+int seqLockWrite(SeqLock* lock, const void* data) {
+    if (!lock || !data) return -EINVAL;
+    void* value;
+    int res = seqLockWriteClaim(lock, &value);
+    if (res < SEQLOCK_OK) return res;
+    copyBytes(value, data, lock->type_size);
+    return seqLockWriteRelease(lock);
+}
+
+int seqLockReadClaim(const SeqLock* lock, const void** out_addr, uint32_t* seq) {
+    if (!lock || !out_addr || !seq) return -EINVAL;
+    *seq = GET_LOCK_VAL(&((SeqLock*)lock)->seq);
+    if (*seq & 1) return -EBUSY;
+    *out_addr = lock->raw;
+    return SEQLOCK_OK;
+}
+
+/**
+ * @details
+ * The acquire fence keeps every read of the value ahead of the second load
+ * of the sequence counter.
+ */
+int seqLockReadRelease(const SeqLock* lock, uint32_t seq) {
+    if (!lock) return -EINVAL;
+    LOCK_ACQUIRE_FENCE();
+    if (GET_LOCK_VAL(&((SeqLock*)lock)->seq) != seq) return -ESTALE;
+    return SEQLOCK_OK;
+}
+
+int seqLockRead(const SeqLock* lock, void* data) {
+    if (!lock || !data) return -EINVAL;
+    const void* value;
+    uint32_t seq;
+    int res = seqLockReadClaim(lock, &value, &seq);
+    if (res < SEQLOCK_OK) return res;
+    copyBytes(data, value, lock->type_size);
+    if (seqLockReadRelease(lock, seq) < SEQLOCK_OK) return -EBUSY;
+    return SEQLOCK_OK;
+}
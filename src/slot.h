@@ -0,0 +1,220 @@
+#pragma once
+/**
+ * @file slot.h
+ * @brief [internal] Epoch-tagged slot states and slot helpers of `Buffer` based containers.
+ *
+ * Slot states carry the buffer epoch they were claimed in above the
+ * `BufferState` bits, so that `bufferClear()` can invalidate every slot at
+ * once by advancing `Buffer::epoch`.
+ */
+#include "buffer.h"
+#include "locking.h"
+#include "copy.h"
+#include "crc32c.h"
+#include "stream.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#define SLOT_STATE_BITS 3
+#define SLOT_STATE_MASK ((1u << SLOT_STATE_BITS) - 1)
+#define SLOT_EPOCH_MASK (0xFFu >> SLOT_STATE_BITS)
+// Epoch never taken by the buffer itself; claims still held when the epoch wraps are moved to it
+#define SLOT_EPOCH_RETIRED SLOT_EPOCH_MASK
+
+/**
+ * @brief Combines an epoch and a `BufferState` into a slot state.
+ */
+static inline uint8_t slotTag(uint8_t epoch, BufferState state) {
+    return (uint8_t)((epoch << SLOT_STATE_BITS) | state);
+}
+
+/**
+ * @brief Extracts the `BufferState` of a slot state.
+ */
+static inline BufferState slotKind(uint8_t tag) {
+    return (BufferState)(tag & SLOT_STATE_MASK);
+}
+
+/**
+ * @brief Extracts the epoch of a slot state.
+ */
+static inline uint8_t slotEpoch(uint8_t tag) {
+    return (uint8_t)(tag >> SLOT_STATE_BITS);
+}
+
+/**
+ * @brief Moves slot `index` from `from` to `to` within the current epoch.
+ *
+ * A slot that is in state `from` but was claimed before the last clear is
+ * freed instead, keeping its old epoch.
+ *
+ * @return `BUFFER_OK`, `-ESTALE` if the slot belonged to an older epoch, or
+ *         `-EPERM` if the slot was not in state `from`.
+ */
+static inline int slotRelease(Buffer* buffer, uint16_t index, BufferState from, BufferState to) {
+    uint8_t epoch = GET_LOCK_VAL(&buffer->epoch);
+    uint8_t expected = slotTag(epoch, from);
+    if (EXPECT_SLOT_STATE(buffer->lock, index, &expected, slotTag(epoch, to))) {
+        return BUFFER_OK;
+    }
+    if (slotKind(expected) != from) return -EPERM;
+    uint8_t stale = slotEpoch(expected);
+    if (!EXPECT_SLOT_STATE(buffer->lock, index, &expected, slotTag(stale, BUFFER_FREE))) {
+        return -EPERM;
+    }
+    return -ESTALE;
+}
+
+/**
+ * @brief Returns the number of elements between the tail and head, given the full flag.
+ */
+static inline uint16_t bufferCount(const Buffer* buffer) {
+    if (buffer->full) return buffer->size;
+    return (uint16_t)((buffer->head + buffer->size - buffer->tail) % buffer->size);
+}
+
+/**
+ * @brief Returns the distance in bytes between consecutive slots.
+ */
+static inline uint16_t slotStride(const Buffer* buffer) {
+    return buffer->stride ? buffer->stride : buffer->type_size;
+}
+
+/**
+ * @brief Returns the address of slot `index`.
+ */
+static inline uint8_t* slotAddr(const Buffer* buffer, uint16_t index) {
+    return (uint8_t*)buffer->raw + ((uint32_t)index * slotStride(buffer));
+}
+
+/**
+ * @brief Copies `size` bytes of `src` into the slot at `slot`, using word copies when slots are aligned.
+ */
+static inline void slotCopyIn(const Buffer* buffer, uint8_t* slot, const void* src, uint16_t size) {
+    if (buffer->stride) {
+        copyToSlot(slot, src, size);
+    } else {
+        copyBytes(slot, src, size);
+    }
+}
+
+/**
+ * @brief Copies `size` bytes of the slot at `slot` into `dest`, using word copies when slots are aligned.
+ */
+static inline void slotCopyOut(const Buffer* buffer, void* dest, const uint8_t* slot, uint16_t size) {
+    if (buffer->stride) {
+        copyFromSlot(dest, slot, size);
+    } else {
+        copyBytes(dest, slot, size);
+    }
+}
+
+/**
+ * @brief Copies `size` bytes of `data` into slot `index`.
+ *
+ * If the buffer keeps checksums, the slot's checksum is computed in the same
+ * pass as the copy. It covers the whole slot, so bytes past `size` are
+ * checksummed as they are.
+ *
+ * Writes of at least `stream_min` bytes are copied with non-temporal
+ * stores; their checksum is then taken from `data`, which is still cached,
+ * rather than from the slot.
+ */
+static inline void slotStore(Buffer* buffer, uint16_t index, const void* data, uint16_t size) {
+    uint8_t* addr = slotAddr(buffer, index);
+    if (buffer->stream_min && size >= buffer->stream_min) {
+        streamCopy(addr, data, size);
+        if (buffer->checksum) {
+            uint32_t crc = crc32cCopy(0, NULL, data, size);
+            buffer->checksum[index] = crc32cCopy(crc, NULL, addr + size, (uint32_t)(buffer->type_size - size));
+        }
+        return;
+    }
+    if (!buffer->checksum) {
+        slotCopyIn(buffer, addr, data, size);
+        return;
+    }
+    uint32_t crc = crc32cCopy(0, addr, data, size);
+    buffer->checksum[index] = crc32cCopy(crc, NULL, addr + size, (uint32_t)(buffer->type_size - size));
+}
+
+/**
+ * @brief Records the checksum of slot `index` as it is, if the buffer keeps checksums.
+ */
+static inline void slotSeal(Buffer* buffer, uint16_t index) {
+    if (!buffer->checksum) return;
+    buffer->checksum[index] = crc32cCopy(0, NULL, slotAddr(buffer, index), buffer->type_size);
+}
+
+/**
+ * @brief Copies the first `size` bytes of slot `index` into `data`.
+ *
+ * If the buffer keeps checksums, the slot is verified in the same pass as
+ * the copy.
+ *
+ * @return `BUFFER_OK`, or `-EBADMSG` if the slot does not match its checksum.
+ */
+static inline int slotLoad(const Buffer* buffer, uint16_t index, void* data, uint16_t size) {
+    const uint8_t* addr = slotAddr(buffer, index);
+    if (!buffer->checksum) {
+        slotCopyOut(buffer, data, addr, size);
+        return BUFFER_OK;
+    }
+    uint32_t crc = crc32cCopy(0, data, addr, size);
+    crc = crc32cCopy(crc, NULL, addr + size, (uint32_t)(buffer->type_size - size));
+    return (crc == buffer->checksum[index]) ? BUFFER_OK : -EBADMSG;
+}
+
+/**
+ * @brief Checks slot `index` against its checksum without copying it.
+ *
+ * @return `BUFFER_OK` if it matches or the buffer keeps no checksums,
+ *         otherwise `-EBADMSG`.
+ */
+static inline int slotVerify(const Buffer* buffer, uint16_t index) {
+    if (!buffer->checksum) return BUFFER_OK;
+    uint32_t crc = crc32cCopy(0, NULL, slotAddr(buffer, index), buffer->type_size);
+    return (crc == buffer->checksum[index]) ? BUFFER_OK : -EBADMSG;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SLOT_PREFETCH_READ(addr) __builtin_prefetch((addr), 0, 3)
+#define SLOT_PREFETCH_WRITE(addr) __builtin_prefetch((addr), 1, 3)
+#else
+#define SLOT_PREFETCH_READ(addr) ((void)(addr))
+#define SLOT_PREFETCH_WRITE(addr) ((void)(addr))
+#endif
+
+/** @brief Cache line size assumed when prefetching a slot line by line. */
+#define SLOT_CACHE_LINE 64
+
+/**
+ * @brief Prefetches the slot `buffer->prefetch` positions after `index`.
+ *
+ * Every cache line the slot's data touches is requested, from the line
+ * holding its first byte to the line holding its last, along with the line
+ * holding its state in atomic builds, so the claim of that slot does not
+ * miss either. Compiled to nothing unless `USE_PREFETCH` is defined.
+ */
+static inline void slotPrefetch(const Buffer* buffer, uint16_t index, bool write) {
+#ifdef USE_PREFETCH
+    if (buffer->prefetch == 0) return;
+    uint16_t ahead = (uint16_t)(((uint32_t)index + buffer->prefetch) % buffer->size);
+    uintptr_t first = (uintptr_t)slotAddr(buffer, ahead);
+    uintptr_t last = first + buffer->type_size - 1;
+    first &= ~(uintptr_t)(SLOT_CACHE_LINE - 1);
+    if (write) {
+        for (uintptr_t line = first; line <= last; line += SLOT_CACHE_LINE) SLOT_PREFETCH_WRITE((const void*)line);
+    } else {
+        for (uintptr_t line = first; line <= last; line += SLOT_CACHE_LINE) SLOT_PREFETCH_READ((const void*)line);
+    }
+#ifdef USE_ATOMIC
+    SLOT_PREFETCH_READ((const void*)(buffer->lock->slot_state + ahead));
+#endif
+#else
+    (void)buffer;
+    (void)index;
+    (void)write;
+#endif
+}
@@ -0,0 +1,313 @@
+#include "snapshot.h"
+#include "buffer.h"
+#include "queue.h"
+#include "stack.h"
+#include "locking.h"
+#include "slot.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+/* -- Private Functions --------------------------------------------------- */
+
+/**
+ * @brief Writes all `len` bytes, retrying short writes.
+ */
+static int writeAll(SnapshotWriteFn write, void* ctx, const void* data, uint32_t len) {
+    const uint8_t* cur = (const uint8_t*)data;
+    while (len > 0) {
+        int32_t res = write(ctx, cur, len);
+        if (res < 0) return res;
+        if (res == 0) return -EIO;
+        cur += res;
+        len -= (uint32_t)res;
+    }
+    return SNAPSHOT_OK;
+}
+
+/**
+ * @brief Reads exactly `len` bytes, retrying short reads.
+ */
+static int readAll(SnapshotReadFn read, void* ctx, void* data, uint32_t len) {
+    uint8_t* cur = (uint8_t*)data;
+    while (len > 0) {
+        int32_t res = read(ctx, cur, len);
+        if (res < 0) return res;
+        if (res == 0) return -EBADMSG;
+        cur += res;
+        len -= (uint32_t)res;
+    }
+    return SNAPSHOT_OK;
+}
+
+/**
+ * @brief Writes `count` slots of `elem` bytes placed `stride` bytes apart.
+ *
+ * Packed slots are written as one range. Padded slots are written one
+ * element at a time, so the stream never contains padding and snapshots
+ * restore into containers of any alignment.
+ */
+static int writeSlots(SnapshotWriteFn write, void* ctx, const uint8_t* base,
+                      uint16_t stride, uint16_t elem, uint16_t count) {
+    if (stride == elem) return writeAll(write, ctx, base, (uint32_t)count * elem);
+    int res = SNAPSHOT_OK;
+    for (uint16_t i = 0; i < count && res == SNAPSHOT_OK; i++) {
+        res = writeAll(write, ctx, base + (uint32_t)i * stride, elem);
+    }
+    return res;
+}
+
+/**
+ * @brief Reads `count` elements of `elem` bytes into slots placed `stride` bytes apart.
+ */
+static int readSlots(SnapshotReadFn read, void* ctx, uint8_t* base,
+                     uint16_t stride, uint16_t elem, uint16_t count) {
+    if (stride == elem) return readAll(read, ctx, base, (uint32_t)count * elem);
+    int res = SNAPSHOT_OK;
+    for (uint16_t i = 0; i < count && res == SNAPSHOT_OK; i++) {
+        res = readAll(read, ctx, base + (uint32_t)i * stride, elem);
+    }
+    return res;
+}
+
+/**
+ * @brief Writes `count` ring entries of `elem` bytes starting at `first`.
+ *
+ * The entries are written as one run of slots, or two if they wrap around
+ * the end of the ring.
+ */
+static int writeRing(SnapshotWriteFn write, void* ctx, const void* base, uint16_t size,
+                     uint16_t stride, uint16_t elem, uint16_t first, uint16_t count) {
+    const uint8_t* raw = (const uint8_t*)base;
+    uint16_t run = (count < size - first) ? count : (uint16_t)(size - first);
+    int res = writeSlots(write, ctx, raw + (uint32_t)first * stride, stride, elem, run);
+    if (res < SNAPSHOT_OK || run == count) return res;
+    return writeSlots(write, ctx, raw, stride, elem, (uint16_t)(count - run));
+}
+
+/**
+ * @brief Writes a snapshot header.
+ */
+static int writeHeader(SnapshotWriteFn write, void* ctx, SnapshotKind kind,
+                       uint16_t type_size, uint16_t count) {
+    SnapshotHeader header = {
+        .magic = SNAPSHOT_MAGIC,
+        .version = SNAPSHOT_VERSION,
+        .kind = (uint16_t)kind,
+        .type_size = type_size,
+        .count = count,
+    };
+    return writeAll(write, ctx, &header, sizeof(header));
+}
+
+/**
+ * @brief Reads and validates a snapshot header.
+ *
+ * @return The element count, or a negative errno value.
+ */
+static int readHeader(SnapshotReadFn read, void* ctx, SnapshotKind kind,
+                      uint16_t type_size, uint16_t capacity) {
+    SnapshotHeader header;
+    int res = readAll(read, ctx, &header, sizeof(header));
+    if (res < SNAPSHOT_OK) return res;
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION) return -EBADMSG;
+    if (header.kind != kind || header.type_size != type_size) return -EINVAL;
+    if (header.count > capacity) return -ENOSPC;
+    return header.count;
+}
+
+/**
+ * @brief Takes both locks of a buffer, holding off producers and consumers.
+ */
+static void lockBuffer(Buffer* buffer) {
+    while (!TAKE_WRITE_LOCK(buffer->lock));
+    while (!TAKE_READ_LOCK(buffer->lock));
+}
+
+/**
+ * @brief Releases both locks taken by `lockBuffer()`.
+ */
+static void unlockBuffer(Buffer* buffer) {
+    CLEAR_READ_LOCK(buffer->lock);
+    CLEAR_WRITE_LOCK(buffer->lock);
+}
+
+/**
+ * @brief Checks that every pending element of a locked buffer has been published.
+ */
+static bool bufferSettled(Buffer* buffer, uint16_t count) {
+    uint8_t ready = slotTag(GET_LOCK_VAL(&buffer->epoch), BUFFER_READY);
+    for (uint16_t i = 0; i < count; i++) {
+        uint8_t expected = ready;
+        if (!EXPECT_SLOT_STATE(buffer->lock, (buffer->tail + i) % buffer->size, &expected, ready)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Checks that the first `size` slots of a lock are not claimed.
+ */
+static bool slotsUnclaimed(Lock_t* lock, uint16_t size) {
+    for (uint16_t i = 0; i < size; i++) {
+        BufferState kind = slotKind(GET_SLOT_STATE(lock, i));
+        if (kind != BUFFER_FREE && kind != BUFFER_READY) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Publishes `count` restored elements at the start of a locked, empty buffer.
+ *
+ * If the buffer keeps checksums, each slot is sealed before it is published,
+ * so restored elements read back like written ones.
+ */
+static void bufferPublish(Buffer* buffer, uint16_t count) {
+    uint8_t ready = slotTag(GET_LOCK_VAL(&buffer->epoch), BUFFER_READY);
+    for (uint16_t i = 0; i < count; i++) {
+        slotSeal(buffer, i);
+        SET_SLOT_STATE(buffer->lock, i, ready);
+    }
+    buffer->tail = 0;
+    buffer->head = (uint16_t)(count % buffer->size);
+    buffer->full = (count == buffer->size);
+}
+
+/* -- Public Functions ----------------------------------------------------- */
+
+/**
+ * @details
+ * Holds both buffer locks while the header and the (at most two) element
+ * ranges are written, so the snapshot is a consistent point-in-time copy.
+ */
+int bufferSnapshot(Buffer* buffer, SnapshotWriteFn write, void* ctx) {
+    if (!buffer || !write) return -EINVAL;
+    lockBuffer(buffer);
+    uint16_t count = bufferCount(buffer);
+    int res = -EBUSY;
+    if (bufferSettled(buffer, count)) {
+        res = writeHeader(write, ctx, SNAPSHOT_BUFFER, buffer->type_size, count);
+        if (res == SNAPSHOT_OK) {
+            res = writeRing(write, ctx, buffer->raw, buffer->size, slotStride(buffer),
+                            buffer->type_size, buffer->tail, count);
+        }
+    }
+    unlockBuffer(buffer);
+    return (res < SNAPSHOT_OK) ? res : count;
+}
+
+/**
+ * @details
+ * The elements are read straight into the first slots of the buffer in one
+ * bulk read; the slots are only published once the whole payload arrived.
+ */
+int bufferRestore(Buffer* buffer, SnapshotReadFn read, void* ctx) {
+    if (!buffer || !read) return -EINVAL;
+    lockBuffer(buffer);
+    int res = -EBUSY;
+    if (bufferIsEmpty(buffer) && slotsUnclaimed(buffer->lock, buffer->size)) {
+        res = readHeader(read, ctx, SNAPSHOT_BUFFER, buffer->type_size, buffer->size);
+    }
+    if (res >= SNAPSHOT_OK) {
+        uint16_t count = (uint16_t)res;
+        res = readSlots(read, ctx, buffer->raw, slotStride(buffer), buffer->type_size, count);
+        if (res == SNAPSHOT_OK) {
+            bufferPublish(buffer, count);
+            res = count;
+        }
+    }
+    unlockBuffer(buffer);
+    return res;
+}
+
+/**
+ * @details
+ * Writes the message lengths and the message slots as two ring ranges each,
+ * under both locks of the slot buffer.
+ */
+int queueSnapshot(Queue* queue, SnapshotWriteFn write, void* ctx) {
+    if (!queue || !write) return -EINVAL;
+    Buffer* buffer = queue->slot_buffer;
+    lockBuffer(buffer);
+    uint16_t count = bufferCount(buffer);
+    int res = -EBUSY;
+    if (bufferSettled(buffer, count)) {
+        res = writeHeader(write, ctx, SNAPSHOT_QUEUE, buffer->type_size, count);
+        if (res == SNAPSHOT_OK) {
+            res = writeRing(write, ctx, queue->msg_len, buffer->size, sizeof(uint16_t),
+                            sizeof(uint16_t), buffer->tail, count);
+        }
+        if (res == SNAPSHOT_OK) {
+            res = writeRing(write, ctx, buffer->raw, buffer->size, slotStride(buffer),
+                            buffer->type_size, buffer->tail, count);
+        }
+    }
+    unlockBuffer(buffer);
+    return (res < SNAPSHOT_OK) ? res : count;
+}
+
+int queueRestore(Queue* queue, SnapshotReadFn read, void* ctx) {
+    if (!queue || !read) return -EINVAL;
+    Buffer* buffer = queue->slot_buffer;
+    lockBuffer(buffer);
+    int res = -EBUSY;
+    if (bufferIsEmpty(buffer) && slotsUnclaimed(buffer->lock, buffer->size)) {
+        res = readHeader(read, ctx, SNAPSHOT_QUEUE, buffer->type_size, buffer->size);
+    }
+    if (res >= SNAPSHOT_OK) {
+        uint16_t count = (uint16_t)res;
+        res = readAll(read, ctx, queue->msg_len, (uint32_t)count * sizeof(uint16_t));
+        if (res == SNAPSHOT_OK) {
+            res = readSlots(read, ctx, buffer->raw, slotStride(buffer), buffer->type_size, count);
+        }
+        if (res == SNAPSHOT_OK) {
+            bufferPublish(buffer, count);
+            res = count;
+        }
+    }
+    unlockBuffer(buffer);
+    return res;
+}
+
+int stackSnapshot(Stack* stack, SnapshotWriteFn write, void* ctx) {
+    if (!stack || !write) return -EINVAL;
+    while (!TAKE_STACK_LOCK(stack->lock));
+    uint16_t count = stack->top;
+    int res = SNAPSHOT_OK;
+    for (uint16_t i = 0; i < count && res == SNAPSHOT_OK; i++) {
+        uint8_t expected = BUFFER_READY;
+        if (!EXPECT_SLOT_STATE(stack->lock, i, &expected, BUFFER_READY)) res = -EBUSY;
+    }
+    if (res == SNAPSHOT_OK) {
+        res = writeHeader(write, ctx, SNAPSHOT_STACK, stack->type_size, count);
+    }
+    if (res == SNAPSHOT_OK) {
+        res = writeSlots(write, ctx, stack->raw, stackStride(stack), stack->type_size, count);
+    }
+    CLEAR_STACK_LOCK(stack->lock);
+    return (res < SNAPSHOT_OK) ? res : count;
+}
+
+int stackRestore(Stack* stack, SnapshotReadFn read, void* ctx) {
+    if (!stack || !read) return -EINVAL;
+    while (!TAKE_STACK_LOCK(stack->lock));
+    int res = -EBUSY;
+    if (stack->top == 0 && slotsUnclaimed(stack->lock, stack->size)) {
+        res = readHeader(read, ctx, SNAPSHOT_STACK, stack->type_size, stack->size);
+    }
+    if (res >= SNAPSHOT_OK) {
+        uint16_t count = (uint16_t)res;
+        res = readSlots(read, ctx, stack->raw, stackStride(stack), stack->type_size, count);
+        if (res == SNAPSHOT_OK) {
+            for (uint16_t i = 0; i < count; i++) {
+                SET_SLOT_STATE(stack->lock, i, BUFFER_READY);
+            }
+            stack->top = count;
+            stack->full = (count == stack->size);
+            res = count;
+        }
+    }
+    CLEAR_STACK_LOCK(stack->lock);
+    return res;
+}
@@ -1,7 +1,9 @@
 #include "stack.h"
 #include "locking.h"
+#include "copy.h"
 #ifdef USE_BITMAP_ALLOCATOR
 #include "block_allocator.h"
+#include "aligned_block.h"
 #endif
 #include <stdint.h>
 #include <stdbool.h>
@@ -26,7 +28,62 @@ static inline void memcpy(void *dest, const void *src, uint16_t size) {
     }
 }
 
+/**
+ * @brief Returns the address of slot `index`.
+ */
+static inline uint8_t* stackSlot(const Stack* stack, uint16_t index) {
+    return (uint8_t*)stack->raw + ((uint32_t)index * stackStride(stack));
+}
+
+/**
+ * @brief Copies one element into a slot, using word copies when slots are aligned.
+ */
+static inline void stackCopyIn(const Stack* stack, uint8_t* slot, const void* src) {
+    if (stack->stride) {
+        copyToSlot(slot, src, stack->type_size);
+    } else {
+        memcpy(slot, src, stack->type_size);
+    }
+}
+
+/**
+ * @brief Copies one element out of a slot, using word copies when slots are aligned.
+ */
+static inline void stackCopyOut(const Stack* stack, void* dest, const uint8_t* slot) {
+    if (stack->stride) {
+        copyFromSlot(dest, slot, stack->type_size);
+    } else {
+        memcpy(dest, slot, stack->type_size);
+    }
+}
+
 #ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @brief Allocates a stack whose slots are aligned to `align` bytes, or packed if 0.
+ */
+static Stack* allocateStack(BlockAllocator* allocator, uint16_t size, uint16_t type_size, uint16_t align) {
+    uint16_t stride = align ? (uint16_t)SLOT_STRIDE(type_size, align) : 0;
+    Stack* stack = (Stack*)blockAllocate(allocator, sizeof(Stack));
+    if (!stack) return NULL;
+    if (stride) {
+        stack->raw = alignedBlockAllocate(allocator, (uint32_t)size * stride, align);
+    } else {
+        stack->raw = blockAllocate(allocator, size * type_size);
+    }
+    if (!stack->raw) {
+        (void)blockDeallocate(allocator, stack);
+        return NULL;
+    }
+    stack->lock = lockAllocate(allocator, size);
+    stack->type_size = type_size;
+    stack->stride = stride;
+    stack->size = size;
+    stack->top = 0;
+    stack->full = false;
+    stack->watermark = NULL;
+    return stack;
+}
+
 /**
  * @details
  * Allocates a stack structure and backing storage from the provided BlockAllocator.
@@ -42,19 +99,22 @@ static inline void memcpy(void *dest, const void *src, uint16_t size) {
 Stack* stackAllocate(BlockAllocator* allocator, uint16_t size, uint16_t type_size) {
     if (!allocator) return NULL;
     if (size == 0 || type_size == 0) return NULL;
-    Stack* stack = (Stack*)blockAllocate(allocator, sizeof(Stack));
-    if (!stack) return NULL;
-    stack->raw = blockAllocate(allocator, size * type_size);
-    if (!stack->raw) {
-        (void)blockDeallocate(allocator, stack);
-        return NULL;
-    }
-    stack->lock = lockAllocate(allocator, size);
-    stack->type_size = type_size;
-    stack->size = size;
-    stack->top = 0;
-    stack->full = false;
-    return stack;
+    return allocateStack(allocator, size, type_size, 0);
+}
+
+/**
+ * @details
+ * As `stackAllocate()`, with the raw buffer sized to `size * stride` bytes
+ * and placed on an `align` byte boundary.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+Stack* stackAllocateAligned(BlockAllocator* allocator, uint16_t size, uint16_t type_size, uint16_t align) {
+    if (!allocator) return NULL;
+    if (size == 0 || type_size == 0 || !slotAlignValid(align)) return NULL;
+    if (SLOT_STRIDE((uint32_t)type_size, align) > UINT16_MAX) return NULL;
+    return allocateStack(allocator, size, type_size, align);
 }
 
 /**
@@ -73,7 +133,7 @@ int stackDeallocate(BlockAllocator* allocator, Stack** stack) {
     if (!allocator || !stack || !(*stack)) return -EINVAL;
     int res1, res2, res3;
     res1 = lockDeallocate(allocator, (&(*stack)->lock));
-    res2 = blockDeallocate(allocator, (*stack)->raw);
+    res2 = alignedBlockDeallocate(allocator, (*stack)->raw, (*stack)->stride != 0);
     res3 = blockDeallocate(allocator, *stack);
     if (res1 != LOCK_OK) return res1;
     if (res2 != BLOCK_ALLOCATOR_OK) return res2;
@@ -88,6 +148,7 @@ int stackDeallocate(BlockAllocator* allocator, Stack** stack) {
  * Clears the contents of the stack without releasing memory.
  * - Resets the `top` index to 0.
  * - Clears the `full` flag.
+ * - Lets an attached watermark fall to 0, firing LOW if HIGH was raised.
  *
  * This effectively resets the stack to an empty state.
  */
@@ -95,6 +156,17 @@ void stackClear(Stack* stack) {
     if (!stack) return;
     stack->top = 0;
     stack->full = false;
+    watermarkFall(stack->watermark, 0);
+}
+
+uint16_t stackStride(const Stack* stack) {
+    return stack->stride ? stack->stride : stack->type_size;
+}
+
+int stackSetWatermark(Stack* stack, Watermark* watermark) {
+    if (!stack) return -EINVAL;
+    stack->watermark = watermark;
+    return STACK_OK;
 }
 
 /**
@@ -125,14 +197,16 @@ int stackPush(Stack* stack, const void* data) {
         return -EBUSY;
     }
     // With all checks down, we can claim the slot
-    uint8_t* head_addr = (uint8_t*)stack->raw + (stack->top * stack->type_size);
+    uint8_t* head_addr = stackSlot(stack, cur_top);
     stack->top += 1;
+    uint16_t count = stack->top;
     // release the write lock
     CLEAR_STACK_LOCK(stack->lock);
     // copy the data
-    memcpy((void*)head_addr, data, stack->type_size);
+    stackCopyIn(stack, head_addr, data);
     // mark the slot as ready
     SET_SLOT_STATE(stack->lock, cur_top, BUFFER_READY);
+    watermarkRise(stack->watermark, count);
 
     return cur_top;
 }
@@ -166,13 +240,14 @@ int stackPop(Stack* stack, void* data) {
     }
     // With all checks down, we can claim the slot
     stack->top--;
-    uint8_t* tail_addr = (uint8_t*)stack->raw + (cur_top * stack->type_size);
+    uint8_t* tail_addr = stackSlot(stack, cur_top);
     // release the read lock
     CLEAR_STACK_LOCK(stack->lock);
     // copy the data
-    memcpy(data, (void*)tail_addr, stack->type_size);
+    stackCopyOut(stack, data, tail_addr);
 
     SET_SLOT_STATE(stack->lock, cur_top, BUFFER_FREE);
+    watermarkFall(stack->watermark, cur_top);
 
     return cur_top;
 }
@@ -0,0 +1,177 @@
+#include "steal_deque.h"
+#include "locking.h"
+#include "copy.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+/* -- Private Functions --------------------------------------------------- */
+
+/**
+ * @brief Address of the element at counter `index`.
+ */
+static inline uint8_t* slotAddr(const StealDeque* deque, uint32_t index) {
+    return (uint8_t*)deque->raw + (index & (deque->size - 1)) * deque->type_size;
+}
+
+/* -- Public Functions ----------------------------------------------------- */
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @details
+ * Allocates a deque structure and backing storage from the provided BlockAllocator.
+ * - Rejects capacities that are not a power of two.
+ * - Allocates a raw buffer of `size * type_size` bytes to store values.
+ *
+ * If any allocation fails, all intermediate allocations are cleaned up to avoid leaks.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+StealDeque* stealDequeAllocate(BlockAllocator* allocator, uint16_t size, uint16_t type_size) {
+    if (!allocator) return NULL;
+    if (size == 0 || type_size == 0 || (size & (size - 1)) != 0) return NULL;
+    StealDeque* deque = (StealDeque*)blockAllocate(allocator, sizeof(StealDeque));
+    if (!deque) return NULL;
+    deque->raw = blockAllocate(allocator, size * type_size);
+    if (!deque->raw) {
+        (void)blockDeallocate(allocator, deque);
+        return NULL;
+    }
+    deque->type_size = type_size;
+    deque->size = size;
+    deque->top = 0;
+    deque->bottom = 0;
+    return deque;
+}
+
+/**
+ * @details
+ * Frees the backing storage and then the structure itself. On success, the
+ * caller's pointer is set to NULL.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+int stealDequeDeallocate(BlockAllocator* allocator, StealDeque** deque) {
+    if (!allocator || !deque || !(*deque)) return -EINVAL;
+    int res1, res2;
+    res1 = blockDeallocate(allocator, (*deque)->raw);
+    res2 = blockDeallocate(allocator, *deque);
+    if (res1 != BLOCK_ALLOCATOR_OK) return res1;
+    if (res2 != BLOCK_ALLOCATOR_OK) return res2;
+    *deque = NULL;
+    return STEAL_DEQUE_OK;
+}
+#endif
+
+/**
+ * @details
+ * Moves `bottom` back to `top` rather than resetting both counters, so a
+ * thief holding a stale `top` can never succeed against the emptied deque.
+ */
+void stealDequeClear(StealDeque* deque) {
+    if (!deque) return;
+    PUBLISH_LOCK_VAL(&deque->bottom, GET_LOCK_VAL(&deque->top));
+}
+
+uint16_t stealDequeCount(const StealDeque* deque) {
+    if (!deque) return 0;
+    uint32_t top = GET_LOCK_VAL(&((StealDeque*)deque)->top);
+    uint32_t bottom = GET_LOCK_VAL(&((StealDeque*)deque)->bottom);
+    int32_t count = (int32_t)(bottom - top);
+    return count > 0 ? (uint16_t)count : 0;
+}
+
+/**
+ * @details
+ * The element is written before `bottom` is published with release ordering,
+ * so a thief that observes the new `bottom` also observes the element.
+ * A stale `top` can only make the full check more conservative.
+ */
+int stealDequePush(StealDeque* deque, const void* data) {
+    if (!deque || !data) return -EINVAL;
+    uint32_t bottom = GET_LOCK_VAL(&deque->bottom);
+    uint32_t top = GET_LOCK_VAL(&deque->top);
+    if ((int32_t)(bottom - top) >= (int32_t)deque->size) return -ENOSPC;
+    copyBytes(slotAddr(deque, bottom), data, deque->type_size);
+    PUBLISH_LOCK_VAL(&deque->bottom, bottom + 1);
+    return STEAL_DEQUE_OK;
+}
+
+/**
+ * @details
+ * Reserves the bottom element by decrementing `bottom` first; the full fence
+ * orders that store before the load of `top`. If more than one element
+ * remains, no thief can reach the reserved one. For the last element the
+ * owner races thieves with the same compare-and-set they use on `top`.
+ */
+int stealDequePop(StealDeque* deque, void* data) {
+    if (!deque || !data) return -EINVAL;
+    uint32_t bottom = GET_LOCK_VAL(&deque->bottom) - 1;
+    PUBLISH_LOCK_VAL(&deque->bottom, bottom);
+    LOCK_FULL_FENCE();
+    uint32_t top = GET_LOCK_VAL(&deque->top);
+    int32_t remaining = (int32_t)(bottom - top);
+    if (remaining < 0) {
+        // empty, undo the reservation
+        PUBLISH_LOCK_VAL(&deque->bottom, bottom + 1);
+        return -EAGAIN;
+    }
+    if (remaining > 0) {
+        copyBytes(data, slotAddr(deque, bottom), deque->type_size);
+        return STEAL_DEQUE_OK;
+    }
+    // last element, race the thieves for it
+    bool won = COMPARE_SET_LOCK_FULL(&deque->top, &top, top + 1);
+    PUBLISH_LOCK_VAL(&deque->bottom, bottom + 1);
+    if (!won) return -EAGAIN;
+    copyBytes(data, slotAddr(deque, bottom), deque->type_size);
+    return STEAL_DEQUE_OK;
+}
+
+/**
+ * @details
+ * The element is copied out before `top` is advanced: once the
+ * compare-and-set succeeds the owner may reuse the slot. A failed
+ * compare-and-set means the copy may be torn and is discarded.
+ */
+int stealDequeSteal(StealDeque* deque, void* data) {
+    if (!deque || !data) return -EINVAL;
+    uint32_t top = GET_LOCK_VAL(&deque->top);
+    LOCK_FULL_FENCE();
+    uint32_t bottom = GET_LOCK_VAL(&deque->bottom);
+    if ((int32_t)(bottom - top) <= 0) return -EAGAIN;
+    copyBytes(data, slotAddr(deque, top), deque->type_size);
+    if (!COMPARE_SET_LOCK_FULL(&deque->top, &top, top + 1)) return -EBUSY;
+    return STEAL_DEQUE_OK;
+}
+
+/**
+ * @details
+ * Claiming several elements with a single compare-and-set on `top` would
+ * race the owner's lock-free pop of an element inside the claimed range, so
+ * the batch is a sequence of single steals. Taking at most half of what is
+ * available leaves the owner with work and keeps thieves from ping-ponging
+ * the whole deque between each other.
+ */
+int stealDequeStealBatch(StealDeque* deque, void* data, uint16_t max_count) {
+    if (!deque || !data || max_count == 0) return -EINVAL;
+    uint16_t available = stealDequeCount(deque);
+    if (available == 0) return -EAGAIN;
+    uint16_t target = (available + 1) / 2;
+    if (target > max_count) target = max_count;
+    uint16_t taken = 0;
+    while (taken < target) {
+        int res = stealDequeSteal(deque, (uint8_t*)data + taken * deque->type_size);
+        if (res < STEAL_DEQUE_OK) {
+            if (taken == 0) return res;
+            break;
+        }
+        taken++;
+    }
+    return taken;
+}
@@ -0,0 +1,62 @@
+#include "stream.h"
+#include "cpu.h"
+#include "copy.h"
+#include <stdint.h>
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+/* -- Private Functions --------------------------------------------------- */
+
+#if CPU_X86
+/**
+ * @brief Number of leading bytes to copy normally until `dest` is aligned to `align`.
+ */
+static inline uint16_t alignGap(const uint8_t* dest, uint16_t align, uint16_t size) {
+    uint16_t gap = (uint16_t)((align - ((uintptr_t)dest & (align - 1))) & (align - 1));
+    return gap < size ? gap : size;
+}
+
+CPU_TARGET("avx")
+static void streamAvx(uint8_t* d, const uint8_t* s, uint16_t size) {
+    uint16_t head = alignGap(d, 32, size);
+    copyBytes(d, s, head);
+    uint32_t off = head;
+    for (; off + 32 <= size; off += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(s + off));
+        _mm256_stream_si256((__m256i*)(d + off), v);
+    }
+    copyBytes(d + off, s + off, (uint16_t)(size - off));
+    _mm_sfence();
+}
+
+#ifdef __SSE2__
+static void streamSse2(uint8_t* d, const uint8_t* s, uint16_t size) {
+    uint16_t head = alignGap(d, 16, size);
+    copyBytes(d, s, head);
+    uint32_t off = head;
+    for (; off + 16 <= size; off += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + off));
+        _mm_stream_si128((__m128i*)(d + off), v);
+    }
+    copyBytes(d + off, s + off, (uint16_t)(size - off));
+    _mm_sfence();
+}
+#endif
+#endif
+
+/* -- Public Functions ----------------------------------------------------- */
+
+void streamCopy(void* dest, const void* src, uint16_t size) {
+#if CPU_X86
+    if (cpuHasAvx()) {
+        streamAvx((uint8_t*)dest, (const uint8_t*)src, size);
+        return;
+    }
+#ifdef __SSE2__
+    streamSse2((uint8_t*)dest, (const uint8_t*)src, size);
+    return;
+#endif
+#endif
+    copyBytes(dest, src, size);
+}
@@ -0,0 +1,28 @@
+#pragma once
+/**
+ * @file stream.h
+ * @brief [internal] Copy kernel with non-temporal stores for large slot payloads.
+ *
+ * Non-temporal stores write around the cache, so a producer handing bulk
+ * data to a consumer on another core does not evict its own working set
+ * with lines it will never read again. The kernel is chosen at runtime:
+ * - AVX: 32-byte `vmovntdq` stores.
+ * - SSE2: 16-byte `movntdq` stores; part of the x86-64 baseline.
+ * - Otherwise `copyBytes()`, on every other target or when the library is
+ *   built without `USE_SIMD`.
+ */
+#include <stdint.h>
+
+/**
+ * @brief Copies `size` bytes from `src` to `dest`, bypassing the cache where possible.
+ *
+ * The bytes before the first vector-aligned address of `dest` and after the
+ * last whole vector are copied with ordinary stores. The copy ends with a
+ * store fence, so a subsequent release store (publishing the slot) cannot
+ * become visible before the data.
+ *
+ * @param dest Destination buffer.
+ * @param src  Source buffer, no alignment required.
+ * @param size Number of bytes to copy.
+ */
+void streamCopy(void* dest, const void* src, uint16_t size);
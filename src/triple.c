@@ -0,0 +1,118 @@
+#include "triple.h"
+#include "locking.h"
+#include "copy.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+/* -- Private Functions --------------------------------------------------- */
+
+/** @brief Returns the address of slot `index`. */
+static inline uint8_t* slotAddr(const TripleBuffer* triple, uint8_t index) {
+    return (uint8_t*)triple->raw + (index * triple->type_size);
+}
+
+/* -- Public Functions ----------------------------------------------------- */
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @details
+ * Allocates the `TripleBuffer` structure and a raw block of `3 * type_size`
+ * bytes from the provided BlockAllocator. The reader starts on slot 0, the
+ * shared slot is 1 and the writer starts on slot 2.
+ *
+ * If allocation of the raw block fails, the structure is released again.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+TripleBuffer* tripleBufferAllocate(BlockAllocator* allocator, uint16_t type_size) {
+    if (!allocator || type_size == 0) return NULL;
+    TripleBuffer* triple = (TripleBuffer*)blockAllocate(allocator, sizeof(TripleBuffer));
+    if (!triple) return NULL;
+    triple->raw = blockAllocate(allocator, 3 * type_size);
+    if (!triple->raw) {
+        (void)blockDeallocate(allocator, triple);
+        return NULL;
+    }
+    triple->type_size = type_size;
+    triple->front = 0;
+    triple->back = 2;
+    triple->middle = 1;
+    return triple;
+}
+
+/**
+ * @details
+ * Frees the raw block and then the structure itself. On success, the
+ * caller's pointer is set to NULL.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+int tripleBufferDeallocate(BlockAllocator* allocator, TripleBuffer** triple) {
+    if (!allocator || !triple || !(*triple)) return -EINVAL;
+    int res1, res2;
+    res1 = blockDeallocate(allocator, (*triple)->raw);
+    res2 = blockDeallocate(allocator, *triple);
+    if (res1 != BLOCK_ALLOCATOR_OK) return res1;
+    if (res2 != BLOCK_ALLOCATOR_OK) return res2;
+    *triple = NULL;
+    return TRIPLE_OK;
+}
+#endif
+
+int tripleBufferWriteClaim(TripleBuffer* triple, void** out_addr) {
+    if (!triple || !out_addr) return -EINVAL;
+    *out_addr = slotAddr(triple, triple->back);
+    return TRIPLE_OK;
+}
+
+/**
+ * @details
+ * Swaps the writer's slot with the shared middle slot and marks it fresh.
+ * Whatever the middle slot held (an unread older value or the reader's
+ * previous slot) becomes the writer's next slot.
+ */
+int tripleBufferWriteRelease(TripleBuffer* triple) {
+    if (!triple) return -EINVAL;
+    uint8_t prev = SWAP_LOCK_VAL(&triple->middle, triple->back | TRIPLE_FRESH);
+    triple->back = prev & TRIPLE_INDEX_MASK;
+    return TRIPLE_OK;
+}
+
+int tripleBufferWrite(TripleBuffer* triple, const void* data) {
+    if (!triple || !data) return -EINVAL;
+    copyBytes(slotAddr(triple, triple->back), data, triple->type_size);
+    return tripleBufferWriteRelease(triple);
+}
+
+/**
+ * @details
+ * Checks the fresh flag first so that a reader polling an idle mailbox only
+ * performs a load. When a fresh value is present, the reader's slot is
+ * exchanged with the middle slot.
+ */
+int tripleBufferReadClaim(TripleBuffer* triple, const void** out_addr) {
+    if (!triple || !out_addr) return -EINVAL;
+    int res = -EAGAIN;
+    if (GET_LOCK_VAL(&triple->middle) & TRIPLE_FRESH) {
+        uint8_t prev = SWAP_LOCK_VAL(&triple->middle, triple->front);
+        triple->front = prev & TRIPLE_INDEX_MASK;
+        res = TRIPLE_OK;
+    }
+    *out_addr = slotAddr(triple, triple->front);
+    return res;
+}
+
+int tripleBufferRead(TripleBuffer* triple, void* data) {
+    if (!triple || !data) return -EINVAL;
+    const void* front;
+    int res = tripleBufferReadClaim(triple, &front);
+    if (res < TRIPLE_OK) return res;
+    copyBytes(data, front, triple->type_size);
+    return TRIPLE_OK;
+}
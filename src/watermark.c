@@ -0,0 +1,38 @@
+#include "watermark.h"
+#include "locking.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+/* -- Public Functions ----------------------------------------------------- */
+
+int watermarkInit(Watermark* watermark, uint16_t high, uint16_t low, WatermarkFn fn, void* ctx) {
+    if (!watermark || !fn || low >= high) return -EINVAL;
+    watermark->high = high;
+    watermark->low = low;
+    watermark->fn = fn;
+    watermark->ctx = ctx;
+    PUBLISH_LOCK_VAL(&watermark->raised, 0);
+    PUBLISH_LOCK_VAL(&watermark->delivering, 0);
+    return WATERMARK_OK;
+}
+
+/**
+ * @details
+ * The flip of `raised` and the callback happen together under `delivering`.
+ * A thread that checked `raised` before another delivered the same event
+ * finds it already flipped once it gets the lock and drops its event, so a
+ * late high event can never follow the low event that ended it.
+ */
+void watermarkDeliver(Watermark* watermark, WatermarkEvent event, uint16_t count) {
+    uint8_t from = (event == WATERMARK_HIGH) ? 0 : 1;
+    uint8_t expected = 0;
+    while (!COMPARE_SET_LOCK(&watermark->delivering, &expected, 1)) {
+        expected = 0;
+    }
+    if (GET_LOCK_VAL(&watermark->raised) == from) {
+        PUBLISH_LOCK_VAL(&watermark->raised, (uint8_t)(1 - from));
+        watermark->fn(watermark->ctx, event, count);
+    }
+    PUBLISH_LOCK_VAL(&watermark->delivering, 0);
+}
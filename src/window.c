@@ -0,0 +1,279 @@
+#include "window.h"
+#include "locking.h"
+#include "copy.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+/* -- Private Functions --------------------------------------------------- */
+
+/**
+ * @brief Defines `name`, summing `n` samples of type `T` into an `Acc`.
+ *
+ * Four independent accumulators break the dependency chain of a single
+ * running sum, so the loop pipelines and is left in a shape the compiler
+ * can vectorize. Integer samples are summed in `uint64_t`, which wraps
+ * instead of overflowing.
+ */
+#define DEFINE_SUM_KERNEL(name, T, Acc)                                         \
+    static Acc name(const T* p, uint16_t n) {                                   \
+        Acc a0 = 0, a1 = 0, a2 = 0, a3 = 0;                                     \
+        uint16_t i = 0;                                                         \
+        for (; i + 4 <= n; i += 4) {                                            \
+            a0 += (Acc)p[i];                                                    \
+            a1 += (Acc)p[i + 1];                                                \
+            a2 += (Acc)p[i + 2];                                                \
+            a3 += (Acc)p[i + 3];                                                \
+        }                                                                       \
+        for (; i < n; i++) a0 += (Acc)p[i];                                     \
+        return (a0 + a1) + (a2 + a3);                                           \
+    }
+
+DEFINE_SUM_KERNEL(sumI32, int32_t, uint64_t)
+DEFINE_SUM_KERNEL(sumI64, int64_t, uint64_t)
+DEFINE_SUM_KERNEL(sumF32, float, double)
+DEFINE_SUM_KERNEL(sumF64, double, double)
+
+static inline bool isFloat(WindowType type) {
+    return type == WINDOW_F32 || type == WINDOW_F64;
+}
+
+/**
+ * @brief Reads the sample in `slot` as an aggregate value.
+ */
+static inline WindowValue loadSample(const Window* window, uint16_t slot) {
+    WindowValue value;
+    switch (window->type) {
+        case WINDOW_I32: value.i = ((const int32_t*)window->raw)[slot]; break;
+        case WINDOW_I64: value.i = ((const int64_t*)window->raw)[slot]; break;
+        case WINDOW_F32: value.f = ((const float*)window->raw)[slot]; break;
+        default:         value.f = ((const double*)window->raw)[slot]; break;
+    }
+    return value;
+}
+
+static inline bool lessThan(WindowType type, WindowValue a, WindowValue b) {
+    return isFloat(type) ? (a.f < b.f) : (a.i < b.i);
+}
+
+/**
+ * @brief Adds `sign * value` to the running sum.
+ */
+static inline void sumUpdate(Window* window, WindowValue value, int sign) {
+    if (isFloat(window->type)) {
+        window->sum.f += sign * value.f;
+    } else {
+        uint64_t delta = (sign > 0) ? (uint64_t)value.i : (uint64_t)0 - (uint64_t)value.i;
+        window->sum.i = (int64_t)((uint64_t)window->sum.i + delta);
+    }
+}
+
+/**
+ * @brief Sums every sample in the window with the bulk kernel of its type.
+ *
+ * The stored samples always occupy slots `0` to `count - 1`, either because
+ * the window has not wrapped yet or because it is full.
+ */
+static WindowValue sumSamples(const Window* window) {
+    WindowValue sum;
+    switch (window->type) {
+        case WINDOW_I32: sum.i = (int64_t)sumI32((const int32_t*)window->raw, window->count); break;
+        case WINDOW_I64: sum.i = (int64_t)sumI64((const int64_t*)window->raw, window->count); break;
+        case WINDOW_F32: sum.f = sumF32((const float*)window->raw, window->count); break;
+        default:         sum.f = sumF64((const double*)window->raw, window->count); break;
+    }
+    return sum;
+}
+
+/**
+ * @brief Appends `slot` to a monotonic deque.
+ *
+ * Entries at the back that the new sample dominates can never become the
+ * extreme again while it is in the window, so they are dropped first.
+ */
+static void extremePush(Window* window, WindowDeque* deque, uint16_t slot, WindowValue value, bool is_min) {
+    while (deque->len > 0) {
+        uint16_t back = deque->slots[(deque->first + deque->len - 1) % window->size];
+        WindowValue other = loadSample(window, back);
+        bool dominated = is_min ? !lessThan(window->type, other, value)
+                                : !lessThan(window->type, value, other);
+        if (!dominated) break;
+        deque->len--;
+    }
+    deque->slots[(deque->first + deque->len) % window->size] = slot;
+    deque->len++;
+}
+
+/**
+ * @brief Removes `slot` from a monotonic deque as it leaves the window.
+ *
+ * The evicted sample is the oldest one, so it can only be at the front.
+ */
+static void extremeEvict(Window* window, WindowDeque* deque, uint16_t slot) {
+    if (deque->len == 0 || deque->slots[deque->first] != slot) return;
+    deque->first = (uint16_t)((deque->first + 1) % window->size);
+    deque->len--;
+}
+
+static inline WindowValue extremeFront(const Window* window, const WindowDeque* deque) {
+    return loadSample(window, deque->slots[deque->first]);
+}
+
+/* -- Public Functions ----------------------------------------------------- */
+
+#ifdef USE_BITMAP_ALLOCATOR
+/**
+ * @details
+ * Allocates the window structure, the sample ring, both deques and the lock
+ * from the provided BlockAllocator. If any allocation fails, all
+ * intermediate allocations are cleaned up to avoid leaks.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+Window* windowAllocate(BlockAllocator* allocator, uint16_t size, WindowType type) {
+    if (!allocator) return NULL;
+    if (size == 0 || type > WINDOW_F64) return NULL;
+    Window* window = (Window*)blockAllocate(allocator, sizeof(Window));
+    if (!window) return NULL;
+    *window = (Window){ .size = size, .type = type };
+    window->raw = blockAllocate(allocator, size * WINDOW_TYPE_SIZE(type));
+    window->min.slots = blockAllocate(allocator, size * sizeof(uint16_t));
+    window->max.slots = blockAllocate(allocator, size * sizeof(uint16_t));
+    window->lock = lockAllocate(allocator, 1);
+    if (!window->raw || !window->min.slots || !window->max.slots || !window->lock) {
+        if (window->raw) (void)blockDeallocate(allocator, window->raw);
+        if (window->min.slots) (void)blockDeallocate(allocator, window->min.slots);
+        if (window->max.slots) (void)blockDeallocate(allocator, window->max.slots);
+        if (window->lock) (void)lockDeallocate(allocator, &window->lock);
+        (void)blockDeallocate(allocator, window);
+        return NULL;
+    }
+    windowClear(window);
+    return window;
+}
+
+/**
+ * @details
+ * Frees the lock, both deques, the sample ring and the window structure
+ * itself. On success, the caller's window pointer is set to NULL.
+ *
+ * @note
+ * This function is only available if `USE_BITMAP_ALLOCATOR` is defined.
+ */
+int windowDeallocate(BlockAllocator* allocator, Window** window) {
+    if (!allocator || !window || !(*window)) return -EINVAL;
+    int res1 = lockDeallocate(allocator, &(*window)->lock);
+    int res2 = blockDeallocate(allocator, (*window)->max.slots);
+    int res3 = blockDeallocate(allocator, (*window)->min.slots);
+    int res4 = blockDeallocate(allocator, (*window)->raw);
+    int res5 = blockDeallocate(allocator, *window);
+    if (res1 != LOCK_OK) return res1;
+    if (res2 != BLOCK_ALLOCATOR_OK) return res2;
+    if (res3 != BLOCK_ALLOCATOR_OK) return res3;
+    if (res4 != BLOCK_ALLOCATOR_OK) return res4;
+    if (res5 != BLOCK_ALLOCATOR_OK) return res5;
+    *window = NULL;
+    return WINDOW_OK;
+}
+#endif
+
+void windowClear(Window* window) {
+    if (!window) return;
+    window->min.first = window->min.len = 0;
+    window->max.first = window->max.len = 0;
+    window->sum = (WindowValue){ 0 };
+    window->count = 0;
+    window->head = 0;
+    window->since_sum = 0;
+}
+
+/**
+ * @details
+ * When the window is full, the sample in the slot about to be overwritten
+ * leaves the sum and, if it is the current extreme, the front of a deque.
+ */
+int windowPush(Window* window, const void* sample) {
+    if (!window || !sample) return -EINVAL;
+    if (!TAKE_WINDOW_LOCK(window->lock)) return -EBUSY;
+    uint16_t slot = window->head;
+    if (window->count == window->size) {
+        extremeEvict(window, &window->min, slot);
+        extremeEvict(window, &window->max, slot);
+        sumUpdate(window, loadSample(window, slot), -1);
+    } else {
+        window->count++;
+    }
+    uint16_t type_size = WINDOW_TYPE_SIZE(window->type);
+    copyBytes((uint8_t*)window->raw + slot * type_size, sample, type_size);
+    WindowValue value = loadSample(window, slot);
+    sumUpdate(window, value, 1);
+    extremePush(window, &window->min, slot, value, true);
+    extremePush(window, &window->max, slot, value, false);
+    window->head = (uint16_t)((slot + 1 == window->size) ? 0 : slot + 1);
+    // drop the rounding error accumulated over a full lap of the ring
+    if (isFloat(window->type) && ++window->since_sum >= window->size) {
+        window->sum = sumSamples(window);
+        window->since_sum = 0;
+    }
+    CLEAR_WINDOW_LOCK(window->lock);
+    return WINDOW_OK;
+}
+
+/**
+ * @details
+ * The samples are copied into slots `0` to `count - 1`, the deques are
+ * rebuilt in one pass, and the sum is taken with the bulk kernel rather
+ * than accumulated sample by sample.
+ */
+int windowReset(Window* window, const void* samples, uint16_t count) {
+    if (!window || (!samples && count > 0)) return -EINVAL;
+    if (!TAKE_WINDOW_LOCK(window->lock)) return -EBUSY;
+    uint16_t type_size = WINDOW_TYPE_SIZE(window->type);
+    const uint8_t* src = (const uint8_t*)samples;
+    if (count > window->size) {
+        src += (uint32_t)(count - window->size) * type_size;
+        count = window->size;
+    }
+    windowClear(window);
+    uint8_t* dst = (uint8_t*)window->raw;
+    for (uint16_t slot = 0; slot < count; slot++) {
+        copyBytes(dst + slot * type_size, src + slot * type_size, type_size);
+        WindowValue value = loadSample(window, slot);
+        extremePush(window, &window->min, slot, value, true);
+        extremePush(window, &window->max, slot, value, false);
+    }
+    window->count = count;
+    window->head = (uint16_t)(count % window->size);
+    window->sum = sumSamples(window);
+    CLEAR_WINDOW_LOCK(window->lock);
+    return WINDOW_OK;
+}
+
+int windowStats(Window* window, WindowStats* stats) {
+    if (!window || !stats) return -EINVAL;
+    if (!TAKE_WINDOW_LOCK(window->lock)) return -EBUSY;
+    if (window->count == 0) {
+        CLEAR_WINDOW_LOCK(window->lock);
+        return -EAGAIN;
+    }
+    stats->count = window->count;
+    stats->sum = window->sum;
+    stats->min = extremeFront(window, &window->min);
+    stats->max = extremeFront(window, &window->max);
+    stats->mean = isFloat(window->type) ? window->sum.f / window->count
+                                        : (double)window->sum.i / window->count;
+    CLEAR_WINDOW_LOCK(window->lock);
+    return WINDOW_OK;
+}
+
+bool windowIsEmpty(const Window* window) {
+    return window->count == 0;
+}
+
+bool windowIsFull(const Window* window) {
+    return window->count == window->size;
+}
@@ -0,0 +1,160 @@
+#include "async.hpp"
+extern "C" {
+#include "test_utils.h"
+}
+#include <coroutine>
+#include <cstring>
+#include <errno.h>
+
+using namespace buffers;
+
+/** Fire-and-forget coroutine used to drive the awaitables. */
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() {}
+    };
+};
+
+static Detached consume(AsyncBuffer<uint32_t>& ring, uint32_t* out, int* steps) {
+    *out = co_await ring.pop();
+    (*steps)++;
+}
+
+static Detached produce(AsyncBuffer<uint32_t>& ring, uint32_t value, int* steps) {
+    co_await ring.push(value);
+    (*steps)++;
+}
+
+struct Batch {
+    std::coroutine_handle<> handles[ASYNC_RESUME_BATCH];
+    std::size_t count = 0;
+    int posts = 0;
+};
+
+static void collect(void* ctx, std::coroutine_handle<>* handles, std::size_t count) {
+    Batch* batch = static_cast<Batch*>(ctx);
+    for (std::size_t i = 0; i < count; i++) batch->handles[batch->count++] = handles[i];
+    batch->posts++;
+}
+
+void test_asyncBuffer() {
+    TEST_CASE("Completes inline when data is available") {
+        CREATE_BUFFER(buf, 4, sizeof(uint32_t));
+        AsyncBuffer<uint32_t> ring(&buf);
+        uint32_t v = 42;
+        (void)bufferWrite(&buf, &v);
+        uint32_t out = 0;
+        int steps = 0;
+        consume(ring, &out, &steps);
+        ASSERT_EQUAL_INT(steps, 1, "consumer should not suspend");
+        ASSERT_EQUAL_INT(out, 42, "data mismatch");
+        ASSERT_EQUAL_INT(ring.waiting(), 0, "nobody should be waiting");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Pop suspends until a push") {
+        CREATE_BUFFER(buf, 4, sizeof(uint32_t));
+        AsyncBuffer<uint32_t> ring(&buf);
+        uint32_t out = 0;
+        int consumed = 0, produced = 0;
+        consume(ring, &out, &consumed);
+        ASSERT_EQUAL_INT(consumed, 0, "consumer should be suspended");
+        ASSERT_EQUAL_INT(ring.waiting(), 1, "consumer should be waiting");
+        produce(ring, 7, &produced);
+        ASSERT_EQUAL_INT(produced, 1, "producer should complete inline");
+        ASSERT_EQUAL_INT(consumed, 1, "consumer should have been resumed");
+        ASSERT_EQUAL_INT(out, 7, "data mismatch");
+        ASSERT_TRUE(bufferIsEmpty(&buf), "value should be handed over, not left in the ring");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Push suspends until a pop") {
+        CREATE_BUFFER(buf, 1, sizeof(uint32_t));
+        AsyncBuffer<uint32_t> ring(&buf);
+        int produced = 0, consumed = 0;
+        produce(ring, 1, &produced);
+        produce(ring, 2, &produced);
+        ASSERT_EQUAL_INT(produced, 1, "second producer should be suspended");
+        uint32_t out = 0;
+        consume(ring, &out, &consumed);
+        ASSERT_EQUAL_INT(out, 1, "data mismatch");
+        ASSERT_EQUAL_INT(produced, 2, "second producer should have been resumed");
+        consume(ring, &out, &consumed);
+        ASSERT_EQUAL_INT(out, 2, "data mismatch");
+        ASSERT_EQUAL_INT(consumed, 2, "both values should be consumed");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Resumptions are batched onto the resumer") {
+        CREATE_BUFFER(buf, 4, sizeof(uint32_t));
+        Batch batch;
+        AsyncBuffer<uint32_t> ring(&buf, Resumer{collect, &batch});
+        uint32_t out[3] = {0};
+        int consumed = 0, produced = 0;
+        for (int i = 0; i < 3; i++) consume(ring, &out[i], &consumed);
+        ASSERT_EQUAL_INT(ring.waiting(), 3, "all consumers should be waiting");
+        uint32_t values[3] = {10, 11, 12};
+        for (int i = 0; i < 3; i++) (void)bufferWrite(&buf, &values[i]);
+        produce(ring, 13, &produced);
+        ASSERT_EQUAL_INT(batch.posts, 1, "resumptions should be posted in one batch");
+        ASSERT_EQUAL_INT(batch.count, 3, "every waiter should be in the batch");
+        ASSERT_EQUAL_INT(consumed, 0, "resumer decides when to resume");
+        for (std::size_t i = 0; i < batch.count; i++) batch.handles[i].resume();
+        ASSERT_EQUAL_INT(consumed, 3, "consumers should have run");
+        ASSERT_EQUAL_INT(out[0], 10, "waiters should be served in order");
+        ASSERT_EQUAL_INT(out[2], 12, "waiters should be served in order");
+    } CASE_COMPLETE;
+}
+
+static Detached popStack(AsyncStack<uint32_t>& stack, uint32_t* out) {
+    *out = co_await stack.pop();
+}
+
+void test_asyncStack() {
+    TEST_CASE("Pops newest element") {
+        CREATE_STACK(raw, 4, sizeof(uint32_t));
+        AsyncStack<uint32_t> stack(&raw);
+        uint32_t out = 0;
+        popStack(stack, &out);
+        ASSERT_EQUAL_INT(stack.waiting(), 1, "pop on empty stack should suspend");
+        Detached([](AsyncStack<uint32_t>& s) -> Detached {
+            co_await s.push(5);
+            co_await s.push(6);
+        }(stack));
+        ASSERT_EQUAL_INT(out, 5, "waiter should receive the first push");
+        popStack(stack, &out);
+        ASSERT_EQUAL_INT(out, 6, "data mismatch");
+    } CASE_COMPLETE;
+}
+
+static Detached popQueue(AsyncQueue& queue, uint8_t* dest, uint16_t cap, int* len) {
+    *len = co_await queue.pop({dest, cap});
+}
+
+void test_asyncQueue() {
+    TEST_CASE("Message round trip") {
+        CREATE_QUEUE(raw, 16, 2);
+        AsyncQueue queue(&raw);
+        uint8_t dest[16] = {0};
+        int len = 0;
+        popQueue(queue, dest, sizeof(dest), &len);
+        ASSERT_EQUAL_INT(queue.waiting(), 1, "pop on empty queue should suspend");
+        const uint8_t msg[] = "hello";
+        int written = 0;
+        Detached([](AsyncQueue& q, const uint8_t* m, int* w) -> Detached {
+            *w = co_await q.push({m, 5});
+        }(queue, msg, &written));
+        ASSERT_EQUAL_INT(written, 5, "bytes written mismatch");
+        ASSERT_EQUAL_INT(len, 5, "bytes read mismatch");
+        ASSERT_EQUAL_STR(dest, msg, 5, "data mismatch");
+    } CASE_COMPLETE;
+}
+
+int main() {
+    LOG_INFO("ASYNC TESTS\n");
+    TEST_EVAL(test_asyncBuffer);
+    TEST_EVAL(test_asyncStack);
+    TEST_EVAL(test_asyncQueue);
+    return testGetStatus();
+}
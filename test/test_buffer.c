@@ -99,6 +99,57 @@ void test_bufferClear() {
         ASSERT_EQUAL_INT(buf.size, 8, "size reset on clear");
         ASSERT_EQUAL_INT(buf.type_size, sizeof(uint8_t), "size reset on clear");
     } CASE_COMPLETE;
+
+    TEST_CASE("Frees ready slots") {
+        CREATE_BUFFER(buf, 4, sizeof(uint8_t));
+        uint8_t val = 7;
+        for (int i = 0; i < 4; i++) (void)bufferWrite(&buf, &val);
+        bufferClear(&buf);
+        ASSERT_TRUE(bufferIsEmpty(&buf), "should be empty after clear");
+        for (int i = 0; i < 4; i++)
+            ASSERT_EQUAL_INT(bufferWrite(&buf, &val), i, "slot should be writable again");
+        ASSERT_TRUE(bufferIsFull(&buf), "should be full again");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalidates claimed slots") {
+        CREATE_BUFFER(buf, 4, sizeof(uint8_t));
+        uint8_t val = 7;
+        void* addr;
+        (void)bufferWrite(&buf, &val);
+        int read_index = bufferReadClaim(&buf, &addr);
+        int write_index = bufferWriteClaim(&buf, &addr);
+        bufferClear(&buf);
+        ASSERT_EQUAL_INT(bufferWriteRelease(&buf, write_index), -ESTALE, "stale write release expected");
+        ASSERT_EQUAL_INT(bufferReadRelease(&buf, read_index), -ESTALE, "stale read release expected");
+        ASSERT_TRUE(bufferIsEmpty(&buf), "stale write should not be published");
+        for (int i = 0; i < 4; i++)
+            ASSERT_EQUAL_INT(bufferWrite(&buf, &val), i, "slot should be writable after release");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Claimed slots stay stale when the epoch wraps") {
+        CREATE_BUFFER(buf, 4, sizeof(uint8_t));
+        uint8_t val = 7;
+        void* addr;
+        (void)bufferWrite(&buf, &val);
+        int read_index = bufferReadClaim(&buf, &addr);
+        int write_index = bufferWriteClaim(&buf, &addr);
+        // twice around the 31 epochs
+        for (int i = 0; i < 62; i++) bufferClear(&buf);
+        ASSERT_EQUAL_INT(bufferWriteRelease(&buf, write_index), -ESTALE, "stale write release expected");
+        ASSERT_EQUAL_INT(bufferReadRelease(&buf, read_index), -ESTALE, "stale read release expected");
+        ASSERT_TRUE(bufferIsEmpty(&buf), "stale write should not be published");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Claimed slot blocks until released") {
+        CREATE_BUFFER(buf, 4, sizeof(uint8_t));
+        uint8_t val = 7;
+        void* addr;
+        int index = bufferWriteClaim(&buf, &addr);
+        bufferClear(&buf);
+        ASSERT_EQUAL_INT(bufferWrite(&buf, &val), -EBUSY, "claimed slot should not be reused");
+        (void)bufferWriteRelease(&buf, index);
+        ASSERT_EQUAL_INT(bufferWrite(&buf, &val), 0, "slot should be reusable after release");
+    } CASE_COMPLETE;
 }
 
 void test_bufferWrite() {
@@ -225,6 +276,421 @@ void test_BufferFill() {
     } CASE_COMPLETE;
 }
 
+static bool keepEven(void* ctx, const void* element) {
+    (void)ctx;
+    return (*(const uint8_t*)element % 2) == 0;
+}
+
+static void widen(void* ctx, void* dst, const void* src) {
+    *(uint32_t*)dst = *(const uint8_t*)src + *(uint32_t*)ctx;
+}
+
+typedef struct {
+    Buffer* src;
+    Buffer* dst;
+    int claimed;
+} TransferRace;
+
+// Stands in for a second reader of src and a writer of dst racing the transfer
+static bool raceTransfer(void* ctx, const void* element) {
+    (void)element;
+    TransferRace* race = (TransferRace*)ctx;
+    uint8_t fill = 0xFF;
+    void* addr;
+    (void)bufferWrite(race->dst, &fill);
+    race->claimed = bufferReadClaim(race->src, &addr);
+    return true;
+}
+
+void test_bufferTransfer() {
+    TEST_CASE("Moves elements in order") {
+        CREATE_BUFFER(src, 8, sizeof(TestStruct));
+        CREATE_BUFFER(dst, 8, sizeof(TestStruct));
+        for (int i = 0; i < 3; i++) {
+            TestStruct in = { .flag = true, .data = 10 + i, .ptr = NULL };
+            (void)bufferWrite(&src, &in);
+        }
+        int res = bufferTransfer(&src, &dst, 8);
+        ASSERT_EQUAL_INT(res, 3, "Expected all elements to move");
+        ASSERT_TRUE(bufferIsEmpty(&src), "Source should be empty");
+        for (int i = 0; i < 3; i++) {
+            TestStruct out;
+            ASSERT_TRUE(bufferRead(&dst, &out) >= BUFFER_OK, "Read failed");
+            ASSERT_EQUAL_INT(out.data, 10 + i, "Element mismatch");
+        }
+    } CASE_COMPLETE;
+
+    TEST_CASE("Stops when destination is full") {
+        CREATE_BUFFER(src, 8, sizeof(uint8_t));
+        CREATE_BUFFER(dst, 2, sizeof(uint8_t));
+        for (uint8_t i = 0; i < 4; i++) (void)bufferWrite(&src, &i);
+        int res = bufferTransfer(&src, &dst, 8);
+        ASSERT_EQUAL_INT(res, 2, "Expected only two elements to move");
+        ASSERT_TRUE(bufferIsFull(&dst), "Destination should be full");
+        res = bufferTransfer(&src, &dst, 8);
+        ASSERT_EQUAL_INT(res, -ENOSPC, "Expected full destination");
+        uint8_t out;
+        ASSERT_TRUE(bufferRead(&src, &out) >= BUFFER_OK, "Read failed");
+        ASSERT_EQUAL_INT(out, 2, "Remaining elements should stay in source");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Requeues an element it can neither move nor unclaim") {
+        CREATE_BUFFER(src, 4, sizeof(uint8_t));
+        CREATE_BUFFER(dst, 1, sizeof(uint8_t));
+        for (uint8_t i = 0; i < 2; i++) (void)bufferWrite(&src, &i);
+        TransferRace race = { .src = &src, .dst = &dst };
+        int res = bufferTransferWith(&src, &dst, 8, raceTransfer, NULL, &race);
+        ASSERT_EQUAL_INT(res, -ENOSPC, "Expected full destination");
+        ASSERT_TRUE(race.claimed >= BUFFER_OK, "Second reader claim failed");
+        ASSERT_TRUE(bufferReadRelease(&src, (uint16_t)race.claimed) >= BUFFER_OK, "Release failed");
+        uint8_t out;
+        ASSERT_TRUE(bufferRead(&src, &out) >= BUFFER_OK, "Element should be back in source");
+        ASSERT_EQUAL_INT(out, 0, "Requeued element mismatch");
+        ASSERT_TRUE(bufferIsEmpty(&src), "Source should be empty");
+        ASSERT_EQUAL_INT(bufferDropped(&src), 0, "Nothing should be dropped");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Counts an element neither side has room for") {
+        CREATE_BUFFER(src, 2, sizeof(uint8_t));
+        CREATE_BUFFER(dst, 1, sizeof(uint8_t));
+        for (uint8_t i = 0; i < 2; i++) (void)bufferWrite(&src, &i);
+        TransferRace race = { .src = &src, .dst = &dst };
+        int res = bufferTransferWith(&src, &dst, 8, raceTransfer, NULL, &race);
+        ASSERT_EQUAL_INT(res, 0, "Nothing should be moved");
+        ASSERT_EQUAL_INT(bufferDropped(&src), 1, "Drop should be counted");
+        ASSERT_TRUE(bufferReadRelease(&src, (uint16_t)race.claimed) >= BUFFER_OK, "Release failed");
+        ASSERT_TRUE(bufferIsEmpty(&src), "Source should be empty");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Respects max_count") {
+        CREATE_BUFFER(src, 8, sizeof(uint8_t));
+        CREATE_BUFFER(dst, 8, sizeof(uint8_t));
+        for (uint8_t i = 0; i < 4; i++) (void)bufferWrite(&src, &i);
+        ASSERT_EQUAL_INT(bufferTransfer(&src, &dst, 3), 3, "Expected three elements to move");
+        ASSERT_FALSE(bufferIsEmpty(&src), "One element should remain");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Empty source") {
+        CREATE_BUFFER(src, 8, sizeof(uint8_t));
+        CREATE_BUFFER(dst, 8, sizeof(uint8_t));
+        ASSERT_EQUAL_INT(bufferTransfer(&src, &dst, 8), -EAGAIN, "Expected empty source");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Filters elements") {
+        CREATE_BUFFER(src, 8, sizeof(uint8_t));
+        CREATE_BUFFER(dst, 8, sizeof(uint8_t));
+        for (uint8_t i = 0; i < 6; i++) (void)bufferWrite(&src, &i);
+        int res = bufferTransferWith(&src, &dst, 8, keepEven, NULL, NULL);
+        ASSERT_EQUAL_INT(res, 3, "Expected three even elements");
+        ASSERT_TRUE(bufferIsEmpty(&src), "Filtered elements should be consumed");
+        uint8_t out;
+        for (uint8_t i = 0; i < 6; i += 2) {
+            (void)bufferRead(&dst, &out);
+            ASSERT_EQUAL_INT(out, i, "Element mismatch");
+        }
+    } CASE_COMPLETE;
+
+    TEST_CASE("Maps between element sizes") {
+        CREATE_BUFFER(src, 8, sizeof(uint8_t));
+        CREATE_BUFFER(dst, 8, sizeof(uint32_t));
+        uint32_t offset = 1000;
+        for (uint8_t i = 0; i < 3; i++) (void)bufferWrite(&src, &i);
+        int res = bufferTransferWith(&src, &dst, 8, NULL, widen, &offset);
+        ASSERT_EQUAL_INT(res, 3, "Expected all elements to move");
+        uint32_t out;
+        for (uint32_t i = 0; i < 3; i++) {
+            (void)bufferRead(&dst, &out);
+            ASSERT_EQUAL_INT(out, 1000 + i, "Mapped element mismatch");
+        }
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_BUFFER(src, 8, sizeof(uint8_t));
+        CREATE_BUFFER(dst, 8, sizeof(uint16_t));
+        ASSERT_EQUAL_INT(bufferTransfer(NULL, &dst, 1), -EINVAL, "NULL source");
+        ASSERT_EQUAL_INT(bufferTransfer(&src, NULL, 1), -EINVAL, "NULL destination");
+        ASSERT_EQUAL_INT(bufferTransfer(&src, &src, 1), -EINVAL, "Same buffer");
+        ASSERT_EQUAL_INT(bufferTransfer(&src, &dst, 1), -EINVAL, "Element size mismatch");
+    } CASE_COMPLETE;
+}
+
+typedef struct {
+    uint64_t id;
+    uint32_t tag;
+    uint16_t kind;
+    uint8_t flag;
+    uint8_t pad;
+} ScanRecord;
+
+void test_bufferFind() {
+    TEST_CASE("Packed keys across the wrap") {
+        CREATE_BUFFER(buffer, 300, sizeof(uint32_t));
+        for (uint32_t v = 0; v < 300; v++) (void)bufferWrite(&buffer, &v);
+        uint32_t out;
+        for (int i = 0; i < 50; i++) (void)bufferRead(&buffer, &out);
+        for (uint32_t v = 300; v < 350; v++) (void)bufferWrite(&buffer, &v);
+        ASSERT_EQUAL_INT(bufferFind(&buffer, 0, 4, 299), 299, "match before the wrap");
+        ASSERT_EQUAL_INT(bufferFind(&buffer, 0, 4, 320), 20, "match after the wrap");
+        ASSERT_EQUAL_INT(bufferFind(&buffer, 0, 4, 10), -ENOENT, "consumed element should not match");
+        ASSERT_EQUAL_INT(bufferCountMatches(&buffer, 0, 4, 320), 1, "expected one match");
+        ASSERT_EQUAL_INT(bufferCountMatches(&buffer, 0, 2, 0), 0, "no element has a zero low half");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Packed keys of every width") {
+        CREATE_BUFFER(bytes, 200, sizeof(uint8_t));
+        CREATE_BUFFER(words, 200, sizeof(uint64_t));
+        for (int i = 0; i < 200; i++) {
+            uint8_t b = (uint8_t)(i % 10);
+            uint64_t w = (uint64_t)(i % 10) << 40;
+            (void)bufferWrite(&bytes, &b);
+            (void)bufferWrite(&words, &w);
+        }
+        ASSERT_EQUAL_INT(bufferFind(&bytes, 0, 1, 7), 7, "first byte match");
+        ASSERT_EQUAL_INT(bufferCountMatches(&bytes, 0, 1, 7), 20, "byte matches");
+        ASSERT_EQUAL_INT(bufferCountMatches(&words, 0, 8, 3ull << 40), 20, "64-bit matches");
+        ASSERT_EQUAL_INT(bufferCountMatches(&words, 0, 8, 3), 0, "high bits must match too");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Key fields inside larger elements") {
+        CREATE_BUFFER(buffer, 100, sizeof(ScanRecord));
+        for (uint32_t i = 0; i < 100; i++) {
+            ScanRecord r = { .id = i * 1000ull, .tag = i % 5, .kind = (uint16_t)(i % 7), .flag = (uint8_t)(i % 3) };
+            (void)bufferWrite(&buffer, &r);
+        }
+        ASSERT_EQUAL_INT(bufferFind(&buffer, 0, 8, 42000), 42, "64-bit field");
+        ASSERT_EQUAL_INT(bufferCountMatches(&buffer, 8, 4, 2), 20, "32-bit field");
+        ASSERT_EQUAL_INT(bufferCountMatches(&buffer, 12, 2, 3), 14, "16-bit field");
+        ASSERT_EQUAL_INT(bufferCountMatches(&buffer, 14, 1, 1), 33, "8-bit field");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Claimed slots are skipped") {
+        CREATE_BUFFER(buffer, 8, sizeof(uint32_t));
+        uint32_t v = 7;
+        (void)bufferWrite(&buffer, &v);
+        void* addr;
+        int index = bufferWriteClaim(&buffer, &addr);
+        *(uint32_t*)addr = 7;
+        ASSERT_EQUAL_INT(bufferCountMatches(&buffer, 0, 4, 7), 1, "claimed slot should not count");
+        (void)bufferWriteRelease(&buffer, (uint16_t)index);
+        ASSERT_EQUAL_INT(bufferCountMatches(&buffer, 0, 4, 7), 2, "released slot should count");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_BUFFER(buffer, 8, sizeof(uint32_t));
+        ASSERT_EQUAL_INT(bufferFind(NULL, 0, 4, 0), -EINVAL, "NULL buffer");
+        ASSERT_EQUAL_INT(bufferFind(&buffer, 0, 3, 0), -EINVAL, "unsupported width");
+        ASSERT_EQUAL_INT(bufferFind(&buffer, 2, 4, 0), -EINVAL, "field past the element");
+        ASSERT_EQUAL_INT(bufferFind(&buffer, 0, 4, 0), -ENOENT, "empty buffer");
+        ASSERT_EQUAL_INT(bufferCountMatches(&buffer, 0, 4, 0), 0, "empty buffer");
+    } CASE_COMPLETE;
+}
+
+void test_bufferChecksums() {
+    TEST_CASE("Checksum of a known vector") {
+        CREATE_BUFFER(buffer, 4, 9);
+        uint32_t crc[4];
+        ASSERT_EQUAL_INT(bufferSetChecksums(&buffer, crc), BUFFER_OK, "enable checksums");
+        int index = bufferWrite(&buffer, "123456789");
+        ASSERT_EQUAL_INT(index, 0, "write should succeed");
+        ASSERT_EQUAL_INT(crc[0] == 0xE3069283u, 1, "CRC32C check value");
+        char out[9];
+        ASSERT_EQUAL_INT(bufferRead(&buffer, out), 0, "intact element should verify");
+        ASSERT_EQUAL_INT(out[8], '9', "data should be copied");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Corrupted slots are reported") {
+        CREATE_BUFFER(buffer, 4, 64);
+        uint32_t crc[4];
+        (void)bufferSetChecksums(&buffer, crc);
+        uint8_t in[64], out[64];
+        for (int i = 0; i < 64; i++) in[i] = (uint8_t)(i * 7);
+        (void)bufferWrite(&buffer, in);
+        (void)bufferWrite(&buffer, in);
+        ((uint8_t*)buffer.raw)[5] ^= 0x10;
+        ASSERT_EQUAL_INT(bufferRead(&buffer, out), -EBADMSG, "flipped bit should be detected");
+        ASSERT_EQUAL_INT(bufferRead(&buffer, out), 1, "corrupted element should be consumed");
+        ASSERT_EQUAL_INT(bufferIsEmpty(&buffer), true, "buffer should be empty");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Partial writes and reads cover the whole slot") {
+        CREATE_BUFFER(buffer, 4, 16);
+        uint32_t crc[4];
+        (void)bufferSetChecksums(&buffer, crc);
+        uint8_t out[16];
+        (void)bufferWriteRaw(&buffer, "abc", 3);
+        ASSERT_EQUAL_INT(bufferReadRaw(&buffer, out, 2), 0, "short read should verify");
+        (void)bufferWriteRaw(&buffer, "abc", 3);
+        ((uint8_t*)buffer.raw)[16 + 12] ^= 1;
+        ASSERT_EQUAL_INT(bufferReadRaw(&buffer, out, 3), -EBADMSG, "corruption past the data should be detected");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Zero-copy writers and readers") {
+        CREATE_BUFFER(buffer, 4, sizeof(uint64_t));
+        uint32_t crc[4];
+        (void)bufferSetChecksums(&buffer, crc);
+        void* addr;
+        int index = bufferWriteClaim(&buffer, &addr);
+        *(uint64_t*)addr = 0x0123456789ABCDEFull;
+        (void)bufferWriteRelease(&buffer, (uint16_t)index);
+        index = bufferReadClaim(&buffer, &addr);
+        ASSERT_EQUAL_INT(bufferVerify(&buffer, (uint16_t)index), BUFFER_OK, "released slot should verify");
+        *(uint64_t*)addr = 0;
+        ASSERT_EQUAL_INT(bufferVerify(&buffer, (uint16_t)index), -EBADMSG, "modified slot should not verify");
+        (void)bufferReadRelease(&buffer, (uint16_t)index);
+        ASSERT_EQUAL_INT(bufferVerify(&buffer, 4), -EINVAL, "index out of range");
+        (void)bufferSetChecksums(&buffer, NULL);
+        ASSERT_EQUAL_INT(bufferVerify(&buffer, 0), BUFFER_OK, "disabled checksums always verify");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Transfers stop at corrupted elements") {
+        CREATE_BUFFER(src, 4, sizeof(uint32_t));
+        CREATE_BUFFER(dst, 4, sizeof(uint32_t));
+        uint32_t src_crc[4], dst_crc[4];
+        (void)bufferSetChecksums(&src, src_crc);
+        (void)bufferSetChecksums(&dst, dst_crc);
+        for (uint32_t v = 1; v <= 3; v++) (void)bufferWrite(&src, &v);
+        ((uint32_t*)src.raw)[1] = 99;
+        ASSERT_EQUAL_INT(bufferTransfer(&src, &dst, 3), 1, "transfer should stop at the corrupted element");
+        ASSERT_EQUAL_INT(bufferTransfer(&src, &dst, 3), 1, "corrupted element should be consumed");
+        uint32_t out;
+        ASSERT_EQUAL_INT(bufferRead(&dst, &out), 0, "moved element should verify");
+        ASSERT_EQUAL_INT(out, 1, "first element");
+        ASSERT_EQUAL_INT(bufferRead(&dst, &out), 1, "moved element should verify");
+        ASSERT_EQUAL_INT(out, 3, "third element");
+        (void)bufferWrite(&src, &out);
+        ((uint32_t*)src.raw)[3] = 99;
+        ASSERT_EQUAL_INT(bufferTransfer(&src, &dst, 3), -EBADMSG, "corruption before any move is reported");
+        ASSERT_EQUAL_INT(bufferIsEmpty(&src), true, "corrupted element should be consumed");
+        ASSERT_EQUAL_INT(bufferIsEmpty(&dst), true, "nothing should be moved");
+    } CASE_COMPLETE;
+}
+
+void test_bufferPrefetch() {
+#ifdef USE_PREFETCH
+    TEST_CASE("Reads and writes are unchanged across the wrap") {
+        CREATE_BUFFER(buffer, 8, 200);
+        ASSERT_EQUAL_INT(bufferSetPrefetch(&buffer, 3), BUFFER_OK, "set distance");
+        uint8_t in[200], out[200];
+        for (int lap = 0; lap < 3; lap++) {
+            for (int i = 0; i < 8; i++) {
+                in[0] = (uint8_t)(lap * 8 + i);
+                ASSERT_EQUAL_INT(bufferWrite(&buffer, in), i, "write should succeed");
+            }
+            for (int i = 0; i < 8; i++) {
+                ASSERT_EQUAL_INT(bufferRead(&buffer, out), i, "read should succeed");
+                ASSERT_EQUAL_INT(out[0], lap * 8 + i, "FIFO order");
+            }
+        }
+    } CASE_COMPLETE;
+#else
+    TEST_CASE("Refused unless built with prefetch") {
+        CREATE_BUFFER(buffer, 8, sizeof(uint32_t));
+        ASSERT_EQUAL_INT(bufferSetPrefetch(&buffer, 3), -ENOTSUP, "prefetch not built");
+    } CASE_COMPLETE;
+#endif
+
+    TEST_CASE("Invalid distances") {
+        CREATE_BUFFER(buffer, 8, sizeof(uint32_t));
+        ASSERT_EQUAL_INT(bufferSetPrefetch(NULL, 1), -EINVAL, "NULL buffer");
+        ASSERT_EQUAL_INT(bufferSetPrefetch(&buffer, 8), -EINVAL, "a whole lap ahead");
+        ASSERT_EQUAL_INT(bufferSetPrefetch(&buffer, 0), BUFFER_OK, "disable");
+    } CASE_COMPLETE;
+}
+
+void test_bufferStreaming() {
+    TEST_CASE("Streamed writes at unaligned slots") {
+        CREATE_BUFFER(buffer, 4, 1001);
+        ASSERT_EQUAL_INT(bufferSetStreaming(&buffer, 64), BUFFER_OK, "enable streaming");
+        uint8_t in[1001], out[1001];
+        for (int i = 0; i < 1001; i++) in[i] = (uint8_t)(i * 13 + 1);
+        for (int slot = 0; slot < 4; slot++) {
+            in[0] = (uint8_t)slot;
+            ASSERT_EQUAL_INT(bufferWrite(&buffer, in), slot, "write should succeed");
+        }
+        int same = 1;
+        for (int slot = 0; slot < 4; slot++) {
+            ASSERT_EQUAL_INT(bufferRead(&buffer, out), slot, "read should succeed");
+            ASSERT_EQUAL_INT(out[0], slot, "first byte");
+            for (int i = 1; i < 1001; i++) same &= (out[i] == in[i]);
+        }
+        ASSERT_EQUAL_INT(same, 1, "payload should be intact");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Writes below the threshold and short writes") {
+        CREATE_BUFFER(buffer, 4, 256);
+        (void)bufferSetStreaming(&buffer, 128);
+        uint8_t in[256], out[256];
+        for (int i = 0; i < 256; i++) in[i] = (uint8_t)i;
+        (void)bufferWriteRaw(&buffer, in, 100);
+        (void)bufferWriteRaw(&buffer, in, 131);
+        ASSERT_EQUAL_INT(bufferReadRaw(&buffer, out, 100), 0, "normal write");
+        ASSERT_EQUAL_INT(out[99], 99, "last byte of the normal write");
+        ASSERT_EQUAL_INT(bufferReadRaw(&buffer, out, 131), 1, "streamed write");
+        ASSERT_EQUAL_INT(out[130], 130, "last byte of the streamed write");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Streamed writes keep checksums") {
+        CREATE_BUFFER(buffer, 4, 512);
+        uint32_t crc[4];
+        (void)bufferSetStreaming(&buffer, 1);
+        (void)bufferSetChecksums(&buffer, crc);
+        uint8_t in[512] = { 1, 2, 3 }, out[512];
+        (void)bufferWriteRaw(&buffer, in, 300);
+        (void)bufferWrite(&buffer, in);
+        ASSERT_EQUAL_INT(bufferRead(&buffer, out), 0, "short streamed write should verify");
+        ((uint8_t*)buffer.raw)[512 + 400] ^= 4;
+        ASSERT_EQUAL_INT(bufferRead(&buffer, out), -EBADMSG, "corruption should be detected");
+        ASSERT_EQUAL_INT(bufferSetStreaming(NULL, 1), -EINVAL, "NULL buffer");
+    } CASE_COMPLETE;
+}
+
+void test_bufferAligned() {
+    TEST_CASE("Slots are padded and aligned") {
+        CREATE_BUFFER_ALIGNED(buffer, 4, 24, 64);
+        ASSERT_EQUAL_INT(bufferStride(&buffer), 64, "stride should be padded to 64");
+        ASSERT_EQUAL_INT((uintptr_t)buffer.raw % 64, 0, "storage should be aligned");
+        uint8_t in[24], out[24];
+        for (int i = 0; i < 24; i++) in[i] = (uint8_t)(i + 1);
+        for (int slot = 0; slot < 4; slot++) {
+            void* addr;
+            int index = bufferWriteClaim(&buffer, &addr);
+            ASSERT_EQUAL_INT((uintptr_t)addr % 64, 0, "slot should be aligned");
+            memcpy(addr, in, sizeof(in));
+            (void)bufferWriteRelease(&buffer, (uint16_t)index);
+        }
+        ASSERT_EQUAL_INT(bufferRead(&buffer, out), 0, "read should succeed");
+        ASSERT_EQUAL_INT(memcmp(in, out, sizeof(in)), 0, "element should round trip");
+        ASSERT_EQUAL_INT(bufferFind(&buffer, 8, 1, 9), 1, "search should step by the stride");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Unaligned caller memory") {
+        CREATE_BUFFER_ALIGNED(buffer, 2, 12, 16);
+        ASSERT_EQUAL_INT(bufferStride(&buffer), 16, "stride should be padded to 16");
+        uint8_t in[13], out[13];
+        for (int i = 0; i < 13; i++) in[i] = (uint8_t)(i * 3);
+        ASSERT_EQUAL_INT(bufferWrite(&buffer, in + 1), 0, "write should succeed");
+        ASSERT_EQUAL_INT(bufferRead(&buffer, out + 1), 0, "read should succeed");
+        ASSERT_EQUAL_INT(memcmp(in + 1, out + 1, 12), 0, "element should round trip");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Packed buffers") {
+        CREATE_BUFFER(buffer, 2, 12);
+        ASSERT_EQUAL_INT(bufferStride(&buffer), 12, "stride should be the element size");
+    } CASE_COMPLETE;
+
+#ifdef USE_BITMAP_ALLOCATOR
+    TEST_CASE("Allocated with alignment") {
+        Buffer* buf = bufferAllocateAligned(&testAllocator, 4, 20, 32);
+        ASSERT_NOT_NULL(buf, "Buffer should not be NULL");
+        ASSERT_EQUAL_INT(bufferStride(buf), 32, "stride should be padded to 32");
+        ASSERT_EQUAL_INT((uintptr_t)buf->raw % 32, 0, "storage should be aligned");
+        ASSERT_EQUAL_INT(bufferDeallocate(&testAllocator, &buf), BUFFER_OK, "deallocation should succeed");
+        ASSERT_NULL(bufferAllocateAligned(&testAllocator, 4, 20, 12), "unsupported alignment");
+        ASSERT_NULL(bufferAllocateAligned(&testAllocator, 4, 0, 32), "zero size");
+    } CASE_COMPLETE;
+#endif
+}
+
 int main() {
     LOG_INFO("BUFFER TESTS\n");
 #ifdef USE_BITMAP_ALLOCATOR
@@ -237,5 +703,11 @@ int main() {
     TEST_EVAL(test_bufferWrite);
     TEST_EVAL(test_bufferRead);
     TEST_EVAL(test_BufferFill);
+    TEST_EVAL(test_bufferTransfer);
+    TEST_EVAL(test_bufferFind);
+    TEST_EVAL(test_bufferChecksums);
+    TEST_EVAL(test_bufferPrefetch);
+    TEST_EVAL(test_bufferStreaming);
+    TEST_EVAL(test_bufferAligned);
     return testGetStatus();
 }
\ No newline at end of file
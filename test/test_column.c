@@ -0,0 +1,230 @@
+#include "column.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include "test_utils.h"
+#include <string.h>
+#include <errno.h>
+
+typedef struct {
+    uint32_t id;
+    double price;
+    uint16_t qty;
+    uint8_t flags;
+} Trade;
+
+static const ColumnField tradeFields[] = {
+    COLUMN_FIELD(Trade, id),
+    COLUMN_FIELD(Trade, price),
+    COLUMN_FIELD(Trade, qty),
+    COLUMN_FIELD(Trade, flags),
+};
+
+static Trade makeTrade(uint32_t n) {
+    Trade t;
+    memset(&t, 0, sizeof(t));
+    t.id = 1000 + n;
+    t.price = 1.5 * n;
+    t.qty = (uint16_t)(n * 3);
+    t.flags = (uint8_t)(n & 1);
+    return t;
+}
+
+#ifdef USE_BITMAP_ALLOCATOR
+#define MEMORY_SIZE 4096
+uint8_t testMemory[MEMORY_SIZE];
+static BlockAllocator testAllocator;
+
+void test_columnAllocate() {
+    TEST_CASE("Allocates and lays out aligned columns") {
+        ColumnBuffer* columns = columnAllocate(&testAllocator, 10, sizeof(Trade), tradeFields, COLUMN_FIELD_COUNT(tradeFields));
+        ASSERT_NOT_NULL(columns, "ColumnBuffer should not be NULL");
+        ASSERT_NOT_NULL(columns->rows.lock, "lock should not be NULL");
+        ASSERT_EQUAL_INT(columns->field_count, 4, "field count mismatch");
+        ASSERT_EQUAL_INT(columns->rows.size, 10, "size mismatch");
+        for (uint16_t f = 0; f < columns->field_count; f++) {
+            ASSERT_EQUAL_INT((uintptr_t)columns->columns[f] % COLUMN_ALIGN, 0, "column should be aligned");
+        }
+        ASSERT_TRUE(columns->columns[1] >= columns->columns[0] + 10 * sizeof(uint32_t), "columns should not overlap");
+        ASSERT_TRUE(columnIsEmpty(columns), "should be empty on init");
+        (void)columnDeallocate(&testAllocator, &columns);
+    } CASE_COMPLETE;
+
+    TEST_CASE("invalid arguments") {
+        const ColumnField past_end[] = { { 12, 8 } };
+        ASSERT_NULL(columnAllocate(&testAllocator, 0, sizeof(Trade), tradeFields, 4), "should return NULL if `size` is zero");
+        ASSERT_NULL(columnAllocate(&testAllocator, 8, sizeof(Trade), tradeFields, 0), "should return NULL without fields");
+        ASSERT_NULL(columnAllocate(&testAllocator, 8, sizeof(Trade), tradeFields, COLUMN_MAX_FIELDS + 1), "should return NULL on too many fields");
+        ASSERT_NULL(columnAllocate(&testAllocator, 8, 16, past_end, 1), "should return NULL if a field ends past the record");
+        ASSERT_NULL(columnAllocate(NULL, 8, sizeof(Trade), tradeFields, 4), "should return NULL on invalid allocator");
+    } CASE_COMPLETE;
+}
+
+void test_columnDeallocate() {
+    TEST_CASE("Deallocates and nullifies pointer") {
+        ColumnBuffer* columns = columnAllocate(&testAllocator, 8, sizeof(Trade), tradeFields, 2);
+        int res = columnDeallocate(&testAllocator, &columns);
+        ASSERT_EQUAL_INT(res, COLUMN_OK, "deallocation failed");
+        ASSERT_NULL(columns, "pointer should be NULL after free");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Null pointer") {
+        ASSERT_EQUAL_INT(columnDeallocate(&testAllocator, NULL), -EINVAL, "expected -EINVAL");
+    } CASE_COMPLETE;
+}
+#endif
+
+void test_columnWriteRead() {
+    TEST_CASE("Records round trip through the columns in FIFO order") {
+        CREATE_COLUMN_BUFFER(columns, 4, Trade, tradeFields);
+        for (uint32_t n = 0; n < 4; n++) {
+            Trade t = makeTrade(n);
+            ASSERT_EQUAL_INT(columnWrite(&columns, &t), (int)n, "write should return the row");
+        }
+        ASSERT_TRUE(columnIsFull(&columns), "should be full");
+        Trade t = makeTrade(9);
+        ASSERT_EQUAL_INT(columnWrite(&columns, &t), -ENOSPC, "write to a full buffer");
+        for (uint32_t n = 0; n < 4; n++) {
+            Trade out, expected = makeTrade(n);
+            memset(&out, 0, sizeof(out));
+            ASSERT_EQUAL_INT(columnRead(&columns, &out), (int)n, "read should return the row");
+            ASSERT_TRUE(memcmp(&out, &expected, sizeof(Trade)) == 0, "record mismatch");
+        }
+        ASSERT_EQUAL_INT(columnRead(&columns, &t), -EAGAIN, "read from an empty buffer");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Each field lands in its own column") {
+        CREATE_COLUMN_BUFFER(columns, 4, Trade, tradeFields);
+        for (uint32_t n = 0; n < 3; n++) {
+            Trade t = makeTrade(n);
+            (void)columnWrite(&columns, &t);
+        }
+        const uint32_t* ids = (const uint32_t*)columns.columns[0];
+        const double* prices = (const double*)columns.columns[1];
+        for (uint32_t n = 0; n < 3; n++) {
+            ASSERT_EQUAL_INT(ids[n], 1000 + n, "id column mismatch");
+            ASSERT_TRUE(prices[n] == 1.5 * n, "price column mismatch");
+        }
+    } CASE_COMPLETE;
+
+    TEST_CASE("Only the described fields are stored") {
+        const ColumnField idOnly[] = { COLUMN_FIELD(Trade, id) };
+        CREATE_COLUMN_BUFFER(columns, 2, Trade, idOnly);
+        Trade in = makeTrade(5), out;
+        memset(&out, 0xFF, sizeof(out));
+        (void)columnWrite(&columns, &in);
+        (void)columnRead(&columns, &out);
+        ASSERT_EQUAL_INT(out.id, in.id, "id mismatch");
+        ASSERT_EQUAL_INT(out.qty, 0xFFFF, "other fields should be untouched");
+    } CASE_COMPLETE;
+
+    TEST_CASE("invalid arguments") {
+        CREATE_COLUMN_BUFFER(columns, 2, Trade, tradeFields);
+        Trade t;
+        ASSERT_EQUAL_INT(columnWrite(NULL, &t), -EINVAL, "expected -EINVAL");
+        ASSERT_EQUAL_INT(columnWrite(&columns, NULL), -EINVAL, "expected -EINVAL");
+        ASSERT_EQUAL_INT(columnRead(&columns, NULL), -EINVAL, "expected -EINVAL");
+    } CASE_COMPLETE;
+}
+
+void test_columnReadSpan() {
+    TEST_CASE("Spans expose columns in place and stop at the end of the ring") {
+        CREATE_COLUMN_BUFFER(columns, 8, Trade, tradeFields);
+        Trade t;
+        for (uint32_t n = 0; n < 6; n++) {
+            t = makeTrade(n);
+            (void)columnWrite(&columns, &t);
+        }
+        for (uint32_t n = 0; n < 6; n++) (void)columnRead(&columns, &t);
+        // rows 6, 7 then 0..3 after the wrap
+        for (uint32_t n = 0; n < 6; n++) {
+            t = makeTrade(n);
+            (void)columnWrite(&columns, &t);
+        }
+        ColumnSpan span;
+        ASSERT_EQUAL_INT(columnReadSpan(&columns, 16, &span), 2, "span should stop at the wrap");
+        ASSERT_EQUAL_INT(span.first, 6, "span should start at the tail");
+        const uint16_t* qty = (const uint16_t*)columnSpanData(&columns, &span, 2);
+        ASSERT_NOT_NULL(qty, "span data should not be NULL");
+        ASSERT_EQUAL_INT(qty[0], 0, "qty mismatch");
+        ASSERT_EQUAL_INT(qty[1], 3, "qty mismatch");
+        ASSERT_EQUAL_INT(columnSpanRelease(&columns, &span), COLUMN_OK, "release failed");
+
+        ASSERT_EQUAL_INT(columnReadSpan(&columns, 3, &span), 3, "span should honour max_count");
+        ASSERT_EQUAL_INT(span.first, 0, "span should continue after the wrap");
+        const uint32_t* ids = (const uint32_t*)columnSpanData(&columns, &span, 0);
+        for (uint16_t i = 0; i < span.count; i++) {
+            ASSERT_EQUAL_INT(ids[i], 1002 + i, "id mismatch");
+        }
+        ASSERT_EQUAL_INT(columnSpanRelease(&columns, &span), COLUMN_OK, "release failed");
+        ASSERT_EQUAL_INT(columnSpanRelease(&columns, &span), -EPERM, "double release");
+        ASSERT_EQUAL_INT(columnRead(&columns, &t), 3, "last record remains");
+        ASSERT_EQUAL_INT(columnReadSpan(&columns, 4, &span), -EAGAIN, "empty buffer");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Span stops at a row still being written") {
+        CREATE_COLUMN_BUFFER(columns, 4, Trade, tradeFields);
+        Trade t = makeTrade(0);
+        (void)columnWrite(&columns, &t);
+        void* addr;
+        int claimed = bufferWriteClaim(&columns.rows, &addr);
+        ColumnSpan span;
+        ASSERT_EQUAL_INT(columnReadSpan(&columns, 4, &span), 1, "span should skip the claimed row");
+        (void)columnSpanRelease(&columns, &span);
+        ASSERT_EQUAL_INT(columnReadSpan(&columns, 4, &span), -EBUSY, "oldest row is being written");
+        (void)bufferWriteRelease(&columns.rows, (uint16_t)claimed);
+        ASSERT_EQUAL_INT(columnReadSpan(&columns, 4, &span), 1, "row is ready after its release");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Search one column of a span") {
+        CREATE_COLUMN_BUFFER(columns, 64, Trade, tradeFields);
+        for (uint32_t n = 0; n < 50; n++) {
+            Trade t = makeTrade(n);
+            (void)columnWrite(&columns, &t);
+        }
+        ColumnSpan span;
+        ASSERT_EQUAL_INT(columnReadSpan(&columns, 64, &span), 50, "span should cover every record");
+        ASSERT_EQUAL_INT(columnSpanFind(&columns, &span, 0, 1037), 37, "id search");
+        ASSERT_EQUAL_INT(columnSpanFind(&columns, &span, 2, 3 * 41), 41, "qty search");
+        ASSERT_EQUAL_INT(columnSpanFind(&columns, &span, 3, 1), 1, "flags search");
+        ASSERT_EQUAL_INT(columnSpanFind(&columns, &span, 0, 999), -ENOENT, "missing key");
+        ASSERT_EQUAL_INT(columnSpanFind(&columns, &span, 2, 0x10000 + 3 * 41), 41, "key is cut to the field size");
+        ASSERT_EQUAL_INT(columnSpanFind(&columns, &span, 3, 0x101), 1, "key is cut to the field size");
+        ASSERT_EQUAL_INT(columnSpanFind(&columns, &span, 4, 0), -EINVAL, "unknown field");
+        (void)columnSpanRelease(&columns, &span);
+    } CASE_COMPLETE;
+
+    TEST_CASE("invalid arguments") {
+        CREATE_COLUMN_BUFFER(columns, 4, Trade, tradeFields);
+        ColumnSpan span = { .first = 3, .count = 2 };
+        ASSERT_EQUAL_INT(columnReadSpan(&columns, 0, &span), -EINVAL, "expected -EINVAL");
+        ASSERT_EQUAL_INT(columnReadSpan(&columns, 4, NULL), -EINVAL, "expected -EINVAL");
+        ASSERT_NULL(columnSpanData(&columns, &span, 0), "span past the end of the ring");
+        ASSERT_EQUAL_INT(columnSpanRelease(&columns, &span), -EINVAL, "span past the end of the ring");
+    } CASE_COMPLETE;
+}
+
+void test_columnClear() {
+    TEST_CASE("Clear discards every record") {
+        CREATE_COLUMN_BUFFER(columns, 4, Trade, tradeFields);
+        Trade t = makeTrade(1);
+        (void)columnWrite(&columns, &t);
+        (void)columnWrite(&columns, &t);
+        columnClear(&columns);
+        ASSERT_TRUE(columnIsEmpty(&columns), "should be empty after clear");
+        ASSERT_EQUAL_INT(columnWrite(&columns, &t), 0, "writes restart at row 0");
+    } CASE_COMPLETE;
+}
+
+int main() {
+    LOG_INFO("COLUMN TESTS\n");
+#ifdef USE_BITMAP_ALLOCATOR
+    initBlockAllocator(&testAllocator, 4, testMemory, MEMORY_SIZE);
+    TEST_EVAL(test_columnAllocate);
+    TEST_EVAL(test_columnDeallocate);
+#endif
+    TEST_EVAL(test_columnWriteRead);
+    TEST_EVAL(test_columnReadSpan);
+    TEST_EVAL(test_columnClear);
+    return testGetStatus();
+}
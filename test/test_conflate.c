@@ -0,0 +1,168 @@
+#include "conflate.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include "test_utils.h"
+#include <string.h>
+#include <errno.h>
+
+#ifdef USE_BITMAP_ALLOCATOR
+#define MEMORY_SIZE 2048
+uint8_t testMemory[MEMORY_SIZE];
+static BlockAllocator testAllocator;
+
+void test_conflatingQueueAllocate() {
+    TEST_CASE("Allocates and initializes conflating queue correctly") {
+        ConflatingQueue* q = conflatingQueueAllocate(&testAllocator, 8, 4);
+        ASSERT_NOT_NULL(q, "ConflatingQueue should not be NULL");
+        ASSERT_NOT_NULL(q->order, "order ring should not be NULL");
+        ASSERT_NOT_NULL(q->free_slots, "free list should not be NULL");
+        ASSERT_NOT_NULL(q->index, "key index should not be NULL");
+        ASSERT_EQUAL_INT(q->size, 4, "size mismatch");
+        ASSERT_EQUAL_INT(q->slot_len, 8, "slot_len mismatch");
+        ASSERT_TRUE(conflatingQueueIsEmpty(q), "should be empty on init");
+        (void)conflatingQueueDeallocate(&testAllocator, &q);
+    } CASE_COMPLETE;
+
+    TEST_CASE("zero dimensions") {
+        ASSERT_NULL(conflatingQueueAllocate(&testAllocator, 0, 4), "should return NULL if `slot_len` is zero");
+        ASSERT_NULL(conflatingQueueAllocate(&testAllocator, 8, 0), "should return NULL if `size` is zero");
+    } CASE_COMPLETE;
+
+    TEST_CASE("invalid allocator") {
+        ASSERT_NULL(conflatingQueueAllocate(NULL, 8, 4), "should return NULL on invalid allocator");
+    } CASE_COMPLETE;
+}
+
+void test_conflatingQueueDeallocate() {
+    TEST_CASE("Deallocates and nullifies pointer") {
+        ConflatingQueue* q = conflatingQueueAllocate(&testAllocator, 8, 4);
+        int res = conflatingQueueDeallocate(&testAllocator, &q);
+        ASSERT_EQUAL_INT(res, CONFLATE_OK, "deallocation failed");
+        ASSERT_NULL(q, "pointer should be NULL after free");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Null pointer") {
+        ASSERT_EQUAL_INT(conflatingQueueDeallocate(&testAllocator, NULL), -EINVAL, "expected -EINVAL");
+    } CASE_COMPLETE;
+}
+#endif
+
+void test_conflatingQueueWrite() {
+    TEST_CASE("Latest value replaces pending value in place") {
+        CREATE_CONFLATING_QUEUE(q, 8, 4);
+        uint8_t out[8];
+        uint64_t key;
+        (void)conflatingQueueWrite(&q, 100, (const uint8_t*)"a1", 2);
+        (void)conflatingQueueWrite(&q, 200, (const uint8_t*)"b1", 2);
+        ASSERT_EQUAL_INT(conflatingQueueWrite(&q, 100, (const uint8_t*)"a222", 4), 4, "write failed");
+        ASSERT_EQUAL_INT(q.count, 2, "replacement should not add a message");
+        ASSERT_EQUAL_INT(q.conflated, 1, "conflation counter mismatch");
+        ASSERT_EQUAL_INT(conflatingQueueRead(&q, &key, out, 8), 4, "length mismatch");
+        ASSERT_TRUE(key == 100, "first-arrival order expected");
+        ASSERT_EQUAL_STR((char*)out, "a222", 4, "latest value expected");
+        ASSERT_EQUAL_INT(conflatingQueueRead(&q, &key, out, 8), 2, "length mismatch");
+        ASSERT_TRUE(key == 200, "key mismatch");
+        ASSERT_EQUAL_STR((char*)out, "b1", 2, "message mismatch");
+        ASSERT_EQUAL_INT(conflatingQueueRead(&q, &key, out, 8), -EAGAIN, "queue should be empty");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Depth is bounded by distinct keys") {
+        CREATE_CONFLATING_QUEUE(q, 4, 3);
+        for (uint32_t i = 0; i < 100; i++) {
+            ASSERT_TRUE(conflatingQueueWrite(&q, i % 3, (const uint8_t*)&i, sizeof(i)) > 0, "write failed");
+        }
+        ASSERT_EQUAL_INT(q.count, 3, "one message per key expected");
+        ASSERT_EQUAL_INT(conflatingQueueWrite(&q, 3, (const uint8_t*)"x", 1), -ENOSPC, "new key should not fit");
+        uint32_t v;
+        uint64_t key;
+        const uint32_t latest[3] = { 99, 97, 98 };
+        for (uint64_t expected = 0; expected < 3; expected++) {
+            ASSERT_EQUAL_INT(conflatingQueueRead(&q, &key, (uint8_t*)&v, sizeof(v)), 4, "read failed");
+            ASSERT_TRUE(key == expected, "order mismatch");
+            ASSERT_EQUAL_INT(v, latest[expected], "latest value expected");
+        }
+    } CASE_COMPLETE;
+
+    TEST_CASE("Key written again after its read is queued last") {
+        CREATE_CONFLATING_QUEUE(q, 4, 4);
+        uint8_t out[4];
+        uint64_t key;
+        (void)conflatingQueueWrite(&q, 1, (const uint8_t*)"a", 1);
+        (void)conflatingQueueWrite(&q, 2, (const uint8_t*)"b", 1);
+        (void)conflatingQueueRead(&q, &key, out, 4);
+        (void)conflatingQueueWrite(&q, 1, (const uint8_t*)"c", 1);
+        (void)conflatingQueueRead(&q, &key, out, 4);
+        ASSERT_TRUE(key == 2, "pending key should come first");
+        (void)conflatingQueueRead(&q, &key, out, 4);
+        ASSERT_TRUE(key == 1, "re-written key should come last");
+        ASSERT_EQUAL_STR((char*)out, "c", 1, "message mismatch");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Truncates to slot length") {
+        CREATE_CONFLATING_QUEUE(q, 4, 2);
+        ASSERT_EQUAL_INT(conflatingQueueWrite(&q, 1, (const uint8_t*)"abcdef", 6), 4, "expected truncation");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_CONFLATING_QUEUE(q, 4, 2);
+        uint8_t out[4];
+        ASSERT_EQUAL_INT(conflatingQueueWrite(NULL, 1, (const uint8_t*)"a", 1), -EINVAL, "NULL queue");
+        ASSERT_EQUAL_INT(conflatingQueueWrite(&q, 1, NULL, 1), -EINVAL, "NULL data");
+        ASSERT_EQUAL_INT(conflatingQueueWrite(&q, 1, (const uint8_t*)"a", 0), -EINVAL, "zero length");
+        ASSERT_EQUAL_INT(conflatingQueueRead(&q, NULL, out, 0), -EINVAL, "zero length");
+        ASSERT_EQUAL_INT(conflatingQueueRead(&q, NULL, NULL, 4), -EINVAL, "NULL data");
+    } CASE_COMPLETE;
+}
+
+void test_conflatingQueueIndex() {
+    TEST_CASE("Keys survive removal of colliding keys") {
+        CREATE_CONFLATING_QUEUE(q, 8, 16);
+        uint64_t key;
+        uint64_t v;
+        // interleave reads and writes so probe clusters are broken up and shifted
+        for (uint64_t round = 0; round < 8; round++) {
+            for (uint64_t k = 0; k < 16; k++) {
+                uint64_t value = round * 100 + k;
+                (void)conflatingQueueWrite(&q, k * 0x10000, (const uint8_t*)&value, sizeof(value));
+            }
+            for (uint64_t k = 0; k < 8; k++) {
+                ASSERT_EQUAL_INT(conflatingQueueRead(&q, &key, (uint8_t*)&v, sizeof(v)), 8, "read failed");
+                ASSERT_TRUE(v % 100 == key / 0x10000, "value should belong to its key");
+            }
+        }
+        while (conflatingQueueRead(&q, &key, (uint8_t*)&v, sizeof(v)) > 0) {
+            ASSERT_TRUE(v / 100 == 7, "only the last round should remain");
+            ASSERT_TRUE(v % 100 == key / 0x10000, "value should belong to its key");
+        }
+        ASSERT_TRUE(conflatingQueueIsEmpty(&q), "should be empty");
+    } CASE_COMPLETE;
+}
+
+void test_conflatingQueueClear() {
+    TEST_CASE("Drops pending messages") {
+        CREATE_CONFLATING_QUEUE(q, 4, 2);
+        uint8_t out[4];
+        (void)conflatingQueueWrite(&q, 1, (const uint8_t*)"a", 1);
+        (void)conflatingQueueWrite(&q, 1, (const uint8_t*)"b", 1);
+        conflatingQueueClear(&q);
+        ASSERT_TRUE(conflatingQueueIsEmpty(&q), "should be empty after clear");
+        ASSERT_EQUAL_INT(q.conflated, 0, "counter should be reset");
+        ASSERT_EQUAL_INT(conflatingQueueRead(&q, NULL, out, 4), -EAGAIN, "nothing should be pending");
+        (void)conflatingQueueWrite(&q, 1, (const uint8_t*)"c", 1);
+        ASSERT_EQUAL_INT(q.count, 1, "cleared key should be appended again");
+    } CASE_COMPLETE;
+}
+
+int main() {
+    LOG_INFO("CONFLATE TESTS\n");
+#ifdef USE_BITMAP_ALLOCATOR
+    initBlockAllocator(&testAllocator, 4, testMemory, MEMORY_SIZE);
+    TEST_EVAL(test_conflatingQueueAllocate);
+    TEST_EVAL(test_conflatingQueueDeallocate);
+#endif
+    TEST_EVAL(test_conflatingQueueWrite);
+    TEST_EVAL(test_conflatingQueueIndex);
+    TEST_EVAL(test_conflatingQueueClear);
+    return testGetStatus();
+}
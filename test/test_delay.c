@@ -0,0 +1,207 @@
+#include "delay.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include "test_utils.h"
+#include <string.h>
+#include <errno.h>
+
+#ifdef USE_BITMAP_ALLOCATOR
+// Everything one delay queue of `size` messages takes from the arena: the
+// queue, its pool, free list, lock, wheel buckets and their lock block.
+#define DELAY_FOOTPRINT(slot_len, size)                                             \
+    (sizeof(DelayQueue) + (size) * ((slot_len) + sizeof(uint32_t) + sizeof(uint16_t))  \
+     + sizeof(Lock_t) + sizeof(LockState_t)                                         \
+     + sizeof(Stack) + sizeof(Lock_t) + (size) * (sizeof(uint16_t) + sizeof(LockState_t)) \
+     + DELAY_WHEEL_BUCKETS * (sizeof(Buffer) + sizeof(Lock_t)                       \
+                              + (size) * (sizeof(uint16_t) + sizeof(LockState_t))))
+// twice the footprint of the largest queue allocated below, for block
+// rounding and the allocator's own bookkeeping
+#define MEMORY_SIZE (2 * DELAY_FOOTPRINT(8, 4))
+uint8_t testMemory[MEMORY_SIZE];
+static BlockAllocator testAllocator;
+
+void test_delayQueueAllocate() {
+    TEST_CASE("Allocates and initializes delay queue correctly") {
+        DelayQueue* dq = delayQueueAllocate(&testAllocator, 8, 4);
+        ASSERT_NOT_NULL(dq, "DelayQueue should not be NULL");
+        if (!dq) {
+            CASE_COMPLETE;
+            return;
+        }
+        ASSERT_NOT_NULL(dq->wheel, "wheel should not be NULL");
+        ASSERT_NOT_NULL(dq->free_slots, "free list should not be NULL");
+        ASSERT_EQUAL_INT(dq->slot_len, 8, "slot_len mismatch");
+        ASSERT_EQUAL_INT(dq->size, 4, "size mismatch");
+        ASSERT_EQUAL_INT(dq->free_slots->top, 4, "all entries should be free on init");
+        ASSERT_TRUE(delayQueueIsEmpty(dq), "should be empty on init");
+        (void)delayQueueDeallocate(&testAllocator, &dq);
+    } CASE_COMPLETE;
+
+    TEST_CASE("zero dimensions") {
+        DelayQueue* dq = delayQueueAllocate(&testAllocator, 0, 4);
+        ASSERT_NULL(dq, "should return NULL if `slot_len` is zero");
+        dq = delayQueueAllocate(&testAllocator, 8, 0);
+        ASSERT_NULL(dq, "should return NULL if `size` is zero");
+    } CASE_COMPLETE;
+
+    TEST_CASE("invalid allocator") {
+        DelayQueue* dq = delayQueueAllocate(NULL, 8, 4);
+        ASSERT_NULL(dq, "should return NULL on invalid allocator");
+    } CASE_COMPLETE;
+}
+
+void test_delayQueueDeallocate() {
+    TEST_CASE("Deallocates and nullifies pointer") {
+        DelayQueue* dq = delayQueueAllocate(&testAllocator, 8, 4);
+        int res = delayQueueDeallocate(&testAllocator, &dq);
+        ASSERT_EQUAL_INT(res, DELAY_OK, "deallocation failed");
+        ASSERT_NULL(dq, "pointer should be NULL after free");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Null pointer") {
+        DelayQueue* dq = NULL;
+        int res = delayQueueDeallocate(&testAllocator, &dq);
+        ASSERT_EQUAL_INT(res, -EINVAL, "Deallocating NULL queue should fail");
+    } CASE_COMPLETE;
+}
+#endif
+
+void test_delayQueueCreateMacro() {
+    TEST_CASE("Creates delay queue correctly") {
+        CREATE_DELAY_QUEUE(dq, 8, 4);
+        ASSERT_EQUAL_INT(dq.slot_len, 8, "slot_len mismatch");
+        ASSERT_EQUAL_INT(dq.size, 4, "size mismatch");
+        ASSERT_EQUAL_INT(dq.free_slots->top, 4, "all entries should be free on init");
+        ASSERT_TRUE(delayQueueIsEmpty(&dq), "should be empty on init");
+    } CASE_COMPLETE;
+}
+
+void test_delayQueueWrite() {
+    TEST_CASE("Writes and truncates") {
+        CREATE_DELAY_QUEUE(dq, 4, 4);
+        uint8_t msg[] = "Hello";
+        int res = delayQueueWrite(&dq, msg, 5, 0, 10);
+        ASSERT_EQUAL_INT(res, 4, "message should be truncated to slot_len");
+        ASSERT_FALSE(delayQueueIsEmpty(&dq), "should not be empty after write");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Full pool") {
+        CREATE_DELAY_QUEUE(dq, 4, 2);
+        uint8_t msg[] = "abcd";
+        (void)delayQueueWrite(&dq, msg, 4, 0, 1);
+        (void)delayQueueWrite(&dq, msg, 4, 0, 2);
+        int res = delayQueueWrite(&dq, msg, 4, 0, 3);
+        ASSERT_EQUAL_INT(res, -ENOSPC, "write to full delay queue should fail");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_DELAY_QUEUE(dq, 4, 2);
+        uint8_t msg[] = "abcd";
+        ASSERT_EQUAL_INT(delayQueueWrite(NULL, msg, 4, 0, 1), -EINVAL, "NULL queue");
+        ASSERT_EQUAL_INT(delayQueueWrite(&dq, NULL, 4, 0, 1), -EINVAL, "NULL data");
+        ASSERT_EQUAL_INT(delayQueueWrite(&dq, msg, 0, 0, 1), -EINVAL, "zero length");
+    } CASE_COMPLETE;
+}
+
+void test_delayQueueRead() {
+    TEST_CASE("Holds message until due") {
+        CREATE_DELAY_QUEUE(dq, 8, 4);
+        uint8_t out[8];
+        uint32_t next_due = 0;
+        (void)delayQueueWrite(&dq, (uint8_t*)"late", 4, 100, 150);
+        int res = delayQueueRead(&dq, out, 8, 149, &next_due);
+        ASSERT_EQUAL_INT(res, -EAGAIN, "message should not be readable before due");
+        ASSERT_EQUAL_INT(next_due, 150, "next deadline mismatch");
+        res = delayQueueRead(&dq, out, 8, 150, &next_due);
+        ASSERT_EQUAL_INT(res, 4, "message should be readable at due time");
+        ASSERT_EQUAL_STR(out, "late", 4, "message mismatch");
+        ASSERT_TRUE(delayQueueIsEmpty(&dq), "should be empty after read");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Returns messages in due order") {
+        CREATE_DELAY_QUEUE(dq, 4, 8);
+        uint32_t due[] = { 5000, 3, 300, 40, 70000, 41 };
+        uint32_t order[] = { 3, 40, 41, 300, 5000, 70000 };
+        for (int i = 0; i < 6; i++) {
+            (void)delayQueueWrite(&dq, (uint8_t*)&due[i], sizeof(uint32_t), 0, due[i]);
+        }
+        for (int i = 0; i < 6; i++) {
+            uint32_t next_due = 0;
+            uint32_t out = 0;
+            int res = delayQueueRead(&dq, (uint8_t*)&out, sizeof(uint32_t), order[i] - 1, &next_due);
+            ASSERT_EQUAL_INT(res, -EAGAIN, "message read before due");
+            ASSERT_EQUAL_INT(next_due, order[i], "next deadline mismatch");
+            res = delayQueueRead(&dq, (uint8_t*)&out, sizeof(uint32_t), next_due, NULL);
+            ASSERT_EQUAL_INT(res, sizeof(uint32_t), "read at deadline failed");
+            ASSERT_EQUAL_INT(out, order[i], "messages out of order");
+        }
+        ASSERT_TRUE(delayQueueIsEmpty(&dq), "should be empty after reads");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Drains overdue messages after a long sleep") {
+        CREATE_DELAY_QUEUE(dq, 4, 4);
+        uint32_t due[] = { 10, 20, 30 };
+        for (int i = 0; i < 3; i++) {
+            (void)delayQueueWrite(&dq, (uint8_t*)&due[i], sizeof(uint32_t), 0, due[i]);
+        }
+        for (int i = 0; i < 3; i++) {
+            uint32_t out = 0;
+            int res = delayQueueRead(&dq, (uint8_t*)&out, sizeof(uint32_t), 1000, NULL);
+            ASSERT_EQUAL_INT(res, sizeof(uint32_t), "overdue message should be readable");
+            ASSERT_EQUAL_INT(out, due[i], "messages out of order");
+        }
+        uint32_t out;
+        int res = delayQueueRead(&dq, (uint8_t*)&out, sizeof(uint32_t), 1000, NULL);
+        ASSERT_EQUAL_INT(res, -EAGAIN, "empty queue should not be readable");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Wraps around the time counter") {
+        CREATE_DELAY_QUEUE(dq, 4, 4);
+        uint32_t now = 0xFFFFFFF0u;
+        uint32_t out = 0;
+        uint32_t next_due = 0;
+        (void)delayQueueWrite(&dq, (uint8_t*)&now, sizeof(uint32_t), now, now + 0x40);
+        int res = delayQueueRead(&dq, (uint8_t*)&out, sizeof(uint32_t), now + 0x3F, &next_due);
+        ASSERT_EQUAL_INT(res, -EAGAIN, "message read before due");
+        ASSERT_EQUAL_INT(next_due, 0x30, "next deadline should wrap");
+        res = delayQueueRead(&dq, (uint8_t*)&out, sizeof(uint32_t), 0x30, NULL);
+        ASSERT_EQUAL_INT(res, sizeof(uint32_t), "read after wrap failed");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_DELAY_QUEUE(dq, 4, 2);
+        uint8_t out[4];
+        ASSERT_EQUAL_INT(delayQueueRead(NULL, out, 4, 0, NULL), -EINVAL, "NULL queue");
+        ASSERT_EQUAL_INT(delayQueueRead(&dq, NULL, 4, 0, NULL), -EINVAL, "NULL data");
+        ASSERT_EQUAL_INT(delayQueueRead(&dq, out, 0, 0, NULL), -EINVAL, "zero length");
+    } CASE_COMPLETE;
+}
+
+void test_delayQueueClear() {
+    TEST_CASE("Clears pending messages") {
+        CREATE_DELAY_QUEUE(dq, 4, 2);
+        (void)delayQueueWrite(&dq, (uint8_t*)"abcd", 4, 0, 1);
+        (void)delayQueueWrite(&dq, (uint8_t*)"efgh", 4, 0, 500);
+        delayQueueClear(&dq);
+        ASSERT_TRUE(delayQueueIsEmpty(&dq), "should be empty after clear");
+        ASSERT_EQUAL_INT(dq.free_slots->top, 2, "all entries should be free after clear");
+        uint8_t out[4];
+        int res = delayQueueRead(&dq, out, 4, 1000, NULL);
+        ASSERT_EQUAL_INT(res, -EAGAIN, "cleared messages should not be readable");
+    } CASE_COMPLETE;
+}
+
+int main() {
+    LOG_INFO("DELAY QUEUE TESTS\n");
+#ifdef USE_BITMAP_ALLOCATOR
+    initBlockAllocator(&testAllocator, 4, testMemory, MEMORY_SIZE);
+    TEST_EVAL(test_delayQueueAllocate);
+    TEST_EVAL(test_delayQueueDeallocate);
+#endif
+    TEST_EVAL(test_delayQueueCreateMacro);
+    TEST_EVAL(test_delayQueueWrite);
+    TEST_EVAL(test_delayQueueRead);
+    TEST_EVAL(test_delayQueueClear);
+    return testGetStatus();
+}
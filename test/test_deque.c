@@ -0,0 +1,191 @@
+#include "deque.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include "test_utils.h"
+#include <string.h>
+#include <errno.h>
+
+#ifdef USE_BITMAP_ALLOCATOR
+#define MEMORY_SIZE 2048
+uint8_t testMemory[MEMORY_SIZE];
+static BlockAllocator testAllocator;
+
+void test_dequeAllocate() {
+    TEST_CASE("Allocates and initializes deque correctly") {
+        Deque* deque = dequeAllocate(&testAllocator, 8, sizeof(TestStruct));
+        ASSERT_NOT_NULL(deque, "Deque should not be NULL");
+        ASSERT_NOT_NULL(deque->ring.raw, "raw should not be NULL");
+        ASSERT_NOT_NULL(deque->ring.lock, "lock should not be NULL");
+        ASSERT_EQUAL_INT(deque->ring.size, 8, "size mismatch");
+        ASSERT_EQUAL_INT(deque->ring.type_size, sizeof(TestStruct), "type_size mismatch");
+        ASSERT_TRUE(dequeIsEmpty(deque), "should be empty on init");
+        (void)dequeDeallocate(&testAllocator, &deque);
+    } CASE_COMPLETE;
+
+    TEST_CASE("zero dimensions") {
+        ASSERT_NULL(dequeAllocate(&testAllocator, 0, 4), "should return NULL if `size` is zero");
+        ASSERT_NULL(dequeAllocate(&testAllocator, 8, 0), "should return NULL if `type_size` is zero");
+    } CASE_COMPLETE;
+
+    TEST_CASE("invalid allocator") {
+        ASSERT_NULL(dequeAllocate(NULL, 8, 4), "should return NULL on invalid allocator");
+    } CASE_COMPLETE;
+}
+
+void test_dequeDeallocate() {
+    TEST_CASE("Deallocates and nullifies pointer") {
+        Deque* deque = dequeAllocate(&testAllocator, 8, 4);
+        int res = dequeDeallocate(&testAllocator, &deque);
+        ASSERT_EQUAL_INT(res, DEQUE_OK, "deallocation failed");
+        ASSERT_NULL(deque, "pointer should be NULL after free");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Null pointer") {
+        ASSERT_EQUAL_INT(dequeDeallocate(&testAllocator, NULL), -EINVAL, "expected -EINVAL");
+    } CASE_COMPLETE;
+}
+#endif
+
+void test_dequePushFront() {
+    TEST_CASE("Front element is read first") {
+        CREATE_DEQUE(deque, 4, sizeof(uint16_t));
+        uint16_t v = 1;
+        (void)dequePushBack(&deque, &v);
+        v = 2;
+        (void)dequePushBack(&deque, &v);
+        v = 0;
+        ASSERT_TRUE(dequePushFront(&deque, &v) >= DEQUE_OK, "push front failed");
+        for (uint16_t expected = 0; expected < 3; expected++) {
+            ASSERT_TRUE(dequePopFront(&deque, &v) >= DEQUE_OK, "pop front failed");
+            ASSERT_EQUAL_INT(v, expected, "order mismatch");
+        }
+        ASSERT_TRUE(dequeIsEmpty(&deque), "should be empty");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Fills to capacity from the front") {
+        CREATE_DEQUE(deque, 3, sizeof(uint16_t));
+        for (uint16_t v = 0; v < 3; v++) {
+            ASSERT_TRUE(dequePushFront(&deque, &v) >= DEQUE_OK, "push front failed");
+        }
+        ASSERT_TRUE(dequeIsFull(&deque), "should be full");
+        uint16_t v = 9;
+        ASSERT_EQUAL_INT(dequePushFront(&deque, &v), -ENOSPC, "no space expected at the front");
+        ASSERT_EQUAL_INT(dequePushBack(&deque, &v), -ENOSPC, "no space expected at the back");
+        for (int expected = 2; expected >= 0; expected--) {
+            (void)dequePopFront(&deque, &v);
+            ASSERT_EQUAL_INT(v, expected, "front pushes should read newest first");
+        }
+    } CASE_COMPLETE;
+
+    TEST_CASE("Claimed front slot blocks readers") {
+        CREATE_DEQUE(deque, 4, sizeof(uint16_t));
+        uint16_t v = 1;
+        (void)dequePushBack(&deque, &v);
+        uint16_t* slot;
+        int index = dequePushFrontClaim(&deque, (void**)&slot);
+        ASSERT_TRUE(index >= DEQUE_OK, "claim failed");
+        ASSERT_EQUAL_INT(dequePopFront(&deque, &v), -EBUSY, "unpublished front should block");
+        *slot = 7;
+        ASSERT_EQUAL_INT(dequePushRelease(&deque, (uint16_t)index), DEQUE_OK, "release failed");
+        ASSERT_TRUE(dequePopFront(&deque, &v) >= DEQUE_OK, "pop front failed");
+        ASSERT_EQUAL_INT(v, 7, "claimed element should be read first");
+    } CASE_COMPLETE;
+}
+
+void test_dequePopBack() {
+    TEST_CASE("Back element is the newest") {
+        CREATE_DEQUE(deque, 4, sizeof(uint16_t));
+        for (uint16_t v = 0; v < 3; v++) (void)dequePushBack(&deque, &v);
+        uint16_t v;
+        for (int expected = 2; expected >= 0; expected--) {
+            ASSERT_TRUE(dequePopBack(&deque, &v) >= DEQUE_OK, "pop back failed");
+            ASSERT_EQUAL_INT(v, expected, "order mismatch");
+        }
+        ASSERT_EQUAL_INT(dequePopBack(&deque, &v), -EAGAIN, "empty deque expected");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Both ends across the wrap") {
+        CREATE_DEQUE(deque, 4, sizeof(uint16_t));
+        uint16_t v;
+        // move the ring positions off zero so both ends wrap
+        for (v = 0; v < 3; v++) (void)dequePushBack(&deque, &v);
+        for (int i = 0; i < 3; i++) (void)dequePopFront(&deque, &v);
+        v = 10;
+        (void)dequePushBack(&deque, &v);
+        v = 11;
+        (void)dequePushBack(&deque, &v);
+        v = 9;
+        (void)dequePushFront(&deque, &v);
+        v = 8;
+        (void)dequePushFront(&deque, &v);
+        ASSERT_TRUE(dequeIsFull(&deque), "should be full");
+        ASSERT_TRUE(dequePopBack(&deque, &v) >= DEQUE_OK, "pop back failed");
+        ASSERT_EQUAL_INT(v, 11, "back mismatch");
+        ASSERT_TRUE(dequePopFront(&deque, &v) >= DEQUE_OK, "pop front failed");
+        ASSERT_EQUAL_INT(v, 8, "front mismatch");
+        ASSERT_TRUE(dequePopBack(&deque, &v) >= DEQUE_OK, "pop back failed");
+        ASSERT_EQUAL_INT(v, 10, "back mismatch");
+        ASSERT_TRUE(dequePopFront(&deque, &v) >= DEQUE_OK, "pop front failed");
+        ASSERT_EQUAL_INT(v, 9, "front mismatch");
+        ASSERT_TRUE(dequeIsEmpty(&deque), "should be empty");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Claimed back slot blocks writers") {
+        CREATE_DEQUE(deque, 2, sizeof(uint16_t));
+        uint16_t v = 3;
+        (void)dequePushBack(&deque, &v);
+        (void)dequePushBack(&deque, &v);
+        uint16_t* slot;
+        int index = dequePopBackClaim(&deque, (void**)&slot);
+        ASSERT_TRUE(index >= DEQUE_OK, "claim failed");
+        ASSERT_EQUAL_INT(*slot, 3, "claimed element mismatch");
+        ASSERT_EQUAL_INT(dequePushBack(&deque, &v), -EBUSY, "slot being read should block");
+        ASSERT_EQUAL_INT(dequePopRelease(&deque, (uint16_t)index), DEQUE_OK, "release failed");
+        ASSERT_TRUE(dequePushBack(&deque, &v) >= DEQUE_OK, "slot should be writable after release");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Unpublished back slot") {
+        CREATE_DEQUE(deque, 4, sizeof(uint16_t));
+        void* addr;
+        (void)dequePushBackClaim(&deque, &addr);
+        uint16_t v;
+        ASSERT_EQUAL_INT(dequePopBack(&deque, &v), -EBUSY, "claimed slot should not be read");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_DEQUE(deque, 4, sizeof(uint16_t));
+        uint16_t v = 0;
+        ASSERT_EQUAL_INT(dequePopBack(NULL, &v), -EINVAL, "NULL deque");
+        ASSERT_EQUAL_INT(dequePopBack(&deque, NULL), -EINVAL, "NULL data");
+        ASSERT_EQUAL_INT(dequePushFront(NULL, &v), -EINVAL, "NULL deque");
+        ASSERT_EQUAL_INT(dequePushFront(&deque, NULL), -EINVAL, "NULL data");
+    } CASE_COMPLETE;
+}
+
+void test_dequeClear() {
+    TEST_CASE("Discards both ends") {
+        CREATE_DEQUE(deque, 4, sizeof(uint16_t));
+        uint16_t v = 1;
+        (void)dequePushBack(&deque, &v);
+        (void)dequePushFront(&deque, &v);
+        dequeClear(&deque);
+        ASSERT_TRUE(dequeIsEmpty(&deque), "should be empty after clear");
+        for (int i = 0; i < 4; i++) {
+            ASSERT_TRUE(dequePushFront(&deque, &v) >= DEQUE_OK, "every slot should be free");
+        }
+    } CASE_COMPLETE;
+}
+
+int main() {
+    LOG_INFO("DEQUE TESTS\n");
+#ifdef USE_BITMAP_ALLOCATOR
+    initBlockAllocator(&testAllocator, 4, testMemory, MEMORY_SIZE);
+    TEST_EVAL(test_dequeAllocate);
+    TEST_EVAL(test_dequeDeallocate);
+#endif
+    TEST_EVAL(test_dequePushFront);
+    TEST_EVAL(test_dequePopBack);
+    TEST_EVAL(test_dequeClear);
+    return testGetStatus();
+}
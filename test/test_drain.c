@@ -0,0 +1,120 @@
+#include "drain.h"
+#include "queue.h"
+#include "test_utils.h"
+#include <string.h>
+#include <errno.h>
+
+void test_drainRegion() {
+    TEST_CASE("Covers the slot storage") {
+        CREATE_QUEUE(queue, 16, 4);
+        void* base;
+        uint32_t len;
+        int res = drainRegion(&queue, &base, &len);
+        ASSERT_EQUAL_INT(res, DRAIN_OK, "drainRegion failed");
+        ASSERT_EQUAL_PTR(base, queue.slot_buffer->raw, "base mismatch");
+        ASSERT_EQUAL_INT(len, 64, "length mismatch");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_QUEUE(queue, 16, 4);
+        void* base;
+        uint32_t len;
+        ASSERT_EQUAL_INT(drainRegion(NULL, &base, &len), -EINVAL, "NULL queue");
+        ASSERT_EQUAL_INT(drainRegion(&queue, NULL, &len), -EINVAL, "NULL base");
+        ASSERT_EQUAL_INT(drainRegion(&queue, &base, NULL), -EINVAL, "NULL len");
+    } CASE_COMPLETE;
+}
+
+void test_drainClaim() {
+    TEST_CASE("Claims ready messages in order") {
+        CREATE_QUEUE(queue, 16, 4);
+        (void)queueWrite(&queue, (const uint8_t*)"first", 5);
+        (void)queueWrite(&queue, (const uint8_t*)"second", 6);
+        (void)queueWrite(&queue, (const uint8_t*)"third", 5);
+        DrainSlot slots[2];
+        int res = drainClaim(&queue, slots, 2);
+        ASSERT_EQUAL_INT(res, 2, "should claim up to max_count");
+        ASSERT_EQUAL_INT(slots[0].len, 5, "length mismatch");
+        ASSERT_EQUAL_STR(slots[0].data, "first", 5, "data mismatch");
+        ASSERT_EQUAL_INT(slots[1].len, 6, "length mismatch");
+        ASSERT_EQUAL_STR(slots[1].data, "second", 6, "data mismatch");
+        res = drainClaim(&queue, slots, 2);
+        ASSERT_EQUAL_INT(res, 1, "should claim the remaining message");
+        res = drainClaim(&queue, slots, 2);
+        ASSERT_EQUAL_INT(res, -EAGAIN, "queue should be empty");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Claimed slots are not overwritten") {
+        CREATE_QUEUE(queue, 8, 2);
+        (void)queueWrite(&queue, (const uint8_t*)"a", 1);
+        (void)queueWrite(&queue, (const uint8_t*)"b", 1);
+        DrainSlot slots[2];
+        (void)drainClaim(&queue, slots, 2);
+        int res = queueWrite(&queue, (const uint8_t*)"c", 1);
+        ASSERT_EQUAL_INT(res, -EBUSY, "in-flight slot should block producers");
+        (void)drainComplete(&queue, &slots[0], 1);
+        res = queueWrite(&queue, (const uint8_t*)"c", 1);
+        ASSERT_TRUE(res >= QUEUE_OK, "completed slot should be reusable");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_QUEUE(queue, 8, 2);
+        DrainSlot slots[2];
+        ASSERT_EQUAL_INT(drainClaim(NULL, slots, 2), -EINVAL, "NULL queue");
+        ASSERT_EQUAL_INT(drainClaim(&queue, NULL, 2), -EINVAL, "NULL slots");
+        ASSERT_EQUAL_INT(drainClaim(&queue, slots, 0), -EINVAL, "zero max_count");
+    } CASE_COMPLETE;
+}
+
+void test_drainComplete() {
+    TEST_CASE("Short write keeps slot claimed") {
+        CREATE_QUEUE(queue, 16, 2);
+        (void)queueWrite(&queue, (const uint8_t*)"payload", 7);
+        DrainSlot slot;
+        (void)drainClaim(&queue, &slot, 1);
+        int res = drainComplete(&queue, &slot, 3);
+        ASSERT_EQUAL_INT(res, -EAGAIN, "short write should request resubmission");
+        ASSERT_EQUAL_INT(slot.len, 4, "remaining length mismatch");
+        ASSERT_EQUAL_STR(slot.data, "load", 4, "remaining data mismatch");
+        res = drainComplete(&queue, &slot, 4);
+        ASSERT_EQUAL_INT(res, DRAIN_OK, "full write should release the slot");
+        ASSERT_TRUE(queueIsEmpty(&queue), "queue should be empty");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Out of order completions") {
+        CREATE_QUEUE(queue, 8, 3);
+        (void)queueWrite(&queue, (const uint8_t*)"a", 1);
+        (void)queueWrite(&queue, (const uint8_t*)"b", 1);
+        DrainSlot slots[2];
+        (void)drainClaim(&queue, slots, 2);
+        ASSERT_EQUAL_INT(drainComplete(&queue, &slots[1], 1), DRAIN_OK, "second completion failed");
+        ASSERT_EQUAL_INT(drainComplete(&queue, &slots[0], 1), DRAIN_OK, "first completion failed");
+        ASSERT_EQUAL_INT(drainComplete(&queue, &slots[0], 1), -EPERM, "double completion should fail");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Failed write leaves slot untouched") {
+        CREATE_QUEUE(queue, 8, 2);
+        (void)queueWrite(&queue, (const uint8_t*)"abc", 3);
+        DrainSlot slot;
+        (void)drainClaim(&queue, &slot, 1);
+        ASSERT_EQUAL_INT(drainComplete(&queue, &slot, -EPIPE), -EPIPE, "error should be passed through");
+        ASSERT_EQUAL_INT(slot.len, 3, "slot should be unchanged");
+        ASSERT_EQUAL_INT(drainRelease(&queue, &slot), DRAIN_OK, "drop failed");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_QUEUE(queue, 8, 2);
+        DrainSlot slot = {.data = NULL, .len = 0, .index = 5};
+        ASSERT_EQUAL_INT(drainComplete(NULL, &slot, 0), -EINVAL, "NULL queue");
+        ASSERT_EQUAL_INT(drainComplete(&queue, NULL, 0), -EINVAL, "NULL slot");
+        ASSERT_EQUAL_INT(drainRelease(&queue, &slot), -EINVAL, "index out of range");
+    } CASE_COMPLETE;
+}
+
+int main() {
+    LOG_INFO("DRAIN TESTS\n");
+    TEST_EVAL(test_drainRegion);
+    TEST_EVAL(test_drainClaim);
+    TEST_EVAL(test_drainComplete);
+    return testGetStatus();
+}
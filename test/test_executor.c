@@ -0,0 +1,219 @@
+#include "executor.h"
+#include "buffer.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include "test_utils.h"
+#include <string.h>
+#include <errno.h>
+
+static int addOne(void* arg) {
+    *(int*)arg += 1;
+    return *(int*)arg;
+}
+
+static uint16_t woken[4];
+
+static void recordWake(void* ctx, uint16_t worker) {
+    (void)ctx;
+    woken[worker]++;
+}
+
+#ifdef USE_BITMAP_ALLOCATOR
+#define MEMORY_SIZE 2048
+uint8_t testMemory[MEMORY_SIZE];
+static BlockAllocator testAllocator;
+
+void test_executorAllocate() {
+    TEST_CASE("Allocates and initializes executor correctly") {
+        Executor* executor = executorAllocate(&testAllocator, 2, 4);
+        ASSERT_NOT_NULL(executor, "Executor should not be NULL");
+        ASSERT_NOT_NULL(executor->workers, "workers should not be NULL");
+        ASSERT_EQUAL_INT(executor->worker_count, 2, "worker count mismatch");
+        ASSERT_EQUAL_INT(executor->workers[1].ring.size, 4, "ring depth mismatch");
+        ASSERT_EQUAL_INT(executor->workers[1].ring.type_size, sizeof(Task), "ring type size mismatch");
+        ASSERT_NULL(executor->replies, "reply ring should not be set");
+        (void)executorDeallocate(&testAllocator, &executor);
+    } CASE_COMPLETE;
+
+    TEST_CASE("zero size") {
+        ASSERT_NULL(executorAllocate(&testAllocator, 0, 4), "zero workers");
+        ASSERT_NULL(executorAllocate(&testAllocator, 2, 0), "zero depth");
+    } CASE_COMPLETE;
+
+    TEST_CASE("invalid allocator") {
+        Executor* executor = executorAllocate(NULL, 2, 4);
+        ASSERT_NULL(executor, "should return NULL on invalid allocator");
+    } CASE_COMPLETE;
+}
+
+void test_executorDeallocate() {
+    TEST_CASE("Deallocates and nullifies pointer") {
+        Executor* executor = executorAllocate(&testAllocator, 2, 4);
+        int res = executorDeallocate(&testAllocator, &executor);
+        ASSERT_EQUAL_INT(res, EXECUTOR_OK, "deallocation failed");
+        ASSERT_NULL(executor, "pointer should be NULL after free");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Null pointer") {
+        Executor* executor = NULL;
+        int res = executorDeallocate(&testAllocator, &executor);
+        ASSERT_EQUAL_INT(res, -EINVAL, "Deallocating NULL executor should fail");
+    } CASE_COMPLETE;
+}
+#endif
+
+void test_executorCreateMacro() {
+    TEST_CASE("Creates executor correctly") {
+        CREATE_EXECUTOR(executor, 3, 8);
+        ASSERT_NOT_NULL(executor.workers, "workers should not be NULL");
+        ASSERT_EQUAL_INT(executor.worker_count, 3, "worker count mismatch");
+        ASSERT_EQUAL_INT(executor.workers[2].ring.size, 8, "ring depth mismatch");
+        ASSERT_TRUE(bufferIsEmpty(&executor.workers[2].ring), "ring should be empty");
+    } CASE_COMPLETE;
+}
+
+void test_executorSubmit() {
+    TEST_CASE("Round-robin submission") {
+        CREATE_EXECUTOR(executor, 3, 4);
+        int counter = 0;
+        Task task = {.fn = addOne, .arg = &counter, .tag = 0};
+        for (int i = 0; i < 6; i++) {
+            int res = executorSubmit(&executor, &task);
+            ASSERT_EQUAL_INT(res, i % 3, "tasks should rotate over workers");
+        }
+    } CASE_COMPLETE;
+
+    TEST_CASE("Full worker falls through to the next") {
+        CREATE_EXECUTOR(executor, 2, 2);
+        int counter = 0;
+        Task task = {.fn = addOne, .arg = &counter, .tag = 0};
+        ASSERT_EQUAL_INT(executorSubmitKeyed(&executor, &task, 1), 1, "keyed submit failed");
+        ASSERT_EQUAL_INT(executorSubmitKeyed(&executor, &task, 1), 1, "keyed submit failed");
+        ASSERT_EQUAL_INT(executorSubmit(&executor, &task), 0, "should skip to worker 0");
+        ASSERT_EQUAL_INT(executorSubmit(&executor, &task), 0, "should skip the full worker");
+        ASSERT_EQUAL_INT(executorSubmit(&executor, &task), -ENOSPC, "all rings are full");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Keyed submission") {
+        CREATE_EXECUTOR(executor, 4, 4);
+        int counter = 0;
+        Task task = {.fn = addOne, .arg = &counter, .tag = 0};
+        ASSERT_EQUAL_INT(executorSubmitKeyed(&executor, &task, 6), 2, "key should select worker");
+        ASSERT_EQUAL_INT(executorSubmitKeyed(&executor, &task, 6), 2, "same key, same worker");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_EXECUTOR(executor, 2, 4);
+        Task task = {.fn = NULL, .arg = NULL, .tag = 0};
+        ASSERT_EQUAL_INT(executorSubmit(&executor, &task), -EINVAL, "NULL task function");
+        ASSERT_EQUAL_INT(executorSubmit(&executor, NULL), -EINVAL, "NULL task");
+        ASSERT_EQUAL_INT(executorSubmit(NULL, &task), -EINVAL, "NULL executor");
+    } CASE_COMPLETE;
+}
+
+void test_executorRun() {
+    TEST_CASE("Runs own tasks") {
+        CREATE_EXECUTOR(executor, 2, 4);
+        int counter = 0;
+        Task task = {.fn = addOne, .arg = &counter, .tag = 0};
+        (void)executorSubmitKeyed(&executor, &task, 0);
+        (void)executorSubmitKeyed(&executor, &task, 0);
+        ASSERT_EQUAL_INT(executorRun(&executor, 0), EXECUTOR_OK, "run failed");
+        ASSERT_EQUAL_INT(executorRun(&executor, 0), EXECUTOR_OK, "run failed");
+        ASSERT_EQUAL_INT(counter, 2, "tasks should have run");
+        ASSERT_EQUAL_INT(executorRun(&executor, 0), -EAGAIN, "no tasks left");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Idle worker steals") {
+        CREATE_EXECUTOR(executor, 3, 4);
+        int counter = 0;
+        Task task = {.fn = addOne, .arg = &counter, .tag = 0};
+        (void)executorSubmitKeyed(&executor, &task, 2);
+        ASSERT_EQUAL_INT(executorRun(&executor, 0), EXECUTOR_OK, "worker 0 should steal");
+        ASSERT_EQUAL_INT(counter, 1, "stolen task should have run");
+        ASSERT_TRUE(bufferIsEmpty(&executor.workers[2].ring), "victim ring should be empty");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Completions go to the reply ring") {
+        CREATE_EXECUTOR(executor, 1, 4);
+        CREATE_BUFFER(replies, 1, sizeof(TaskResult));
+        ASSERT_EQUAL_INT(executorSetReplyRing(&executor, &replies), EXECUTOR_OK, "set reply ring failed");
+        int counter = 10;
+        Task first = {.fn = addOne, .arg = &counter, .tag = 7};
+        Task second = {.fn = addOne, .arg = &counter, .tag = 8};
+        (void)executorSubmit(&executor, &first);
+        (void)executorSubmit(&executor, &second);
+        ASSERT_EQUAL_INT(executorRun(&executor, 0), EXECUTOR_OK, "run failed");
+        ASSERT_EQUAL_INT(executorRun(&executor, 0), EXECUTOR_OK, "run failed");
+        ASSERT_EQUAL_INT(counter, 12, "both tasks should have run");
+        // second completion is held back until the reply ring has space
+        ASSERT_EQUAL_INT(executorRun(&executor, 0), -ENOSPC, "reply ring is full");
+        TaskResult reply;
+        (void)bufferRead(&replies, &reply);
+        ASSERT_EQUAL_INT(reply.tag, 7, "tag mismatch");
+        ASSERT_EQUAL_INT(reply.result, 11, "result mismatch");
+        ASSERT_EQUAL_INT(executorRun(&executor, 0), -EAGAIN, "pending reply flushed, no task left");
+        (void)bufferRead(&replies, &reply);
+        ASSERT_EQUAL_INT(reply.tag, 8, "tag mismatch");
+        ASSERT_EQUAL_INT(reply.result, 12, "result mismatch");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Reply ring type size must match") {
+        CREATE_EXECUTOR(executor, 1, 4);
+        CREATE_BUFFER(replies, 4, sizeof(uint8_t));
+        ASSERT_EQUAL_INT(executorSetReplyRing(&executor, &replies), -EINVAL, "wrong type size");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_EXECUTOR(executor, 2, 4);
+        ASSERT_EQUAL_INT(executorRun(&executor, 2), -EINVAL, "worker out of range");
+        ASSERT_EQUAL_INT(executorRun(NULL, 0), -EINVAL, "NULL executor");
+    } CASE_COMPLETE;
+}
+
+void test_executorPark() {
+    TEST_CASE("Submit wakes a parked worker once") {
+        CREATE_EXECUTOR(executor, 2, 4);
+        (void)executorSetWakeHook(&executor, recordWake, NULL);
+        memset(woken, 0, sizeof(woken));
+        ASSERT_EQUAL_INT(executorPark(&executor, 1), EXECUTOR_OK, "park failed");
+        ASSERT_EQUAL_INT(*executorIdleFlag(&executor, 1), 1, "idle flag should be set");
+        int counter = 0;
+        Task task = {.fn = addOne, .arg = &counter, .tag = 0};
+        (void)executorSubmitKeyed(&executor, &task, 1);
+        (void)executorSubmitKeyed(&executor, &task, 1);
+        ASSERT_EQUAL_INT(woken[1], 1, "worker should be woken exactly once");
+        ASSERT_EQUAL_INT(woken[0], 0, "other worker should not be woken");
+        ASSERT_EQUAL_INT(*executorIdleFlag(&executor, 1), 0, "idle flag should be cleared");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Park with queued work") {
+        CREATE_EXECUTOR(executor, 1, 4);
+        int counter = 0;
+        Task task = {.fn = addOne, .arg = &counter, .tag = 0};
+        (void)executorSubmit(&executor, &task);
+        ASSERT_EQUAL_INT(executorPark(&executor, 0), -EAGAIN, "park should be refused");
+        ASSERT_EQUAL_INT(*executorIdleFlag(&executor, 0), 0, "idle flag should be withdrawn");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_EXECUTOR(executor, 1, 4);
+        ASSERT_EQUAL_INT(executorPark(&executor, 1), -EINVAL, "worker out of range");
+        ASSERT_NULL(executorIdleFlag(&executor, 1), "worker out of range");
+    } CASE_COMPLETE;
+}
+
+int main() {
+    LOG_INFO("EXECUTOR TESTS\n");
+#ifdef USE_BITMAP_ALLOCATOR
+    initBlockAllocator(&testAllocator, 4, testMemory, MEMORY_SIZE);
+    TEST_EVAL(test_executorAllocate);
+    TEST_EVAL(test_executorDeallocate);
+#endif
+    TEST_EVAL(test_executorCreateMacro);
+    TEST_EVAL(test_executorSubmit);
+    TEST_EVAL(test_executorRun);
+    TEST_EVAL(test_executorPark);
+    return testGetStatus();
+}
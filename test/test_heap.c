@@ -0,0 +1,175 @@
+#include "heap.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include "test_utils.h"
+#include <string.h>
+#include <errno.h>
+
+#ifdef USE_BITMAP_ALLOCATOR
+#define MEMORY_SIZE 2048
+uint8_t testMemory[MEMORY_SIZE];
+static BlockAllocator testAllocator;
+
+void test_heapAllocate() {
+    TEST_CASE("Allocates and initializes heap correctly") {
+        Heap* heap = heapAllocate(&testAllocator, 8, sizeof(TestStruct));
+        ASSERT_NOT_NULL(heap, "Heap should not be NULL");
+        ASSERT_NOT_NULL(heap->entries, "entries should not be NULL");
+        ASSERT_NOT_NULL(heap->raw, "raw should not be NULL");
+        ASSERT_EQUAL_INT(heap->size, 8, "size mismatch");
+        ASSERT_EQUAL_INT(heap->type_size, sizeof(TestStruct), "type_size mismatch");
+        ASSERT_TRUE(heapIsEmpty(heap), "should be empty on init");
+        (void)heapDeallocate(&testAllocator, &heap);
+    } CASE_COMPLETE;
+
+    TEST_CASE("zero dimensions") {
+        ASSERT_NULL(heapAllocate(&testAllocator, 0, 4), "should return NULL if `size` is zero");
+        ASSERT_NULL(heapAllocate(&testAllocator, 8, 0), "should return NULL if `type_size` is zero");
+    } CASE_COMPLETE;
+
+    TEST_CASE("invalid allocator") {
+        ASSERT_NULL(heapAllocate(NULL, 8, 4), "should return NULL on invalid allocator");
+    } CASE_COMPLETE;
+}
+
+void test_heapDeallocate() {
+    TEST_CASE("Deallocates and nullifies pointer") {
+        Heap* heap = heapAllocate(&testAllocator, 8, 4);
+        int res = heapDeallocate(&testAllocator, &heap);
+        ASSERT_EQUAL_INT(res, HEAP_OK, "deallocation failed");
+        ASSERT_NULL(heap, "pointer should be NULL after free");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Null pointer") {
+        ASSERT_EQUAL_INT(heapDeallocate(&testAllocator, NULL), -EINVAL, "expected -EINVAL");
+    } CASE_COMPLETE;
+}
+#endif
+
+void test_heapPush() {
+    TEST_CASE("Fills to capacity") {
+        CREATE_HEAP(heap, 4, sizeof(uint32_t));
+        uint32_t v = 1;
+        for (int i = 0; i < 4; i++) {
+            ASSERT_EQUAL_INT(heapPush(&heap, 10 - i, &v), HEAP_OK, "push failed");
+        }
+        ASSERT_TRUE(heapIsFull(&heap), "should be full");
+        ASSERT_EQUAL_INT(heapPush(&heap, 0, &v), -ENOSPC, "no space expected");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_HEAP(heap, 4, sizeof(uint32_t));
+        uint32_t v = 1;
+        ASSERT_EQUAL_INT(heapPush(NULL, 0, &v), -EINVAL, "NULL heap");
+        ASSERT_EQUAL_INT(heapPush(&heap, 0, NULL), -EINVAL, "NULL data");
+    } CASE_COMPLETE;
+}
+
+void test_heapPop() {
+    TEST_CASE("Releases smallest key first") {
+        CREATE_HEAP(heap, 32, sizeof(TestStruct));
+        // a fixed permutation of 0..31 so every level of the tree is exercised
+        for (uint32_t i = 0; i < 32; i++) {
+            uint64_t key = (i * 13u) % 32u;
+            TestStruct in = { .flag = true, .data = (int)key, .ptr = NULL };
+            (void)heapPush(&heap, key << 32, &in);
+        }
+        for (uint64_t expected = 0; expected < 32; expected++) {
+            TestStruct out;
+            uint64_t key;
+            ASSERT_EQUAL_INT(heapPop(&heap, &key, &out), HEAP_OK, "pop failed");
+            ASSERT_TRUE(key == (expected << 32), "key order mismatch");
+            ASSERT_EQUAL_INT(out.data, (int)expected, "payload should follow its key");
+        }
+        ASSERT_TRUE(heapIsEmpty(&heap), "should be empty");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Reuses freed slots") {
+        CREATE_HEAP(heap, 3, sizeof(uint16_t));
+        uint16_t v;
+        for (int round = 0; round < 4; round++) {
+            for (uint16_t i = 0; i < 3; i++) {
+                v = (uint16_t)(round * 10 + i);
+                ASSERT_EQUAL_INT(heapPush(&heap, 3 - i, &v), HEAP_OK, "push failed");
+            }
+            for (int i = 2; i >= 0; i--) {
+                ASSERT_EQUAL_INT(heapPop(&heap, NULL, &v), HEAP_OK, "pop failed");
+                ASSERT_EQUAL_INT(v, round * 10 + i, "payload mismatch");
+            }
+        }
+    } CASE_COMPLETE;
+
+    TEST_CASE("Empty heap") {
+        CREATE_HEAP(heap, 3, sizeof(uint16_t));
+        uint16_t v;
+        uint64_t key;
+        ASSERT_EQUAL_INT(heapPop(&heap, &key, &v), -EAGAIN, "empty heap expected");
+        ASSERT_EQUAL_INT(heapPeek(&heap, &key), -EAGAIN, "empty heap expected");
+        ASSERT_EQUAL_INT(heapPop(&heap, &key, NULL), -EINVAL, "NULL data");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Peek leaves the heap unchanged") {
+        CREATE_HEAP(heap, 3, sizeof(uint16_t));
+        uint16_t v = 5;
+        uint64_t key;
+        (void)heapPush(&heap, 20, &v);
+        (void)heapPush(&heap, 7, &v);
+        ASSERT_EQUAL_INT(heapPeek(&heap, &key), HEAP_OK, "peek failed");
+        ASSERT_TRUE(key == 7, "smallest key expected");
+        ASSERT_EQUAL_INT(heap.count, 2, "peek should not remove");
+    } CASE_COMPLETE;
+}
+
+void test_heapPopBatch() {
+    TEST_CASE("Stops at the limit") {
+        CREATE_HEAP(heap, 8, sizeof(uint32_t));
+        for (uint32_t v = 0; v < 8; v++) (void)heapPush(&heap, 100 + v * 10, &v);
+        uint64_t keys[8];
+        uint32_t out[8];
+        ASSERT_EQUAL_INT(heapPopBatch(&heap, 125, keys, out, 8), 3, "three keys are due");
+        for (uint32_t i = 0; i < 3; i++) {
+            ASSERT_TRUE(keys[i] == 100 + i * 10, "key order mismatch");
+            ASSERT_EQUAL_INT(out[i], i, "payload mismatch");
+        }
+        ASSERT_EQUAL_INT(heapPopBatch(&heap, 125, keys, out, 8), 0, "nothing else is due");
+        ASSERT_EQUAL_INT(heap.count, 5, "remaining count mismatch");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Stops at max_count") {
+        CREATE_HEAP(heap, 8, sizeof(uint32_t));
+        for (uint32_t v = 0; v < 8; v++) (void)heapPush(&heap, v, &v);
+        uint32_t out[2];
+        ASSERT_EQUAL_INT(heapPopBatch(&heap, UINT64_MAX, NULL, out, 2), 2, "two elements expected");
+        ASSERT_EQUAL_INT(out[0], 0, "payload mismatch");
+        ASSERT_EQUAL_INT(out[1], 1, "payload mismatch");
+        ASSERT_EQUAL_INT(heapPopBatch(NULL, 0, NULL, out, 2), -EINVAL, "NULL heap");
+    } CASE_COMPLETE;
+}
+
+void test_heapClear() {
+    TEST_CASE("Resets the heap") {
+        CREATE_HEAP(heap, 4, sizeof(uint8_t));
+        uint8_t v = 1;
+        for (int i = 0; i < 4; i++) (void)heapPush(&heap, i, &v);
+        heapClear(&heap);
+        ASSERT_TRUE(heapIsEmpty(&heap), "should be empty after clear");
+        for (int i = 0; i < 4; i++) {
+            ASSERT_EQUAL_INT(heapPush(&heap, i, &v), HEAP_OK, "every slot should be free");
+        }
+    } CASE_COMPLETE;
+}
+
+int main() {
+    LOG_INFO("HEAP TESTS\n");
+#ifdef USE_BITMAP_ALLOCATOR
+    initBlockAllocator(&testAllocator, 4, testMemory, MEMORY_SIZE);
+    TEST_EVAL(test_heapAllocate);
+    TEST_EVAL(test_heapDeallocate);
+#endif
+    TEST_EVAL(test_heapPush);
+    TEST_EVAL(test_heapPop);
+    TEST_EVAL(test_heapPopBatch);
+    TEST_EVAL(test_heapClear);
+    return testGetStatus();
+}
@@ -0,0 +1,167 @@
+#include "lease.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include "test_utils.h"
+#include <string.h>
+#include <errno.h>
+
+#ifdef USE_BITMAP_ALLOCATOR
+#define MEMORY_SIZE 2048
+uint8_t testMemory[MEMORY_SIZE];
+static BlockAllocator testAllocator;
+
+void test_leaseQueueAllocate() {
+    TEST_CASE("Allocates and initializes lease queue correctly") {
+        LeaseQueue* lq = leaseQueueAllocate(&testAllocator, 8, 4, 10);
+        ASSERT_NOT_NULL(lq, "LeaseQueue should not be NULL");
+        ASSERT_NOT_NULL(lq->queue, "queue should not be NULL");
+        ASSERT_NOT_NULL(lq->redeliver, "redelivery ring should not be NULL");
+        ASSERT_EQUAL_INT(lq->queue->slot_len, 8, "slot_len mismatch");
+        ASSERT_EQUAL_INT(lq->redeliver->size, 4, "redelivery ring size mismatch");
+        ASSERT_EQUAL_INT(lq->lease, 10, "lease mismatch");
+        ASSERT_TRUE(queueIsEmpty(lq->queue), "should be empty on init");
+        (void)leaseQueueDeallocate(&testAllocator, &lq);
+    } CASE_COMPLETE;
+
+    TEST_CASE("zero dimensions") {
+        ASSERT_NULL(leaseQueueAllocate(&testAllocator, 0, 4, 10), "should return NULL if `slot_len` is zero");
+        ASSERT_NULL(leaseQueueAllocate(&testAllocator, 8, 0, 10), "should return NULL if `size` is zero");
+    } CASE_COMPLETE;
+
+    TEST_CASE("invalid allocator") {
+        ASSERT_NULL(leaseQueueAllocate(NULL, 8, 4, 10), "should return NULL on invalid allocator");
+    } CASE_COMPLETE;
+}
+
+void test_leaseQueueDeallocate() {
+    TEST_CASE("Deallocates and nullifies pointer") {
+        LeaseQueue* lq = leaseQueueAllocate(&testAllocator, 8, 4, 10);
+        int res = leaseQueueDeallocate(&testAllocator, &lq);
+        ASSERT_EQUAL_INT(res, LEASE_OK, "deallocation failed");
+        ASSERT_NULL(lq, "pointer should be NULL after free");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Null pointer") {
+        ASSERT_EQUAL_INT(leaseQueueDeallocate(&testAllocator, NULL), -EINVAL, "expected -EINVAL");
+    } CASE_COMPLETE;
+}
+#endif
+
+void test_leaseQueueClaim() {
+    TEST_CASE("Delivers in order and acks") {
+        CREATE_LEASE_QUEUE(lq, 8, 4, 10);
+        LeaseSlot slot;
+        (void)queueWrite(lq.queue, (const uint8_t*)"first", 5);
+        (void)queueWrite(lq.queue, (const uint8_t*)"second", 6);
+        ASSERT_TRUE(leaseQueueClaim(&lq, 0, &slot) >= LEASE_OK, "claim failed");
+        ASSERT_EQUAL_INT(slot.len, 5, "length mismatch");
+        ASSERT_EQUAL_STR((char*)slot.data, "first", 5, "message mismatch");
+        ASSERT_EQUAL_INT(slot.delivery, 1, "first delivery expected");
+        ASSERT_EQUAL_INT(leaseQueueAck(&lq, &slot), LEASE_OK, "ack failed");
+        ASSERT_TRUE(leaseQueueClaim(&lq, 0, &slot) >= LEASE_OK, "claim failed");
+        ASSERT_EQUAL_STR((char*)slot.data, "second", 6, "message mismatch");
+        ASSERT_EQUAL_INT(leaseQueueAck(&lq, &slot), LEASE_OK, "ack failed");
+        ASSERT_EQUAL_INT(leaseQueueClaim(&lq, 0, &slot), -EAGAIN, "queue should be empty");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Leased slot is not reused") {
+        CREATE_LEASE_QUEUE(lq, 8, 2, 10);
+        LeaseSlot slot;
+        (void)queueWrite(lq.queue, (const uint8_t*)"a", 1);
+        (void)queueWrite(lq.queue, (const uint8_t*)"b", 1);
+        (void)leaseQueueClaim(&lq, 0, &slot);
+        ASSERT_EQUAL_INT(queueWrite(lq.queue, (const uint8_t*)"c", 1), -EBUSY, "leased slot should block writers");
+        (void)leaseQueueAck(&lq, &slot);
+        ASSERT_EQUAL_INT(queueWrite(lq.queue, (const uint8_t*)"c", 1), 1, "acked slot should be writable");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Nack redelivers") {
+        CREATE_LEASE_QUEUE(lq, 8, 4, 10);
+        LeaseSlot slot, again;
+        (void)queueWrite(lq.queue, (const uint8_t*)"retry", 5);
+        (void)queueWrite(lq.queue, (const uint8_t*)"next", 4);
+        (void)leaseQueueClaim(&lq, 0, &slot);
+        ASSERT_EQUAL_INT(leaseQueueNack(&lq, &slot), LEASE_OK, "nack failed");
+        ASSERT_TRUE(leaseQueueClaim(&lq, 1, &again) >= LEASE_OK, "claim failed");
+        ASSERT_EQUAL_INT(again.index, slot.index, "nacked message should come first");
+        ASSERT_EQUAL_INT(again.delivery, 2, "second delivery expected");
+        ASSERT_EQUAL_STR((char*)again.data, "retry", 5, "message mismatch");
+        ASSERT_EQUAL_INT(leaseQueueAck(&lq, &slot), -ETIMEDOUT, "old delivery should be rejected");
+        ASSERT_EQUAL_INT(leaseQueueAck(&lq, &again), LEASE_OK, "ack failed");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_LEASE_QUEUE(lq, 8, 4, 10);
+        LeaseSlot slot = { .index = 9, .delivery = 1 };
+        ASSERT_EQUAL_INT(leaseQueueClaim(NULL, 0, &slot), -EINVAL, "NULL queue");
+        ASSERT_EQUAL_INT(leaseQueueClaim(&lq, 0, NULL), -EINVAL, "NULL slot");
+        ASSERT_EQUAL_INT(leaseQueueAck(&lq, &slot), -EINVAL, "index out of range");
+        slot.index = 0;
+        ASSERT_EQUAL_INT(leaseQueueAck(&lq, &slot), -EPERM, "slot is not leased");
+        ASSERT_EQUAL_INT(leaseQueueNack(&lq, &slot), -EPERM, "slot is not leased");
+    } CASE_COMPLETE;
+}
+
+void test_leaseQueueExpire() {
+    TEST_CASE("Redelivers after the lease period") {
+        CREATE_LEASE_QUEUE(lq, 8, 4, 10);
+        LeaseSlot slot, again;
+        (void)queueWrite(lq.queue, (const uint8_t*)"lost", 4);
+        (void)leaseQueueClaim(&lq, 100, &slot);
+        ASSERT_EQUAL_INT(leaseQueueExpire(&lq, 109, 4), 0, "lease should still be active");
+        ASSERT_EQUAL_INT(leaseQueueClaim(&lq, 109, &again), -EAGAIN, "nothing to deliver yet");
+        ASSERT_EQUAL_INT(leaseQueueExpire(&lq, 110, 4), 1, "lease should expire");
+        ASSERT_EQUAL_INT(leaseQueueAck(&lq, &slot), -ETIMEDOUT, "expired lease should be rejected");
+        ASSERT_TRUE(leaseQueueClaim(&lq, 110, &again) >= LEASE_OK, "claim failed");
+        ASSERT_EQUAL_INT(again.delivery, 2, "second delivery expected");
+        ASSERT_EQUAL_STR((char*)again.data, "lost", 4, "message mismatch");
+        ASSERT_EQUAL_INT(leaseQueueAck(&lq, &again), LEASE_OK, "ack failed");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Idle claim sweeps") {
+        CREATE_LEASE_QUEUE(lq, 8, 4, 10);
+        LeaseSlot slot, again;
+        (void)queueWrite(lq.queue, (const uint8_t*)"lost", 4);
+        (void)leaseQueueClaim(&lq, 0, &slot);
+        ASSERT_TRUE(leaseQueueClaim(&lq, 50, &again) >= LEASE_OK, "expired lease should be redelivered");
+        ASSERT_EQUAL_INT(again.index, slot.index, "same message expected");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Time wrap-around") {
+        CREATE_LEASE_QUEUE(lq, 8, 4, 10);
+        LeaseSlot slot;
+        (void)queueWrite(lq.queue, (const uint8_t*)"wrap", 4);
+        (void)leaseQueueClaim(&lq, 0xFFFFFFFBu, &slot);
+        ASSERT_EQUAL_INT(leaseQueueExpire(&lq, 2, 4), 0, "lease should still be active");
+        ASSERT_EQUAL_INT(leaseQueueExpire(&lq, 5, 4), 1, "lease should expire");
+    } CASE_COMPLETE;
+}
+
+void test_leaseQueueClear() {
+    TEST_CASE("Frees leased slots") {
+        CREATE_LEASE_QUEUE(lq, 8, 2, 10);
+        LeaseSlot slot;
+        (void)queueWrite(lq.queue, (const uint8_t*)"a", 1);
+        (void)queueWrite(lq.queue, (const uint8_t*)"b", 1);
+        (void)leaseQueueClaim(&lq, 0, &slot);
+        leaseQueueClear(&lq);
+        ASSERT_TRUE(queueIsEmpty(lq.queue), "should be empty after clear");
+        ASSERT_EQUAL_INT(queueWrite(lq.queue, (const uint8_t*)"c", 1), 1, "slot should be writable");
+        ASSERT_EQUAL_INT(queueWrite(lq.queue, (const uint8_t*)"d", 1), 1, "slot should be writable");
+        ASSERT_EQUAL_INT(leaseQueueAck(&lq, &slot), -EPERM, "lease should be gone");
+    } CASE_COMPLETE;
+}
+
+int main() {
+    LOG_INFO("LEASE TESTS\n");
+#ifdef USE_BITMAP_ALLOCATOR
+    initBlockAllocator(&testAllocator, 4, testMemory, MEMORY_SIZE);
+    TEST_EVAL(test_leaseQueueAllocate);
+    TEST_EVAL(test_leaseQueueDeallocate);
+#endif
+    TEST_EVAL(test_leaseQueueClaim);
+    TEST_EVAL(test_leaseQueueExpire);
+    TEST_EVAL(test_leaseQueueClear);
+    return testGetStatus();
+}
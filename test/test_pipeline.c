@@ -0,0 +1,249 @@
+#ifdef USE_THREADS
+#define _GNU_SOURCE
+#endif
+#include "pipeline.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include "test_utils.h"
+#include <string.h>
+#include <errno.h>
+#ifdef USE_THREADS
+#include <sched.h>
+#endif
+
+/**
+ * @brief Collects the elements reaching the last stage.
+ */
+typedef struct {
+    uint32_t values[32];
+    uint16_t count;
+} Sink;
+
+static void addOne(void* ctx, void* out, const void* in) {
+    (void)ctx;
+    *(uint32_t*)out = *(const uint32_t*)in + 1;
+}
+
+static void timesTen(void* ctx, void* out, const void* in) {
+    (void)ctx;
+    *(uint32_t*)out = *(const uint32_t*)in * 10;
+}
+
+static void collect(void* ctx, void* out, const void* in) {
+    Sink* sink = (Sink*)ctx;
+    (void)out;
+    sink->values[sink->count++] = *(const uint32_t*)in;
+}
+
+#ifdef USE_BITMAP_ALLOCATOR
+#define MEMORY_SIZE 2048
+uint8_t testMemory[MEMORY_SIZE];
+static BlockAllocator testAllocator;
+
+void test_pipelineAllocate() {
+    TEST_CASE("Allocates and initializes pipeline correctly") {
+        Pipeline* p = pipelineAllocate(&testAllocator, 3, 4, sizeof(uint32_t));
+        ASSERT_NOT_NULL(p, "Pipeline should not be NULL");
+        ASSERT_EQUAL_INT(p->stage_count, 3, "stage_count mismatch");
+        for (uint16_t s = 0; s < 3; s++) {
+            ASSERT_NOT_NULL(p->stages[s].input.raw, "ring storage should not be NULL");
+            ASSERT_NOT_NULL(p->stages[s].input.lock, "ring lock should not be NULL");
+            ASSERT_EQUAL_INT(p->stages[s].input.size, 4, "ring size mismatch");
+            ASSERT_EQUAL_INT(GET_LOCK_VAL(&p->stages[s].credits), 4, "credits should match depth");
+        }
+        (void)pipelineDeallocate(&testAllocator, &p);
+    } CASE_COMPLETE;
+
+    TEST_CASE("zero dimensions") {
+        ASSERT_NULL(pipelineAllocate(&testAllocator, 0, 4, 4), "should return NULL if `stage_count` is zero");
+        ASSERT_NULL(pipelineAllocate(&testAllocator, 3, 0, 4), "should return NULL if `depth` is zero");
+        ASSERT_NULL(pipelineAllocate(&testAllocator, 3, 4, 0), "should return NULL if `type_size` is zero");
+    } CASE_COMPLETE;
+
+    TEST_CASE("invalid allocator") {
+        ASSERT_NULL(pipelineAllocate(NULL, 3, 4, 4), "should return NULL on invalid allocator");
+    } CASE_COMPLETE;
+}
+
+void test_pipelineDeallocate() {
+    TEST_CASE("Deallocates and nullifies pointer") {
+        Pipeline* p = pipelineAllocate(&testAllocator, 2, 4, sizeof(uint32_t));
+        int res = pipelineDeallocate(&testAllocator, &p);
+        ASSERT_EQUAL_INT(res, PIPELINE_OK, "deallocation failed");
+        ASSERT_NULL(p, "pointer should be NULL after free");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Null pointer") {
+        ASSERT_EQUAL_INT(pipelineDeallocate(&testAllocator, NULL), -EINVAL, "expected -EINVAL");
+    } CASE_COMPLETE;
+}
+#endif
+
+void test_pipelineRun() {
+    TEST_CASE("Elements pass through every stage in order") {
+        CREATE_PIPELINE(p, 3, 4, sizeof(uint32_t));
+        Sink sink = {0};
+        (void)pipelineSetStage(&p, 0, addOne, NULL, 2);
+        (void)pipelineSetStage(&p, 1, timesTen, NULL, 4);
+        (void)pipelineSetStage(&p, 2, collect, &sink, 4);
+        for (uint32_t v = 0; v < 4; v++) {
+            ASSERT_EQUAL_INT(pipelinePush(&p, &v), PIPELINE_OK, "push failed");
+        }
+        ASSERT_EQUAL_INT(pipelineRun(&p, 0), 2, "batch should be limited to two");
+        ASSERT_EQUAL_INT(pipelineRun(&p, 0), 2, "batch should be limited to two");
+        ASSERT_EQUAL_INT(pipelineRun(&p, 0), -EAGAIN, "first stage should be empty");
+        ASSERT_EQUAL_INT(pipelineRun(&p, 1), 4, "second stage should take all four");
+        ASSERT_EQUAL_INT(pipelineRun(&p, 2), 4, "last stage should take all four");
+        ASSERT_EQUAL_INT(sink.count, 4, "expected four elements");
+        for (uint32_t v = 0; v < 4; v++) {
+            ASSERT_EQUAL_INT(sink.values[v], (v + 1) * 10, "element mismatch");
+        }
+    } CASE_COMPLETE;
+
+    TEST_CASE("Unconfigured stage") {
+        CREATE_PIPELINE(p, 2, 4, sizeof(uint32_t));
+        ASSERT_EQUAL_INT(pipelineRun(&p, 0), -EINVAL, "stage without a function");
+        ASSERT_EQUAL_INT(pipelineRun(&p, 2), -EINVAL, "stage out of range");
+        ASSERT_EQUAL_INT(pipelineRun(NULL, 0), -EINVAL, "NULL pipeline");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid stage settings") {
+        CREATE_PIPELINE(p, 2, 4, sizeof(uint32_t));
+        ASSERT_EQUAL_INT(pipelineSetStage(&p, 0, NULL, NULL, 1), -EINVAL, "NULL function");
+        ASSERT_EQUAL_INT(pipelineSetStage(&p, 0, addOne, NULL, 0), -EINVAL, "zero batch");
+        ASSERT_EQUAL_INT(pipelineSetStage(&p, 0, addOne, NULL, 5), -EINVAL, "batch above depth");
+        ASSERT_EQUAL_INT(pipelineSetStage(&p, 2, addOne, NULL, 1), -EINVAL, "stage out of range");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid thread settings") {
+        CREATE_PIPELINE(p, 2, 4, sizeof(uint32_t));
+        ASSERT_EQUAL_INT(pipelineSetThreads(&p, 0, 0, PIPELINE_CPU_ANY), -EINVAL, "zero threads");
+        ASSERT_EQUAL_INT(pipelineSetThreads(&p, 0, 1, -2), -EINVAL, "negative CPU");
+        ASSERT_EQUAL_INT(pipelineSetThreads(&p, 2, 1, PIPELINE_CPU_ANY), -EINVAL, "stage out of range");
+        ASSERT_EQUAL_INT(pipelineSetThreads(&p, 1, 3, 0), PIPELINE_OK, "valid settings");
+        ASSERT_EQUAL_INT(p.stages[1].threads, 3, "thread count mismatch");
+    } CASE_COMPLETE;
+}
+
+void test_pipelineCredits() {
+    TEST_CASE("Push stops when the first ring has no credit") {
+        CREATE_PIPELINE(p, 2, 4, sizeof(uint32_t));
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++) (void)pipelinePush(&p, &v);
+        ASSERT_EQUAL_INT(pipelinePush(&p, &v), -ENOSPC, "no credit expected");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Stage stalls on a full downstream ring") {
+        CREATE_PIPELINE(p, 2, 2, sizeof(uint32_t));
+        Sink sink = {0};
+        (void)pipelineSetStage(&p, 0, addOne, NULL, 2);
+        (void)pipelineSetStage(&p, 1, collect, &sink, 1);
+        uint32_t v = 0;
+        (void)pipelinePush(&p, &v);
+        (void)pipelinePush(&p, &v);
+        ASSERT_EQUAL_INT(pipelineRun(&p, 0), 2, "first batch expected");
+        (void)pipelinePush(&p, &v);
+        ASSERT_EQUAL_INT(pipelineRun(&p, 0), -ENOSPC, "stage should stall");
+        ASSERT_EQUAL_INT(GET_LOCK_VAL(&p.stages[0].credits), 1, "stalled element should stay queued");
+        ASSERT_EQUAL_INT(pipelineRun(&p, 1), 1, "last stage should free one slot");
+        ASSERT_EQUAL_INT(pipelineRun(&p, 0), 1, "stage should resume");
+        PipelineStats stats;
+        (void)pipelineStats(&p, 0, &stats);
+        ASSERT_EQUAL_INT(stats.processed, 3, "processed mismatch");
+        ASSERT_EQUAL_INT(stats.batches, 2, "batches mismatch");
+        ASSERT_EQUAL_INT(stats.stalls, 1, "stalls mismatch");
+        ASSERT_EQUAL_INT(stats.depth, 0, "first ring should be empty");
+        (void)pipelineStats(&p, 1, &stats);
+        ASSERT_EQUAL_INT(stats.depth, 2, "last ring should be full");
+        ASSERT_EQUAL_INT(pipelineStats(&p, 2, &stats), -EINVAL, "stage out of range");
+    } CASE_COMPLETE;
+}
+
+void test_pipelineClose() {
+    TEST_CASE("Drains stage by stage") {
+        CREATE_PIPELINE(p, 2, 4, sizeof(uint32_t));
+        Sink sink = {0};
+        (void)pipelineSetStage(&p, 0, addOne, NULL, 4);
+        (void)pipelineSetStage(&p, 1, collect, &sink, 4);
+        uint32_t v = 7;
+        (void)pipelinePush(&p, &v);
+        pipelineClose(&p);
+        ASSERT_EQUAL_INT(pipelinePush(&p, &v), -EPIPE, "push after close should fail");
+        ASSERT_EQUAL_INT(pipelineRun(&p, 1), -EAGAIN, "last stage is not done while upstream runs");
+        ASSERT_EQUAL_INT(pipelineRun(&p, 0), 1, "queued element should still be processed");
+        ASSERT_EQUAL_INT(pipelineRun(&p, 0), -EPIPE, "first stage should be done");
+        ASSERT_EQUAL_INT(pipelineRun(&p, 1), 1, "last stage should drain");
+        ASSERT_EQUAL_INT(pipelineRun(&p, 1), -EPIPE, "last stage should be done");
+        ASSERT_EQUAL_INT(sink.count, 1, "element should not be lost");
+        ASSERT_EQUAL_INT(sink.values[0], 8, "element mismatch");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Clear reopens") {
+        CREATE_PIPELINE(p, 1, 4, sizeof(uint32_t));
+        Sink sink = {0};
+        (void)pipelineSetStage(&p, 0, collect, &sink, 4);
+        uint32_t v = 1;
+        (void)pipelinePush(&p, &v);
+        pipelineClose(&p);
+        pipelineClear(&p);
+        ASSERT_EQUAL_INT(pipelineRun(&p, 0), -EAGAIN, "cleared ring should be empty and open");
+        ASSERT_EQUAL_INT(pipelinePush(&p, &v), PIPELINE_OK, "push after clear should succeed");
+        ASSERT_EQUAL_INT(pipelineRun(&p, 0), 1, "stage function should be kept");
+    } CASE_COMPLETE;
+}
+
+#ifdef USE_THREADS
+void test_pipelineStart() {
+    TEST_CASE("Stage threads drain the pipeline") {
+        CREATE_PIPELINE(p, 2, 4, sizeof(uint32_t));
+        CREATE_PIPELINE_RUNNER(runner, 2);
+        Sink sink = {0};
+        (void)pipelineSetStage(&p, 0, addOne, NULL, 2);
+        (void)pipelineSetStage(&p, 1, collect, &sink, 4);
+        // a CPU the test is allowed to run on
+        int cpu = sched_getcpu();
+        ASSERT_TRUE(cpu >= 0, "sched_getcpu failed");
+        (void)pipelineSetThreads(&p, 0, 1, (int16_t)cpu);
+        ASSERT_EQUAL_INT(pipelineStart(&p, &runner), PIPELINE_OK, "start failed");
+        ASSERT_EQUAL_INT(runner.count, 2, "one thread per stage expected");
+        for (uint32_t v = 0; v < 20; v++) {
+            while (pipelinePush(&p, &v) == -ENOSPC) sched_yield();
+        }
+        pipelineClose(&p);
+        ASSERT_EQUAL_INT(pipelineJoin(&runner), PIPELINE_OK, "stages should drain");
+        ASSERT_EQUAL_INT(sink.count, 20, "every element should arrive");
+        for (uint32_t v = 0; v < 20; v++) {
+            ASSERT_EQUAL_INT(sink.values[v], v + 1, "element mismatch");
+        }
+    } CASE_COMPLETE;
+
+    TEST_CASE("Rejects invalid runners") {
+        CREATE_PIPELINE(p, 2, 4, sizeof(uint32_t));
+        CREATE_PIPELINE_RUNNER(runner, 2);
+        (void)pipelineSetStage(&p, 0, addOne, NULL, 1);
+        ASSERT_EQUAL_INT(pipelineStart(&p, &runner), -EINVAL, "unconfigured stage");
+        (void)pipelineSetStage(&p, 1, timesTen, NULL, 1);
+        (void)pipelineSetThreads(&p, 1, 2, PIPELINE_CPU_ANY);
+        ASSERT_EQUAL_INT(pipelineStart(&p, &runner), -ENOSPC, "runner too small");
+        ASSERT_EQUAL_INT(pipelineStart(NULL, &runner), -EINVAL, "NULL pipeline");
+        ASSERT_EQUAL_INT(pipelineJoin(NULL), -EINVAL, "NULL runner");
+    } CASE_COMPLETE;
+}
+#endif
+
+int main() {
+    LOG_INFO("PIPELINE TESTS\n");
+#ifdef USE_BITMAP_ALLOCATOR
+    initBlockAllocator(&testAllocator, 4, testMemory, MEMORY_SIZE);
+    TEST_EVAL(test_pipelineAllocate);
+    TEST_EVAL(test_pipelineDeallocate);
+#endif
+    TEST_EVAL(test_pipelineRun);
+    TEST_EVAL(test_pipelineCredits);
+    TEST_EVAL(test_pipelineClose);
+#ifdef USE_THREADS
+    TEST_EVAL(test_pipelineStart);
+#endif
+    return testGetStatus();
+}
@@ -84,23 +84,33 @@ void test_queueCreateMacro() {
 }
 
 void test_queueClear() {
-    TEST_CASE("Clears msg_len array") {
+    TEST_CASE("Resets positions") {
         CREATE_QUEUE(buf, 8, 4);
         buf.slot_buffer->head = 2;
         buf.slot_buffer->tail = 1;
         buf.slot_buffer->full = true;
-        for (int i = 0; i < 4; ++i) buf.msg_len[i] = 4;
         uint8_t* raw = (uint8_t*)buf.slot_buffer->raw;
         queueClear(&buf);
         ASSERT_EQUAL_INT(buf.slot_buffer->head, 0, "head not reset");
         ASSERT_EQUAL_INT(buf.slot_buffer->tail, 0, "tail not reset");
         ASSERT_FALSE(buf.slot_buffer->full, "full not reset");
-        for (int i = 0; i < 4; ++i)
-            ASSERT_EQUAL_INT(buf.msg_len[i], 0, "msg_len[i] not cleared");
         ASSERT_EQUAL_PTR(raw, (uint8_t*)buf.slot_buffer->raw, "slot_buffer reset on clear");
         ASSERT_EQUAL_INT(buf.slot_len, 8, "size reset on clear");
         ASSERT_EQUAL_INT(buf.slot_buffer->size, 4, "size reset on clear");
     } CASE_COMPLETE;
+
+    TEST_CASE("Discards pending messages") {
+        CREATE_QUEUE(buf, 8, 4);
+        uint8_t msg[8] = "abcdefg";
+        uint8_t out[8];
+        for (int i = 0; i < 4; ++i) (void)queueWrite(&buf, msg, 7);
+        queueClear(&buf);
+        ASSERT_TRUE(queueIsEmpty(&buf), "should be empty after clear");
+        ASSERT_EQUAL_INT(queueRead(&buf, out, 8), -EAGAIN, "nothing should be readable");
+        for (int i = 0; i < 4; ++i)
+            ASSERT_EQUAL_INT(queueWrite(&buf, msg, 3), 3, "slots should be writable again");
+        ASSERT_EQUAL_INT(queueRead(&buf, out, 8), 3, "length of the new message expected");
+    } CASE_COMPLETE;
 }
 
 void test_queueWrite() {
@@ -236,6 +246,31 @@ void test_QueueFill() {
     } CASE_COMPLETE;
 }
 
+void test_queueAligned() {
+    TEST_CASE("Message slots are padded and aligned") {
+        CREATE_QUEUE_ALIGNED(queue, 40, 4, 64);
+        ASSERT_EQUAL_INT(queueStride(&queue), 64, "stride should be padded to 64");
+        ASSERT_EQUAL_INT((uintptr_t)queue.slot_buffer->raw % 64, 0, "storage should be aligned");
+        uint8_t out[40];
+        ASSERT_EQUAL_INT(queueWrite(&queue, (const uint8_t*)"first", 5), 5, "write should succeed");
+        ASSERT_EQUAL_INT(queueWrite(&queue, (const uint8_t*)"second", 6), 6, "write should succeed");
+        ASSERT_EQUAL_INT(queueRead(&queue, out, 40), 5, "read should return the length");
+        ASSERT_EQUAL_INT(queueRead(&queue, out, 40), 6, "read should return the length");
+        ASSERT_EQUAL_INT(memcmp(out, "second", 6), 0, "message should round trip");
+    } CASE_COMPLETE;
+
+#ifdef USE_BITMAP_ALLOCATOR
+    TEST_CASE("Allocated with alignment") {
+        Queue* queue = queueAllocateAligned(&testAllocator, 10, 4, 16);
+        ASSERT_NOT_NULL(queue, "Queue should not be NULL");
+        ASSERT_EQUAL_INT(queueStride(queue), 16, "stride should be padded to 16");
+        ASSERT_EQUAL_INT((uintptr_t)queue->slot_buffer->raw % 16, 0, "storage should be aligned");
+        ASSERT_EQUAL_INT(queueDeallocate(&testAllocator, &queue), QUEUE_OK, "deallocation should succeed");
+        ASSERT_NULL(queueAllocateAligned(&testAllocator, 10, 4, 3), "unsupported alignment");
+    } CASE_COMPLETE;
+#endif
+}
+
 int main() {
     LOG_INFO("QUEUE TESTS\n");
 #ifdef USE_BITMAP_ALLOCATOR
@@ -248,5 +283,6 @@ int main() {
     TEST_EVAL(test_queueWrite);
     TEST_EVAL(test_queueRead);
     TEST_EVAL(test_QueueFill);
+    TEST_EVAL(test_queueAligned);
     return testGetStatus();
 }
\ No newline at end of file
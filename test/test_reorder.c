@@ -0,0 +1,223 @@
+#include "reorder.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include "test_utils.h"
+#include <string.h>
+#include <errno.h>
+
+#ifdef USE_BITMAP_ALLOCATOR
+#define MEMORY_SIZE 2048
+uint8_t testMemory[MEMORY_SIZE];
+static BlockAllocator testAllocator;
+
+void test_reorderAllocate() {
+    TEST_CASE("Allocates and initializes reorder buffer correctly") {
+        ReorderBuffer* reorder = reorderAllocate(&testAllocator, 8, sizeof(TestStruct));
+        ASSERT_NOT_NULL(reorder, "ReorderBuffer should not be NULL");
+        ASSERT_NOT_NULL(reorder->ring.raw, "raw should not be NULL");
+        ASSERT_NOT_NULL(reorder->ring.lock, "lock should not be NULL");
+        ASSERT_EQUAL_INT(reorder->ring.size, 8, "size mismatch");
+        ASSERT_EQUAL_INT(reorder->ring.type_size, sizeof(TestStruct), "type_size mismatch");
+        ASSERT_EQUAL_INT(reorderNext(reorder), 0, "first expected sequence should be 0");
+        ASSERT_FALSE(reorderIsReady(reorder), "should not be ready on init");
+        (void)reorderDeallocate(&testAllocator, &reorder);
+    } CASE_COMPLETE;
+
+    TEST_CASE("zero dimensions") {
+        ASSERT_NULL(reorderAllocate(&testAllocator, 0, 4), "should return NULL if `size` is zero");
+        ASSERT_NULL(reorderAllocate(&testAllocator, 8, 0), "should return NULL if `type_size` is zero");
+    } CASE_COMPLETE;
+
+    TEST_CASE("invalid allocator") {
+        ASSERT_NULL(reorderAllocate(NULL, 8, 4), "should return NULL on invalid allocator");
+    } CASE_COMPLETE;
+}
+
+void test_reorderDeallocate() {
+    TEST_CASE("Deallocates and nullifies pointer") {
+        ReorderBuffer* reorder = reorderAllocate(&testAllocator, 8, 4);
+        int res = reorderDeallocate(&testAllocator, &reorder);
+        ASSERT_EQUAL_INT(res, REORDER_OK, "deallocation failed");
+        ASSERT_NULL(reorder, "pointer should be NULL after free");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Null pointer") {
+        ASSERT_EQUAL_INT(reorderDeallocate(&testAllocator, NULL), -EINVAL, "expected -EINVAL");
+    } CASE_COMPLETE;
+}
+#endif
+
+void test_reorderWrite() {
+    TEST_CASE("Out of order writes are read in sequence order") {
+        CREATE_REORDER_BUFFER(reorder, 4, sizeof(uint32_t));
+        const uint32_t order[4] = { 2, 0, 3, 1 };
+        for (int i = 0; i < 4; i++) {
+            ASSERT_TRUE(reorderWrite(&reorder, order[i], &order[i]) >= REORDER_OK, "write failed");
+        }
+        for (uint32_t expected = 0; expected < 4; expected++) {
+            uint32_t v, seq;
+            ASSERT_TRUE(reorderRead(&reorder, &v, &seq) >= REORDER_OK, "read failed");
+            ASSERT_EQUAL_INT(seq, expected, "sequence mismatch");
+            ASSERT_EQUAL_INT(v, expected, "value mismatch");
+        }
+        ASSERT_EQUAL_INT(reorderNext(&reorder), 4, "next sequence mismatch");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Sequences outside the window are rejected") {
+        CREATE_REORDER_BUFFER(reorder, 4, sizeof(uint32_t));
+        uint32_t v = 0;
+        ASSERT_EQUAL_INT(reorderWrite(&reorder, 4, &v), -ENOSPC, "seq past the window");
+        (void)reorderWrite(&reorder, 0, &v);
+        (void)reorderRead(&reorder, &v, NULL);
+        ASSERT_EQUAL_INT(reorderWrite(&reorder, 0, &v), -EINVAL, "seq already read");
+        ASSERT_TRUE(reorderWrite(&reorder, 4, &v) >= REORDER_OK, "window should have moved");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Duplicate sequence is busy") {
+        CREATE_REORDER_BUFFER(reorder, 4, sizeof(uint32_t));
+        uint32_t v = 0;
+        (void)reorderWrite(&reorder, 1, &v);
+        ASSERT_EQUAL_INT(reorderWrite(&reorder, 1, &v), -EBUSY, "slot is still pending");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Sequence numbers wrap around") {
+        CREATE_REORDER_BUFFER(reorder, 4, sizeof(uint32_t));
+        reorderClear(&reorder, UINT32_MAX - 1);
+        uint32_t seqs[4] = { 1, UINT32_MAX, 0, UINT32_MAX - 1 };
+        for (int i = 0; i < 4; i++) {
+            ASSERT_TRUE(reorderWrite(&reorder, seqs[i], &seqs[i]) >= REORDER_OK, "write failed");
+        }
+        uint32_t v[4];
+        ASSERT_EQUAL_INT(reorderReadBatch(&reorder, v, 4), 4, "batch read failed");
+        ASSERT_TRUE(v[0] == UINT32_MAX - 1 && v[1] == UINT32_MAX && v[2] == 0 && v[3] == 1, "order mismatch");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_REORDER_BUFFER(reorder, 4, sizeof(uint32_t));
+        uint32_t v = 0;
+        ASSERT_EQUAL_INT(reorderWrite(NULL, 0, &v), -EINVAL, "NULL reorder buffer");
+        ASSERT_EQUAL_INT(reorderWrite(&reorder, 0, NULL), -EINVAL, "NULL data");
+        ASSERT_EQUAL_INT(reorderWriteRelease(&reorder, 4), -EINVAL, "index out of range");
+    } CASE_COMPLETE;
+}
+
+void test_reorderRead() {
+    TEST_CASE("Gap at the next sequence blocks later ones") {
+        CREATE_REORDER_BUFFER(reorder, 4, sizeof(uint32_t));
+        uint32_t v = 1;
+        (void)reorderWrite(&reorder, 1, &v);
+        ASSERT_EQUAL_INT(reorderRead(&reorder, &v, NULL), -EAGAIN, "seq 0 is missing");
+        v = 0;
+        (void)reorderWrite(&reorder, 0, &v);
+        ASSERT_TRUE(reorderRead(&reorder, &v, NULL) >= REORDER_OK, "seq 0 should be read");
+        ASSERT_TRUE(reorderRead(&reorder, &v, NULL) >= REORDER_OK, "seq 1 should be read");
+        ASSERT_EQUAL_INT(v, 1, "value mismatch");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Batch stops at the first gap") {
+        CREATE_REORDER_BUFFER(reorder, 8, sizeof(uint32_t));
+        for (uint32_t seq = 0; seq < 6; seq++) {
+            if (seq != 3) (void)reorderWrite(&reorder, seq, &seq);
+        }
+        uint32_t v[8];
+        ASSERT_EQUAL_INT(reorderReadBatch(&reorder, v, 8), 3, "expected the ready prefix");
+        ASSERT_EQUAL_INT(reorderNext(&reorder), 3, "next sequence mismatch");
+        ASSERT_EQUAL_INT(reorderReadBatch(&reorder, v, 8), 0, "gap should block");
+        uint32_t seq = 3;
+        (void)reorderWrite(&reorder, seq, &seq);
+        ASSERT_EQUAL_INT(reorderReadBatch(&reorder, v, 2), 2, "batch limited by max_count");
+        ASSERT_TRUE(v[0] == 3 && v[1] == 4, "order mismatch");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Claimed slot is not read before release") {
+        CREATE_REORDER_BUFFER(reorder, 4, sizeof(uint32_t));
+        void* addr;
+        int index = reorderWriteClaim(&reorder, 0, &addr);
+        ASSERT_TRUE(index >= REORDER_OK, "claim failed");
+        uint32_t v;
+        ASSERT_EQUAL_INT(reorderRead(&reorder, &v, NULL), -EAGAIN, "claimed slot should not be read");
+        *(uint32_t*)addr = 42;
+        ASSERT_EQUAL_INT(reorderWriteRelease(&reorder, (uint16_t)index), REORDER_OK, "release failed");
+        ASSERT_TRUE(reorderRead(&reorder, &v, NULL) >= REORDER_OK, "read failed");
+        ASSERT_EQUAL_INT(v, 42, "value mismatch");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Slot being read is busy for the next lap") {
+        CREATE_REORDER_BUFFER(reorder, 4, sizeof(uint32_t));
+        uint32_t v = 0;
+        (void)reorderWrite(&reorder, 0, &v);
+        void* addr;
+        int index = reorderReadClaim(&reorder, &addr, NULL);
+        ASSERT_TRUE(index >= REORDER_OK, "read claim failed");
+        ASSERT_EQUAL_INT(reorderWrite(&reorder, 4, &v), -EBUSY, "slot still being read");
+        ASSERT_EQUAL_INT(reorderReadRelease(&reorder, (uint16_t)index), REORDER_OK, "release failed");
+        ASSERT_TRUE(reorderWrite(&reorder, 4, &v) >= REORDER_OK, "slot should be free");
+    } CASE_COMPLETE;
+}
+
+static int wakeCount = 0;
+static void countWake(void* ctx) {
+    (void)ctx;
+    wakeCount++;
+}
+
+void test_reorderPark() {
+    TEST_CASE("Completing the next sequence wakes the consumer") {
+        CREATE_REORDER_BUFFER(reorder, 4, sizeof(uint32_t));
+        (void)reorderSetWakeHook(&reorder, countWake, NULL);
+        wakeCount = 0;
+        ASSERT_EQUAL_INT(reorderPark(&reorder), REORDER_OK, "park failed");
+        ASSERT_EQUAL_INT(*reorderWaitFlag(&reorder), 1, "wait flag should be set");
+        uint32_t v = 1;
+        (void)reorderWrite(&reorder, 1, &v);
+        ASSERT_EQUAL_INT(wakeCount, 0, "later sequence should not wake");
+        v = 0;
+        (void)reorderWrite(&reorder, 0, &v);
+        ASSERT_EQUAL_INT(wakeCount, 1, "next sequence should wake");
+        ASSERT_EQUAL_INT(*reorderWaitFlag(&reorder), 0, "wait flag should be cleared");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Park is refused while the next sequence is ready") {
+        CREATE_REORDER_BUFFER(reorder, 4, sizeof(uint32_t));
+        uint32_t v = 0;
+        (void)reorderWrite(&reorder, 0, &v);
+        ASSERT_EQUAL_INT(reorderPark(&reorder), -EAGAIN, "should not park");
+        ASSERT_EQUAL_INT(*reorderWaitFlag(&reorder), 0, "wait flag should be withdrawn");
+    } CASE_COMPLETE;
+}
+
+void test_reorderClear() {
+    TEST_CASE("Discards pending elements and moves the window") {
+        CREATE_REORDER_BUFFER(reorder, 4, sizeof(uint32_t));
+        uint32_t v = 0;
+        (void)reorderWrite(&reorder, 0, &v);
+        (void)reorderWrite(&reorder, 2, &v);
+        void* addr;
+        int index = reorderWriteClaim(&reorder, 1, &addr);
+        reorderClear(&reorder, 10);
+        ASSERT_EQUAL_INT(reorderNext(&reorder), 10, "next sequence mismatch");
+        ASSERT_FALSE(reorderIsReady(&reorder), "old elements should be discarded");
+        ASSERT_EQUAL_INT(reorderWriteRelease(&reorder, (uint16_t)index), -ESTALE, "claim predates the clear");
+        for (uint32_t seq = 10; seq < 14; seq++) {
+            ASSERT_TRUE(reorderWrite(&reorder, seq, &seq) >= REORDER_OK, "every slot should be free");
+        }
+        uint32_t out[4];
+        ASSERT_EQUAL_INT(reorderReadBatch(&reorder, out, 4), 4, "batch read failed");
+        ASSERT_EQUAL_INT(out[0], 10, "value mismatch");
+    } CASE_COMPLETE;
+}
+
+int main() {
+    LOG_INFO("REORDER TESTS\n");
+#ifdef USE_BITMAP_ALLOCATOR
+    initBlockAllocator(&testAllocator, 4, testMemory, MEMORY_SIZE);
+    TEST_EVAL(test_reorderAllocate);
+    TEST_EVAL(test_reorderDeallocate);
+#endif
+    TEST_EVAL(test_reorderWrite);
+    TEST_EVAL(test_reorderRead);
+    TEST_EVAL(test_reorderPark);
+    TEST_EVAL(test_reorderClear);
+    return testGetStatus();
+}
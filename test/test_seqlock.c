@@ -0,0 +1,148 @@
+#include "seqlock.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include "test_utils.h"
+#include <string.h>
+#include <errno.h>
+
+#ifdef USE_BITMAP_ALLOCATOR
+#define MEMORY_SIZE 2048
+uint8_t testMemory[MEMORY_SIZE];
+static BlockAllocator testAllocator;
+
+void test_seqLockAllocate() {
+    TEST_CASE("Allocates and initializes seqlock correctly") {
+        SeqLock* lock = seqLockAllocate(&testAllocator, sizeof(TestStruct));
+        ASSERT_NOT_NULL(lock, "SeqLock should not be NULL");
+        ASSERT_NOT_NULL(lock->raw, "raw pointer should not be NULL");
+        ASSERT_EQUAL_INT(lock->type_size, sizeof(TestStruct), "type size mismatch");
+        ASSERT_EQUAL_INT(lock->seq, 0, "sequence should be 0 on init");
+        (void)seqLockDeallocate(&testAllocator, &lock);
+    } CASE_COMPLETE;
+
+    TEST_CASE("zero size") {
+        SeqLock* lock = seqLockAllocate(&testAllocator, 0);
+        ASSERT_NULL(lock, "SeqLock should be NULL");
+    } CASE_COMPLETE;
+
+    TEST_CASE("invalid allocator") {
+        SeqLock* lock = seqLockAllocate(NULL, 4);
+        ASSERT_NULL(lock, "should return NULL on invalid allocator");
+    } CASE_COMPLETE;
+}
+
+void test_seqLockDeallocate() {
+    TEST_CASE("Deallocates and nullifies pointer") {
+        SeqLock* lock = seqLockAllocate(&testAllocator, 4);
+        int res = seqLockDeallocate(&testAllocator, &lock);
+        ASSERT_EQUAL_INT(res, SEQLOCK_OK, "deallocation failed");
+        ASSERT_NULL(lock, "pointer should be NULL after free");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Null pointer") {
+        SeqLock* lock = NULL;
+        int res = seqLockDeallocate(&testAllocator, &lock);
+        ASSERT_EQUAL_INT(res, -EINVAL, "Deallocating NULL seqlock should fail");
+    } CASE_COMPLETE;
+}
+#endif
+
+void test_seqLockCreateMacro() {
+    TEST_CASE("Creates seqlock correctly") {
+        CREATE_SEQLOCK(lock, sizeof(uint32_t));
+        ASSERT_NOT_NULL(lock.raw, "raw pointer should not be NULL");
+        ASSERT_EQUAL_INT(lock.type_size, sizeof(uint32_t), "type size mismatch");
+        ASSERT_EQUAL_INT(lock.seq, 0, "sequence should be 0 on init");
+    } CASE_COMPLETE;
+}
+
+void test_seqLockWrite() {
+    TEST_CASE("Writes value") {
+        CREATE_SEQLOCK(lock, sizeof(TestStruct));
+        uint32_t data = 68;
+        TestStruct input = {.flag = true, .data = data, .ptr = &data};
+        int res = seqLockWrite(&lock, &input);
+        ASSERT_EQUAL_INT(res, SEQLOCK_OK, "write failed");
+        ASSERT_EQUAL_INT(lock.seq, 2, "sequence should advance by two per write");
+        TestStruct stored = *(TestStruct*)lock.raw;
+        ASSERT_EQUAL_INT(stored.data, data, "data mismatch");
+        ASSERT_EQUAL_PTR(stored.ptr, &data, "pointer mismatch");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Rejects concurrent writer") {
+        CREATE_SEQLOCK(lock, sizeof(uint32_t));
+        void* value;
+        (void)seqLockWriteClaim(&lock, &value);
+        uint32_t v = 1;
+        ASSERT_EQUAL_INT(seqLockWrite(&lock, &v), -EBUSY, "second writer should be rejected");
+        ASSERT_EQUAL_INT(seqLockWriteRelease(&lock), SEQLOCK_OK, "release failed");
+        ASSERT_EQUAL_INT(seqLockWriteRelease(&lock), -EPERM, "double release should fail");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_SEQLOCK(lock, sizeof(uint32_t));
+        uint32_t v = 1;
+        ASSERT_EQUAL_INT(seqLockWrite(NULL, &v), -EINVAL, "NULL seqlock");
+        ASSERT_EQUAL_INT(seqLockWrite(&lock, NULL), -EINVAL, "NULL data");
+    } CASE_COMPLETE;
+}
+
+void test_seqLockRead() {
+    TEST_CASE("Reads snapshot") {
+        CREATE_SEQLOCK(lock, sizeof(uint32_t));
+        uint32_t v = 0x1234;
+        (void)seqLockWrite(&lock, &v);
+        uint32_t out = 0;
+        int res = seqLockRead(&lock, &out);
+        ASSERT_EQUAL_INT(res, SEQLOCK_OK, "read failed");
+        ASSERT_EQUAL_INT(out, v, "data mismatch");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Read during write") {
+        CREATE_SEQLOCK(lock, sizeof(uint32_t));
+        void* value;
+        (void)seqLockWriteClaim(&lock, &value);
+        uint32_t out = 0xAAAA;
+        int res = seqLockRead(&lock, &out);
+        ASSERT_EQUAL_INT(res, -EBUSY, "read during write should fail");
+        (void)seqLockWriteRelease(&lock);
+        res = seqLockRead(&lock, &out);
+        ASSERT_EQUAL_INT(res, SEQLOCK_OK, "read after write should succeed");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Zero-copy read detects overlapping write") {
+        CREATE_SEQLOCK(lock, sizeof(uint32_t));
+        uint32_t v = 1;
+        (void)seqLockWrite(&lock, &v);
+        const void* value;
+        uint32_t seq;
+        int res = seqLockReadClaim(&lock, &value, &seq);
+        ASSERT_EQUAL_INT(res, SEQLOCK_OK, "read claim failed");
+        ASSERT_EQUAL_INT(*(const uint32_t*)value, 1, "data mismatch");
+        ASSERT_EQUAL_INT(seqLockReadRelease(&lock, seq), SEQLOCK_OK, "stable read should validate");
+        v = 2;
+        (void)seqLockWrite(&lock, &v);
+        ASSERT_EQUAL_INT(seqLockReadRelease(&lock, seq), -ESTALE, "overlapping write should invalidate");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_SEQLOCK(lock, sizeof(uint32_t));
+        uint32_t v;
+        ASSERT_EQUAL_INT(seqLockRead(NULL, &v), -EINVAL, "NULL seqlock");
+        ASSERT_EQUAL_INT(seqLockRead(&lock, NULL), -EINVAL, "NULL data");
+    } CASE_COMPLETE;
+}
+
+int main() {
+    LOG_INFO("SEQLOCK TESTS\n");
+#ifdef USE_BITMAP_ALLOCATOR
+    initBlockAllocator(&testAllocator, 4, testMemory, MEMORY_SIZE);
+    TEST_EVAL(test_seqLockAllocate);
+    TEST_EVAL(test_seqLockDeallocate);
+#endif
+    TEST_EVAL(test_seqLockCreateMacro);
+    TEST_EVAL(test_seqLockWrite);
+    TEST_EVAL(test_seqLockRead);
+    return testGetStatus();
+}
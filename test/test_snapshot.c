@@ -0,0 +1,265 @@
+#include "snapshot.h"
+#include "test_utils.h"
+#include <string.h>
+#include <errno.h>
+
+/**
+ * @brief In-memory snapshot sink and source moving at most `chunk` bytes per call.
+ */
+typedef struct {
+    uint8_t data[512];
+    uint32_t len;
+    uint32_t pos;
+    uint32_t chunk;
+} MemFile;
+
+static int32_t memWrite(void* ctx, const void* data, uint32_t len) {
+    MemFile* file = (MemFile*)ctx;
+    if (len > file->chunk) len = file->chunk;
+    if (len > sizeof(file->data) - file->len) return -ENOSPC;
+    memcpy(file->data + file->len, data, len);
+    file->len += len;
+    return (int32_t)len;
+}
+
+static int32_t memRead(void* ctx, void* data, uint32_t len) {
+    MemFile* file = (MemFile*)ctx;
+    if (len > file->chunk) len = file->chunk;
+    if (len > file->len - file->pos) len = file->len - file->pos;
+    memcpy(data, file->data + file->pos, len);
+    file->pos += len;
+    return (int32_t)len;
+}
+
+void test_bufferSnapshot() {
+    TEST_CASE("Round trip of a wrapped buffer") {
+        CREATE_BUFFER(src, 6, sizeof(uint32_t));
+        CREATE_BUFFER(dst, 8, sizeof(uint32_t));
+        MemFile file = { .chunk = 5 };
+        uint32_t v;
+        for (v = 0; v < 6; v++) (void)bufferWrite(&src, &v);
+        for (int i = 0; i < 3; i++) (void)bufferRead(&src, &v);
+        for (v = 6; v < 9; v++) (void)bufferWrite(&src, &v);
+        int res = bufferSnapshot(&src, memWrite, &file);
+        ASSERT_EQUAL_INT(res, 6, "expected six elements in the snapshot");
+        ASSERT_EQUAL_INT(file.len, sizeof(SnapshotHeader) + 6 * sizeof(uint32_t), "snapshot size mismatch");
+        ASSERT_TRUE(bufferIsFull(&src), "snapshot should not consume the source");
+        res = bufferRestore(&dst, memRead, &file);
+        ASSERT_EQUAL_INT(res, 6, "expected six elements restored");
+        for (uint32_t expected = 3; expected < 9; expected++) {
+            ASSERT_TRUE(bufferRead(&dst, &v) >= BUFFER_OK, "read failed");
+            ASSERT_EQUAL_INT(v, expected, "element order mismatch");
+        }
+        ASSERT_TRUE(bufferIsEmpty(&dst), "no extra elements expected");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Restore into a buffer of the same capacity") {
+        CREATE_BUFFER(src, 4, sizeof(uint8_t));
+        CREATE_BUFFER(dst, 4, sizeof(uint8_t));
+        MemFile file = { .chunk = 64 };
+        for (uint8_t i = 0; i < 4; i++) (void)bufferWrite(&src, &i);
+        (void)bufferSnapshot(&src, memWrite, &file);
+        ASSERT_EQUAL_INT(bufferRestore(&dst, memRead, &file), 4, "expected four elements restored");
+        ASSERT_TRUE(bufferIsFull(&dst), "restored buffer should be full");
+        uint8_t v = 9;
+        ASSERT_EQUAL_INT(bufferWrite(&dst, &v), -ENOSPC, "no space expected");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Restore into a buffer with checksums") {
+        CREATE_BUFFER(src, 4, sizeof(uint32_t));
+        CREATE_BUFFER(dst, 4, sizeof(uint32_t));
+        uint32_t crc[4];
+        ASSERT_EQUAL_INT(bufferSetChecksums(&dst, crc), BUFFER_OK, "enable checksums");
+        MemFile file = { .chunk = 64 };
+        uint32_t v;
+        for (v = 0; v < 3; v++) (void)bufferWrite(&src, &v);
+        (void)bufferSnapshot(&src, memWrite, &file);
+        ASSERT_EQUAL_INT(bufferRestore(&dst, memRead, &file), 3, "expected three elements restored");
+        for (uint32_t expected = 0; expected < 3; expected++) {
+            ASSERT_TRUE(bufferRead(&dst, &v) >= BUFFER_OK, "restored element should verify");
+            ASSERT_EQUAL_INT(v, expected, "element mismatch");
+        }
+    } CASE_COMPLETE;
+
+    TEST_CASE("Claimed element") {
+        CREATE_BUFFER(src, 4, sizeof(uint8_t));
+        MemFile file = { .chunk = 64 };
+        void* addr;
+        (void)bufferWriteClaim(&src, &addr);
+        ASSERT_EQUAL_INT(bufferSnapshot(&src, memWrite, &file), -EBUSY, "unpublished element should block");
+        ASSERT_EQUAL_INT(file.len, 0, "nothing should be written");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_BUFFER(buf, 4, sizeof(uint8_t));
+        MemFile file = { .chunk = 64 };
+        ASSERT_EQUAL_INT(bufferSnapshot(NULL, memWrite, &file), -EINVAL, "NULL buffer");
+        ASSERT_EQUAL_INT(bufferSnapshot(&buf, NULL, &file), -EINVAL, "NULL callback");
+        ASSERT_EQUAL_INT(bufferRestore(NULL, memRead, &file), -EINVAL, "NULL buffer");
+        ASSERT_EQUAL_INT(bufferRestore(&buf, NULL, &file), -EINVAL, "NULL callback");
+    } CASE_COMPLETE;
+}
+
+void test_bufferRestore() {
+    CREATE_BUFFER(src, 4, sizeof(uint16_t));
+    uint16_t v = 7;
+    (void)bufferWrite(&src, &v);
+    (void)bufferWrite(&src, &v);
+
+    TEST_CASE("Target not empty") {
+        CREATE_BUFFER(dst, 4, sizeof(uint16_t));
+        MemFile file = { .chunk = 64 };
+        (void)bufferSnapshot(&src, memWrite, &file);
+        (void)bufferWrite(&dst, &v);
+        ASSERT_EQUAL_INT(bufferRestore(&dst, memRead, &file), -EBUSY, "non-empty target should be rejected");
+        ASSERT_EQUAL_INT(file.pos, 0, "nothing should be read");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Element size mismatch") {
+        CREATE_BUFFER(dst, 4, sizeof(uint32_t));
+        MemFile file = { .chunk = 64 };
+        (void)bufferSnapshot(&src, memWrite, &file);
+        ASSERT_EQUAL_INT(bufferRestore(&dst, memRead, &file), -EINVAL, "size mismatch expected");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Insufficient capacity") {
+        CREATE_BUFFER(dst, 1, sizeof(uint16_t));
+        MemFile file = { .chunk = 64 };
+        (void)bufferSnapshot(&src, memWrite, &file);
+        ASSERT_EQUAL_INT(bufferRestore(&dst, memRead, &file), -ENOSPC, "capacity error expected");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Bad magic") {
+        CREATE_BUFFER(dst, 4, sizeof(uint16_t));
+        MemFile file = { .chunk = 64 };
+        (void)bufferSnapshot(&src, memWrite, &file);
+        file.data[0] ^= 0xFF;
+        ASSERT_EQUAL_INT(bufferRestore(&dst, memRead, &file), -EBADMSG, "malformed snapshot expected");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Truncated payload") {
+        CREATE_BUFFER(dst, 4, sizeof(uint16_t));
+        MemFile file = { .chunk = 64 };
+        (void)bufferSnapshot(&src, memWrite, &file);
+        file.len -= 1;
+        ASSERT_EQUAL_INT(bufferRestore(&dst, memRead, &file), -EBADMSG, "truncated snapshot expected");
+        ASSERT_TRUE(bufferIsEmpty(&dst), "target should stay empty");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Kind mismatch") {
+        CREATE_STACK(dst, 4, sizeof(uint16_t));
+        MemFile file = { .chunk = 64 };
+        (void)bufferSnapshot(&src, memWrite, &file);
+        ASSERT_EQUAL_INT(stackRestore(&dst, memRead, &file), -EINVAL, "kind mismatch expected");
+    } CASE_COMPLETE;
+}
+
+void test_queueSnapshot() {
+    TEST_CASE("Round trip keeps message lengths") {
+        CREATE_QUEUE(src, 8, 4);
+        CREATE_QUEUE(dst, 8, 4);
+        MemFile file = { .chunk = 7 };
+        uint8_t out[8];
+        (void)queueWrite(&src, (const uint8_t*)"ab", 2);
+        (void)queueWrite(&src, (const uint8_t*)"abc", 3);
+        (void)queueRead(&src, out, 8);
+        (void)queueWrite(&src, (const uint8_t*)"hello", 5);
+        (void)queueWrite(&src, (const uint8_t*)"x", 1);
+        (void)queueWrite(&src, (const uint8_t*)"wrapped", 7);
+        ASSERT_EQUAL_INT(queueSnapshot(&src, memWrite, &file), 4, "expected four messages");
+        ASSERT_EQUAL_INT(queueRestore(&dst, memRead, &file), 4, "expected four messages restored");
+        ASSERT_EQUAL_INT(queueRead(&dst, out, 8), 3, "length mismatch");
+        ASSERT_EQUAL_STR((char*)out, "abc", 3, "message mismatch");
+        ASSERT_EQUAL_INT(queueRead(&dst, out, 8), 5, "length mismatch");
+        ASSERT_EQUAL_STR((char*)out, "hello", 5, "message mismatch");
+        ASSERT_EQUAL_INT(queueRead(&dst, out, 8), 1, "length mismatch");
+        ASSERT_EQUAL_INT(queueRead(&dst, out, 8), 7, "length mismatch");
+        ASSERT_EQUAL_STR((char*)out, "wrapped", 7, "message mismatch");
+        ASSERT_TRUE(queueIsEmpty(&dst), "no extra messages expected");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Slot length mismatch") {
+        CREATE_QUEUE(src, 8, 4);
+        CREATE_QUEUE(dst, 4, 4);
+        MemFile file = { .chunk = 64 };
+        (void)queueWrite(&src, (const uint8_t*)"ab", 2);
+        (void)queueSnapshot(&src, memWrite, &file);
+        ASSERT_EQUAL_INT(queueRestore(&dst, memRead, &file), -EINVAL, "size mismatch expected");
+    } CASE_COMPLETE;
+}
+
+void test_stackSnapshot() {
+    TEST_CASE("Round trip keeps order") {
+        CREATE_STACK(src, 4, sizeof(TestStruct));
+        CREATE_STACK(dst, 4, sizeof(TestStruct));
+        MemFile file = { .chunk = 9 };
+        for (int i = 0; i < 3; i++) {
+            TestStruct in = { .flag = true, .data = i, .ptr = NULL };
+            (void)stackPush(&src, &in);
+        }
+        ASSERT_EQUAL_INT(stackSnapshot(&src, memWrite, &file), 3, "expected three elements");
+        ASSERT_EQUAL_INT(stackRestore(&dst, memRead, &file), 3, "expected three elements restored");
+        for (int i = 2; i >= 0; i--) {
+            TestStruct out;
+            ASSERT_TRUE(stackPop(&dst, &out) >= STACK_OK, "pop failed");
+            ASSERT_EQUAL_INT(out.data, i, "element order mismatch");
+        }
+    } CASE_COMPLETE;
+
+    TEST_CASE("Empty stack") {
+        CREATE_STACK(src, 4, sizeof(uint8_t));
+        CREATE_STACK(dst, 4, sizeof(uint8_t));
+        MemFile file = { .chunk = 64 };
+        ASSERT_EQUAL_INT(stackSnapshot(&src, memWrite, &file), 0, "expected no elements");
+        ASSERT_EQUAL_INT(file.len, sizeof(SnapshotHeader), "only the header expected");
+        ASSERT_EQUAL_INT(stackRestore(&dst, memRead, &file), 0, "expected no elements restored");
+    } CASE_COMPLETE;
+}
+
+void test_alignedSnapshot() {
+    TEST_CASE("Padded slots are not written") {
+        CREATE_BUFFER_ALIGNED(src, 4, 6, 16);
+        CREATE_BUFFER(dst, 4, 6);
+        MemFile file = { .chunk = 5 };
+        uint8_t skip[6];
+        (void)bufferWrite(&src, skip);
+        (void)bufferWrite(&src, skip);
+        (void)bufferRead(&src, skip);
+        (void)bufferRead(&src, skip);
+        for (uint8_t i = 2; i < 6; i++) {
+            uint8_t in[6] = { i, i, i, i, i, i };
+            (void)bufferWrite(&src, in);
+        }
+        ASSERT_EQUAL_INT(bufferSnapshot(&src, memWrite, &file), 4, "expected four elements");
+        ASSERT_EQUAL_INT(file.len, sizeof(SnapshotHeader) + 4 * 6, "only element bytes expected");
+        ASSERT_EQUAL_INT(bufferRestore(&dst, memRead, &file), 4, "packed buffer should restore it");
+        for (uint8_t i = 2; i < 6; i++) {
+            uint8_t out[6];
+            (void)bufferRead(&dst, out);
+            ASSERT_EQUAL_INT(out[5], i, "element order mismatch");
+        }
+    } CASE_COMPLETE;
+
+    TEST_CASE("Stack restores into padded slots") {
+        CREATE_STACK(src, 4, 3);
+        CREATE_STACK_ALIGNED(dst, 4, 3, 8);
+        MemFile file = { .chunk = 64 };
+        for (uint8_t i = 0; i < 3; i++) {
+            uint8_t in[3] = { i, i, i };
+            (void)stackPush(&src, in);
+        }
+        ASSERT_EQUAL_INT(stackSnapshot(&src, memWrite, &file), 3, "expected three elements");
+        ASSERT_EQUAL_INT(stackRestore(&dst, memRead, &file), 3, "expected three elements restored");
+        ASSERT_EQUAL_INT(((uint8_t*)dst.raw)[2 * 8 + 2], 2, "third element should sit at twice the stride");
+    } CASE_COMPLETE;
+}
+
+int main() {
+    LOG_INFO("SNAPSHOT TESTS\n");
+    TEST_EVAL(test_bufferSnapshot);
+    TEST_EVAL(test_bufferRestore);
+    TEST_EVAL(test_queueSnapshot);
+    TEST_EVAL(test_stackSnapshot);
+    TEST_EVAL(test_alignedSnapshot);
+    return testGetStatus();
+}
@@ -210,6 +210,33 @@ void test_stackFilled() {
     
 }
 
+void test_stackAligned() {
+    TEST_CASE("Slots are padded and aligned") {
+        CREATE_STACK_ALIGNED(stack, 4, 12, 16);
+        ASSERT_EQUAL_INT(stackStride(&stack), 16, "stride should be padded to 16");
+        ASSERT_EQUAL_INT((uintptr_t)stack.raw % 16, 0, "storage should be aligned");
+        uint8_t in[12], out[12];
+        for (int i = 0; i < 3; i++) {
+            memset(in, i + 1, sizeof(in));
+            ASSERT_EQUAL_INT(stackPush(&stack, in), i, "push should succeed");
+        }
+        ASSERT_EQUAL_INT(((uint8_t*)stack.raw)[2 * 16], 3, "third slot should start at twice the stride");
+        ASSERT_EQUAL_INT(stackPop(&stack, out), 2, "pop should succeed");
+        ASSERT_EQUAL_INT(memcmp(in, out, sizeof(in)), 0, "element should round trip");
+    } CASE_COMPLETE;
+
+#ifdef USE_BITMAP_ALLOCATOR
+    TEST_CASE("Allocated with alignment") {
+        Stack* stack = stackAllocateAligned(&testAllocator, 4, 6, 8);
+        ASSERT_NOT_NULL(stack, "Stack should not be NULL");
+        ASSERT_EQUAL_INT(stackStride(stack), 8, "stride should be padded to 8");
+        ASSERT_EQUAL_INT((uintptr_t)stack->raw % 8, 0, "storage should be aligned");
+        ASSERT_EQUAL_INT(stackDeallocate(&testAllocator, &stack), STACK_OK, "deallocation should succeed");
+        ASSERT_NULL(stackAllocateAligned(&testAllocator, 4, 6, 128), "unsupported alignment");
+    } CASE_COMPLETE;
+#endif
+}
+
 int main() {
     LOG_INFO("STACK TESTS\n");
 #ifdef USE_BITMAP_ALLOCATOR
@@ -222,5 +249,6 @@ int main() {
     TEST_EVAL(test_stackPush);
     TEST_EVAL(test_stackPop);
     TEST_EVAL(test_stackFilled);
+    TEST_EVAL(test_stackAligned);
     return testGetStatus();
 }
@@ -0,0 +1,176 @@
+#include "steal_deque.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include "test_utils.h"
+#include <string.h>
+#include <errno.h>
+
+#ifdef USE_BITMAP_ALLOCATOR
+#define MEMORY_SIZE 2048
+uint8_t testMemory[MEMORY_SIZE];
+static BlockAllocator testAllocator;
+
+void test_stealDequeAllocate() {
+    TEST_CASE("Allocates and initializes deque correctly") {
+        StealDeque* deque = stealDequeAllocate(&testAllocator, 8, sizeof(TestStruct));
+        ASSERT_NOT_NULL(deque, "StealDeque should not be NULL");
+        ASSERT_NOT_NULL(deque->raw, "raw pointer should not be NULL");
+        ASSERT_EQUAL_INT(deque->size, 8, "size mismatch");
+        ASSERT_EQUAL_INT(deque->type_size, sizeof(TestStruct), "type size mismatch");
+        ASSERT_EQUAL_INT(deque->top, 0, "top should be 0 on init");
+        ASSERT_EQUAL_INT(deque->bottom, 0, "bottom should be 0 on init");
+        (void)stealDequeDeallocate(&testAllocator, &deque);
+    } CASE_COMPLETE;
+
+    TEST_CASE("zero size") {
+        StealDeque* deque = stealDequeAllocate(&testAllocator, 0, 4);
+        ASSERT_NULL(deque, "StealDeque should be NULL");
+    } CASE_COMPLETE;
+
+    TEST_CASE("size not a power of two") {
+        StealDeque* deque = stealDequeAllocate(&testAllocator, 6, 4);
+        ASSERT_NULL(deque, "StealDeque should be NULL");
+    } CASE_COMPLETE;
+
+    TEST_CASE("invalid allocator") {
+        StealDeque* deque = stealDequeAllocate(NULL, 8, 4);
+        ASSERT_NULL(deque, "should return NULL on invalid allocator");
+    } CASE_COMPLETE;
+}
+
+void test_stealDequeDeallocate() {
+    TEST_CASE("Deallocates and nullifies pointer") {
+        StealDeque* deque = stealDequeAllocate(&testAllocator, 8, 4);
+        int res = stealDequeDeallocate(&testAllocator, &deque);
+        ASSERT_EQUAL_INT(res, STEAL_DEQUE_OK, "deallocation failed");
+        ASSERT_NULL(deque, "pointer should be NULL after free");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Null pointer") {
+        StealDeque* deque = NULL;
+        int res = stealDequeDeallocate(&testAllocator, &deque);
+        ASSERT_EQUAL_INT(res, -EINVAL, "Deallocating NULL deque should fail");
+    } CASE_COMPLETE;
+}
+#endif
+
+void test_stealDequeCreateMacro() {
+    TEST_CASE("Creates deque correctly") {
+        CREATE_STEAL_DEQUE(deque, 16, sizeof(uint32_t));
+        ASSERT_NOT_NULL(deque.raw, "raw pointer should not be NULL");
+        ASSERT_EQUAL_INT(deque.size, 16, "size mismatch");
+        ASSERT_EQUAL_INT(deque.type_size, sizeof(uint32_t), "type size mismatch");
+        ASSERT_EQUAL_INT(stealDequeCount(&deque), 0, "deque should be empty");
+    } CASE_COMPLETE;
+}
+
+void test_stealDequePushPop() {
+    TEST_CASE("Owner sees LIFO order") {
+        CREATE_STEAL_DEQUE(deque, 4, sizeof(uint32_t));
+        for (uint32_t v = 1; v <= 3; v++) {
+            ASSERT_EQUAL_INT(stealDequePush(&deque, &v), STEAL_DEQUE_OK, "push failed");
+        }
+        for (uint32_t v = 3; v >= 1; v--) {
+            uint32_t out = 0;
+            ASSERT_EQUAL_INT(stealDequePop(&deque, &out), STEAL_DEQUE_OK, "pop failed");
+            ASSERT_EQUAL_INT(out, v, "data mismatch");
+        }
+        uint32_t out;
+        ASSERT_EQUAL_INT(stealDequePop(&deque, &out), -EAGAIN, "pop on empty deque should fail");
+        ASSERT_EQUAL_INT(stealDequeCount(&deque), 0, "empty pop should leave deque empty");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Push to full deque") {
+        CREATE_STEAL_DEQUE(deque, 2, sizeof(uint32_t));
+        uint32_t v = 1;
+        (void)stealDequePush(&deque, &v);
+        (void)stealDequePush(&deque, &v);
+        ASSERT_EQUAL_INT(stealDequePush(&deque, &v), -ENOSPC, "push to full deque should fail");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Wraps around the backing storage") {
+        CREATE_STEAL_DEQUE(deque, 2, sizeof(TestStruct));
+        for (uint32_t v = 0; v < 10; v++) {
+            TestStruct in = {.flag = v & 1, .data = v, .ptr = NULL};
+            ASSERT_EQUAL_INT(stealDequePush(&deque, &in), STEAL_DEQUE_OK, "push failed");
+            TestStruct out;
+            ASSERT_EQUAL_INT(stealDequeSteal(&deque, &out), STEAL_DEQUE_OK, "steal failed");
+            ASSERT_EQUAL_INT(out.data, v, "data mismatch");
+        }
+    } CASE_COMPLETE;
+
+    TEST_CASE("Clear") {
+        CREATE_STEAL_DEQUE(deque, 4, sizeof(uint32_t));
+        uint32_t v = 1;
+        (void)stealDequePush(&deque, &v);
+        (void)stealDequePush(&deque, &v);
+        stealDequeClear(&deque);
+        ASSERT_EQUAL_INT(stealDequeCount(&deque), 0, "deque should be empty after clear");
+        ASSERT_EQUAL_INT(stealDequeSteal(&deque, &v), -EAGAIN, "steal after clear should fail");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_STEAL_DEQUE(deque, 4, sizeof(uint32_t));
+        uint32_t v = 1;
+        ASSERT_EQUAL_INT(stealDequePush(NULL, &v), -EINVAL, "NULL deque");
+        ASSERT_EQUAL_INT(stealDequePush(&deque, NULL), -EINVAL, "NULL data");
+        ASSERT_EQUAL_INT(stealDequePop(NULL, &v), -EINVAL, "NULL deque");
+        ASSERT_EQUAL_INT(stealDequePop(&deque, NULL), -EINVAL, "NULL data");
+    } CASE_COMPLETE;
+}
+
+void test_stealDequeSteal() {
+    TEST_CASE("Thieves see FIFO order") {
+        CREATE_STEAL_DEQUE(deque, 4, sizeof(uint32_t));
+        for (uint32_t v = 1; v <= 3; v++) {
+            (void)stealDequePush(&deque, &v);
+        }
+        uint32_t out = 0;
+        ASSERT_EQUAL_INT(stealDequeSteal(&deque, &out), STEAL_DEQUE_OK, "steal failed");
+        ASSERT_EQUAL_INT(out, 1, "thief should take the oldest element");
+        ASSERT_EQUAL_INT(stealDequePop(&deque, &out), STEAL_DEQUE_OK, "pop failed");
+        ASSERT_EQUAL_INT(out, 3, "owner should take the newest element");
+        ASSERT_EQUAL_INT(stealDequeSteal(&deque, &out), STEAL_DEQUE_OK, "steal failed");
+        ASSERT_EQUAL_INT(out, 2, "data mismatch");
+        ASSERT_EQUAL_INT(stealDequeSteal(&deque, &out), -EAGAIN, "steal on empty deque should fail");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Batch steal takes half") {
+        CREATE_STEAL_DEQUE(deque, 8, sizeof(uint32_t));
+        for (uint32_t v = 0; v < 6; v++) {
+            (void)stealDequePush(&deque, &v);
+        }
+        uint32_t out[8] = {0};
+        int res = stealDequeStealBatch(&deque, out, 8);
+        ASSERT_EQUAL_INT(res, 3, "should steal half of the elements");
+        for (uint32_t i = 0; i < 3; i++) {
+            ASSERT_EQUAL_INT(out[i], i, "data mismatch");
+        }
+        ASSERT_EQUAL_INT(stealDequeCount(&deque), 3, "owner should keep the rest");
+        res = stealDequeStealBatch(&deque, out, 1);
+        ASSERT_EQUAL_INT(res, 1, "should respect max_count");
+        ASSERT_EQUAL_INT(out[0], 3, "data mismatch");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Batch steal on empty deque") {
+        CREATE_STEAL_DEQUE(deque, 8, sizeof(uint32_t));
+        uint32_t out[2];
+        ASSERT_EQUAL_INT(stealDequeStealBatch(&deque, out, 2), -EAGAIN, "empty deque");
+        ASSERT_EQUAL_INT(stealDequeStealBatch(&deque, out, 0), -EINVAL, "zero max_count");
+        ASSERT_EQUAL_INT(stealDequeSteal(NULL, out), -EINVAL, "NULL deque");
+    } CASE_COMPLETE;
+}
+
+int main() {
+    LOG_INFO("STEAL DEQUE TESTS\n");
+#ifdef USE_BITMAP_ALLOCATOR
+    initBlockAllocator(&testAllocator, 4, testMemory, MEMORY_SIZE);
+    TEST_EVAL(test_stealDequeAllocate);
+    TEST_EVAL(test_stealDequeDeallocate);
+#endif
+    TEST_EVAL(test_stealDequeCreateMacro);
+    TEST_EVAL(test_stealDequePushPop);
+    TEST_EVAL(test_stealDequeSteal);
+    return testGetStatus();
+}
@@ -0,0 +1,152 @@
+#include "triple.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include "test_utils.h"
+#include <string.h>
+#include <errno.h>
+
+#ifdef USE_BITMAP_ALLOCATOR
+#define MEMORY_SIZE 2048
+uint8_t testMemory[MEMORY_SIZE];
+static BlockAllocator testAllocator;
+
+void test_tripleBufferAllocate() {
+    TEST_CASE("Allocates and initializes triple buffer correctly") {
+        TripleBuffer* triple = tripleBufferAllocate(&testAllocator, sizeof(TestStruct));
+        ASSERT_NOT_NULL(triple, "TripleBuffer should not be NULL");
+        ASSERT_NOT_NULL(triple->raw, "raw pointer should not be NULL");
+        ASSERT_EQUAL_INT(triple->type_size, sizeof(TestStruct), "type size mismatch");
+        ASSERT_EQUAL_INT(triple->front, 0, "front should be 0 on init");
+        ASSERT_EQUAL_INT(triple->back, 2, "back should be 2 on init");
+        (void)tripleBufferDeallocate(&testAllocator, &triple);
+    } CASE_COMPLETE;
+
+    TEST_CASE("zero size") {
+        TripleBuffer* triple = tripleBufferAllocate(&testAllocator, 0);
+        ASSERT_NULL(triple, "TripleBuffer should be NULL");
+    } CASE_COMPLETE;
+
+    TEST_CASE("invalid allocator") {
+        TripleBuffer* triple = tripleBufferAllocate(NULL, 4);
+        ASSERT_NULL(triple, "should return NULL on invalid allocator");
+    } CASE_COMPLETE;
+}
+
+void test_tripleBufferDeallocate() {
+    TEST_CASE("Deallocates and nullifies pointer") {
+        TripleBuffer* triple = tripleBufferAllocate(&testAllocator, 4);
+        int res = tripleBufferDeallocate(&testAllocator, &triple);
+        ASSERT_EQUAL_INT(res, TRIPLE_OK, "deallocation failed");
+        ASSERT_NULL(triple, "pointer should be NULL after free");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Null pointer") {
+        TripleBuffer* triple = NULL;
+        int res = tripleBufferDeallocate(&testAllocator, &triple);
+        ASSERT_EQUAL_INT(res, -EINVAL, "Deallocating NULL triple buffer should fail");
+    } CASE_COMPLETE;
+}
+#endif
+
+void test_tripleBufferCreateMacro() {
+    TEST_CASE("Creates triple buffer correctly") {
+        CREATE_TRIPLE_BUFFER(triple, sizeof(uint32_t));
+        ASSERT_NOT_NULL(triple.raw, "raw pointer should not be NULL");
+        ASSERT_EQUAL_INT(triple.type_size, sizeof(uint32_t), "type size mismatch");
+        ASSERT_EQUAL_INT(triple.front, 0, "front should be 0 on init");
+        ASSERT_EQUAL_INT(triple.back, 2, "back should be 2 on init");
+    } CASE_COMPLETE;
+}
+
+void test_tripleBufferRead() {
+    TEST_CASE("Nothing published") {
+        CREATE_TRIPLE_BUFFER(triple, sizeof(uint32_t));
+        uint32_t out = 0xAAAA;
+        int res = tripleBufferRead(&triple, &out);
+        ASSERT_EQUAL_INT(res, -EAGAIN, "read without publish should fail");
+        ASSERT_EQUAL_INT(out, 0xAAAA, "output should be untouched");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Reads latest value only") {
+        CREATE_TRIPLE_BUFFER(triple, sizeof(uint32_t));
+        for (uint32_t v = 1; v <= 5; v++) {
+            int res = tripleBufferWrite(&triple, &v);
+            ASSERT_EQUAL_INT(res, TRIPLE_OK, "write should never block");
+        }
+        uint32_t out = 0;
+        int res = tripleBufferRead(&triple, &out);
+        ASSERT_EQUAL_INT(res, TRIPLE_OK, "read failed");
+        ASSERT_EQUAL_INT(out, 5, "should read the latest value");
+        res = tripleBufferRead(&triple, &out);
+        ASSERT_EQUAL_INT(res, -EAGAIN, "value should only be delivered once");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Interleaved reads and writes") {
+        CREATE_TRIPLE_BUFFER(triple, sizeof(TestStruct));
+        for (uint32_t v = 0; v < 10; v++) {
+            TestStruct in = {.flag = v & 1, .data = v, .ptr = NULL};
+            (void)tripleBufferWrite(&triple, &in);
+            TestStruct out;
+            int res = tripleBufferRead(&triple, &out);
+            ASSERT_EQUAL_INT(res, TRIPLE_OK, "read failed");
+            ASSERT_EQUAL_INT(out.data, v, "data mismatch");
+            ASSERT_EQUAL_INT(out.flag, v & 1, "flag mismatch");
+        }
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_TRIPLE_BUFFER(triple, sizeof(uint32_t));
+        uint32_t v = 1;
+        ASSERT_EQUAL_INT(tripleBufferWrite(NULL, &v), -EINVAL, "NULL triple buffer");
+        ASSERT_EQUAL_INT(tripleBufferWrite(&triple, NULL), -EINVAL, "NULL data");
+        ASSERT_EQUAL_INT(tripleBufferRead(NULL, &v), -EINVAL, "NULL triple buffer");
+        ASSERT_EQUAL_INT(tripleBufferRead(&triple, NULL), -EINVAL, "NULL data");
+    } CASE_COMPLETE;
+}
+
+void test_tripleBufferClaim() {
+    TEST_CASE("Zero-copy publish and read") {
+        CREATE_TRIPLE_BUFFER(triple, sizeof(uint32_t));
+        void* slot;
+        int res = tripleBufferWriteClaim(&triple, &slot);
+        ASSERT_EQUAL_INT(res, TRIPLE_OK, "write claim failed");
+        *(uint32_t*)slot = 42;
+        (void)tripleBufferWriteRelease(&triple);
+        const void* front;
+        res = tripleBufferReadClaim(&triple, &front);
+        ASSERT_EQUAL_INT(res, TRIPLE_OK, "read claim failed");
+        ASSERT_EQUAL_PTR(front, slot, "reader should get the published slot");
+        ASSERT_EQUAL_INT(*(const uint32_t*)front, 42, "data mismatch");
+        res = tripleBufferReadClaim(&triple, &front);
+        ASSERT_EQUAL_INT(res, -EAGAIN, "no new value should be reported");
+        ASSERT_EQUAL_INT(*(const uint32_t*)front, 42, "previous value should stay valid");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Writer never reuses the reader's slot") {
+        CREATE_TRIPLE_BUFFER(triple, sizeof(uint32_t));
+        uint32_t v = 7;
+        (void)tripleBufferWrite(&triple, &v);
+        const void* front;
+        (void)tripleBufferReadClaim(&triple, &front);
+        for (int i = 0; i < 4; i++) {
+            void* slot;
+            (void)tripleBufferWriteClaim(&triple, &slot);
+            ASSERT_TRUE(slot != front, "writer slot aliases reader slot");
+            (void)tripleBufferWriteRelease(&triple);
+        }
+    } CASE_COMPLETE;
+}
+
+int main() {
+    LOG_INFO("TRIPLE BUFFER TESTS\n");
+#ifdef USE_BITMAP_ALLOCATOR
+    initBlockAllocator(&testAllocator, 4, testMemory, MEMORY_SIZE);
+    TEST_EVAL(test_tripleBufferAllocate);
+    TEST_EVAL(test_tripleBufferDeallocate);
+#endif
+    TEST_EVAL(test_tripleBufferCreateMacro);
+    TEST_EVAL(test_tripleBufferRead);
+    TEST_EVAL(test_tripleBufferClaim);
+    return testGetStatus();
+}
@@ -0,0 +1,229 @@
+#include "watermark.h"
+#include "buffer.h"
+#include "queue.h"
+#include "stack.h"
+#include "test_utils.h"
+#include <string.h>
+#include <errno.h>
+
+/**
+ * @brief Records the events reported by a watermark.
+ */
+typedef struct {
+    int high;
+    int low;
+    WatermarkEvent last;
+    uint16_t count;
+} EventLog;
+
+static void logEvent(void* ctx, WatermarkEvent event, uint16_t count) {
+    EventLog* log = (EventLog*)ctx;
+    if (event == WATERMARK_HIGH) log->high++;
+    else log->low++;
+    log->last = event;
+    log->count = count;
+}
+
+void test_watermarkInit() {
+    TEST_CASE("Initializes thresholds") {
+        Watermark wm;
+        EventLog log = {0};
+        ASSERT_EQUAL_INT(watermarkInit(&wm, 6, 2, logEvent, &log), WATERMARK_OK, "init failed");
+        ASSERT_EQUAL_INT(wm.high, 6, "high mismatch");
+        ASSERT_EQUAL_INT(wm.low, 2, "low mismatch");
+        ASSERT_EQUAL_INT(GET_LOCK_VAL(&wm.raised), 0, "should start lowered");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        Watermark wm;
+        EventLog log = {0};
+        ASSERT_EQUAL_INT(watermarkInit(NULL, 6, 2, logEvent, &log), -EINVAL, "NULL watermark");
+        ASSERT_EQUAL_INT(watermarkInit(&wm, 6, 2, NULL, &log), -EINVAL, "NULL callback");
+        ASSERT_EQUAL_INT(watermarkInit(&wm, 2, 2, logEvent, &log), -EINVAL, "low must be below high");
+        ASSERT_EQUAL_INT(watermarkInit(&wm, 2, 6, logEvent, &log), -EINVAL, "low must be below high");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Drops events that were already delivered") {
+        Watermark wm;
+        EventLog log = {0};
+        (void)watermarkInit(&wm, 6, 2, logEvent, &log);
+        // as seen by two threads that both checked `raised` before either delivered
+        watermarkDeliver(&wm, WATERMARK_HIGH, 6);
+        watermarkDeliver(&wm, WATERMARK_HIGH, 7);
+        watermarkDeliver(&wm, WATERMARK_LOW, 2);
+        watermarkDeliver(&wm, WATERMARK_LOW, 1);
+        ASSERT_EQUAL_INT(log.high, 1, "high event should be delivered once");
+        ASSERT_EQUAL_INT(log.low, 1, "low event should be delivered once");
+        ASSERT_EQUAL_INT(log.count, 2, "count of the delivered low event expected");
+        ASSERT_EQUAL_INT(GET_LOCK_VAL(&wm.delivering), 0, "delivery lock should be free");
+    } CASE_COMPLETE;
+}
+
+void test_bufferWatermark() {
+    TEST_CASE("Fires once per crossing") {
+        CREATE_BUFFER(buf, 8, sizeof(uint8_t));
+        Watermark wm;
+        EventLog log = {0};
+        (void)watermarkInit(&wm, 6, 2, logEvent, &log);
+        ASSERT_EQUAL_INT(bufferSetWatermark(&buf, &wm), BUFFER_OK, "attach failed");
+        uint8_t v = 0;
+        for (int i = 0; i < 5; i++) (void)bufferWrite(&buf, &v);
+        ASSERT_EQUAL_INT(log.high, 0, "no event below the high watermark");
+        (void)bufferWrite(&buf, &v);
+        ASSERT_EQUAL_INT(log.high, 1, "high watermark should fire");
+        ASSERT_EQUAL_INT(log.count, 6, "count mismatch");
+        (void)bufferWrite(&buf, &v);
+        ASSERT_EQUAL_INT(log.high, 1, "high watermark should fire once");
+        for (int i = 0; i < 4; i++) (void)bufferRead(&buf, &v);
+        ASSERT_EQUAL_INT(log.low, 0, "no event above the low watermark");
+        (void)bufferRead(&buf, &v);
+        ASSERT_EQUAL_INT(log.low, 1, "low watermark should fire");
+        ASSERT_EQUAL_INT(log.last, WATERMARK_LOW, "event mismatch");
+        ASSERT_EQUAL_INT(log.count, 2, "count mismatch");
+        (void)bufferRead(&buf, &v);
+        ASSERT_EQUAL_INT(log.low, 1, "low watermark should fire once");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Hysteresis") {
+        CREATE_BUFFER(buf, 8, sizeof(uint8_t));
+        Watermark wm;
+        EventLog log = {0};
+        (void)watermarkInit(&wm, 4, 1, logEvent, &log);
+        (void)bufferSetWatermark(&buf, &wm);
+        uint8_t v = 0;
+        for (int i = 0; i < 4; i++) (void)bufferWrite(&buf, &v);
+        // oscillating around the high watermark does not fire again
+        for (int i = 0; i < 3; i++) {
+            (void)bufferRead(&buf, &v);
+            (void)bufferWrite(&buf, &v);
+        }
+        ASSERT_EQUAL_INT(log.high, 1, "high watermark should fire once");
+        ASSERT_EQUAL_INT(log.low, 0, "low watermark not reached");
+        for (int i = 0; i < 3; i++) (void)bufferRead(&buf, &v);
+        (void)bufferWrite(&buf, &v);
+        (void)bufferRead(&buf, &v);
+        ASSERT_EQUAL_INT(log.low, 1, "low watermark should fire once");
+        for (int i = 0; i < 4; i++) (void)bufferWrite(&buf, &v);
+        ASSERT_EQUAL_INT(log.high, 2, "high watermark should fire again");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Wrapped positions") {
+        CREATE_BUFFER(buf, 4, sizeof(uint8_t));
+        Watermark wm;
+        EventLog log = {0};
+        (void)watermarkInit(&wm, 4, 0, logEvent, &log);
+        (void)bufferSetWatermark(&buf, &wm);
+        uint8_t v = 0;
+        for (int i = 0; i < 3; i++) (void)bufferWrite(&buf, &v);
+        for (int i = 0; i < 3; i++) (void)bufferRead(&buf, &v);
+        for (int i = 0; i < 4; i++) (void)bufferWrite(&buf, &v);
+        ASSERT_EQUAL_INT(log.high, 1, "full buffer should reach the high watermark");
+        ASSERT_EQUAL_INT(log.count, 4, "count mismatch");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Detached") {
+        CREATE_BUFFER(buf, 4, sizeof(uint8_t));
+        Watermark wm;
+        EventLog log = {0};
+        (void)watermarkInit(&wm, 2, 0, logEvent, &log);
+        (void)bufferSetWatermark(&buf, &wm);
+        ASSERT_EQUAL_INT(bufferSetWatermark(&buf, NULL), BUFFER_OK, "detach failed");
+        uint8_t v = 0;
+        for (int i = 0; i < 4; i++) (void)bufferWrite(&buf, &v);
+        ASSERT_EQUAL_INT(log.high, 0, "detached watermark should not fire");
+        ASSERT_EQUAL_INT(bufferSetWatermark(NULL, &wm), -EINVAL, "NULL buffer");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Clear fires low") {
+        CREATE_BUFFER(buf, 8, sizeof(uint8_t));
+        Watermark wm;
+        EventLog log = {0};
+        (void)watermarkInit(&wm, 6, 2, logEvent, &log);
+        (void)bufferSetWatermark(&buf, &wm);
+        uint8_t v = 0;
+        bufferClear(&buf);
+        ASSERT_EQUAL_INT(log.low, 0, "no low watermark without a high one");
+        for (int i = 0; i < 6; i++) (void)bufferWrite(&buf, &v);
+        bufferClear(&buf);
+        ASSERT_EQUAL_INT(log.low, 1, "clear should fire the low watermark");
+        ASSERT_EQUAL_INT(log.count, 0, "count mismatch");
+        for (int i = 0; i < 6; i++) (void)bufferWrite(&buf, &v);
+        ASSERT_EQUAL_INT(log.high, 2, "high watermark should fire again");
+    } CASE_COMPLETE;
+}
+
+void test_queueWatermark() {
+    TEST_CASE("Counts messages") {
+        CREATE_QUEUE(q, 8, 4);
+        Watermark wm;
+        EventLog log = {0};
+        (void)watermarkInit(&wm, 3, 1, logEvent, &log);
+        ASSERT_EQUAL_INT(queueSetWatermark(&q, &wm), QUEUE_OK, "attach failed");
+        uint8_t out[8];
+        (void)queueWrite(&q, (const uint8_t*)"a", 1);
+        (void)queueWrite(&q, (const uint8_t*)"bb", 2);
+        ASSERT_EQUAL_INT(log.high, 0, "no event below the high watermark");
+        (void)queueWrite(&q, (const uint8_t*)"ccc", 3);
+        ASSERT_EQUAL_INT(log.high, 1, "high watermark should fire");
+        (void)queueRead(&q, out, 8);
+        (void)queueRead(&q, out, 8);
+        ASSERT_EQUAL_INT(log.low, 1, "low watermark should fire");
+        ASSERT_EQUAL_INT(queueSetWatermark(NULL, &wm), -EINVAL, "NULL queue");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Clear fires low") {
+        CREATE_QUEUE(q, 8, 4);
+        Watermark wm;
+        EventLog log = {0};
+        (void)watermarkInit(&wm, 2, 1, logEvent, &log);
+        (void)queueSetWatermark(&q, &wm);
+        (void)queueWrite(&q, (const uint8_t*)"a", 1);
+        (void)queueWrite(&q, (const uint8_t*)"bb", 2);
+        ASSERT_EQUAL_INT(log.high, 1, "high watermark should fire");
+        queueClear(&q);
+        ASSERT_EQUAL_INT(log.low, 1, "clear should fire the low watermark");
+        ASSERT_EQUAL_INT(log.count, 0, "count mismatch");
+    } CASE_COMPLETE;
+}
+
+void test_stackWatermark() {
+    TEST_CASE("Counts elements") {
+        CREATE_STACK(s, 4, sizeof(uint16_t));
+        Watermark wm;
+        EventLog log = {0};
+        (void)watermarkInit(&wm, 3, 0, logEvent, &log);
+        ASSERT_EQUAL_INT(stackSetWatermark(&s, &wm), STACK_OK, "attach failed");
+        uint16_t v = 1;
+        for (int i = 0; i < 3; i++) (void)stackPush(&s, &v);
+        ASSERT_EQUAL_INT(log.high, 1, "high watermark should fire");
+        ASSERT_EQUAL_INT(log.count, 3, "count mismatch");
+        for (int i = 0; i < 2; i++) (void)stackPop(&s, &v);
+        ASSERT_EQUAL_INT(log.low, 0, "no event above the low watermark");
+        (void)stackPop(&s, &v);
+        ASSERT_EQUAL_INT(log.low, 1, "low watermark should fire");
+        ASSERT_EQUAL_INT(log.count, 0, "count mismatch");
+        ASSERT_EQUAL_INT(stackSetWatermark(NULL, &wm), -EINVAL, "NULL stack");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Clear fires low") {
+        CREATE_STACK(s, 4, sizeof(uint16_t));
+        Watermark wm;
+        EventLog log = {0};
+        (void)watermarkInit(&wm, 3, 0, logEvent, &log);
+        (void)stackSetWatermark(&s, &wm);
+        uint16_t v = 1;
+        for (int i = 0; i < 3; i++) (void)stackPush(&s, &v);
+        stackClear(&s);
+        ASSERT_EQUAL_INT(log.low, 1, "clear should fire the low watermark");
+        ASSERT_EQUAL_INT(log.count, 0, "count mismatch");
+    } CASE_COMPLETE;
+}
+
+int main() {
+    LOG_INFO("WATERMARK TESTS\n");
+    TEST_EVAL(test_watermarkInit);
+    TEST_EVAL(test_bufferWatermark);
+    TEST_EVAL(test_queueWatermark);
+    TEST_EVAL(test_stackWatermark);
+    return testGetStatus();
+}
@@ -0,0 +1,178 @@
+#include "window.h"
+#ifdef USE_BITMAP_ALLOCATOR
+#include "block_allocator.h"
+#endif
+#include "test_utils.h"
+#include <string.h>
+#include <errno.h>
+
+#ifdef USE_BITMAP_ALLOCATOR
+#define MEMORY_SIZE 2048
+uint8_t testMemory[MEMORY_SIZE];
+static BlockAllocator testAllocator;
+
+void test_windowAllocate() {
+    TEST_CASE("Allocates and initializes window correctly") {
+        Window* window = windowAllocate(&testAllocator, 16, WINDOW_F64);
+        ASSERT_NOT_NULL(window, "Window should not be NULL");
+        ASSERT_NOT_NULL(window->raw, "raw should not be NULL");
+        ASSERT_NOT_NULL(window->min.slots, "min deque should not be NULL");
+        ASSERT_NOT_NULL(window->max.slots, "max deque should not be NULL");
+        ASSERT_NOT_NULL(window->lock, "lock should not be NULL");
+        ASSERT_EQUAL_INT(window->size, 16, "size mismatch");
+        ASSERT_TRUE(windowIsEmpty(window), "should be empty on init");
+        (void)windowDeallocate(&testAllocator, &window);
+    } CASE_COMPLETE;
+
+    TEST_CASE("invalid arguments") {
+        ASSERT_NULL(windowAllocate(&testAllocator, 0, WINDOW_I32), "should return NULL if `size` is zero");
+        ASSERT_NULL(windowAllocate(&testAllocator, 8, (WindowType)7), "should return NULL on unknown type");
+        ASSERT_NULL(windowAllocate(NULL, 8, WINDOW_I32), "should return NULL on invalid allocator");
+    } CASE_COMPLETE;
+}
+
+void test_windowDeallocate() {
+    TEST_CASE("Deallocates and nullifies pointer") {
+        Window* window = windowAllocate(&testAllocator, 8, WINDOW_I32);
+        int res = windowDeallocate(&testAllocator, &window);
+        ASSERT_EQUAL_INT(res, WINDOW_OK, "deallocation failed");
+        ASSERT_NULL(window, "pointer should be NULL after free");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Null pointer") {
+        ASSERT_EQUAL_INT(windowDeallocate(&testAllocator, NULL), -EINVAL, "expected -EINVAL");
+    } CASE_COMPLETE;
+}
+#endif
+
+void test_windowPush() {
+    TEST_CASE("Aggregates follow the last N samples") {
+        CREATE_WINDOW(window, 4, WINDOW_I32);
+        const int32_t samples[8] = { 5, -3, 8, 1, 7, 2, -6, 4 };
+        WindowStats stats;
+        for (int n = 0; n < 8; n++) {
+            ASSERT_EQUAL_INT(windowPush(&window, &samples[n]), WINDOW_OK, "push failed");
+            ASSERT_EQUAL_INT(windowStats(&window, &stats), WINDOW_OK, "stats failed");
+            // brute-force reference over the last four samples
+            int first = (n >= 3) ? n - 3 : 0;
+            int64_t sum = 0, min = samples[first], max = samples[first];
+            for (int k = first; k <= n; k++) {
+                sum += samples[k];
+                if (samples[k] < min) min = samples[k];
+                if (samples[k] > max) max = samples[k];
+            }
+            ASSERT_EQUAL_INT(stats.count, n - first + 1, "count mismatch");
+            ASSERT_TRUE(stats.sum.i == sum, "sum mismatch");
+            ASSERT_TRUE(stats.min.i == min, "min mismatch");
+            ASSERT_TRUE(stats.max.i == max, "max mismatch");
+            ASSERT_TRUE(stats.mean == (double)sum / stats.count, "mean mismatch");
+        }
+        ASSERT_TRUE(windowIsFull(&window), "should be full");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Monotonic input keeps the extremes at the window edges") {
+        CREATE_WINDOW(window, 8, WINDOW_I64);
+        WindowStats stats;
+        for (int64_t v = 0; v < 100; v++) {
+            (void)windowPush(&window, &v);
+        }
+        (void)windowStats(&window, &stats);
+        ASSERT_TRUE(stats.min.i == 92, "oldest sample is the minimum");
+        ASSERT_TRUE(stats.max.i == 99, "newest sample is the maximum");
+        ASSERT_TRUE(window.min.len == 8, "every sample stays a min candidate");
+        ASSERT_TRUE(window.max.len == 1, "only the newest sample is a max candidate");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Floating-point samples") {
+        CREATE_WINDOW(window, 3, WINDOW_F32);
+        const float samples[5] = { 1.5f, -2.0f, 4.25f, 0.5f, 3.0f };
+        for (int i = 0; i < 5; i++) {
+            (void)windowPush(&window, &samples[i]);
+        }
+        WindowStats stats;
+        (void)windowStats(&window, &stats);
+        ASSERT_TRUE(stats.sum.f == 7.75, "sum mismatch");
+        ASSERT_TRUE(stats.min.f == 0.5, "min mismatch");
+        ASSERT_TRUE(stats.max.f == 4.25, "max mismatch");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Floating-point sum is recomputed after a lap") {
+        CREATE_WINDOW(window, 4, WINDOW_F64);
+        // the ones are absorbed by the large sample, so the running sum
+        // goes wrong once it is evicted
+        double v = 1e16;
+        (void)windowPush(&window, &v);
+        v = 1.0;
+        for (int i = 0; i < 7; i++) {
+            (void)windowPush(&window, &v);
+        }
+        WindowStats stats;
+        (void)windowStats(&window, &stats);
+        ASSERT_TRUE(stats.sum.f == 4.0, "sum should match the window");
+        ASSERT_TRUE(stats.mean == 1.0, "mean should match the window");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Invalid arguments") {
+        CREATE_WINDOW(window, 4, WINDOW_I32);
+        int32_t v = 0;
+        WindowStats stats;
+        ASSERT_EQUAL_INT(windowPush(NULL, &v), -EINVAL, "NULL window");
+        ASSERT_EQUAL_INT(windowPush(&window, NULL), -EINVAL, "NULL sample");
+        ASSERT_EQUAL_INT(windowStats(&window, NULL), -EINVAL, "NULL stats");
+        ASSERT_EQUAL_INT(windowStats(&window, &stats), -EAGAIN, "empty window");
+    } CASE_COMPLETE;
+}
+
+void test_windowReset() {
+    TEST_CASE("Loads a whole window at once") {
+        CREATE_WINDOW(window, 8, WINDOW_I32);
+        int32_t v = 100;
+        (void)windowPush(&window, &v);
+        const int32_t samples[10] = { 9, 9, 3, 7, -1, 4, 6, 2, 8, 5 };
+        ASSERT_EQUAL_INT(windowReset(&window, samples, 10), WINDOW_OK, "reset failed");
+        WindowStats stats;
+        (void)windowStats(&window, &stats);
+        ASSERT_EQUAL_INT(stats.count, 8, "only the newest samples are kept");
+        ASSERT_TRUE(stats.sum.i == 34, "sum mismatch");
+        ASSERT_TRUE(stats.min.i == -1, "min mismatch");
+        ASSERT_TRUE(stats.max.i == 8, "max mismatch");
+        // pushes continue from the loaded window
+        v = -5;
+        (void)windowPush(&window, &v);
+        (void)windowStats(&window, &stats);
+        ASSERT_TRUE(stats.sum.i == 26, "sum after push mismatch");
+        ASSERT_TRUE(stats.min.i == -5, "min after push mismatch");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Partial window") {
+        CREATE_WINDOW(window, 8, WINDOW_F64);
+        const double samples[3] = { 2.0, 0.5, 1.0 };
+        (void)windowReset(&window, samples, 3);
+        WindowStats stats;
+        (void)windowStats(&window, &stats);
+        ASSERT_EQUAL_INT(stats.count, 3, "count mismatch");
+        ASSERT_TRUE(stats.mean == 3.5 / 3, "mean mismatch");
+        ASSERT_FALSE(windowIsFull(&window), "should not be full");
+    } CASE_COMPLETE;
+
+    TEST_CASE("Empty reset clears") {
+        CREATE_WINDOW(window, 4, WINDOW_I64);
+        int64_t v = 1;
+        (void)windowPush(&window, &v);
+        ASSERT_EQUAL_INT(windowReset(&window, NULL, 0), WINDOW_OK, "reset failed");
+        ASSERT_TRUE(windowIsEmpty(&window), "should be empty");
+        ASSERT_EQUAL_INT(windowReset(&window, NULL, 1), -EINVAL, "NULL samples");
+    } CASE_COMPLETE;
+}
+
+int main() {
+    LOG_INFO("WINDOW TESTS\n");
+#ifdef USE_BITMAP_ALLOCATOR
+    initBlockAllocator(&testAllocator, 4, testMemory, MEMORY_SIZE);
+    TEST_EVAL(test_windowAllocate);
+    TEST_EVAL(test_windowDeallocate);
+#endif
+    TEST_EVAL(test_windowPush);
+    TEST_EVAL(test_windowReset);
+    return testGetStatus();
+}